@@ -0,0 +1,184 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "hle/rt64_application.h"
+#include "hle/rt64_display_list_capture.h"
+
+// Replays a display list capture through the whole HLE and rendering pipeline as fast as possible.
+// Usage: dl_replay <capture.dlc> [--loops N] [--null]
+// With --null no window is created, so it can run on machines without a display.
+
+static void checkInterrupts() {
+    // The replay doesn't emulate a CPU, so interrupts are ignored.
+}
+
+static bool processWindowMessages() {
+#if defined(_WIN32)
+    MSG msg;
+    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+        if (msg.message == WM_QUIT) {
+            return false;
+        }
+
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+#else
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <capture.dlc> [--loops N] [--null]\n", argv[0]);
+        return 1;
+    }
+
+    const char *capturePath = argv[1];
+    uint32_t loopCount = 1;
+    bool useNull = false;
+    for (int i = 2; i < argc; i++) {
+        if ((strcmp(argv[i], "--loops") == 0) && ((i + 1) < argc)) {
+            loopCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if (strcmp(argv[i], "--null") == 0) {
+            useNull = true;
+        }
+        else {
+            fprintf(stderr, "Unknown argument %s.\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // Registers and memory that would normally be owned by the emulator.
+    std::vector<uint8_t> RDRAM(RT64::DisplayListCapture::RDRAMCaptureSize, 0);
+    std::vector<uint8_t> HEADER(0x40, 0);
+    std::vector<uint8_t> DMEM(0x1000, 0);
+    std::vector<uint8_t> IMEM(0x1000, 0);
+    uint32_t MI_INTR_REG = 0;
+    uint32_t DPC_REGS[9] = {};
+    uint32_t VI_REGS[RT64::DisplayListCapture::VIRegisterCount] = {};
+
+    RT64::Application::Core core = {};
+    core.window = {};
+    core.HEADER = HEADER.data();
+    core.RDRAM = RDRAM.data();
+    core.DMEM = DMEM.data();
+    core.IMEM = IMEM.data();
+    core.MI_INTR_REG = &MI_INTR_REG;
+    core.DPC_START_REG = &DPC_REGS[0];
+    core.DPC_END_REG = &DPC_REGS[1];
+    core.DPC_CURRENT_REG = &DPC_REGS[2];
+    core.DPC_STATUS_REG = &DPC_REGS[3];
+    core.DPC_CLOCK_REG = &DPC_REGS[4];
+    core.DPC_BUFBUSY_REG = &DPC_REGS[5];
+    core.DPC_PIPEBUSY_REG = &DPC_REGS[6];
+    core.DPC_TMEM_REG = &DPC_REGS[7];
+
+    // Must match the order used by Application::Core::copyVIRegisters().
+    core.VI_STATUS_REG = &VI_REGS[0];
+    core.VI_ORIGIN_REG = &VI_REGS[1];
+    core.VI_WIDTH_REG = &VI_REGS[2];
+    core.VI_INTR_REG = &VI_REGS[3];
+    core.VI_V_CURRENT_LINE_REG = &VI_REGS[4];
+    core.VI_TIMING_REG = &VI_REGS[5];
+    core.VI_V_SYNC_REG = &VI_REGS[6];
+    core.VI_H_SYNC_REG = &VI_REGS[7];
+    core.VI_LEAP_REG = &VI_REGS[8];
+    core.VI_H_START_REG = &VI_REGS[9];
+    core.VI_V_START_REG = &VI_REGS[10];
+    core.VI_V_BURST_REG = &VI_REGS[11];
+    core.VI_X_SCALE_REG = &VI_REGS[12];
+    core.VI_Y_SCALE_REG = &VI_REGS[13];
+    core.checkInterrupts = &checkInterrupts;
+
+    // Use the default configuration so results don't depend on the user's settings.
+    RT64::ApplicationConfiguration appConfig;
+    appConfig.useConfigurationFile = false;
+
+    std::unique_ptr<RT64::Application> application = std::make_unique<RT64::Application>(core, appConfig);
+    if (useNull) {
+        application->userConfig.graphicsAPI = RT64::UserConfiguration::GraphicsAPI::Null;
+    }
+
+    if (application->setup(0) != RT64::Application::SetupResult::Success) {
+        fprintf(stderr, "Failed to set up the application.\n");
+        return 1;
+    }
+
+    application->swapChain->setVsyncEnabled(false);
+
+    RT64::DisplayListCapture::Event event;
+    uint64_t frameCount = 0;
+    double slowestFrameMs = 0.0;
+    bool running = true;
+    auto replayBegin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; (i < loopCount) && running; i++) {
+        RT64::DisplayListCaptureReader reader;
+        if (!reader.open(capturePath)) {
+            fprintf(stderr, "Failed to open %s.\n", capturePath);
+            return 1;
+        }
+
+        // Every loop must start from the same memory contents to be deterministic.
+        memset(RDRAM.data(), 0, RDRAM.size());
+
+        auto frameBegin = std::chrono::steady_clock::now();
+        while (running && reader.readEvent(RDRAM.data(), event)) {
+            switch (event.type) {
+            case RT64::DisplayListCapture::EventType::DisplayLists: {
+                const RT64::DisplayListCapture::DisplayListsEvent &dlEvent = event.displayLists;
+                uint8_t *memory = event.inlineDisplayLists.empty() ? RDRAM.data() : event.inlineDisplayLists.data();
+                if (dlEvent.isHLE) {
+                    application->interpreter->loadUCodeGBI(dlEvent.ucodeTextAddress, dlEvent.ucodeDataAddress, true);
+                }
+
+                application->processDisplayLists(memory, dlEvent.dlStartAddress, dlEvent.dlEndAddress, dlEvent.isHLE);
+                break;
+            }
+            case RT64::DisplayListCapture::EventType::UpdateScreen: {
+                memcpy(VI_REGS, event.viRegisters, sizeof(VI_REGS));
+                application->updateScreen();
+                running = processWindowMessages();
+
+                auto frameEnd = std::chrono::steady_clock::now();
+                slowestFrameMs = std::max(slowestFrameMs, std::chrono::duration<double, std::milli>(frameEnd - frameBegin).count());
+                frameBegin = frameEnd;
+                frameCount++;
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    // Wait for all the submitted work to finish so the total time includes it.
+    application->workloadQueue->waitForWorkloadId(application->state->workloadId);
+    application->presentQueue->waitForPresentId(application->state->presentId);
+
+    const double replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replayBegin).count();
+    if (frameCount > 0) {
+        fprintf(stdout, "Replayed %" PRIu64 " frames in %.3f ms (average %.3f ms, slowest %.3f ms, %.2f FPS).\n", frameCount, replayMs, replayMs / frameCount, slowestFrameMs, (frameCount * 1000.0) / replayMs);
+    }
+    else {
+        fprintf(stdout, "No frames were found in the capture.\n");
+    }
+
+    application->end();
+    return 0;
+}
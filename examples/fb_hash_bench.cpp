@@ -0,0 +1,200 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "xxHash/xxh3.h"
+
+#include "hle/rt64_framebuffer.h"
+#include "shared/rt64_f3d_defines.h"
+
+#ifdef __GNUC__
+#define _byteswap_ulong __builtin_bswap32
+#endif
+
+// Compares detecting and swapping CPU writes to framebuffers in RDRAM with a single hash of the whole framebuffer against the per-block
+// hashes used by Framebuffer. Synthetic writes are made to an RDRAM image every frame and both methods must agree on the contents of the
+// swapped copy. The block hashes are checked and then committed after the swap like the screen framebuffer does. The upload to the GPU is
+// the same for both methods and is not included.
+// Usage: fb_hash_bench [--frames N]
+
+namespace {
+    const uint32_t RDRAMSize = 0x800000;
+    const uint32_t FramebufferAddress = 0x300000;
+
+    struct FramebufferSize {
+        const char *name;
+        uint32_t width;
+        uint32_t height;
+        uint8_t siz;
+    };
+
+    const FramebufferSize FramebufferSizes[] = {
+        { "320x240 16-bit", 320, 240, G_IM_SIZ_16b },
+        { "640x480 16-bit", 640, 480, G_IM_SIZ_16b },
+        { "640x480 32-bit", 640, 480, G_IM_SIZ_32b }
+    };
+
+    struct WritePattern {
+        const char *name;
+
+        // Rows written every frame. Zero leaves the framebuffer untouched.
+        uint32_t rowCount;
+    };
+
+    const WritePattern WritePatterns[] = {
+        { "no writes", 0 },
+        { "8 rows", 8 },
+        { "all rows", UINT32_MAX }
+    };
+
+    // The method used before the per-block hashes: the whole framebuffer is hashed and swapped when the hash changes.
+    struct FullHashTracker {
+        uint64_t RAMHash = 0;
+        std::vector<uint8_t> nativeSwappedRAM;
+
+        bool check(const uint8_t *fbRAM, uint32_t RAMBytes) {
+            const uint64_t newHash = XXH3_64bits(fbRAM, RAMBytes);
+            if (newHash != RAMHash) {
+                RAMHash = newHash;
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+
+        void swap(const uint8_t *fbRAM, uint32_t nativeSize) {
+            nativeSwappedRAM.resize(nativeSize);
+
+            const uint32_t *srcWords = reinterpret_cast<const uint32_t *>(fbRAM);
+            uint32_t *dstWords = reinterpret_cast<uint32_t *>(nativeSwappedRAM.data());
+            for (uint32_t i = 0; i < (nativeSize / sizeof(uint32_t)); i++) {
+                dstWords[i] = _byteswap_ulong(srcWords[i]);
+            }
+        }
+    };
+
+    // Writes the rows of the pattern at a position that moves every frame, like a counter or a text box being drawn by the CPU.
+    void writeRows(uint8_t *fbRAM, uint32_t rowBytes, uint32_t height, uint32_t rowCount, uint32_t frame) {
+        if (rowCount == 0) {
+            return;
+        }
+
+        const uint32_t writeRowCount = std::min(rowCount, height);
+        const uint32_t rowStart = (frame * 3) % (height - writeRowCount + 1);
+        memset(&fbRAM[rowStart * rowBytes], int(frame & 0xFF), writeRowCount * rowBytes);
+    }
+
+    struct BenchmarkResult {
+        double fullTime = 0.0;
+        double blockTime = 0.0;
+        uint32_t mismatchCount = 0;
+    };
+
+    BenchmarkResult runBenchmark(std::vector<uint8_t> &RDRAM, const FramebufferSize &size, const WritePattern &pattern, uint32_t frameCount) {
+        uint8_t *fbRAM = &RDRAM[FramebufferAddress];
+        const uint32_t rowBytes = size.width << size.siz >> 1;
+        const uint32_t RAMBytes = rowBytes * size.height;
+        for (uint32_t i = 0; i < RAMBytes; i++) {
+            fbRAM[i] = uint8_t(i * 31);
+        }
+
+        RT64::Framebuffer fb;
+        fb.addressStart = FramebufferAddress;
+        fb.addressEnd = FramebufferAddress + RAMBytes;
+        fb.width = size.width;
+        fb.height = size.height;
+        fb.maxHeight = size.height;
+        fb.siz = size.siz;
+        fb.RAMBytes = RAMBytes;
+
+        // Both methods start from a framebuffer whose contents were already swapped once.
+        FullHashTracker fullTracker;
+        fullTracker.check(fbRAM, RAMBytes);
+        fullTracker.swap(fbRAM, RAMBytes);
+        fb.checkRAMBlocks(fbRAM, true);
+        fb.swapDirtyRAMToNative(fbRAM);
+
+        BenchmarkResult result;
+        for (uint32_t f = 0; f < frameCount; f++) {
+            writeRows(fbRAM, rowBytes, size.height, pattern.rowCount, f + 1);
+
+            // The method that runs first pays for bringing the written rows into the cache, so the order alternates every frame.
+            bool fullChanged = false;
+            bool blockChanged = false;
+            auto runFull = [&]() {
+                const auto startTime = std::chrono::steady_clock::now();
+                fullChanged = fullTracker.check(fbRAM, RAMBytes);
+                if (fullChanged) {
+                    fullTracker.swap(fbRAM, RAMBytes);
+                }
+
+                result.fullTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+            };
+
+            auto runBlock = [&]() {
+                const auto startTime = std::chrono::steady_clock::now();
+                blockChanged = fb.checkRAMBlocks(fbRAM, false);
+                if (blockChanged) {
+                    fb.swapDirtyRAMToNative(fbRAM);
+                    fb.commitRAMBlocks();
+                }
+
+                result.blockTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+            };
+
+            if ((f & 1) == 0) {
+                runFull();
+                runBlock();
+            }
+            else {
+                runBlock();
+                runFull();
+            }
+
+            if ((fullChanged != blockChanged) || (fullTracker.nativeSwappedRAM != fb.nativeSwappedRAM)) {
+                result.mismatchCount++;
+            }
+        }
+
+        result.fullTime /= frameCount;
+        result.blockTime /= frameCount;
+        return result;
+    }
+};
+
+int main(int argc, char **argv) {
+    uint32_t frameCount = 1000;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "--frames") == 0) && hasValue) {
+            frameCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> RDRAM(RDRAMSize, 0);
+    uint32_t mismatchCount = 0;
+    for (const FramebufferSize &size : FramebufferSizes) {
+        for (const WritePattern &pattern : WritePatterns) {
+            const BenchmarkResult result = runBenchmark(RDRAM, size, pattern, frameCount);
+            printf("%s, %s: full hash %8.2f us, block hash %8.2f us per frame, %5.2fx speedup.\n", size.name, pattern.name, result.fullTime, result.blockTime, result.fullTime / result.blockTime);
+            if (result.mismatchCount > 0) {
+                fprintf(stderr, "%s, %s: the methods disagreed on %u frames.\n", size.name, pattern.name, result.mismatchCount);
+                mismatchCount += result.mismatchCount;
+            }
+        }
+    }
+
+    return (mismatchCount > 0) ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "xxHash/xxh3.h"
+
+#include "common/rt64_flat_hash_map.h"
+
+// Measures the lookups per second of FlatHashMap against the std::unordered_map it replaced for the texture hash lookups. The keys are XXH3
+// hashes like the ones used by the texture cache. Lookups are done in a shuffled order, both for keys that are in the map and for keys that
+// aren't, and both maps must return the same results.
+// Usage: flat_hash_bench [--lookups N]
+
+namespace {
+    const size_t EntryCounts[] = { 10000, 100000, 1000000 };
+
+    struct LookupResult {
+        double seconds = 0.0;
+        uint64_t checksum = 0;
+    };
+
+    // Each lookup adds the found value to a checksum, so the lookups can't be removed and both maps can be compared.
+    template<typename Map>
+    LookupResult runLookups(const Map &map, const std::vector<uint64_t> &keys, size_t lookupCount) {
+        LookupResult result;
+        const auto startTime = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookupCount; i++) {
+            auto it = map.find(keys[i % keys.size()]);
+            if (it != map.end()) {
+                result.checksum += it->second + 1;
+            }
+        }
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return result;
+    }
+
+    uint64_t hashIndex(uint64_t index) {
+        return XXH3_64bits(&index, sizeof(index));
+    }
+
+    // Shuffles with a fixed sequence so every run does the same lookups.
+    void shuffleKeys(std::vector<uint64_t> &keys) {
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (size_t i = keys.size() - 1; i > 0; i--) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            std::swap(keys[i], keys[(state >> 33) % (i + 1)]);
+        }
+    }
+
+    void printResult(const char *name, size_t entryCount, const char *lookupType, size_t lookupCount, const LookupResult &result) {
+        printf("%-18s %8zu entries, %s: %8.2f million lookups per second.\n", name, entryCount, lookupType, double(lookupCount) / (result.seconds * 1e6));
+    }
+};
+
+int main(int argc, char **argv) {
+    size_t lookupCount = 10000000;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "--lookups") == 0) && hasValue) {
+            lookupCount = std::max(size_t(strtoull(argv[++i], nullptr, 10)), size_t(1));
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    uint32_t mismatchCount = 0;
+    for (size_t entryCount : EntryCounts) {
+        RT64::FlatHashMap<uint32_t> flatMap;
+        std::unordered_map<uint64_t, uint32_t> unorderedMap;
+        std::vector<uint64_t> hitKeys(entryCount);
+        std::vector<uint64_t> missKeys(entryCount);
+        for (size_t i = 0; i < entryCount; i++) {
+            hitKeys[i] = hashIndex(i);
+            missKeys[i] = hashIndex(entryCount + i);
+            flatMap.emplace(hitKeys[i], uint32_t(i));
+            unorderedMap.emplace(hitKeys[i], uint32_t(i));
+        }
+
+        shuffleKeys(hitKeys);
+        shuffleKeys(missKeys);
+
+        // Warm up both maps before measuring.
+        runLookups(flatMap, hitKeys, entryCount);
+        runLookups(unorderedMap, hitKeys, entryCount);
+
+        const LookupResult flatHits = runLookups(flatMap, hitKeys, lookupCount);
+        const LookupResult unorderedHits = runLookups(unorderedMap, hitKeys, lookupCount);
+        const LookupResult flatMisses = runLookups(flatMap, missKeys, lookupCount);
+        const LookupResult unorderedMisses = runLookups(unorderedMap, missKeys, lookupCount);
+        printResult("FlatHashMap", entryCount, "hits  ", lookupCount, flatHits);
+        printResult("std::unordered_map", entryCount, "hits  ", lookupCount, unorderedHits);
+        printResult("FlatHashMap", entryCount, "misses", lookupCount, flatMisses);
+        printResult("std::unordered_map", entryCount, "misses", lookupCount, unorderedMisses);
+
+        if ((flatHits.checksum != unorderedHits.checksum) || (flatMisses.checksum != 0) || (unorderedMisses.checksum != 0)) {
+            fprintf(stderr, "%zu entries: the maps returned different values.\n", entryCount);
+            mismatchCount++;
+        }
+    }
+
+    return (mismatchCount > 0) ? 1 : 0;
+}
@@ -0,0 +1,777 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "common/rt64_math.h"
+#include "hle/rt64_game_frame.h"
+#include "hle/rt64_workload_queue.h"
+#include "shared/rt64_f3d_defines.h"
+
+// Replays a deterministic sequence of synthetic frames through GameFrame::match and through a reference matcher that uses the std::multimap and
+// std::set containers the matching was originally written with. Every pair of consecutive frames must produce the same GameFrameMap with both
+// matchers, and the time each of them takes is reported. Vertex interpolation is left disabled in every transform group so the matching never
+// submits velocity uploads and no render device is required.
+// Usage: frame_match_bench [--frames N] [--iterations N]
+
+namespace {
+    const uint32_t ObjectCount = 160;
+    const uint32_t HudObjectCount = 24;
+    const uint32_t TriangleCounts[] = { 2, 4, 8, 12 };
+    const uint32_t TMEMHashCount = 8;
+
+    // Small generator with a fixed output sequence on every platform and standard library.
+    struct SplitMix64 {
+        uint64_t state;
+
+        SplitMix64(uint64_t seed) {
+            state = seed;
+        }
+
+        uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        uint32_t range(uint32_t count) {
+            return uint32_t(next() % count);
+        }
+
+        float unit() {
+            return float(next() >> 40) / float(1 << 24);
+        }
+    };
+
+    // Properties of an object that stay the same on every frame. Only the transforms and the tile coordinates change over time.
+    struct SceneObject {
+        uint32_t matrixId = G_EX_ID_AUTO;
+        uint8_t ordering = G_EX_ORDER_AUTO;
+        uint8_t tileInterpolation = G_EX_COMPONENT_AUTO;
+        uint32_t triangleCount = 0;
+        uint64_t tmemHash = 0;
+        float position[3] = {};
+        float velocity[3] = {};
+        float spin = 0.0f;
+        float scale = 1.0f;
+        float tileScroll = 0.0f;
+        int tileMask = 0;
+        bool mirrored = false;
+        bool hud = false;
+    };
+
+    void generateObjects(std::vector<SceneObject> &objects) {
+        SplitMix64 random(0x4D415443484D4150ULL);
+        objects.resize(ObjectCount + HudObjectCount);
+        for (uint32_t i = 0; i < objects.size(); i++) {
+            SceneObject &object = objects[i];
+            object.hud = (i >= ObjectCount);
+
+            // Mix automatic matching with every kind of ID so all the paths of the matching are used. A few IDs are shared between objects.
+            const uint32_t kind = random.range(10);
+            if (kind < 5) {
+                object.matrixId = G_EX_ID_AUTO;
+            }
+            else if (kind < 7) {
+                object.matrixId = 0x100 + random.range(48);
+                object.ordering = G_EX_ORDER_LINEAR;
+            }
+            else if (kind < 9) {
+                object.matrixId = 0x200 + random.range(48);
+                object.ordering = G_EX_ORDER_AUTO;
+            }
+            else {
+                object.matrixId = G_EX_ID_IGNORE;
+            }
+
+            // Few distinct triangle counts and texture hashes give many calls with the same hash, like most games do.
+            object.triangleCount = TriangleCounts[random.range(uint32_t(std::size(TriangleCounts)))];
+            object.tmemHash = 0x1000 + random.range(TMEMHashCount);
+            object.tileInterpolation = (random.range(8) == 0) ? G_EX_COMPONENT_SKIP : G_EX_COMPONENT_AUTO;
+            for (uint32_t c = 0; c < 3; c++) {
+                object.position[c] = (random.unit() - 0.5f) * 200.0f;
+                object.velocity[c] = (random.unit() - 0.5f) * 4.0f;
+            }
+
+            object.spin = (random.unit() - 0.5f) * 0.2f;
+            object.scale = 0.5f + random.unit();
+            object.tileScroll = (random.range(2) == 0) ? (random.unit() * 3.0f) : 0.0f;
+            object.tileMask = 4 + random.range(4);
+            object.mirrored = (random.range(16) == 0);
+        }
+    }
+
+    interop::float4x4 objectTransform(const SceneObject &object, uint32_t frame) {
+        const float angle = object.spin * frame;
+        const float c = cosf(angle) * object.scale;
+        const float s = sinf(angle) * object.scale;
+        const float mirror = object.mirrored ? -1.0f : 1.0f;
+        return interop::float4x4(
+            c * mirror, 0.0f, -s, 0.0f,
+            0.0f, object.scale, 0.0f, 0.0f,
+            s, 0.0f, c, 0.0f,
+            object.position[0] + object.velocity[0] * frame, object.position[1] + object.velocity[1] * frame, object.position[2] + object.velocity[2] * frame, 1.0f);
+    }
+
+    void addObject(RT64::Workload &workload, const SceneObject &object, uint32_t frame) {
+        RT64::DrawData &drawData = workload.drawData;
+        const uint32_t transformIndex = uint32_t(drawData.worldTransforms.size());
+        RT64::TransformGroup group;
+        group.matrixId = object.matrixId;
+        group.ordering = object.ordering;
+        group.tileInterpolation = object.tileInterpolation;
+        drawData.worldTransforms.emplace_back(objectTransform(object, frame));
+        drawData.worldTransformGroups.emplace_back(uint32_t(drawData.transformGroups.size()));
+        drawData.transformGroups.emplace_back(group);
+        drawData.worldTransformVertexIndices.emplace_back(drawData.vertexCount());
+        for (uint32_t v = 0; v < 3; v++) {
+            for (uint32_t c = 0; c < 3; c++) {
+                drawData.posShorts.emplace_back(int16_t(v * 16 + c));
+                drawData.velShorts.emplace_back(int16_t(0));
+            }
+
+            drawData.worldIndices.emplace_back(uint16_t(transformIndex));
+        }
+
+        const uint32_t tileIndex = uint32_t(drawData.rdpTiles.size());
+        interop::RDPTile rdpTile = {};
+        rdpTile.masks = object.tileMask;
+        rdpTile.maskt = object.tileMask;
+        rdpTile.uls = object.tileScroll * frame;
+        rdpTile.ult = object.tileScroll * frame * 0.5f;
+        rdpTile.lrs = rdpTile.uls + 31.0f;
+        rdpTile.lrt = rdpTile.ult + 31.0f;
+        drawData.rdpTiles.emplace_back(rdpTile);
+
+        RT64::DrawCallTile callTile = {};
+        callTile.tmemHashOrID = object.tmemHash;
+        drawData.callTiles.emplace_back(callTile);
+
+        RT64::GameCall gameCall = {};
+        gameCall.callDesc.minWorldMatrix = uint16_t(transformIndex);
+        gameCall.callDesc.maxWorldMatrix = uint16_t(transformIndex);
+        gameCall.callDesc.triangleCount = object.triangleCount;
+        gameCall.callDesc.tileIndex = tileIndex;
+        gameCall.callDesc.tileCount = 1;
+        workload.fbPairs[0].addGameCall(gameCall);
+    }
+
+    // Fills the workload with the frame. Objects are submitted in a different order every frame and a few of them are missing on some frames,
+    // so the matching can't rely on the calls lining up between frames.
+    void generateFrame(RT64::Workload &workload, const std::vector<SceneObject> &objects, uint32_t frame) {
+        workload.reset();
+        workload.fbPairCount = 1;
+
+        RT64::FramebufferPair &fbPair = workload.fbPairs[0];
+        fbPair.colorImage.address = 0x100000;
+        fbPair.colorImage.fmt = G_IM_FMT_RGBA;
+        fbPair.colorImage.siz = G_IM_SIZ_16b;
+        fbPair.colorImage.width = 320;
+
+        // The first transforms are the perspective camera, which pans slowly, and the second ones are the orthographic projection of the HUD.
+        RT64::DrawData &drawData = workload.drawData;
+        const float cameraX = frame * 0.5f;
+        const interop::float4x4 perspView(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -cameraX, 0.0f, -300.0f, 1.0f);
+        const interop::float4x4 perspProj(1.5f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, -1.0f, 0.0f, 0.0f, -2.0f, 0.0f);
+        const interop::float4x4 orthoView = interop::float4x4::identity();
+        const interop::float4x4 orthoProj(2.0f / 320.0f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f / 240.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, -1.0f, -1.0f, 0.0f, 1.0f);
+        drawData.viewTransforms = { perspView, orthoView };
+        drawData.projTransforms = { perspProj, orthoProj };
+        drawData.viewProjTransforms = { hlslpp::mul(hlslpp::float4x4(perspView), hlslpp::float4x4(perspProj)), hlslpp::mul(hlslpp::float4x4(orthoView), hlslpp::float4x4(orthoProj)) };
+        drawData.viewProjTransformGroups = { 0, 0 };
+        drawData.transformGroups.emplace_back(RT64::TransformGroup());
+
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < objects.size(); i++) {
+            if (((i + frame) % 13) != 0) {
+                order.emplace_back(i);
+            }
+        }
+
+        SplitMix64 random(0x5245504C4159ULL + frame);
+        for (size_t i = order.size() - 1; i > 0; i--) {
+            std::swap(order[i], order[random.range(uint32_t(i + 1))]);
+        }
+
+        for (bool hud : { false, true }) {
+            fbPair.changeProjection(hud ? 1 : 0, hud ? RT64::Projection::Type::Orthographic : RT64::Projection::Type::Perspective);
+            for (uint32_t i : order) {
+                if (objects[i].hud == hud) {
+                    addObject(workload, objects[i], frame);
+                }
+            }
+        }
+    }
+
+    // Reference matcher. It's the matching as it was written before it used flat containers, and it must only change if GameFrame::match changes.
+
+    typedef std::pair<uint32_t, uint32_t> IndexPair;
+
+    struct MatchCandidate {
+        uint32_t curIndex = 0;
+        uint32_t prevIndex = 0;
+        float difference = FLT_MAX;
+
+        MatchCandidate(uint32_t curIndex, uint32_t prevIndex, float difference) {
+            this->curIndex = curIndex;
+            this->prevIndex = prevIndex;
+            this->difference = difference;
+        }
+    };
+
+    bool operator<(const MatchCandidate &lhs, const MatchCandidate &rhs) {
+        return lhs.difference < rhs.difference;
+    }
+
+    struct TransformMatchResult {
+        float positionDifference = FLT_MAX;
+        float orientationDifference = FLT_MAX;
+        float screenSpaceDifference = FLT_MAX;
+        bool valid = false;
+
+        float computeDifference() const {
+            if (!valid) {
+                return FLT_MAX;
+            }
+
+            float totalDiff = 0.0f;
+            if (positionDifference < FLT_MAX) {
+                totalDiff += positionDifference;
+            }
+
+            if (orientationDifference < FLT_MAX) {
+                totalDiff += orientationDifference;
+            }
+
+            if (screenSpaceDifference < FLT_MAX) {
+                totalDiff += screenSpaceDifference;
+            }
+
+            return totalDiff;
+        }
+    };
+
+    TransformMatchResult computeTransformMatch(const hlslpp::float4x4 &curTransform, const hlslpp::float4x4 &curViewProj, const hlslpp::float4x4 &prevTransform, const hlslpp::float4x4 &prevViewProj, const RT64::RigidBody *prevRigidBody) {
+        TransformMatchResult matchResult;
+        const float m0det = hlslpp::determinant(RT64::extract3x3(prevTransform));
+        const float m1det = hlslpp::determinant(RT64::extract3x3(curTransform));
+        if ((m0det * m1det) < 0.0f) {
+            return matchResult;
+        }
+
+        const hlslpp::float3 curPos = curTransform[3].xyz;
+        hlslpp::float3 prevPos = prevTransform[3].xyz;
+        if (prevRigidBody != nullptr) {
+            prevPos += prevRigidBody->linearVelocity;
+        }
+
+        matchResult.positionDifference = hlslpp::length(curPos - prevPos);
+        matchResult.orientationDifference =
+            (1.0f - hlslpp::dot(hlslpp::normalize(curTransform[0].xyz), hlslpp::normalize(prevTransform[0].xyz))) +
+            (1.0f - hlslpp::dot(hlslpp::normalize(curTransform[1].xyz), hlslpp::normalize(prevTransform[1].xyz))) +
+            (1.0f - hlslpp::dot(hlslpp::normalize(curTransform[2].xyz), hlslpp::normalize(prevTransform[2].xyz)));
+
+        hlslpp::float4 prevScreenPos = hlslpp::mul(prevTransform[3], prevViewProj);
+        hlslpp::float4 curScreenPos = hlslpp::mul(curTransform[3], curViewProj);
+        prevScreenPos = (fabs(prevScreenPos.w) < 1e-6f) ? prevScreenPos : prevScreenPos / prevScreenPos.w;
+        curScreenPos = (fabs(curScreenPos.w) < 1e-6f) ? curScreenPos : curScreenPos / curScreenPos.w;
+        matchResult.screenSpaceDifference = hlslpp::length(curScreenPos.xyz - prevScreenPos.xyz);
+        matchResult.valid = true;
+        return matchResult;
+    }
+
+    void referenceBuildCallHashMap(const RT64::GameFrame &frame, uint32_t sceneProjIndex, const RT64::Workload &workload, const RT64::Projection &proj, std::multimap<uint64_t, RT64::GameCallMap> &hashMap) {
+        for (uint32_t c = 0; c < proj.gameCallCount; c++) {
+            const RT64::GameCall &call = proj.gameCalls[c];
+            uint32_t matrixIdHash = 0;
+            bool doTransformMatching = false;
+            bool doTileMatching = false;
+            for (uint32_t m = call.callDesc.minWorldMatrix; m <= call.callDesc.maxWorldMatrix; m++) {
+                const uint32_t groupIndex = workload.drawData.worldTransformGroups[m];
+                const RT64::TransformGroup &group = workload.drawData.transformGroups[groupIndex];
+                matrixIdHash = matrixIdHash * 33 ^ group.matrixId;
+
+                const bool usesIdWithAutoOrdering = (group.matrixId != G_EX_ID_AUTO) && (group.matrixId != G_EX_ID_IGNORE) && (group.ordering == G_EX_ORDER_AUTO);
+                doTransformMatching = doTransformMatching || (group.matrixId == G_EX_ID_AUTO) || usesIdWithAutoOrdering;
+                doTileMatching = doTileMatching || (group.tileInterpolation != G_EX_COMPONENT_SKIP);
+            }
+
+            hashMap.emplace(frame.hashFromCall(call, matrixIdHash), RT64::GameCallMap{ sceneProjIndex, c, doTransformMatching, doTileMatching });
+        }
+    }
+
+    void referenceBuildTransformIdMap(const RT64::Workload &workload, std::multimap<uint32_t, uint32_t> &idMap, std::vector<uint32_t> &ignoredIdVector) {
+        idMap.clear();
+        ignoredIdVector.clear();
+
+        const uint32_t transformCount = uint32_t(workload.drawData.worldTransformGroups.size());
+        for (uint32_t i = 0; i < transformCount; i++) {
+            const uint32_t groupIndex = workload.drawData.worldTransformGroups[i];
+            const RT64::TransformGroup &group = workload.drawData.transformGroups[groupIndex];
+            if (group.matrixId == G_EX_ID_AUTO) {
+                continue;
+            }
+            else if (group.matrixId == G_EX_ID_IGNORE) {
+                ignoredIdVector.emplace_back(i);
+            }
+            else if (group.ordering == G_EX_ORDER_LINEAR) {
+                idMap.emplace(group.matrixId, i);
+            }
+        }
+    }
+
+    void referenceMatchScene(RT64::GameFrame &frame, RT64::WorkloadQueue &workloadQueue, const RT64::GameFrame &prevFrame, const RT64::GameScene &curScene, const RT64::GameScene &prevScene, bool &tileInterpolationUsed) {
+        if (curScene.projections.empty() || prevScene.projections.empty()) {
+            return;
+        }
+
+        std::multimap<uint64_t, RT64::GameCallMap> curCallHashMap;
+        std::multimap<uint64_t, RT64::GameCallMap> prevCallHashMap;
+        const RT64::GameIndices::Projection &firstCurProjIndices = curScene.projections[0];
+        const RT64::GameIndices::Projection &firstPrevProjIndices = prevScene.projections[0];
+        RT64::GameFrameMap::WorkloadMap &firstCurWorkloadMap = frame.frameMap.workloads[firstCurProjIndices.workloadIndex];
+        RT64::Workload &firstCurWorkload = workloadQueue.workloads[firstCurProjIndices.workloadIndex];
+        const RT64::Projection &firstCurProj = firstCurWorkload.fbPairs[firstCurProjIndices.fbPairIndex].projections[firstCurProjIndices.projectionIndex];
+        const RT64::Workload &firstPrevWorkload = workloadQueue.workloads[firstPrevProjIndices.workloadIndex];
+        const RT64::Projection &firstPrevProj = firstPrevWorkload.fbPairs[firstPrevProjIndices.fbPairIndex].projections[firstPrevProjIndices.projectionIndex];
+        const RT64::GameFrameMap::WorkloadMap *firstPrevWorkloadMap = nullptr;
+        if (prevFrame.matched && prevFrame.frameMap.workloads[firstPrevProjIndices.workloadIndex].mapped) {
+            firstPrevWorkloadMap = &prevFrame.frameMap.workloads[firstPrevProjIndices.workloadIndex];
+        }
+
+        uint32_t mappedViewProjIndex = UINT32_MAX;
+        for (uint32_t p = 0; p < curScene.projections.size(); p++) {
+            const RT64::GameIndices::Projection &curProjIndices = curScene.projections[p];
+            RT64::Workload &curWorkload = workloadQueue.workloads[curProjIndices.workloadIndex];
+            const RT64::Projection &curProj = curWorkload.fbPairs[curProjIndices.fbPairIndex].projections[curProjIndices.projectionIndex];
+            referenceBuildCallHashMap(frame, p, curWorkload, curProj, curCallHashMap);
+
+            if (mappedViewProjIndex < UINT32_MAX) {
+                firstCurWorkloadMap.viewProjections[curProj.transformsIndex] = firstCurWorkloadMap.viewProjections[mappedViewProjIndex];
+            }
+
+            if (p >= prevScene.projections.size()) {
+                continue;
+            }
+
+            if (mappedViewProjIndex == UINT32_MAX) {
+                RT64::GameFrameMap::ViewProjectionMap &viewProjMap = firstCurWorkloadMap.viewProjections[curProj.transformsIndex];
+                if (viewProjMap.mapped) {
+                    mappedViewProjIndex = curProj.transformsIndex;
+                    continue;
+                }
+
+                const RT64::GameIndices::Projection &prevProjIndices = prevScene.projections[p];
+                const RT64::Workload &prevWorkload = workloadQueue.workloads[prevProjIndices.workloadIndex];
+                const RT64::Projection &prevProj = prevWorkload.fbPairs[prevProjIndices.fbPairIndex].projections[prevProjIndices.projectionIndex];
+                const hlslpp::float4x4 &curView = curWorkload.drawData.viewTransforms[curProj.transformsIndex];
+                const hlslpp::float4x4 &prevView = prevWorkload.drawData.viewTransforms[prevProj.transformsIndex];
+                const RT64::TransformGroup &curProjGroup = curWorkload.drawData.transformGroups[curWorkload.drawData.viewProjTransformGroups[curProj.transformsIndex]];
+                const RT64::TransformGroup &prevProjGroup = prevWorkload.drawData.transformGroups[prevWorkload.drawData.viewProjTransformGroups[prevProj.transformsIndex]];
+                bool projectionDecompose = false;
+                uint8_t projectionLinearComponent = G_EX_COMPONENT_INTERPOLATE;
+                uint8_t projectionAngularComponent = G_EX_COMPONENT_INTERPOLATE;
+                uint8_t projectionScaleComponent = G_EX_COMPONENT_INTERPOLATE;
+                uint8_t projectionSkewComponent = G_EX_COMPONENT_INTERPOLATE;
+                if ((curProjGroup.matrixId != G_EX_ID_IGNORE) && (curProjGroup.matrixId != G_EX_ID_AUTO)) {
+                    projectionDecompose = curProjGroup.decompose;
+                    projectionLinearComponent = curProjGroup.positionInterpolation;
+                    projectionAngularComponent = curProjGroup.rotationInterpolation;
+                    projectionScaleComponent = curProjGroup.scaleInterpolation;
+                    projectionSkewComponent = curProjGroup.skewInterpolation;
+                    viewProjMap.mapped = (curProjGroup.matrixId == prevProjGroup.matrixId);
+                }
+                else {
+                    viewProjMap.mapped = (curProjGroup.matrixId == G_EX_ID_AUTO);
+                }
+
+                if (viewProjMap.mapped) {
+                    if (firstPrevWorkloadMap != nullptr) {
+                        viewProjMap.rigidBody = firstPrevWorkloadMap->viewProjections[prevProj.transformsIndex].rigidBody;
+                    }
+
+                    viewProjMap.rigidBody.updateLinear(prevView, curView, projectionLinearComponent);
+                    viewProjMap.rigidBody.updateAngular(prevView, curView, projectionAngularComponent, projectionScaleComponent, projectionSkewComponent);
+                    viewProjMap.rigidBody.updateDecomposition(curView, projectionDecompose);
+                    viewProjMap.prevTransformIndex = prevProj.transformsIndex;
+                    mappedViewProjIndex = curProj.transformsIndex;
+                }
+                else {
+                    viewProjMap.rigidBody = RT64::RigidBody();
+                }
+            }
+        }
+
+        for (uint32_t p = 0; p < prevScene.projections.size(); p++) {
+            const RT64::GameIndices::Projection &prevProjIndices = prevScene.projections[p];
+            const RT64::Workload &prevWorkload = workloadQueue.workloads[prevProjIndices.workloadIndex];
+            const RT64::Projection &prevProj = prevWorkload.fbPairs[prevProjIndices.fbPairIndex].projections[prevProjIndices.projectionIndex];
+            referenceBuildCallHashMap(frame, p, prevWorkload, prevProj, prevCallHashMap);
+        }
+
+        std::set<IndexPair> transformCheckSet;
+        std::set<IndexPair> tileCheckSet;
+        for (const auto &curIt : curCallHashMap) {
+            auto prevRange = prevCallHashMap.equal_range(curIt.first);
+            for (auto prevIt = prevRange.first; prevIt != prevRange.second; prevIt++) {
+                const RT64::GameIndices::Projection &curProjIndices = curScene.projections[curIt.second.sceneProjIndex];
+                const RT64::Workload &curWorkload = workloadQueue.workloads[curProjIndices.workloadIndex];
+                const RT64::GameCall &curCall = curWorkload.fbPairs[curProjIndices.fbPairIndex].projections[curProjIndices.projectionIndex].gameCalls[curIt.second.callIndex];
+                const RT64::GameIndices::Projection &prevProjIndices = prevScene.projections[prevIt->second.sceneProjIndex];
+                const RT64::Workload &prevWorkload = workloadQueue.workloads[prevProjIndices.workloadIndex];
+                const RT64::GameCall &prevCall = prevWorkload.fbPairs[prevProjIndices.fbPairIndex].projections[prevProjIndices.projectionIndex].gameCalls[prevIt->second.callIndex];
+                const uint32_t curWorldMatrixCount = (curCall.callDesc.maxWorldMatrix - curCall.callDesc.minWorldMatrix) + 1;
+                const uint32_t prevWorldMatrixCount = (prevCall.callDesc.maxWorldMatrix - prevCall.callDesc.minWorldMatrix) + 1;
+                if ((curWorldMatrixCount == prevWorldMatrixCount) && curIt.second.doTransformMatching && prevIt->second.doTransformMatching) {
+                    for (uint32_t w = 0; w < curWorldMatrixCount; w++) {
+                        const uint32_t curWorldMatrix = curCall.callDesc.minWorldMatrix + w;
+                        const RT64::TransformGroup &curGroup = curWorkload.drawData.transformGroups[curWorkload.drawData.worldTransformGroups[curWorldMatrix]];
+                        const uint32_t prevWorldMatrix = prevCall.callDesc.minWorldMatrix + w;
+                        const RT64::TransformGroup &prevGroup = prevWorkload.drawData.transformGroups[prevWorkload.drawData.worldTransformGroups[prevWorldMatrix]];
+                        if ((curGroup.matrixId == prevGroup.matrixId) && ((curGroup.matrixId == G_EX_ID_AUTO) || ((curGroup.matrixId != G_EX_ID_IGNORE) && (curGroup.ordering == G_EX_ORDER_AUTO)))) {
+                            transformCheckSet.emplace(curWorldMatrix, prevWorldMatrix);
+                        }
+                    }
+                }
+
+                if ((curCall.callDesc.tileCount == prevCall.callDesc.tileCount) && (curIt.second.doTileMatching && prevIt->second.doTileMatching)) {
+                    for (uint32_t t = 0; t < curCall.callDesc.tileCount; t++) {
+                        const RT64::DrawCallTile &curCallTile = curWorkload.drawData.callTiles[curCall.callDesc.tileIndex + t];
+                        const RT64::DrawCallTile &prevCallTile = prevWorkload.drawData.callTiles[prevCall.callDesc.tileIndex + t];
+                        if (curCallTile.tmemHashOrID != prevCallTile.tmemHashOrID) {
+                            continue;
+                        }
+
+                        tileCheckSet.emplace(curCall.callDesc.tileIndex + t, prevCall.callDesc.tileIndex + t);
+                    }
+                }
+            }
+        }
+
+        std::vector<MatchCandidate> matchCandidates;
+        const hlslpp::float4x4 &firstCurViewProj = firstCurWorkload.drawData.viewProjTransforms[firstCurProj.transformsIndex];
+        const hlslpp::float4x4 &firstPrevViewProj = firstPrevWorkload.drawData.viewProjTransforms[firstPrevProj.transformsIndex];
+        for (const IndexPair &indices : transformCheckSet) {
+            const hlslpp::float4x4 &curTransform = firstCurWorkload.drawData.worldTransforms[indices.first];
+            const hlslpp::float4x4 &prevTransform = firstPrevWorkload.drawData.worldTransforms[indices.second];
+            const RT64::RigidBody *prevRigidBody = (firstPrevWorkloadMap != nullptr) ? &firstPrevWorkloadMap->transforms[indices.second].rigidBody : nullptr;
+            TransformMatchResult matchResult = computeTransformMatch(curTransform, firstCurViewProj, prevTransform, firstPrevViewProj, prevRigidBody);
+            if (matchResult.valid) {
+                matchCandidates.emplace_back(indices.first, indices.second, matchResult.computeDifference());
+            }
+        }
+
+        bool modifiedVelocityBuffer = false;
+        std::stable_sort(matchCandidates.begin(), matchCandidates.end());
+        for (const MatchCandidate &candidate : matchCandidates) {
+            if (firstCurWorkloadMap.transforms[candidate.curIndex].mapped || firstCurWorkloadMap.prevTransformsMapped[candidate.prevIndex]) {
+                continue;
+            }
+
+            frame.matchTransform(firstCurWorkload, firstPrevWorkload, firstCurWorkloadMap, firstPrevWorkloadMap, candidate.curIndex, candidate.prevIndex, modifiedVelocityBuffer);
+        }
+
+        for (const IndexPair &indices : tileCheckSet) {
+            if (firstCurWorkloadMap.tiles[indices.first].mapped || firstCurWorkloadMap.prevTilesMapped[indices.second]) {
+                continue;
+            }
+
+            const interop::RDPTile &curTile = firstCurWorkload.drawData.rdpTiles[indices.first];
+            const interop::RDPTile &prevTile = firstPrevWorkload.drawData.rdpTiles[indices.second];
+            if ((curTile.fmt != prevTile.fmt) || (curTile.siz != prevTile.siz) || (curTile.stride != prevTile.stride) ||
+                (curTile.masks != prevTile.masks) || (curTile.maskt != prevTile.maskt) || (curTile.shifts != prevTile.shifts) ||
+                (curTile.shiftt != prevTile.shiftt) || (curTile.cms != prevTile.cms) || (curTile.cmt != prevTile.cmt))
+            {
+                continue;
+            }
+
+            RT64::GameFrameMap::TileMap &curTileMap = firstCurWorkloadMap.tiles[indices.first];
+            if (firstPrevWorkloadMap != nullptr) {
+                curTileMap = firstPrevWorkloadMap->tiles[indices.second];
+            }
+
+            auto modulo = [](int a, int b) {
+                if (b != 0) {
+                    int r = a % b;
+                    return r < 0 ? r + b : r;
+                }
+                else {
+                    return a;
+                }
+            };
+
+            const float deltaUls = curTile.uls - prevTile.uls;
+            const float deltaUlt = curTile.ult - prevTile.ult;
+            const float deltaLrs = curTile.lrs - prevTile.lrs;
+            const float deltaLrt = curTile.lrt - prevTile.lrt;
+            const bool tileScrolled = (deltaUls != 0.0f) || (deltaUlt != 0.0f) || (deltaLrs != 0.0f) || (deltaLrt != 0.0f);
+            const bool wrappedUls = (curTile.cms == G_TX_WRAP) && (modulo(std::lround(curTile.uls), curTile.masks * 4) == modulo(std::lround(prevTile.uls + curTileMap.deltaUls), curTile.masks * 4));
+            const bool wrappedUlt = (curTile.cmt == G_TX_WRAP) && (modulo(std::lround(curTile.ult), curTile.maskt * 4) == modulo(std::lround(prevTile.ult + curTileMap.deltaUlt), curTile.maskt * 4));
+            const bool wrappedLrs = (curTile.cms == G_TX_WRAP) && (modulo(std::lround(curTile.lrs), curTile.masks * 4) == modulo(std::lround(prevTile.lrs + curTileMap.deltaLrs), curTile.masks * 4));
+            const bool wrappedLrt = (curTile.cmt == G_TX_WRAP) && (modulo(std::lround(curTile.lrt), curTile.maskt * 4) == modulo(std::lround(prevTile.lrt + curTileMap.deltaLrt), curTile.maskt * 4));
+            curTileMap.prevUls = curTile.uls - curTileMap.deltaUls;
+            curTileMap.prevUlt = curTile.ult - curTileMap.deltaUlt;
+            curTileMap.prevLrs = curTile.lrs - curTileMap.deltaLrs;
+            curTileMap.prevLrt = curTile.lrt - curTileMap.deltaLrt;
+            curTileMap.deltaUls = wrappedUls || (abs(deltaUls) >= curTile.masks * 2) ? curTileMap.deltaUls : deltaUls;
+            curTileMap.deltaUlt = wrappedUlt || (abs(deltaUlt) >= curTile.maskt * 2) ? curTileMap.deltaUlt : deltaUlt;
+            curTileMap.deltaLrs = wrappedLrs || (abs(deltaLrs) >= curTile.masks * 2) ? curTileMap.deltaLrs : deltaLrs;
+            curTileMap.deltaLrt = wrappedLrt || (abs(deltaLrt) >= curTile.maskt * 2) ? curTileMap.deltaLrt : deltaLrt;
+            curTileMap.mapped = true;
+            firstCurWorkloadMap.prevTilesMapped[indices.second] = true;
+            tileInterpolationUsed = tileInterpolationUsed || tileScrolled;
+        }
+    }
+
+    void referenceMatch(RT64::GameFrame &frame, RT64::WorkloadQueue &workloadQueue, const RT64::GameFrame &prevFrame, bool &tileInterpolationUsed) {
+        tileInterpolationUsed = false;
+        frame.matched = true;
+
+        std::multimap<uint32_t, uint32_t> curIdMap;
+        std::multimap<uint32_t, uint32_t> prevIdMap;
+        std::vector<uint32_t> curIgnoredIds;
+        std::vector<uint32_t> prevIgnoredIds;
+        for (uint32_t w = 0; w < frame.workloads.size(); w++) {
+            if (w >= prevFrame.workloads.size()) {
+                continue;
+            }
+
+            RT64::GameFrameMap::WorkloadMap &workloadMap = frame.frameMap.workloads[frame.workloads[w]];
+            workloadMap.prevWorkloadIndex = prevFrame.workloads[w];
+            workloadMap.mapped = true;
+
+            RT64::Workload &curWorkload = workloadQueue.workloads[frame.workloads[w]];
+            const RT64::Workload &prevWorkload = workloadQueue.workloads[workloadMap.prevWorkloadIndex];
+            workloadMap.viewProjections.clear();
+            workloadMap.viewProjections.resize(curWorkload.drawData.viewProjTransforms.size());
+            workloadMap.transforms.clear();
+            workloadMap.transforms.resize(curWorkload.drawData.worldTransforms.size());
+            workloadMap.tiles.clear();
+            workloadMap.tiles.resize(curWorkload.drawData.rdpTiles.size());
+            workloadMap.prevTransformsMapped.clear();
+            workloadMap.prevTransformsMapped.resize(prevWorkload.drawData.worldTransforms.size());
+            workloadMap.prevTilesMapped.clear();
+            workloadMap.prevTilesMapped.resize(prevWorkload.drawData.rdpTiles.size());
+            referenceBuildTransformIdMap(curWorkload, curIdMap, curIgnoredIds);
+            referenceBuildTransformIdMap(prevWorkload, prevIdMap, prevIgnoredIds);
+
+            const RT64::GameFrameMap::WorkloadMap *prevWorkloadMap = nullptr;
+            if (prevFrame.matched && prevFrame.frameMap.workloads[workloadMap.prevWorkloadIndex].mapped) {
+                prevWorkloadMap = &prevFrame.frameMap.workloads[workloadMap.prevWorkloadIndex];
+            }
+
+            auto curIt = curIdMap.begin();
+            auto prevIt = prevIdMap.begin();
+            bool modifiedVelocityBuffer = false;
+            while ((curIt != curIdMap.end()) && (prevIt != prevIdMap.end())) {
+                if (curIt->first < prevIt->first) {
+                    curIt++;
+                }
+                else if (curIt->first > prevIt->first) {
+                    prevIt++;
+                }
+                else {
+                    frame.matchTransform(curWorkload, prevWorkload, workloadMap, prevWorkloadMap, curIt->second, prevIt->second, modifiedVelocityBuffer);
+                    curIt++;
+                    prevIt++;
+                }
+            }
+
+            for (uint32_t ignoredId : curIgnoredIds) {
+                RT64::GameFrameMap::TransformMap &curTransformMap = workloadMap.transforms[ignoredId];
+                curTransformMap.rigidBody = RT64::RigidBody();
+                curTransformMap.prevTransformIndex = 0;
+                curTransformMap.mapped = false;
+            }
+        }
+
+        auto matchScenes = [&](const std::vector<RT64::GameScene> &curScenes, const std::vector<RT64::GameScene> &prevScenes) {
+            std::vector<MatchCandidate> matchCandidates;
+            for (uint32_t i = 0; i < curScenes.size(); i++) {
+                const RT64::GameIndices::Projection curFirstProj = curScenes[i].projections[0];
+                const RT64::Workload &curWorkload = workloadQueue.workloads[curFirstProj.workloadIndex];
+                const RT64::Projection &curProj = curWorkload.fbPairs[curFirstProj.fbPairIndex].projections[curFirstProj.projectionIndex];
+                const hlslpp::float4x4 &curViewTransform = curWorkload.drawData.viewTransforms[curProj.transformsIndex];
+                const hlslpp::float4x4 &curProjTransform = curWorkload.drawData.projTransforms[curProj.transformsIndex];
+                for (uint32_t j = 0; j < prevScenes.size(); j++) {
+                    const RT64::GameIndices::Projection prevFirstProj = prevScenes[j].projections[0];
+                    const RT64::Workload &prevWorkload = workloadQueue.workloads[prevFirstProj.workloadIndex];
+                    const RT64::Projection &prevProj = prevWorkload.fbPairs[prevFirstProj.fbPairIndex].projections[prevFirstProj.projectionIndex];
+                    const hlslpp::float4x4 &prevViewTransform = prevWorkload.drawData.viewTransforms[prevProj.transformsIndex];
+                    const hlslpp::float4x4 &prevProjTransform = prevWorkload.drawData.projTransforms[prevProj.transformsIndex];
+                    matchCandidates.emplace_back(i, j, RT64::matrixDifference(curViewTransform, prevViewTransform) + RT64::matrixDifference(curProjTransform, prevProjTransform));
+                }
+            }
+
+            std::vector<bool> curScenesMatched(curScenes.size());
+            std::vector<bool> prevScenesMatched(prevScenes.size());
+            std::stable_sort(matchCandidates.begin(), matchCandidates.end());
+            for (const MatchCandidate &candidate : matchCandidates) {
+                if (curScenesMatched[candidate.curIndex] || prevScenesMatched[candidate.prevIndex]) {
+                    continue;
+                }
+
+                referenceMatchScene(frame, workloadQueue, prevFrame, curScenes[candidate.curIndex], prevScenes[candidate.prevIndex], tileInterpolationUsed);
+                curScenesMatched[candidate.curIndex] = true;
+                prevScenesMatched[candidate.prevIndex] = true;
+            }
+        };
+
+        matchScenes(frame.perspectiveScenes, prevFrame.perspectiveScenes);
+        matchScenes(frame.orthographicScenes, prevFrame.orthographicScenes);
+    }
+
+    // Comparison of the results. The vectors of the rigid bodies are derived from the same matched transforms, so only the scalar state is compared.
+
+    bool sameRigidBody(const RT64::RigidBody &lhs, const RT64::RigidBody &rhs) {
+        return (lhs.angularVelocity == rhs.angularVelocity) && (lhs.transformIndex == rhs.transformIndex) && (lhs.lerpTranslation == rhs.lerpTranslation) &&
+            (lhs.lerpRotation == rhs.lerpRotation) && (lhs.lerpScale == rhs.lerpScale) && (lhs.lerpSkew == rhs.lerpSkew) &&
+            (lhs.lerpPerspective == rhs.lerpPerspective) && (lhs.lerpDecompose == rhs.lerpDecompose);
+    }
+
+    template<typename T>
+    bool sameTransformMaps(const std::vector<T> &lhs, const std::vector<T> &rhs) {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < lhs.size(); i++) {
+            if ((lhs[i].mapped != rhs[i].mapped) || (lhs[i].prevTransformIndex != rhs[i].prevTransformIndex) || !sameRigidBody(lhs[i].rigidBody, rhs[i].rigidBody)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool sameTileMaps(const std::vector<RT64::GameFrameMap::TileMap> &lhs, const std::vector<RT64::GameFrameMap::TileMap> &rhs) {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < lhs.size(); i++) {
+            const RT64::GameFrameMap::TileMap &l = lhs[i];
+            const RT64::GameFrameMap::TileMap &r = rhs[i];
+            if ((l.mapped != r.mapped) ||
+                (l.deltaUls != r.deltaUls) || (l.deltaUlt != r.deltaUlt) || (l.deltaLrs != r.deltaLrs) || (l.deltaLrt != r.deltaLrt) ||
+                (l.prevUls != r.prevUls) || (l.prevUlt != r.prevUlt) || (l.prevLrs != r.prevLrs) || (l.prevLrt != r.prevLrt))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool sameFrameMap(const RT64::GameFrameMap &lhs, const RT64::GameFrameMap &rhs) {
+        if (lhs.workloads.size() != rhs.workloads.size()) {
+            return false;
+        }
+
+        for (size_t w = 0; w < lhs.workloads.size(); w++) {
+            const RT64::GameFrameMap::WorkloadMap &l = lhs.workloads[w];
+            const RT64::GameFrameMap::WorkloadMap &r = rhs.workloads[w];
+            if ((l.mapped != r.mapped) || (l.prevWorkloadIndex != r.prevWorkloadIndex) || (l.prevTransformsMapped != r.prevTransformsMapped) || (l.prevTilesMapped != r.prevTilesMapped)) {
+                return false;
+            }
+
+            if (!sameTransformMaps(l.viewProjections, r.viewProjections) || !sameTransformMaps(l.transforms, r.transforms) || !sameTileMaps(l.tiles, r.tiles)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    uint32_t countMapped(const RT64::GameFrameMap &frameMap) {
+        uint32_t count = 0;
+        for (const RT64::GameFrameMap::WorkloadMap &workloadMap : frameMap.workloads) {
+            for (const RT64::GameFrameMap::TransformMap &transformMap : workloadMap.transforms) {
+                count += transformMap.mapped ? 1 : 0;
+            }
+        }
+
+        return count;
+    }
+};
+
+int main(int argc, char **argv) {
+    uint32_t frameCount = 120;
+    uint32_t iterations = 20;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "--frames") == 0) && hasValue) {
+            frameCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 2U);
+        }
+        else if ((strcmp(argv[i], "--iterations") == 0) && hasValue) {
+            iterations = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<SceneObject> objects;
+    generateObjects(objects);
+
+    // Frames alternate between two workloads like they do in the queue. The result of the flat matcher is kept as the previous frame.
+    RT64::WorkloadQueue workloadQueue(2);
+    RT64::GameFrame gameFrames[2];
+    double flatTime = 0.0;
+    double referenceTime = 0.0;
+    uint32_t mismatchCount = 0;
+    uint64_t mappedCount = 0;
+    for (uint32_t f = 0; f < frameCount; f++) {
+        const uint32_t curIndex = f % 2;
+        const uint32_t prevIndex = 1 - curIndex;
+        generateFrame(workloadQueue.workloads[curIndex], objects, f);
+        gameFrames[curIndex].set(workloadQueue, &curIndex, 1);
+        if (f == 0) {
+            continue;
+        }
+
+        const RT64::GameFrame unmatchedFrame = gameFrames[curIndex];
+        RT64::GameFrame flatFrame;
+        RT64::GameFrame referenceFrame;
+        bool velocityUploaderUsed = false;
+        bool flatTileInterpolationUsed = false;
+        bool referenceTileInterpolationUsed = false;
+        for (uint32_t i = 0; i < iterations; i++) {
+            flatFrame = unmatchedFrame;
+            auto startTime = std::chrono::steady_clock::now();
+            flatFrame.match(nullptr, workloadQueue, gameFrames[prevIndex], nullptr, velocityUploaderUsed, flatTileInterpolationUsed);
+            flatTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+            referenceFrame = unmatchedFrame;
+            startTime = std::chrono::steady_clock::now();
+            referenceMatch(referenceFrame, workloadQueue, gameFrames[prevIndex], referenceTileInterpolationUsed);
+            referenceTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        if (velocityUploaderUsed || (flatTileInterpolationUsed != referenceTileInterpolationUsed) || !sameFrameMap(flatFrame.frameMap, referenceFrame.frameMap)) {
+            fprintf(stderr, "Frame %u: the flat and reference matchers produced different mappings.\n", f);
+            mismatchCount++;
+        }
+
+        mappedCount += countMapped(flatFrame.frameMap);
+        gameFrames[curIndex] = flatFrame;
+    }
+
+    const uint32_t matchCount = (frameCount - 1) * iterations;
+    printf("%u frame pairs, %u calls per frame, %.1f transforms matched per frame.\n", frameCount - 1, uint32_t(objects.size()), double(mappedCount) / (frameCount - 1));
+    printf("Flat: %8.2f us, reference: %8.2f us per match, %5.2fx speedup.\n", flatTime / matchCount, referenceTime / matchCount, referenceTime / flatTime);
+    return (mismatchCount > 0) ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/rt64_task_scheduler.h"
+#include "render/rt64_command_list_recorder.h"
+#include "render/rt64_render_worker.h"
+
+// Records a synthetic workload of independent framebuffer pairs with the command list recorder and reports how the recording time scales
+// with the amount of tasks allowed to record in parallel. Every draw issues a few commands and does a fixed amount of work to stand in for the
+// state translation the renderer does per draw. The work is not time based, so oversubscribed cores don't inflate the speedup.
+// Usage: recorder_bench [--pairs N] [--draws N] [--draw-work N] [--frames N] [--threads N] [--null]
+
+namespace RT64 {
+    extern std::unique_ptr<RenderInterface> CreateVulkanInterface();
+    extern std::unique_ptr<RenderInterface> CreateMetalInterface();
+    extern std::unique_ptr<RenderInterface> CreateNullInterface();
+};
+
+namespace {
+    const uint32_t TargetWidth = 320;
+    const uint32_t TargetHeight = 240;
+    const RT64::RenderFormat TargetFormat = RT64::RenderFormat::R8G8B8A8_UNORM;
+
+    struct BenchmarkConfig {
+        uint32_t pairCount = 64;
+        uint32_t drawCount = 100;
+        uint32_t drawWork = 1000;
+        uint32_t frameCount = 60;
+        uint32_t threadCount = 0;
+        bool useNull = false;
+    };
+
+    struct FramebufferPair {
+        std::unique_ptr<RT64::RenderTexture> colorTarget;
+        std::unique_ptr<RT64::RenderFramebuffer> framebuffer;
+    };
+
+    std::unique_ptr<RT64::RenderInterface> createRenderInterface(bool useNull) {
+        if (useNull) {
+            return RT64::CreateNullInterface();
+        }
+
+#   if defined(__APPLE__)
+        return RT64::CreateMetalInterface();
+#   else
+        return RT64::CreateVulkanInterface();
+#   endif
+    }
+
+    // Mixes the value as many times as requested. The result is used by the caller so the loop can't be removed.
+    uint64_t doWork(uint64_t value, uint32_t iterations) {
+        for (uint32_t i = 0; i < iterations; i++) {
+            value ^= value >> 33;
+            value *= 0xFF51AFD7ED558CCDULL;
+        }
+
+        return value;
+    }
+
+    void recordPair(RT64::RenderCommandList *commandList, const FramebufferPair &pair, const BenchmarkConfig &config) {
+        commandList->barriers(RT64::RenderBarrierStage::GRAPHICS, RT64::RenderTextureBarrier(pair.colorTarget.get(), RT64::RenderTextureLayout::COLOR_WRITE));
+        commandList->setFramebuffer(pair.framebuffer.get());
+        commandList->clearColor(0, RT64::RenderColor(0.0f, 0.0f, 0.0f));
+
+        for (uint32_t i = 0; i < config.drawCount; i++) {
+            const int32_t x = int32_t((i * 7) % (TargetWidth - 8));
+            const int32_t y = int32_t((i * 13) % (TargetHeight - 8));
+            const RT64::RenderRect rect(x, y, x + 8, y + 8);
+            const uint64_t work = doWork(i + 1, config.drawWork);
+            commandList->setViewports(RT64::RenderViewport(0.0f, 0.0f, float(TargetWidth), float(TargetHeight)));
+            commandList->setScissors(rect);
+            commandList->clearColor(0, RT64::RenderColor(float(work & 1), 0.5f, 0.0f), &rect, 1);
+        }
+
+        commandList->barriers(RT64::RenderBarrierStage::COPY, RT64::RenderTextureBarrier(pair.colorTarget.get(), RT64::RenderTextureLayout::COPY_SOURCE));
+    }
+
+    // Returns the median time in milliseconds it took to record every frame.
+    double runParallelCount(RT64::RenderWorker *worker, RT64::TaskScheduler *taskScheduler, uint32_t parallelCount, const std::vector<FramebufferPair> &pairs, const BenchmarkConfig &config) {
+        RT64::CommandListRecorder recorder(worker, RT64::RenderCommandListType::DIRECT, taskScheduler, parallelCount);
+        std::vector<double> frameTimes;
+        for (uint32_t f = 0; f < config.frameCount; f++) {
+            const auto startTime = std::chrono::steady_clock::now();
+            worker->commandList->begin();
+            recorder.begin(worker);
+            for (const FramebufferPair &pair : pairs) {
+                recorder.recordParallel([&pair, &config](RT64::RenderCommandList *commandList) {
+                    recordPair(commandList, pair, config);
+                });
+            }
+
+            recorder.execute();
+            const auto endTime = std::chrono::steady_clock::now();
+            worker->wait();
+            frameTimes.emplace_back(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+        }
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+        return frameTimes[frameTimes.size() / 2];
+    }
+};
+
+int main(int argc, char **argv) {
+    BenchmarkConfig config;
+    config.threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "--pairs") == 0) && hasValue) {
+            config.pairCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if ((strcmp(argv[i], "--draws") == 0) && hasValue) {
+            config.drawCount = uint32_t(strtoul(argv[++i], nullptr, 10));
+        }
+        else if ((strcmp(argv[i], "--draw-work") == 0) && hasValue) {
+            config.drawWork = uint32_t(strtoul(argv[++i], nullptr, 10));
+        }
+        else if ((strcmp(argv[i], "--frames") == 0) && hasValue) {
+            config.frameCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if ((strcmp(argv[i], "--threads") == 0) && hasValue) {
+            config.threadCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if (strcmp(argv[i], "--null") == 0) {
+            config.useNull = true;
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<RT64::RenderInterface> renderInterface = createRenderInterface(config.useNull);
+    std::unique_ptr<RT64::RenderDevice> device = (renderInterface != nullptr) ? renderInterface->createDevice() : nullptr;
+    if (device == nullptr) {
+        fprintf(stderr, "Failed to create the render device.\n");
+        return 1;
+    }
+
+    std::vector<FramebufferPair> pairs(config.pairCount);
+    for (FramebufferPair &pair : pairs) {
+        pair.colorTarget = device->createTexture(RT64::RenderTextureDesc::ColorTarget(TargetWidth, TargetHeight, TargetFormat));
+        const RT64::RenderTexture *colorTarget = pair.colorTarget.get();
+        pair.framebuffer = device->createFramebuffer(RT64::RenderFramebufferDesc(&colorTarget, 1));
+    }
+
+    // The workload queue submits the recording tasks to the shared scheduler, so the same is done here with one thread per core.
+    std::unique_ptr<RT64::RenderWorker> worker = std::make_unique<RT64::RenderWorker>(device.get(), "Recorder", RT64::RenderCommandListType::DIRECT);
+    std::unique_ptr<RT64::TaskScheduler> taskScheduler = std::make_unique<RT64::TaskScheduler>(config.threadCount);
+    printf("%u framebuffer pairs, %u draws per pair, %u work iterations per draw, %u frames, %u scheduler threads.\n", config.pairCount, config.drawCount, config.drawWork, config.frameCount, config.threadCount);
+
+    // Zero records everything on the calling thread, which is the baseline for the speedup.
+    double baselineTime = 0.0;
+    for (uint32_t parallelCount = 0; parallelCount <= config.threadCount; parallelCount = std::max(parallelCount * 2, 1U)) {
+        const double recordTime = runParallelCount(worker.get(), taskScheduler.get(), parallelCount, pairs, config);
+        if (parallelCount == 0) {
+            baselineTime = recordTime;
+        }
+
+        printf("Parallel count %2u: %8.3f ms per frame, %5.2fx speedup.\n", parallelCount, recordTime, baselineTime / recordTime);
+    }
+
+    // Every resource must be released before the device.
+    taskScheduler.reset();
+    worker.reset();
+    pairs.clear();
+    return 0;
+}
@@ -1,9 +1,13 @@
+#include <cstdlib>
+#include <cstring>
+
 #include "rhi/rt64_render_interface.h"
 
 namespace RT64 {
     extern std::unique_ptr<RenderInterface> CreateD3D12Interface();
     extern std::unique_ptr<RenderInterface> CreateVulkanInterface();
     extern std::unique_ptr<RenderInterface> CreateMetalInterface();
+    extern std::unique_ptr<RenderInterface> CreateNullInterface();
 }
 
 std::unique_ptr<RT64::RenderInterface> CreateRenderInterface() {
@@ -27,7 +31,26 @@ std::unique_ptr<RT64::RenderInterface> CreateRenderInterface() {
 }
 
 int main(int argc, char** argv) {
+    // The null backend discards all GPU work, which is useful for measuring the CPU cost of the interface.
+    bool useNull = false;
+    uint32_t frameCount = 600;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--null") == 0) {
+            useNull = true;
+        }
+        else if ((strcmp(argv[i], "--frames") == 0) && ((i + 1) < argc)) {
+            frameCount = uint32_t(strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    if (useNull) {
+        // The null backend doesn't need a window, so it runs every test for a fixed number of frames and exits.
+        auto renderInterface = RT64::CreateNullInterface();
+        return RT64::RenderInterfaceTestHeadless(renderInterface.get(), frameCount);
+    }
+
     auto renderInterface = CreateRenderInterface();
     // Execute a blocking test that creates a window and draws some geometry to test the render interface.
     RT64::RenderInterfaceTest(renderInterface.get());
+    return 0;
 }
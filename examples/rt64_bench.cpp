@@ -0,0 +1,846 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <json/json.hpp>
+
+#include "gbi/rt64_gbi_f3dex2.h"
+#include "gbi/rt64_gbi_s2dex.h"
+#include "gbi/rt64_gbi_s2dex2.h"
+#include "hle/rt64_application.h"
+#include "hle/rt64_interpreter.h"
+#include "shared/rt64_f3d_defines.h"
+
+using json = nlohmann::json;
+
+// Runs synthetic F3DEX2 and S2DEX2 display lists through the whole HLE and rendering pipeline and reports the time spent on each stage.
+// Usage: rt64_bench [--scene NAME] [--frames N] [--warmup N] [--null] [--output FILE] [--baseline FILE] [--threshold RATIO]
+// With --null no window is created, so it can run on machines without a display.
+
+namespace {
+    // Memory layout of the synthetic RDRAM image.
+    const uint32_t RDRAMSize = 0x800000;
+    const uint32_t DisplayListAddress = 0x100000;
+    const uint32_t VertexAddress = 0x140000;
+    const uint32_t MatrixAddress = 0x1C0000;
+    const uint32_t ViewportAddress = 0x1FF000;
+    const uint32_t TextureAddress = 0x200000;
+    const uint32_t RenderTextureAddress = 0x280000;
+    const uint32_t ColorImageAddress = 0x300000;
+    const uint32_t DepthImageAddress = 0x340000;
+    const uint32_t BackgroundAddress = 0x380000;
+    const uint32_t ObjectAddress = 0x3C0000;
+
+    const uint32_t ScreenWidth = 320;
+    const uint32_t ScreenHeight = 240;
+    const uint32_t TextureSize = 32;
+    const uint32_t TextureCount = 64;
+    const uint32_t RenderTextureCount = 4;
+
+    // Lines of a screen sized 16-bit background that fit in TMEM at once when it's copied.
+    const uint32_t BackgroundTMEMLines = 4096 / (ScreenWidth * 2);
+
+    // F3DEX2 values that are not part of the shared defines.
+    const uint32_t F3DEX2_G_ZBUFFER = 0x00000001;
+    const uint32_t F3DEX2_G_CULL_BACK = 0x00000400;
+    const uint32_t F3DEX2_G_SHADING_SMOOTH = 0x00200000;
+    const uint32_t F3DEX2_G_MTX_MODELVIEW_LOAD = 0x02;
+    const uint32_t F3DEX2_G_MTX_PROJECTION_LOAD = 0x06;
+    const uint32_t F3DEX2_G_MTX_PUSH_MASK = 0x01;
+
+    // Opaque surface with depth testing and writing, blending the input color with itself.
+    const uint32_t RenderModeOpaqueZ = Z_CMP | Z_UPD | FORCE_BL | ZMODE_OPA | 0x0F0A0000;
+
+    // Same as above without depth, used by rectangles.
+    const uint32_t RenderModeOpaque = FORCE_BL | ZMODE_OPA | 0x0F0A0000;
+
+    // S2DEX values that are not part of the shared defines.
+    const uint32_t S2DEX_G_OBJLT_TXTRBLOCK = 0x00001033;
+
+    // Combiner inputs.
+    const uint32_t CC_0_A = 15;
+    const uint32_t CC_0_B = 15;
+    const uint32_t CC_0_C = 31;
+    const uint32_t CC_0_D = 7;
+    const uint32_t CC_TEXEL0 = 1;
+    const uint32_t CC_SHADE = 4;
+    const uint32_t AC_0 = 7;
+    const uint32_t AC_TEXEL0 = 1;
+    const uint32_t AC_SHADE = 4;
+
+    struct DisplayListBuilder {
+        std::vector<RT64::DisplayList> commands;
+
+        void add(uint32_t w0, uint32_t w1) {
+            RT64::DisplayList &dl = commands.emplace_back();
+            dl.w0 = w0;
+            dl.w1 = w1;
+        }
+
+        void setColorImage(uint32_t width, uint32_t address) {
+            add((G_SETCIMG << 24) | (G_IM_FMT_RGBA << 21) | (G_IM_SIZ_16b << 19) | (width - 1), address);
+        }
+
+        void setDepthImage(uint32_t address) {
+            add(G_SETZIMG << 24, address);
+        }
+
+        void setScissor(uint32_t width, uint32_t height) {
+            add(G_SETSCISSOR << 24, ((width << 2) << 12) | (height << 2));
+        }
+
+        void setOtherMode(uint32_t high, uint32_t low) {
+            add((G_RDPSETOTHERMODE << 24) | (high & 0xFFFFFF), low);
+        }
+
+        void setCombine(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t aa, uint32_t ab, uint32_t ac, uint32_t ad) {
+            // Both cycles use the same equation.
+            const uint32_t w0 = (G_SETCOMBINE << 24) | (a << 20) | (c << 15) | (aa << 12) | (ac << 9) | (a << 5) | c;
+            const uint32_t w1 = (b << 28) | (b << 24) | (aa << 21) | (ac << 18) | (d << 15) | (ab << 12) | (ad << 9) | (d << 6) | (ab << 3) | ad;
+            add(w0, w1);
+        }
+
+        void fillRect(uint32_t ulx, uint32_t uly, uint32_t lrx, uint32_t lry) {
+            add((G_FILLRECT << 24) | ((lrx << 2) << 12) | (lry << 2), ((ulx << 2) << 12) | (uly << 2));
+        }
+
+        void clear(uint32_t width, uint32_t height, uint32_t address, uint32_t fillColor) {
+            setColorImage(width, address);
+            setOtherMode(G_CYC_FILL, 0);
+            add(G_SETFILLCOLOR << 24, fillColor);
+            fillRect(0, 0, width - 1, height - 1);
+            add(G_RDPPIPESYNC << 24, 0);
+        }
+
+        void loadTexture(uint32_t address) {
+            const uint32_t lineWords = (TextureSize * 2) / 8;
+            const uint32_t dxt = (2048 + lineWords - 1) / lineWords;
+            add(G_RDPTILESYNC << 24, 0);
+            add((G_SETTIMG << 24) | (G_IM_FMT_RGBA << 21) | (G_IM_SIZ_16b << 19), address);
+            add((G_SETTILE << 24) | (G_IM_FMT_RGBA << 21) | (G_IM_SIZ_16b << 19), G_TX_LOADTILE << 24);
+            add(G_RDPLOADSYNC << 24, 0);
+            add(G_LOADBLOCK << 24, (G_TX_LOADTILE << 24) | (((TextureSize * TextureSize) - 1) << 12) | dxt);
+            add(G_RDPPIPESYNC << 24, 0);
+            renderTile();
+        }
+
+        void renderTile() {
+            const uint32_t lineWords = (TextureSize * 2) / 8;
+            add((G_SETTILE << 24) | (G_IM_FMT_RGBA << 21) | (G_IM_SIZ_16b << 19) | (lineWords << 9), (G_TX_RENDERTILE << 24) | (5 << 14) | (5 << 4));
+            add(G_SETTILESIZE << 24, (G_TX_RENDERTILE << 24) | (((TextureSize - 1) << 2) << 12) | ((TextureSize - 1) << 2));
+        }
+
+        void texture(bool enabled) {
+            add((F3DEX2_G_TEXTURE << 24) | ((enabled ? 1 : 0) << 1), 0xFFFFFFFF);
+        }
+
+        void geometryMode(uint32_t mode) {
+            add(F3DEX2_G_GEOMETRYMODE << 24, mode);
+        }
+
+        void viewport(uint32_t address) {
+            add((F3DEX2_G_MOVEMEM << 24) | (((16 - 1) / 8) << 19) | F3DEX2_G_MV_VIEWPORT, address);
+        }
+
+        void matrix(uint32_t address, uint32_t params) {
+            add((F3DEX2_G_MTX << 24) | (0x38 << 16) | (params ^ F3DEX2_G_MTX_PUSH_MASK), address);
+        }
+
+        void vertex(uint32_t address, uint32_t count) {
+            add((F3DEX2_G_VTX << 24) | (count << 12) | (count << 1), address);
+        }
+
+        void tri2(uint32_t a0, uint32_t b0, uint32_t c0, uint32_t a1, uint32_t b1, uint32_t c1) {
+            add((F3DEX2_G_TRI2 << 24) | ((a0 * 2) << 16) | ((b0 * 2) << 8) | (c0 * 2), ((a1 * 2) << 16) | ((b1 * 2) << 8) | (c1 * 2));
+        }
+
+        void texRect(uint32_t ulx, uint32_t uly, uint32_t lrx, uint32_t lry) {
+            add((G_TEXRECT << 24) | ((lrx << 2) << 12) | (lry << 2), (G_TX_RENDERTILE << 24) | ((ulx << 2) << 12) | (uly << 2));
+            add(F3DEX2_G_RDPHALF_1 << 24, 0);
+            add(F3DEX2_G_RDPHALF_2 << 24, (1 << 10) << 16 | (1 << 10));
+        }
+
+        void objRenderMode(uint32_t mode) {
+            add(S2DEX2_G_OBJ_RENDERMODE << 24, mode);
+        }
+
+        void objLoadTexture(uint32_t address) {
+            add((S2DEX2_G_OBJ_LOADTXTR << 24) | (sizeof(RT64::GBI_S2DEX::uObjTxtr) - 1), address);
+        }
+
+        void bgCopy(uint32_t address) {
+            add(S2DEX2_G_BG_COPY << 24, address);
+        }
+
+        void bg1Cyc(uint32_t address) {
+            add(S2DEX2_G_BG_1CYC << 24, address);
+        }
+
+        void end() {
+            add(G_RDPFULLSYNC << 24, 0);
+            add(F3DEX2_G_ENDDL << 24, 0);
+        }
+    };
+
+    struct SyntheticImage {
+        uint8_t *RDRAM;
+        uint32_t vertexCursor = VertexAddress;
+        uint32_t matrixCursor = MatrixAddress;
+        uint32_t objectCursor = ObjectAddress;
+
+        void writeMatrix(uint32_t address, const float *values) {
+            RT64::FixedMatrix *fixedMatrix = reinterpret_cast<RT64::FixedMatrix *>(&RDRAM[address]);
+            for (uint32_t i = 0; i < 4; i++) {
+                for (uint32_t j = 0; j < 4; j++) {
+                    const int32_t fixedValue = int32_t(values[i * 4 + j] * 65536.0f);
+                    fixedMatrix->integer[i][j ^ 1] = int16_t(fixedValue >> 16);
+                    fixedMatrix->frac[i][j ^ 1] = uint16_t(fixedValue & 0xFFFF);
+                }
+            }
+        }
+
+        uint32_t allocateMatrix(const float *values) {
+            const uint32_t address = matrixCursor;
+            writeMatrix(address, values);
+            matrixCursor += sizeof(RT64::FixedMatrix);
+            return address;
+        }
+
+        uint32_t allocateModelMatrix(float x, float y, float z, float angle, float scale) {
+            const float c = cosf(angle) * scale;
+            const float s = sinf(angle) * scale;
+            const float values[16] = {
+                c, 0.0f, -s, 0.0f,
+                0.0f, scale, 0.0f, 0.0f,
+                s, 0.0f, c, 0.0f,
+                x, y, z, 1.0f
+            };
+
+            return allocateMatrix(values);
+        }
+
+        uint32_t allocateProjectionMatrix() {
+            // Perspective projection with a 60 degree field of view and a 4:3 aspect ratio.
+            const float nearPlane = 10.0f;
+            const float farPlane = 2000.0f;
+            const float f = 1.0f / tanf(0.5236f);
+            const float values[16] = {
+                f / (4.0f / 3.0f), 0.0f, 0.0f, 0.0f,
+                0.0f, f, 0.0f, 0.0f,
+                0.0f, 0.0f, (farPlane + nearPlane) / (nearPlane - farPlane), -1.0f,
+                0.0f, 0.0f, (2.0f * farPlane * nearPlane) / (nearPlane - farPlane), 0.0f
+            };
+
+            return allocateMatrix(values);
+        }
+
+        uint32_t allocateCube(uint32_t colorSeed) {
+            const uint32_t address = vertexCursor;
+            RT64::RSP::Vertex *vertices = reinterpret_cast<RT64::RSP::Vertex *>(&RDRAM[address]);
+            for (uint32_t i = 0; i < 8; i++) {
+                RT64::RSP::Vertex &vertex = vertices[i];
+                vertex = {};
+                vertex.x = (i & 1) ? 10 : -10;
+                vertex.y = (i & 2) ? 10 : -10;
+                vertex.z = (i & 4) ? 10 : -10;
+                vertex.s = (i & 1) ? (TextureSize << 6) : 0;
+                vertex.t = (i & 2) ? (TextureSize << 6) : 0;
+                vertex.color.r = uint8_t(colorSeed * 37 + i * 11);
+                vertex.color.g = uint8_t(colorSeed * 73 + i * 29);
+                vertex.color.b = uint8_t(colorSeed * 151 + i * 53);
+                vertex.color.a = 0xFF;
+            }
+
+            vertexCursor += sizeof(RT64::RSP::Vertex) * 8;
+            return address;
+        }
+
+        void writeViewport(uint32_t address) {
+            // The RSP reads the viewport as pairs of swapped 16-bit values.
+            int16_t *vp = reinterpret_cast<int16_t *>(&RDRAM[address]);
+            vp[1] = ScreenWidth * 2;
+            vp[0] = ScreenHeight * 2;
+            vp[3] = G_MAXZ / 2;
+            vp[2] = 0;
+            vp[5] = ScreenWidth * 2;
+            vp[4] = ScreenHeight * 2;
+            vp[7] = G_MAXZ / 2;
+            vp[6] = 0;
+        }
+
+        uint32_t allocateObjectTexture(uint32_t textureIndex) {
+            // Loads the whole texture as a block. The flag is unique per texture, so the microcode skips loading a texture that's already in TMEM.
+            const uint32_t address = objectCursor;
+            RT64::GBI_S2DEX::uObjTxtr *txtr = reinterpret_cast<RT64::GBI_S2DEX::uObjTxtr *>(&RDRAM[address]);
+            const uint32_t lineWords = (TextureSize * 2) / 8;
+            *txtr = {};
+            txtr->type = S2DEX_G_OBJLT_TXTRBLOCK;
+            txtr->image = TextureAddress + textureIndex * TextureSize * TextureSize * 2;
+            txtr->val1 = ((TextureSize * TextureSize) >> (4 - G_IM_SIZ_16b)) - 1;
+            txtr->val2 = (2048 + lineWords - 1) / lineWords;
+            txtr->flag = textureIndex + 1;
+            txtr->mask = 0xFFFFFFFF;
+            objectCursor += sizeof(RT64::GBI_S2DEX::uObjTxtr);
+            return address;
+        }
+
+        uint32_t allocateBackgroundCopy() {
+            // Positions and sizes are in 10.2 fixed point.
+            const uint32_t address = objectCursor;
+            RT64::GBI_S2DEX::uObjBg_t *bg = reinterpret_cast<RT64::GBI_S2DEX::uObjBg_t *>(&RDRAM[address]);
+            *bg = {};
+            bg->imageW = ScreenWidth << 2;
+            bg->imageH = ScreenHeight << 2;
+            bg->frameW = ScreenWidth << 2;
+            bg->frameH = ScreenHeight << 2;
+            bg->imageAddress = BackgroundAddress;
+            bg->imageSiz = G_IM_SIZ_16b;
+            bg->imageFmt = G_IM_FMT_RGBA;
+            bg->imageLoad = S2DEX_G_BGLT_LOADTILE;
+            bg->tmemW = (ScreenWidth * 2) / 8;
+            bg->tmemH = BackgroundTMEMLines << 2;
+            objectCursor += sizeof(RT64::GBI_S2DEX::uObjBg);
+            return address;
+        }
+
+        uint32_t allocateScaledBackground(uint32_t scrollX, uint32_t scale) {
+            // The image position is in 10.5 fixed point and the scale in 5.10 fixed point.
+            const uint32_t address = objectCursor;
+            RT64::GBI_S2DEX::uObjScaleBg_t *bg = reinterpret_cast<RT64::GBI_S2DEX::uObjScaleBg_t *>(&RDRAM[address]);
+            *bg = {};
+            bg->imageW = ScreenWidth << 2;
+            bg->imageX = (scrollX % ScreenWidth) << 5;
+            bg->imageH = ScreenHeight << 2;
+            bg->frameW = ScreenWidth << 2;
+            bg->frameH = ScreenHeight << 2;
+            bg->imageAddress = BackgroundAddress;
+            bg->imageSiz = G_IM_SIZ_16b;
+            bg->imageFmt = G_IM_FMT_RGBA;
+            bg->imageLoad = S2DEX_G_BGLT_LOADTILE;
+            bg->scaleW = scale;
+            bg->scaleH = scale;
+            objectCursor += sizeof(RT64::GBI_S2DEX::uObjBg);
+            return address;
+        }
+
+        void writeBackground() {
+            uint16_t *texels = reinterpret_cast<uint16_t *>(&RDRAM[BackgroundAddress]);
+            for (uint32_t j = 0; j < ScreenWidth * ScreenHeight; j++) {
+                texels[j ^ 1] = uint16_t(((j % ScreenWidth) * 0x0842U) ^ ((j / ScreenWidth) * 0x2108U)) | 1;
+            }
+        }
+
+        void writeTextures() {
+            for (uint32_t i = 0; i < TextureCount; i++) {
+                uint16_t *texels = reinterpret_cast<uint16_t *>(&RDRAM[TextureAddress + i * TextureSize * TextureSize * 2]);
+                for (uint32_t j = 0; j < TextureSize * TextureSize; j++) {
+                    texels[j ^ 1] = uint16_t((i * 0x9E37U) ^ (j * 0x45D9U)) | 1;
+                }
+            }
+        }
+    };
+
+    void drawCube(DisplayListBuilder &builder, uint32_t matrixAddress, uint32_t vertexAddress) {
+        builder.matrix(matrixAddress, F3DEX2_G_MTX_MODELVIEW_LOAD);
+        builder.vertex(vertexAddress, 8);
+        builder.tri2(0, 1, 3, 0, 3, 2);
+        builder.tri2(4, 6, 7, 4, 7, 5);
+        builder.tri2(0, 4, 5, 0, 5, 1);
+        builder.tri2(2, 3, 7, 2, 7, 6);
+        builder.tri2(0, 2, 6, 0, 6, 4);
+        builder.tri2(1, 5, 7, 1, 7, 3);
+    }
+
+    struct SceneDesc {
+        const char *name;
+        uint32_t shadedObjects;
+        uint32_t texturedObjects;
+        uint32_t texRects;
+        uint32_t renderTexturePasses;
+
+        // Scenes with any of these use S2DEX2 instead of F3DEX2.
+        uint32_t backgroundCopies;
+        uint32_t scaledBackgrounds;
+        uint32_t objectRects;
+
+        bool usesS2DEX() const {
+            return (backgroundCopies > 0) || (scaledBackgrounds > 0) || (objectRects > 0);
+        }
+    };
+
+    const SceneDesc Scenes[] = {
+        { "matrices", 400, 0, 0, 0, 0, 0, 0 },
+        { "textured", 0, 200, 0, 0, 0, 0, 0 },
+        { "texrects", 0, 0, 600, 0, 0, 0, 0 },
+        { "render_to_texture", 100, 0, 64, RenderTextureCount, 0, 0, 0 },
+        { "mixed", 150, 100, 200, 2, 0, 0, 0 },
+        { "s2dex_bg", 0, 0, 0, 0, 2, 4, 0 },
+        { "s2dex_obj", 0, 0, 0, 0, 1, 0, 600 }
+    };
+
+    void buildFrame(const SceneDesc &scene, uint8_t *RDRAM, uint32_t frameIndex) {
+        SyntheticImage image;
+        image.RDRAM = RDRAM;
+        image.writeViewport(ViewportAddress);
+
+        DisplayListBuilder builder;
+        const float time = frameIndex / 60.0f;
+        const uint32_t projectionAddress = image.allocateProjectionMatrix();
+        auto beginGeometry = [&](bool textured) {
+            builder.setOtherMode(G_CYC_1CYCLE | G_TP_PERSP | G_TF_BILERP, RenderModeOpaqueZ);
+            if (textured) {
+                builder.setCombine(CC_TEXEL0, CC_0_B, CC_SHADE, CC_0_D, AC_0, AC_0, AC_0, AC_SHADE);
+            }
+            else {
+                builder.setCombine(CC_0_A, CC_0_B, CC_0_C, CC_SHADE, AC_0, AC_0, AC_0, AC_SHADE);
+            }
+
+            builder.texture(textured);
+            builder.geometryMode(F3DEX2_G_ZBUFFER | G_SHADE | F3DEX2_G_CULL_BACK | F3DEX2_G_SHADING_SMOOTH);
+            builder.viewport(ViewportAddress);
+            builder.matrix(projectionAddress, F3DEX2_G_MTX_PROJECTION_LOAD);
+        };
+
+        auto beginRects = [&]() {
+            builder.setOtherMode(G_CYC_1CYCLE | G_TP_NONE | G_TF_POINT, RenderModeOpaque);
+            builder.setCombine(CC_0_A, CC_0_B, CC_0_C, CC_TEXEL0, AC_0, AC_0, AC_0, AC_TEXEL0);
+        };
+
+        // Render to texture passes draw into small color images that are sampled afterwards by the main pass.
+        builder.setDepthImage(DepthImageAddress);
+        for (uint32_t i = 0; i < scene.renderTexturePasses; i++) {
+            const uint32_t address = RenderTextureAddress + i * TextureSize * TextureSize * 2;
+            builder.clear(TextureSize, TextureSize, address, 0x00010001 * (i + 1));
+            builder.setScissor(TextureSize, TextureSize);
+            beginRects();
+            builder.loadTexture(TextureAddress + (i % TextureCount) * TextureSize * TextureSize * 2);
+            for (uint32_t j = 0; j < 8; j++) {
+                const uint32_t offset = (frameIndex + j * 3) % (TextureSize / 2);
+                builder.texRect(offset, offset, offset + TextureSize / 2, offset + TextureSize / 2);
+            }
+
+            builder.add(G_RDPPIPESYNC << 24, 0);
+        }
+
+        // Main pass.
+        builder.clear(ScreenWidth, ScreenHeight, DepthImageAddress, 0xFFFCFFFC);
+        builder.clear(ScreenWidth, ScreenHeight, ColorImageAddress, 0x00010001);
+        builder.setScissor(ScreenWidth, ScreenHeight);
+
+        if (scene.backgroundCopies > 0) {
+            builder.setOtherMode(G_CYC_COPY | G_TP_NONE | G_TF_POINT, RenderModeOpaque);
+            for (uint32_t i = 0; i < scene.backgroundCopies; i++) {
+                builder.bgCopy(image.allocateBackgroundCopy());
+                builder.add(G_RDPPIPESYNC << 24, 0);
+            }
+        }
+
+        if (scene.scaledBackgrounds > 0) {
+            // Parallax layers that scroll at different speeds.
+            builder.setOtherMode(G_CYC_1CYCLE | G_TP_NONE | G_TF_POINT, RenderModeOpaque);
+            builder.setCombine(CC_0_A, CC_0_B, CC_0_C, CC_TEXEL0, AC_0, AC_0, AC_0, AC_TEXEL0);
+            builder.objRenderMode(0);
+            for (uint32_t i = 0; i < scene.scaledBackgrounds; i++) {
+                builder.bg1Cyc(image.allocateScaledBackground(frameIndex * (i + 1), (1 << 10) + (i << 7)));
+                builder.add(G_RDPPIPESYNC << 24, 0);
+            }
+        }
+
+        if (scene.objectRects > 0) {
+            beginRects();
+            builder.objRenderMode(0);
+
+            uint32_t objectTextures[TextureCount];
+            for (uint32_t i = 0; i < TextureCount; i++) {
+                objectTextures[i] = image.allocateObjectTexture(i);
+            }
+
+            // Consecutive sprites share textures, like animation frames of the same character.
+            for (uint32_t i = 0; i < scene.objectRects; i++) {
+                builder.objLoadTexture(objectTextures[(i / 4) % TextureCount]);
+                builder.renderTile();
+
+                const uint32_t x = (i * 13 + frameIndex) % (ScreenWidth - TextureSize);
+                const uint32_t y = (i * 7) % (ScreenHeight - TextureSize);
+                builder.texRect(x, y, x + TextureSize, y + TextureSize);
+            }
+        }
+
+        if (scene.shadedObjects > 0) {
+            beginGeometry(false);
+            for (uint32_t i = 0; i < scene.shadedObjects; i++) {
+                const float x = float(int32_t(i % 20) - 10) * 30.0f;
+                const float y = float(int32_t((i / 20) % 20) - 10) * 20.0f;
+                const float z = -300.0f - float(i / 400) * 50.0f;
+                drawCube(builder, image.allocateModelMatrix(x, y, z, time + i * 0.1f, 1.0f), image.allocateCube(i));
+            }
+        }
+
+        if (scene.texturedObjects > 0) {
+            beginGeometry(true);
+            for (uint32_t i = 0; i < scene.texturedObjects; i++) {
+                builder.loadTexture(TextureAddress + (i % TextureCount) * TextureSize * TextureSize * 2);
+                const float x = float(int32_t(i % 16) - 8) * 35.0f;
+                const float y = float(int32_t((i / 16) % 16) - 8) * 25.0f;
+                drawCube(builder, image.allocateModelMatrix(x, y, -350.0f, time * 0.5f + i * 0.2f, 1.2f), image.allocateCube(i + 1000));
+            }
+        }
+
+        if ((scene.texRects > 0) || (scene.renderTexturePasses > 0)) {
+            beginRects();
+            for (uint32_t i = 0; i < scene.texRects; i++) {
+                // Alternate between the regular textures and the render targets written earlier.
+                const bool useRenderTexture = (scene.renderTexturePasses > 0) && ((i % 2) == 0);
+                const uint32_t textureAddress = useRenderTexture ? RenderTextureAddress + (i % scene.renderTexturePasses) * TextureSize * TextureSize * 2 : TextureAddress + (i % TextureCount) * TextureSize * TextureSize * 2;
+                builder.loadTexture(textureAddress);
+
+                const uint32_t x = (i * 13 + frameIndex) % (ScreenWidth - TextureSize);
+                const uint32_t y = (i * 7) % (ScreenHeight - TextureSize);
+                builder.texRect(x, y, x + TextureSize, y + TextureSize);
+            }
+        }
+
+        builder.end();
+        memcpy(&RDRAM[DisplayListAddress], builder.commands.data(), builder.commands.size() * sizeof(RT64::DisplayList));
+    }
+
+    void writeVIRegisters(uint32_t *registers) {
+        // NTSC 320x240 with 16-bit color. Matches the order of Application::Core::copyVIRegisters().
+        registers[0] = 0x0000320E;
+        registers[1] = ColorImageAddress;
+        registers[2] = ScreenWidth;
+        registers[3] = 0x00000002;
+        registers[4] = 0x00000000;
+        registers[5] = 0x03E52239;
+        registers[6] = 0x0000020D;
+        registers[7] = 0x00000C15;
+        registers[8] = 0x0C150C15;
+        registers[9] = 0x006C02EC;
+        registers[10] = 0x002501FF;
+        registers[11] = 0x000E0204;
+        registers[12] = 0x00000200;
+        registers[13] = 0x00000400;
+    }
+
+    struct StageSamples {
+        std::string name;
+        RT64::ProfilingTimer *timer;
+        std::vector<double> samples;
+    };
+
+    json summarize(std::vector<double> samples) {
+        json result;
+        if (samples.empty()) {
+            return result;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+
+        const size_t p99Index = std::min(samples.size() - 1, size_t(std::ceil(samples.size() * 0.99)) - 1);
+        result["samples"] = samples.size();
+        result["min"] = samples.front();
+        result["median"] = samples[samples.size() / 2];
+        result["p99"] = samples[p99Index];
+        result["mean"] = sum / samples.size();
+        return result;
+    }
+
+    void collectSamples(const RT64::ProfilingTimer &timer, uint32_t warmupCount, std::vector<double> &samples) {
+        // The history is large enough to never wrap around during a scene.
+        const uint32_t loggedCount = std::min(uint32_t(timer.index()), uint32_t(timer.size()));
+        for (uint32_t i = warmupCount; i < loggedCount; i++) {
+            samples.emplace_back(timer.data()[i]);
+        }
+    }
+
+    bool compareWithBaseline(const json &results, const json &baseline, double threshold) {
+        bool regressed = false;
+        for (auto sceneIt = results["scenes"].begin(); sceneIt != results["scenes"].end(); sceneIt++) {
+            if (!baseline["scenes"].contains(sceneIt.key())) {
+                continue;
+            }
+
+            const json &baselineScene = baseline["scenes"][sceneIt.key()];
+            for (auto stageIt = sceneIt.value().begin(); stageIt != sceneIt.value().end(); stageIt++) {
+                if (!baselineScene.contains(stageIt.key()) || !stageIt.value().contains("median")) {
+                    continue;
+                }
+
+                const double baselineMedian = baselineScene[stageIt.key()].value("median", 0.0);
+                const double currentMedian = stageIt.value()["median"].get<double>();
+                if ((baselineMedian > 0.0) && (currentMedian > (baselineMedian * (1.0 + threshold)))) {
+                    fprintf(stderr, "Regression in %s/%s: %.3f ms -> %.3f ms (%+.1f%%).\n", sceneIt.key().c_str(), stageIt.key().c_str(), baselineMedian, currentMedian, ((currentMedian / baselineMedian) - 1.0) * 100.0);
+                    regressed = true;
+                }
+            }
+        }
+
+        return regressed;
+    }
+
+    void checkInterrupts() {
+        // The benchmark doesn't emulate a CPU, so interrupts are ignored.
+    }
+
+    bool processWindowMessages() {
+#   if defined(_WIN32)
+        MSG msg;
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                return false;
+            }
+
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+#   else
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                return false;
+            }
+        }
+#   endif
+        return true;
+    }
+};
+
+int main(int argc, char **argv) {
+    std::vector<std::string> sceneNames;
+    uint32_t frameCount = 300;
+    uint32_t warmupCount = 60;
+    bool useNull = false;
+    std::string outputPath;
+    std::string baselinePath;
+    double threshold = 0.1;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "--scene") == 0) && hasValue) {
+            sceneNames.emplace_back(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "--frames") == 0) && hasValue) {
+            frameCount = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if ((strcmp(argv[i], "--warmup") == 0) && hasValue) {
+            warmupCount = uint32_t(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--null") == 0) {
+            useNull = true;
+        }
+        else if ((strcmp(argv[i], "--output") == 0) && hasValue) {
+            outputPath = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--baseline") == 0) && hasValue) {
+            baselinePath = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--threshold") == 0) && hasValue) {
+            threshold = strtod(argv[++i], nullptr);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--scene NAME] [--frames N] [--warmup N] [--null] [--output FILE] [--baseline FILE] [--threshold RATIO]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<const SceneDesc *> scenes;
+    for (const SceneDesc &scene : Scenes) {
+        if (sceneNames.empty() || (std::find(sceneNames.begin(), sceneNames.end(), scene.name) != sceneNames.end())) {
+            scenes.emplace_back(&scene);
+        }
+    }
+
+    if (scenes.empty()) {
+        fprintf(stderr, "No scenes match the requested names.\n");
+        return 1;
+    }
+
+    // Registers and memory that would normally be owned by the emulator.
+    std::vector<uint8_t> RDRAM(RDRAMSize, 0);
+    std::vector<uint8_t> HEADER(0x40, 0);
+    std::vector<uint8_t> DMEM(0x1000, 0);
+    std::vector<uint8_t> IMEM(0x1000, 0);
+    uint32_t MI_INTR_REG = 0;
+    uint32_t DPC_REGS[8] = {};
+    uint32_t VI_REGS[14] = {};
+
+    RT64::Application::Core core = {};
+    core.HEADER = HEADER.data();
+    core.RDRAM = RDRAM.data();
+    core.DMEM = DMEM.data();
+    core.IMEM = IMEM.data();
+    core.MI_INTR_REG = &MI_INTR_REG;
+    core.DPC_START_REG = &DPC_REGS[0];
+    core.DPC_END_REG = &DPC_REGS[1];
+    core.DPC_CURRENT_REG = &DPC_REGS[2];
+    core.DPC_STATUS_REG = &DPC_REGS[3];
+    core.DPC_CLOCK_REG = &DPC_REGS[4];
+    core.DPC_BUFBUSY_REG = &DPC_REGS[5];
+    core.DPC_PIPEBUSY_REG = &DPC_REGS[6];
+    core.DPC_TMEM_REG = &DPC_REGS[7];
+    core.VI_STATUS_REG = &VI_REGS[0];
+    core.VI_ORIGIN_REG = &VI_REGS[1];
+    core.VI_WIDTH_REG = &VI_REGS[2];
+    core.VI_INTR_REG = &VI_REGS[3];
+    core.VI_V_CURRENT_LINE_REG = &VI_REGS[4];
+    core.VI_TIMING_REG = &VI_REGS[5];
+    core.VI_V_SYNC_REG = &VI_REGS[6];
+    core.VI_H_SYNC_REG = &VI_REGS[7];
+    core.VI_LEAP_REG = &VI_REGS[8];
+    core.VI_H_START_REG = &VI_REGS[9];
+    core.VI_V_START_REG = &VI_REGS[10];
+    core.VI_V_BURST_REG = &VI_REGS[11];
+    core.VI_X_SCALE_REG = &VI_REGS[12];
+    core.VI_Y_SCALE_REG = &VI_REGS[13];
+    core.checkInterrupts = &checkInterrupts;
+    writeVIRegisters(VI_REGS);
+
+    // Use the default configuration so results don't depend on the user's settings.
+    RT64::ApplicationConfiguration appConfig;
+    appConfig.useConfigurationFile = false;
+
+    std::unique_ptr<RT64::Application> application = std::make_unique<RT64::Application>(core, appConfig);
+    if (useNull) {
+        application->userConfig.graphicsAPI = RT64::UserConfiguration::GraphicsAPI::Null;
+    }
+
+    // Targeting the original rate enables frame matching, which runs the projection, transform and tile processors, without
+    // generating any interpolated frames. Every stage then logs at most once per frame.
+    application->userConfig.refreshRate = RT64::UserConfiguration::RefreshRate::Manual;
+    application->userConfig.refreshRateTarget = 60;
+
+    if (application->setup(0) != RT64::Application::SetupResult::Success) {
+        fprintf(stderr, "Failed to set up the application.\n");
+        return 1;
+    }
+
+    application->swapChain->setVsyncEnabled(false);
+
+    // The lists are generated directly, so there's no microcode in RDRAM to detect the GBI from.
+    const RT64::GBIInstance benchmarkInstance = { "F3DEX2 (Benchmark)", RT64::GBIUCode::F3DEX2, {} };
+    const RT64::GBIInstance backgroundInstance = { "S2DEX2 (Benchmark)", RT64::GBIUCode::S2DEX2, {} };
+    SyntheticImage image;
+    image.RDRAM = RDRAM.data();
+    image.writeTextures();
+    image.writeBackground();
+
+    json results;
+    results["frames"] = frameCount;
+    results["warmup"] = warmupCount;
+    results["graphicsAPI"] = application->chosenGraphicsAPI;
+    results["device"] = application->device->getDescription().name;
+
+    RT64::State *state = application->state.get();
+    RT64::WorkloadQueue *workloadQueue = application->workloadQueue.get();
+    RT64::PresentQueue *presentQueue = application->presentQueue.get();
+    const uint32_t totalFrames = warmupCount + frameCount;
+    bool running = true;
+    for (const SceneDesc *scene : scenes) {
+        if (!running) {
+            break;
+        }
+
+        std::vector<StageSamples> stages = {
+            { "display_lists_api", &application->dlApiProfiler },
+            { "screen_api", &application->screenApiProfiler },
+            { "display_lists", &state->dlCpuProfiler },
+            { "screen", &state->screenCpuProfiler },
+            { "matching", &workloadQueue->matchingProfiler },
+            { "renderer", &workloadQueue->rendererProfiler },
+            { "workload", &workloadQueue->workloadProfiler },
+            { "present", &presentQueue->presentProfiler },
+            { "projection", &workloadQueue->projectionProfiler },
+            { "transform", &workloadQueue->transformProfiler },
+            { "tile", &workloadQueue->tileProfiler }
+        };
+
+        // The queue threads log their timers after notifying the IDs, so they must also be idle before the timers can be touched.
+        // Every stage logs at most once per frame, so the history can hold the whole scene without wrapping around.
+        workloadQueue->waitForWorkloadId(state->workloadId);
+        presentQueue->waitForPresentId(state->presentId);
+        workloadQueue->waitForIdle();
+        presentQueue->waitForIdle();
+        application->interpreter->loadInstanceGBI(scene->usesS2DEX() ? &backgroundInstance : &benchmarkInstance);
+        for (StageSamples &stage : stages) {
+            stage.timer->setCount(totalFrames * 2);
+            stage.timer->clear();
+        }
+
+        std::vector<double> frameSamples;
+        for (uint32_t i = 0; (i < totalFrames) && running; i++) {
+            buildFrame(*scene, RDRAM.data(), i);
+
+            auto frameBegin = std::chrono::steady_clock::now();
+            application->processDisplayLists(RDRAM.data(), DisplayListAddress, 0, true);
+            application->updateScreen();
+            auto frameEnd = std::chrono::steady_clock::now();
+            running = processWindowMessages();
+            if (i >= warmupCount) {
+                frameSamples.emplace_back(std::chrono::duration<double, std::milli>(frameEnd - frameBegin).count());
+            }
+        }
+
+        workloadQueue->waitForWorkloadId(state->workloadId);
+        presentQueue->waitForPresentId(state->presentId);
+        workloadQueue->waitForIdle();
+        presentQueue->waitForIdle();
+
+        json &sceneResults = results["scenes"][scene->name];
+        sceneResults["submit"] = summarize(frameSamples);
+        for (StageSamples &stage : stages) {
+            collectSamples(*stage.timer, warmupCount, stage.samples);
+            if (!stage.samples.empty()) {
+                sceneResults[stage.name] = summarize(stage.samples);
+            }
+        }
+
+        fprintf(stderr, "%s: submit median %.3f ms, renderer median %.3f ms.\n", scene->name, sceneResults["submit"].value("median", 0.0), sceneResults.contains("renderer") ? sceneResults["renderer"].value("median", 0.0) : 0.0);
+    }
+
+    application->end();
+
+    const std::string resultsText = results.dump(4);
+    if (outputPath.empty()) {
+        fprintf(stdout, "%s\n", resultsText.c_str());
+    }
+    else {
+        std::ofstream outputStream(outputPath);
+        outputStream << resultsText << std::endl;
+        if (outputStream.bad()) {
+            fprintf(stderr, "Unable to write results to %s.\n", outputPath.c_str());
+            return 1;
+        }
+    }
+
+    if (!baselinePath.empty()) {
+        std::ifstream baselineStream(baselinePath);
+        if (!baselineStream.is_open()) {
+            fprintf(stderr, "Unable to open baseline %s.\n", baselinePath.c_str());
+            return 1;
+        }
+
+        json baseline = json::parse(baselineStream, nullptr, false);
+        if (baseline.is_discarded() || !baseline.contains("scenes")) {
+            fprintf(stderr, "Baseline %s is not valid.\n", baselinePath.c_str());
+            return 1;
+        }
+
+        if (compareWithBaseline(results, baseline, threshold)) {
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -5,9 +5,11 @@
 #include "rhi/rt64_render_interface.h"
 
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
 #include <chrono>
 #include <functional>
+#include <mutex>
 #include <SDL.h>
 #include <SDL_syswm.h>
 #include <thread>
@@ -1278,6 +1280,9 @@ namespace RT64 {
 
     struct AsyncComputeTest : public TestBase {
         std::unique_ptr<std::thread> thread;
+        std::mutex threadMutex;
+        std::condition_variable threadCondition;
+        bool threadRunning = false;
         std::unique_ptr<RenderPipeline> asyncPipeline;
         std::unique_ptr<RenderPipelineLayout> asyncPipelineLayout;
         std::unique_ptr<RenderDescriptorSet> asyncDescriptorSet;
@@ -1361,9 +1366,33 @@ namespace RT64 {
             std::unique_ptr<RenderShader> computeShader = ctx.device->createShader(csData.blob, csData.size, "CSMain", shaderFormat);
             asyncPipeline = ctx.device->createComputePipeline(RenderComputePipelineDesc(asyncPipelineLayout.get(), computeShader.get(), 1, 1, 1));
 
+            threadRunning = true;
             thread = std::make_unique<std::thread>(&AsyncComputeTest::threadFunction, this);
         }
 
+        void shutdown(TestContext &ctx) override {
+            {
+                std::unique_lock<std::mutex> lock(threadMutex);
+                threadRunning = false;
+            }
+
+            threadCondition.notify_all();
+            thread->join();
+            thread.reset();
+
+            asyncPipeline.reset();
+            asyncDescriptorSet.reset();
+            asyncByteAddressBuffer.reset();
+            asyncStructuredBuffer.reset();
+            asyncBufferFormattedView.reset();
+            asyncBuffer.reset();
+            asyncPipelineLayout.reset();
+            asyncCommandFence.reset();
+            asyncCommandList.reset();
+            asyncCommandQueue.reset();
+            TestBase::shutdown(ctx);
+        }
+
         void resize(TestContext &ctx) override {
             // This test does not use a swap chain.
         }
@@ -1406,8 +1435,12 @@ namespace RT64 {
                 inputValue += 1.0f;
                 frameCount++;
 
+                // Wait before the next dispatch unless the test is shutting down.
                 using namespace std::chrono_literals;
-                std::this_thread::sleep_for(500ms);
+                std::unique_lock<std::mutex> lock(threadMutex);
+                if (threadCondition.wait_for(lock, 500ms, [this]() { return !threadRunning; })) {
+                    break;
+                }
             }
         }
     };
@@ -1427,6 +1460,33 @@ namespace RT64 {
         g_Tests.push_back([]() { return std::make_unique<AsyncComputeTest>(); });
     }
 
+    int RenderInterfaceTestHeadless(RenderInterface *renderInterface, uint32_t frameCount) {
+        RegisterTests();
+
+        for (uint32_t i = 0; i < uint32_t(g_Tests.size()); i++) {
+            // The swap chain is created without a window, so this only works with interfaces that don't present to one, like the null backend.
+            // Shutting down a test destroys the whole context, so every test gets its own.
+            TestContext testContext;
+            createContext(testContext, renderInterface, RenderWindow{});
+            if ((testContext.device == nullptr) || (testContext.swapChain == nullptr)) {
+                fprintf(stderr, "Failed to create the device or the swap chain for test %u.\n", i);
+                return 1;
+            }
+
+            g_CurrentTest = g_Tests[i]();
+            g_CurrentTest->initialize(testContext);
+            for (uint32_t f = 0; f < frameCount; f++) {
+                g_CurrentTest->draw(testContext);
+            }
+
+            g_CurrentTest->shutdown(testContext);
+            g_CurrentTest.reset();
+            fprintf(stdout, "Test %u ran for %u frames.\n", i, frameCount);
+        }
+
+        return 0;
+    }
+
     // Update platform specific code to use the new test framework
 #if defined(_WIN64)
     TestContext g_TestContext;
@@ -0,0 +1,264 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "xxHash/xxh3.h"
+
+#include "common/rt64_load_types.h"
+#include "shared/rt64_f3d_defines.h"
+#include "common/rt64_tmem_hasher.h"
+
+// Hashes a deterministic corpus of synthetic TMEM contents and tiles with every hash version and compares the results against the recorded
+// digests. Both the runtime and texture_hasher use the same hasher, so a change in any of these digests means existing texture packs would
+// stop matching. A new hash version must only append its digest to the table.
+// Usage: tmem_hasher_test [--bench] [--iterations N] [--print]
+
+namespace {
+    const uint64_t CorpusSeed = 0x52543634544D454DULL;
+    const uint32_t CorpusSize = 4096;
+    const uint32_t TMEMBytes = 4096;
+
+    // Digests of the hashes of the whole corpus for versions 1 to 5. Recorded with the implementation that updated the hash state for every range.
+    const uint64_t GoldenDigests[] = {
+        0xDD9A2AF8C7D42CE9ULL,
+        0xE4E1D8E126A262AAULL,
+        0x1634F7F3C6F13D36ULL,
+        0xEF0A155A0DF5A630ULL,
+        0x859FE18FF4826E60ULL
+    };
+
+    static_assert(std::size(GoldenDigests) == RT64::TMEMHasher::CurrentHashVersion, "A digest must be recorded for every hash version.");
+
+    // Small generator with a fixed output sequence on every platform and standard library.
+    struct SplitMix64 {
+        uint64_t state;
+
+        SplitMix64(uint64_t seed) {
+            state = seed;
+        }
+
+        uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        uint32_t range(uint32_t count) {
+            return uint32_t(next() % count);
+        }
+    };
+
+    struct TextureFormat {
+        uint8_t fmt;
+        uint8_t siz;
+    };
+
+    const TextureFormat TextureFormats[] = {
+        { G_IM_FMT_RGBA, G_IM_SIZ_16b },
+        { G_IM_FMT_RGBA, G_IM_SIZ_32b },
+        { G_IM_FMT_IA, G_IM_SIZ_8b },
+        { G_IM_FMT_IA, G_IM_SIZ_16b },
+        { G_IM_FMT_I, G_IM_SIZ_4b },
+        { G_IM_FMT_I, G_IM_SIZ_8b },
+        { G_IM_FMT_CI, G_IM_SIZ_4b },
+        { G_IM_FMT_CI, G_IM_SIZ_8b }
+    };
+
+    struct CorpusEntry {
+        std::vector<uint8_t> TMEM;
+        RT64::LoadTile loadTile = {};
+        uint16_t width = 0;
+        uint16_t height = 0;
+        uint32_t tlut = 0;
+    };
+
+    void generateEntry(SplitMix64 &random, CorpusEntry &entry) {
+        const TextureFormat &format = TextureFormats[random.range(uint32_t(std::size(TextureFormats)))];
+        const bool RGBA32 = (format.siz == G_IM_SIZ_32b) && (format.fmt == G_IM_FMT_RGBA);
+        const bool CI = (format.fmt == G_IM_FMT_CI);
+
+        // Tiles that don't fit in TMEM are never hashed, so they're generated again until they do.
+        RT64::LoadTile &loadTile = entry.loadTile;
+        do {
+            loadTile = {};
+            loadTile.fmt = format.fmt;
+            loadTile.siz = format.siz;
+            entry.width = uint16_t(1 + random.range(64));
+            entry.height = uint16_t(1 + random.range(64));
+
+            // Half of the tiles leave padding at the end of every row, which requires hashing the rows individually.
+            const uint32_t drawBytesPerRow = std::max(uint32_t(entry.width) << (RGBA32 ? G_IM_SIZ_16b : format.siz) >> 1U, 1U);
+            const uint32_t paddingWords = (random.range(2) == 0) ? random.range(4) : 0;
+            loadTile.line = uint16_t(((drawBytesPerRow + 7) >> 3) + paddingWords);
+            loadTile.tmem = uint16_t(random.range(TMEMBytes >> 3));
+            loadTile.palette = uint8_t(random.range(16));
+        } while (RT64::TMEMHasher::requiresRawTMEM(loadTile, entry.width, entry.height));
+
+        // Color indexed formats always use a TLUT. A few of the other formats use it as well to cover the address masking.
+        if (CI || (random.range(8) == 0)) {
+            entry.tlut = 1 + random.range(2);
+        }
+        else {
+            entry.tlut = 0;
+        }
+
+        entry.TMEM.resize(TMEMBytes);
+        for (uint8_t &byte : entry.TMEM) {
+            byte = uint8_t(random.next());
+        }
+
+        // Half of the textures that use a TLUT only use a few distinct indices so only part of the palette is hashed.
+        if ((entry.tlut > 0) && (random.range(2) == 0)) {
+            uint8_t indices[16];
+            const uint32_t indexCount = 1 + random.range(uint32_t(std::size(indices)));
+            for (uint32_t i = 0; i < indexCount; i++) {
+                indices[i] = uint8_t(random.next());
+            }
+
+            for (uint32_t i = 0; i < (TMEMBytes >> 1); i++) {
+                entry.TMEM[i] = indices[random.range(indexCount)];
+            }
+        }
+    }
+
+    void generateCorpus(std::vector<CorpusEntry> &corpus) {
+        SplitMix64 random(CorpusSeed);
+        corpus.resize(CorpusSize);
+        for (CorpusEntry &entry : corpus) {
+            generateEntry(random, entry);
+        }
+    }
+
+    uint64_t hashCorpus(const std::vector<CorpusEntry> &corpus, uint32_t version, std::vector<uint64_t> &hashes) {
+        hashes.resize(corpus.size());
+        for (size_t i = 0; i < corpus.size(); i++) {
+            const CorpusEntry &entry = corpus[i];
+            hashes[i] = RT64::TMEMHasher::hash(entry.TMEM.data(), entry.loadTile, entry.width, entry.height, entry.tlut, version);
+        }
+
+        return XXH3_64bits(hashes.data(), hashes.size() * sizeof(uint64_t));
+    }
+
+    int runCheck(const std::vector<CorpusEntry> &corpus, bool printDigests) {
+        std::vector<uint64_t> hashes;
+        uint32_t mismatchCount = 0;
+        for (uint32_t version = 1; version <= RT64::TMEMHasher::CurrentHashVersion; version++) {
+            const uint64_t digest = hashCorpus(corpus, version, hashes);
+            const uint64_t goldenDigest = GoldenDigests[version - 1];
+            if (printDigests) {
+                printf("        0x%016" PRIX64 "ULL%s\n", digest, (version < RT64::TMEMHasher::CurrentHashVersion) ? "," : "");
+            }
+            else if (digest != goldenDigest) {
+                fprintf(stderr, "Version %u: digest 0x%016" PRIX64 " does not match the recorded digest 0x%016" PRIX64 ".\n", version, digest, goldenDigest);
+                mismatchCount++;
+            }
+            else {
+                printf("Version %u: OK.\n", version);
+            }
+        }
+
+        return (mismatchCount > 0) ? 1 : 0;
+    }
+
+    void runBenchmark(const std::vector<CorpusEntry> &corpus, uint32_t iterations) {
+        std::vector<uint64_t> hashes;
+        for (uint32_t version = 1; version <= RT64::TMEMHasher::CurrentHashVersion; version++) {
+            // Warm up the gather buffer and the caches before measuring.
+            hashCorpus(corpus, version, hashes);
+
+            const auto startTime = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++) {
+                hashCorpus(corpus, version, hashes);
+            }
+
+            const auto endTime = std::chrono::steady_clock::now();
+            const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+            const double hashCount = double(corpus.size()) * iterations;
+            printf("Version %u: %.1f ns per hash, %.2f million hashes per second.\n", version, (seconds * 1e9) / hashCount, hashCount / (seconds * 1e6));
+        }
+
+        // The scan of the TLUT indices is measured on its own for the textures that use a TLUT, both on the corpus contents and with every row
+        // repeating the first one like in textures with solid areas.
+        std::vector<uint8_t> repeatedBytes(TMEMBytes >> 1);
+        uint8_t bytesPresent[256];
+        uint32_t scanCount = 0;
+        double scanSeconds = 0.0;
+        double repeatedScanSeconds = 0.0;
+        for (const CorpusEntry &entry : corpus) {
+            if (entry.tlut == 0) {
+                continue;
+            }
+
+            const uint32_t rowBytes = std::max(uint32_t(entry.loadTile.line) << 3, 8U);
+            for (uint32_t i = 0; i < repeatedBytes.size(); i++) {
+                repeatedBytes[i] = entry.TMEM[i % rowBytes];
+            }
+
+            auto startTime = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++) {
+                memset(bytesPresent, 0, sizeof(bytesPresent));
+                RT64::TMEMHasher::markBytesPresent(entry.TMEM.data(), uint32_t(repeatedBytes.size()), bytesPresent);
+            }
+
+            auto endTime = std::chrono::steady_clock::now();
+            scanSeconds += std::chrono::duration<double>(endTime - startTime).count();
+
+            startTime = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++) {
+                memset(bytesPresent, 0, sizeof(bytesPresent));
+                RT64::TMEMHasher::markBytesPresent(repeatedBytes.data(), uint32_t(repeatedBytes.size()), bytesPresent);
+            }
+
+            endTime = std::chrono::steady_clock::now();
+            repeatedScanSeconds += std::chrono::duration<double>(endTime - startTime).count();
+            scanCount += iterations;
+        }
+
+        if (scanCount > 0) {
+            printf("TLUT scan: %.1f ns per 2 KB, %.1f ns per 2 KB with repeated rows.\n", (scanSeconds * 1e9) / scanCount, (repeatedScanSeconds * 1e9) / scanCount);
+        }
+    }
+};
+
+int main(int argc, char **argv) {
+    bool benchmark = false;
+    bool printDigests = false;
+    uint32_t iterations = 100;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if (strcmp(argv[i], "--bench") == 0) {
+            benchmark = true;
+        }
+        else if ((strcmp(argv[i], "--iterations") == 0) && hasValue) {
+            iterations = std::max(uint32_t(strtoul(argv[++i], nullptr, 10)), 1U);
+        }
+        else if (strcmp(argv[i], "--print") == 0) {
+            printDigests = true;
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<CorpusEntry> corpus;
+    generateCorpus(corpus);
+
+    if (benchmark) {
+        runBenchmark(corpus, iterations);
+        return 0;
+    }
+    else {
+        return runCheck(corpus, printDigests);
+    }
+}
@@ -43,6 +43,11 @@ namespace RT64 {
         virtual bool exists(const std::string &path) const = 0;
         virtual std::string makeCanonical(const std::string &path) const = 0;
 
+        // Optional. Retrieve a pointer to the contents of the file that remains valid for the lifetime of the file system without copying them.
+        virtual bool view(const std::string &path, const uint8_t *&fileData, size_t &fileDataByteCount) const {
+            return false;
+        }
+
         // Concrete implementation shortcut.
         bool load(const std::string &path, std::vector<uint8_t> &fileData) {
             size_t fileDataSize = getSize(path);
@@ -54,6 +59,21 @@ namespace RT64 {
             return load(path, fileData.data(), fileDataSize);
         }
 
+        // Views the file if it's supported by the file system or loads it into the fallback vector otherwise.
+        bool viewOrLoad(const std::string &path, std::vector<uint8_t> &fallbackData, const uint8_t *&fileData, size_t &fileDataByteCount) {
+            if (view(path, fileData, fileDataByteCount)) {
+                return true;
+            }
+
+            if (!load(path, fallbackData)) {
+                return false;
+            }
+
+            fileData = fallbackData.data();
+            fileDataByteCount = fallbackData.size();
+            return true;
+        }
+
         static std::string toForwardSlashes(std::string str) {
             std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return (c == '\\') ? '/' : c; });
             return str;
@@ -122,6 +122,28 @@ namespace RT64 {
         return { impl->endIterator };
     }
     
+    static const uint8_t *getZipFileData(const MappedFile &zipMappedFile, const FileSystemZipInfo &fileInfo) {
+        // Validate the local dir header.
+        if ((fileInfo.localHeaderOffset + MZ_ZIP_LOCAL_DIR_HEADER_SIZE) > zipMappedFile.size()) {
+            return nullptr;
+        }
+
+        const char *localDirHeader = reinterpret_cast<const char *>(&zipMappedFile.data()[fileInfo.localHeaderOffset]);
+        if (MZ_READ_LE32(localDirHeader) != MZ_ZIP_LOCAL_DIR_HEADER_SIG) {
+            return nullptr;
+        }
+
+        // Skip over unused data of the header.
+        uint32_t ldhFilenameLenOfs = MZ_READ_LE16(localDirHeader + MZ_ZIP_LDH_FILENAME_LEN_OFS);
+        uint32_t ldhExtraLenOfs = MZ_READ_LE16(localDirHeader + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+        size_t dataAddress = fileInfo.localHeaderOffset + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + ldhFilenameLenOfs + ldhExtraLenOfs;
+        if ((dataAddress + fileInfo.compressedSize) > zipMappedFile.size()) {
+            return nullptr;
+        }
+
+        return reinterpret_cast<const uint8_t *>(&zipMappedFile.data()[dataAddress]);
+    }
+
     bool FileSystemZip::load(const std::string &path, uint8_t *fileData, size_t fileDataMaxByteCount) const {
         assert(impl->archiveOpen);
 
@@ -135,19 +157,11 @@ namespace RT64 {
             return false;
         }
 
-        // Validate the local dir header.
-        const char *localDirHeader = reinterpret_cast<const char *>(&impl->zipMappedFile.data()[it->second.localHeaderOffset]);
-        if (MZ_READ_LE32(localDirHeader) != MZ_ZIP_LOCAL_DIR_HEADER_SIG) {
+        const uint8_t *zipFileData = getZipFileData(impl->zipMappedFile, it->second);
+        if (zipFileData == nullptr) {
             return false;
         }
 
-        // Skip over unused data of the header.
-        uint32_t ldhFilenameLenOfs = MZ_READ_LE16(localDirHeader + MZ_ZIP_LDH_FILENAME_LEN_OFS);
-        uint32_t ldhExtraLenOfs = MZ_READ_LE16(localDirHeader + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-        size_t dataAddress = it->second.localHeaderOffset + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + ldhFilenameLenOfs + ldhExtraLenOfs;
-
-        // Make sure output vector has enough bytes to hold the data.
-        const uint8_t *zipFileData = reinterpret_cast<const uint8_t *>(&impl->zipMappedFile.data()[dataAddress]);
         if (it->second.compression == FileSystemZipInfo::Compression::Zstd) {
             if (ZSTD_decompress(fileData, it->second.uncompressedSize, zipFileData, it->second.compressedSize) != it->second.uncompressedSize) {
                 return false;
@@ -165,6 +179,25 @@ namespace RT64 {
         return true;
     }
 
+    bool FileSystemZip::view(const std::string &path, const uint8_t *&fileData, size_t &fileDataByteCount) const {
+        assert(impl->archiveOpen);
+
+        // Only files stored without compression can be read directly from the mapped file.
+        auto it = impl->fileInfoMap.find(path);
+        if ((it == impl->fileInfoMap.end()) || (it->second.compression != FileSystemZipInfo::Compression::None)) {
+            return false;
+        }
+
+        const uint8_t *zipFileData = getZipFileData(impl->zipMappedFile, it->second);
+        if (zipFileData == nullptr) {
+            return false;
+        }
+
+        fileData = zipFileData;
+        fileDataByteCount = it->second.uncompressedSize;
+        return true;
+    }
+
     size_t FileSystemZip::getSize(const std::string &path) const {
         assert(impl->archiveOpen);
         auto it = impl->fileInfoMap.find(path);
@@ -38,6 +38,7 @@ namespace RT64 {
         size_t getSize(const std::string &path) const override;
         bool exists(const std::string &path) const override;
         std::string makeCanonical(const std::string &path) const override;
+        bool view(const std::string &path, const uint8_t *&fileData, size_t &fileDataByteCount) const override;
         bool isOpen() const;
         static std::unique_ptr<FileSystem> create(const std::filesystem::path &zipPath, const std::string &basePath);
     };
@@ -0,0 +1,331 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace RT64 {
+    // Open addressing hash map for 64-bit keys that are already the result of a good hash function (e.g. XXH3).
+    // Entries are stored contiguously in a power of two table and collisions are resolved with linear probing.
+    // Erasing shifts the following entries back instead of leaving tombstones, so lookups never degrade over time.
+    // Inserting or erasing invalidates all iterators and pointers to values. Entries must not be erased while iterating.
+    template<typename V>
+    struct FlatHashMap {
+        struct Slot {
+            uint64_t first = 0;
+            V second = V();
+        };
+
+        template<typename MapType, typename SlotType>
+        struct IteratorBase {
+            MapType *map = nullptr;
+            size_t index = 0;
+
+            IteratorBase(MapType *map, size_t index) : map(map), index(index) {
+                skipEmpty();
+            }
+
+            void skipEmpty() {
+                while ((index < map->slots.size()) && !map->occupied[index]) {
+                    index++;
+                }
+            }
+
+            SlotType &operator*() const {
+                return map->slots[index];
+            }
+
+            SlotType *operator->() const {
+                return &map->slots[index];
+            }
+
+            IteratorBase &operator++() {
+                index++;
+                skipEmpty();
+                return *this;
+            }
+
+            bool operator==(const IteratorBase &other) const {
+                return index == other.index;
+            }
+
+            bool operator!=(const IteratorBase &other) const {
+                return index != other.index;
+            }
+        };
+
+        typedef IteratorBase<FlatHashMap, Slot> Iterator;
+        typedef IteratorBase<const FlatHashMap, const Slot> ConstIterator;
+
+        static const size_t MinimumCapacity = 16;
+
+        std::vector<Slot> slots;
+        std::vector<uint8_t> occupied;
+        size_t count = 0;
+        uint32_t indexShift = 64;
+
+        size_t homeIndex(uint64_t key) const {
+            // Fibonacci hashing spreads keys that only differ in their upper bits across the table.
+            return size_t((key * 0x9E3779B97F4A7C15ULL) >> indexShift);
+        }
+
+        size_t indexMask() const {
+            return slots.size() - 1;
+        }
+
+        size_t findIndex(uint64_t key) const {
+            if (count == 0) {
+                return slots.size();
+            }
+
+            size_t index = homeIndex(key);
+            while (occupied[index]) {
+                if (slots[index].first == key) {
+                    return index;
+                }
+
+                index = (index + 1) & indexMask();
+            }
+
+            return slots.size();
+        }
+
+        void rehash(size_t newCapacity) {
+            assert((newCapacity & (newCapacity - 1)) == 0 && "Capacity must be a power of two.");
+            std::vector<Slot> oldSlots = std::move(slots);
+            std::vector<uint8_t> oldOccupied = std::move(occupied);
+            slots.clear();
+            slots.resize(newCapacity);
+            occupied.clear();
+            occupied.resize(newCapacity, 0);
+
+            indexShift = 64;
+            while ((size_t(1) << (64 - indexShift)) < newCapacity) {
+                indexShift--;
+            }
+
+            for (size_t i = 0; i < oldSlots.size(); i++) {
+                if (oldOccupied[i]) {
+                    size_t index = homeIndex(oldSlots[i].first);
+                    while (occupied[index]) {
+                        index = (index + 1) & indexMask();
+                    }
+
+                    slots[index] = std::move(oldSlots[i]);
+                    occupied[index] = 1;
+                }
+            }
+        }
+
+        void reserve(size_t entryCount) {
+            // Keep the load factor at 75% at most.
+            size_t newCapacity = MinimumCapacity;
+            while ((newCapacity * 3) < (entryCount * 4)) {
+                newCapacity <<= 1;
+            }
+
+            if (newCapacity > slots.size()) {
+                rehash(newCapacity);
+            }
+        }
+
+        std::pair<Iterator, bool> emplace(uint64_t key, V value) {
+            reserve(count + 1);
+
+            size_t index = homeIndex(key);
+            while (occupied[index]) {
+                if (slots[index].first == key) {
+                    return { Iterator(this, index), false };
+                }
+
+                index = (index + 1) & indexMask();
+            }
+
+            slots[index].first = key;
+            slots[index].second = std::move(value);
+            occupied[index] = 1;
+            count++;
+            return { Iterator(this, index), true };
+        }
+
+        V &operator[](uint64_t key) {
+            size_t index = findIndex(key);
+            if (index < slots.size()) {
+                return slots[index].second;
+            }
+
+            return emplace(key, V()).first->second;
+        }
+
+        Iterator find(uint64_t key) {
+            return Iterator(this, findIndex(key));
+        }
+
+        ConstIterator find(uint64_t key) const {
+            return ConstIterator(this, findIndex(key));
+        }
+
+        bool contains(uint64_t key) const {
+            return findIndex(key) < slots.size();
+        }
+
+        void erase(Iterator it) {
+            assert((it.index < slots.size()) && occupied[it.index]);
+
+            // Shift back the entries that follow in the probe sequence if their home position allows it.
+            size_t holeIndex = it.index;
+            size_t index = holeIndex;
+            while (true) {
+                index = (index + 1) & indexMask();
+                if (!occupied[index]) {
+                    break;
+                }
+
+                const size_t entryHome = homeIndex(slots[index].first);
+                const bool entryStays = (holeIndex <= index) ? ((holeIndex < entryHome) && (entryHome <= index)) : ((holeIndex < entryHome) || (entryHome <= index));
+                if (!entryStays) {
+                    slots[holeIndex] = std::move(slots[index]);
+                    holeIndex = index;
+                }
+            }
+
+            slots[holeIndex] = Slot();
+            occupied[holeIndex] = 0;
+            count--;
+        }
+
+        size_t erase(uint64_t key) {
+            size_t index = findIndex(key);
+            if (index < slots.size()) {
+                erase(Iterator(this, index));
+                return 1;
+            }
+            else {
+                return 0;
+            }
+        }
+
+        void clear() {
+            // Keep the table allocated so it can be filled again without reallocating.
+            for (size_t i = 0; (i < slots.size()) && (count > 0); i++) {
+                if (occupied[i]) {
+                    slots[i] = Slot();
+                    occupied[i] = 0;
+                    count--;
+                }
+            }
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        Iterator begin() {
+            return Iterator(this, 0);
+        }
+
+        Iterator end() {
+            return Iterator(this, slots.size());
+        }
+
+        ConstIterator begin() const {
+            return ConstIterator(this, 0);
+        }
+
+        ConstIterator end() const {
+            return ConstIterator(this, slots.size());
+        }
+    };
+
+    // Set version of the map for keys that don't need to store any values.
+    struct FlatHashSet {
+        FlatHashMap<uint8_t> map;
+
+        bool insert(uint64_t key) {
+            return map.emplace(key, 0).second;
+        }
+
+        bool contains(uint64_t key) const {
+            return map.contains(key);
+        }
+
+        size_t erase(uint64_t key) {
+            return map.erase(key);
+        }
+
+        void clear() {
+            map.clear();
+        }
+
+        size_t size() const {
+            return map.size();
+        }
+    };
+
+    // Multimap version of the map. The values of every key are chained in insertion order inside a single vector, so inserting and
+    // looking up are both constant time regardless of how they're interleaved. Clearing keeps the storage allocated.
+    template<typename V>
+    struct FlatHashMultimap {
+        static const uint32_t ChainEnd = UINT32_MAX;
+
+        struct Entry {
+            V value;
+            uint32_t next;
+        };
+
+        struct Chain {
+            uint32_t first = ChainEnd;
+            uint32_t last = ChainEnd;
+        };
+
+        FlatHashMap<Chain> chains;
+        std::vector<Entry> entries;
+
+        void emplace(uint64_t key, const V &value) {
+            const uint32_t entryIndex = uint32_t(entries.size());
+            entries.emplace_back(Entry{ value, ChainEnd });
+
+            Chain &chain = chains[key];
+            if (chain.last != ChainEnd) {
+                entries[chain.last].next = entryIndex;
+            }
+            else {
+                chain.first = entryIndex;
+            }
+
+            chain.last = entryIndex;
+        }
+
+        // Calls the function with every value stored for the key in the order they were inserted.
+        template<typename Function>
+        void forEach(uint64_t key, const Function &function) const {
+            auto it = chains.find(key);
+            if (it == chains.end()) {
+                return;
+            }
+
+            for (uint32_t i = it->second.first; i != ChainEnd; i = entries[i].next) {
+                function(entries[i].value);
+            }
+        }
+
+        void clear() {
+            chains.clear();
+            entries.clear();
+        }
+
+        size_t size() const {
+            return entries.size();
+        }
+    };
+};
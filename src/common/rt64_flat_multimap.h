@@ -0,0 +1,111 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace RT64 {
+    // Sorted vector replacement for std::multimap. Entries are appended unsorted and the owner must call sort() once they're all inserted,
+    // before searching or iterating the map. Iteration order is identical to std::multimap: entries are ordered by key and entries with
+    // equal keys keep their insertion order. Clearing the map keeps the entries and the sorting scratch buffer allocated, so it can be
+    // reused every frame without reallocating.
+    template<typename K, typename V>
+    struct FlatMultimap {
+        typedef std::pair<K, V> Entry;
+        typedef typename std::vector<Entry>::const_iterator ConstIterator;
+
+        std::vector<Entry> entries;
+        std::vector<Entry> scratch;
+        size_t sortedCount = 0;
+
+        static bool compareKeys(const Entry &lhs, const Entry &rhs) {
+            return lhs.first < rhs.first;
+        }
+
+        void clear() {
+            entries.clear();
+            sortedCount = 0;
+        }
+
+        void emplace(const K &key, const V &value) {
+            entries.emplace_back(key, value);
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        size_t size() const {
+            return entries.size();
+        }
+
+        bool isSorted() const {
+            return sortedCount == entries.size();
+        }
+
+        void sort() {
+            if (isSorted()) {
+                return;
+            }
+
+            // Only the entries appended since the last sort need to be sorted. The standard stable algorithms allocate a temporary buffer
+            // on every call, so a bottom-up merge sort that alternates between the entries and the scratch buffer is used instead.
+            const size_t sortedEnd = sortedCount;
+            const size_t entryCount = entries.size();
+            scratch.resize(entryCount);
+
+            Entry *src = entries.data();
+            Entry *dst = scratch.data();
+            for (size_t width = 1; width < (entryCount - sortedEnd); width *= 2) {
+                for (size_t low = sortedEnd; low < entryCount; low += width * 2) {
+                    const size_t middle = std::min(low + width, entryCount);
+                    const size_t high = std::min(middle + width, entryCount);
+                    std::merge(src + low, src + middle, src + middle, src + high, dst + low, compareKeys);
+                }
+
+                std::swap(src, dst);
+            }
+
+            if (src == entries.data()) {
+                std::copy(entries.begin() + sortedEnd, entries.end(), scratch.begin() + sortedEnd);
+            }
+
+            // Merge the new entries into the sorted ones from the back, so no sorted entry is overwritten before it's moved. The new entries
+            // are taken first when the keys are equal to keep them after the older ones.
+            size_t sortedIndex = sortedEnd;
+            size_t newIndex = entryCount;
+            size_t dstIndex = entryCount;
+            while (newIndex > sortedEnd) {
+                if ((sortedIndex > 0) && compareKeys(scratch[newIndex - 1], entries[sortedIndex - 1])) {
+                    entries[--dstIndex] = entries[--sortedIndex];
+                }
+                else {
+                    entries[--dstIndex] = scratch[--newIndex];
+                }
+            }
+
+            sortedCount = entryCount;
+        }
+
+        std::pair<ConstIterator, ConstIterator> equal_range(const K &key) const {
+            assert(isSorted() && "Map must be sorted before it can be searched.");
+            auto lowerIt = std::lower_bound(entries.cbegin(), entries.cend(), key, [](const Entry &entry, const K &k) { return entry.first < k; });
+            auto upperIt = std::upper_bound(lowerIt, entries.cend(), key, [](const K &k, const Entry &entry) { return k < entry.first; });
+            return { lowerIt, upperIt };
+        }
+
+        ConstIterator begin() const {
+            assert(isSorted() && "Map must be sorted before it can be iterated.");
+            return entries.cbegin();
+        }
+
+        ConstIterator end() const {
+            return entries.cend();
+        }
+    };
+};
\ No newline at end of file
@@ -4,6 +4,10 @@
 
 #include "rt64_load_types.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
 namespace RT64 {
     // LoadTile
 
@@ -58,4 +62,64 @@ namespace RT64 {
         loadTexture.siz = j.value("siz", 0);
         loadTexture.width = j.value("width", 0);
     }
+
+    // TMEMRangeList
+
+    void TMEMRangeList::add(uint32_t address, uint32_t byteCount) {
+        if (byteCount == 0) {
+            return;
+        }
+
+        // Absorb every range that overlaps or touches the new one and remove them from the list.
+        uint32_t startAddress = address;
+        uint32_t endAddress = address + byteCount;
+        uint32_t keptCount = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t rangeStart = ranges[i].address;
+            const uint32_t rangeEnd = rangeStart + ranges[i].byteCount;
+            if ((rangeStart <= endAddress) && (startAddress <= rangeEnd)) {
+                startAddress = std::min(startAddress, rangeStart);
+                endAddress = std::max(endAddress, rangeEnd);
+            }
+            else {
+                ranges[keptCount++] = ranges[i];
+            }
+        }
+
+        assert((keptCount < MaxCount) && "Too many TMEM ranges.");
+
+        // Insert the merged range while keeping the list sorted by address.
+        uint32_t insertIndex = keptCount;
+        while ((insertIndex > 0) && (ranges[insertIndex - 1].address > startAddress)) {
+            ranges[insertIndex] = ranges[insertIndex - 1];
+            insertIndex--;
+        }
+
+        ranges[insertIndex].address = uint16_t(startAddress);
+        ranges[insertIndex].byteCount = uint16_t(endAddress - startAddress);
+        count = keptCount + 1;
+    }
+
+    uint32_t TMEMRangeList::byteCount() const {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            total += ranges[i].byteCount;
+        }
+
+        return total;
+    }
+
+    void TMEMRangeList::gather(const uint8_t *TMEM, uint8_t *dstBytes) const {
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(dstBytes, &TMEM[ranges[i].address], ranges[i].byteCount);
+            dstBytes += ranges[i].byteCount;
+        }
+    }
+
+    void TMEMRangeList::scatter(const uint8_t *srcBytes, uint8_t *TMEM) const {
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(&TMEM[ranges[i].address], srcBytes, ranges[i].byteCount);
+            srcBytes += ranges[i].byteCount;
+        }
+    }
 };
\ No newline at end of file
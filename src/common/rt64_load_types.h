@@ -82,6 +82,32 @@ namespace RT64 {
         };
     };
 
+    // Range of bytes in TMEM.
+    struct TMEMRange {
+        uint16_t address;
+        uint16_t byteCount;
+    };
+
+    // Sorted list of the non-overlapping TMEM ranges a texture can read from. Only these bytes need to be stored and uploaded
+    // instead of the entirety of TMEM, as long as they're placed back at the same addresses when they're read.
+    struct TMEMRangeList {
+        static const uint32_t MaxCount = 8;
+        TMEMRange ranges[MaxCount];
+        uint32_t count = 0;
+
+        // Merges the range with any ranges it overlaps or is adjacent to.
+        void add(uint32_t address, uint32_t byteCount);
+
+        // Total amount of bytes covered by all ranges.
+        uint32_t byteCount() const;
+
+        // Copies the bytes of all ranges from TMEM into a contiguous buffer of byteCount() bytes.
+        void gather(const uint8_t *TMEM, uint8_t *dstBytes) const;
+
+        // Copies the contiguous bytes back into their addresses in TMEM. Bytes outside of the ranges are left untouched.
+        void scatter(const uint8_t *srcBytes, uint8_t *TMEM) const;
+    };
+
     enum class LoadTLUT {
         None,
         RGBA16,
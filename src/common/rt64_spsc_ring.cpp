@@ -0,0 +1,159 @@
+//
+// RT64
+//
+
+#include "rt64_spsc_ring.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace RT64 {
+    // LatencyHistogram
+
+    LatencyHistogram::LatencyHistogram() {
+        reset();
+    }
+
+    void LatencyHistogram::reset() {
+        for (std::atomic<uint64_t> &bucket : buckets) {
+            bucket = 0;
+        }
+
+        totalMicroseconds = 0;
+    }
+
+    void LatencyHistogram::record(uint64_t microseconds) {
+        uint32_t bucketIndex = 0;
+        while ((bucketIndex < (BucketCount - 1)) && (microseconds >= getBucketLimit(bucketIndex))) {
+            bucketIndex++;
+        }
+
+        buckets[bucketIndex]++;
+        totalMicroseconds += microseconds;
+    }
+
+    uint64_t LatencyHistogram::getCount() const {
+        uint64_t count = 0;
+        for (const std::atomic<uint64_t> &bucket : buckets) {
+            count += bucket;
+        }
+
+        return count;
+    }
+
+    uint64_t LatencyHistogram::getPercentileLimit(double percentile) const {
+        const uint64_t count = getCount();
+        const uint64_t targetCount = std::max(uint64_t(count * percentile), uint64_t(1));
+        uint64_t accumulatedCount = 0;
+        for (uint32_t i = 0; i < BucketCount; i++) {
+            accumulatedCount += buckets[i];
+            if (accumulatedCount >= targetCount) {
+                return getBucketLimit(i);
+            }
+        }
+
+        return getBucketLimit(BucketCount - 1);
+    }
+
+    uint64_t LatencyHistogram::getBucketLimit(uint32_t bucketIndex) {
+        assert(bucketIndex < BucketCount);
+
+        if (bucketIndex == (BucketCount - 1)) {
+            return UINT64_MAX;
+        }
+        else {
+            return uint64_t(1) << bucketIndex;
+        }
+    }
+
+    // AtomicWaiter
+
+    void AtomicWaiter::notify() {
+        if (sleeperCount == 0) {
+            return;
+        }
+
+        // The mutex must be acquired so the notification can't be missed by a thread that's about to sleep.
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+        }
+
+        sleepCondition.notify_all();
+    }
+
+    // SPSCRing
+
+    void SPSCRing::reset(uint32_t depth, uint32_t barrierCursor) {
+        assert(depth > 1);
+        assert(barrierCursor < depth);
+
+        this->depth = depth;
+        this->writeCursor = 0;
+        this->threadCursor = 0;
+        this->barrierCursor = barrierCursor;
+        producerHistogram.reset();
+        consumerHistogram.reset();
+    }
+
+    uint32_t SPSCRing::nextCursor(uint32_t cursor) const {
+        return (cursor + 1) % depth;
+    }
+
+    uint32_t SPSCRing::previousWriteCursor() const {
+        const uint32_t writeCursorValue = writeCursor;
+        if (writeCursorValue > 0) {
+            return writeCursorValue - 1;
+        }
+        else {
+            return depth - 1;
+        }
+    }
+
+    void SPSCRing::advanceWriteCursor() {
+        // Stall the producer until the barrier is lifted if it's trying to write on a slot the consumer is still using.
+        const uint32_t nextWriteCursor = nextCursor(writeCursor);
+        waiter.wait([&]() {
+            return (nextWriteCursor != barrierCursor);
+        }, &producerHistogram);
+
+        writeCursor = nextWriteCursor;
+        waiter.notify();
+    }
+
+    void SPSCRing::repeatLast() {
+        threadCursor = previousWriteCursor();
+        waiter.notify();
+    }
+
+    bool SPSCRing::claim(const std::atomic<bool> &running, uint32_t &cursor) {
+        waiter.wait([&]() {
+            return (writeCursor != threadCursor) || !running;
+        }, &consumerHistogram);
+
+        if (!running) {
+            return false;
+        }
+
+        // The producer can move the thread cursor back to repeat the last slot, so it's only advanced if it wasn't modified in the meantime.
+        uint32_t threadCursorValue = threadCursor;
+        while (!threadCursor.compare_exchange_weak(threadCursorValue, nextCursor(threadCursorValue))) {
+            continue;
+        }
+
+        cursor = threadCursorValue;
+        return true;
+    }
+
+    bool SPSCRing::hasPending() const {
+        return (writeCursor != threadCursor);
+    }
+
+    void SPSCRing::advanceBarrier() {
+        barrierCursor = nextCursor(barrierCursor);
+        waiter.notify();
+    }
+
+    void SPSCRing::notify() {
+        waiter.notify();
+    }
+};
@@ -0,0 +1,114 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "rt64_timer.h"
+
+namespace RT64 {
+    // Histogram of the time spent waiting. The first bucket holds the waits that didn't block, and every bucket after it doubles in size
+    // starting at one microsecond. The last bucket holds everything that didn't fit in the others.
+    struct LatencyHistogram {
+        static const uint32_t BucketCount = 16;
+
+        std::array<std::atomic<uint64_t>, BucketCount> buckets;
+        std::atomic<uint64_t> totalMicroseconds;
+
+        LatencyHistogram();
+        void reset();
+        void record(uint64_t microseconds);
+        uint64_t getCount() const;
+
+        // Upper limit in microseconds of the bucket that contains the percentile. Returns UINT64_MAX if it's the last bucket.
+        uint64_t getPercentileLimit(double percentile) const;
+        static uint64_t getBucketLimit(uint32_t bucketIndex);
+    };
+
+    // Lets a thread sleep until a condition on atomic variables becomes true. The condition is polled for a short while before sleeping,
+    // and notifying only involves the mutex when a thread is actually asleep, so the common case never enters the kernel.
+    struct AtomicWaiter {
+        static const uint32_t SpinCount = 64;
+
+        std::atomic<uint32_t> sleeperCount = 0;
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+
+        // The atomic variables the predicate reads must be modified before calling notify().
+        template<typename Predicate>
+        void wait(const Predicate &predicate, LatencyHistogram *histogram = nullptr) {
+            if (predicate()) {
+                if (histogram != nullptr) {
+                    histogram->record(0);
+                }
+
+                return;
+            }
+
+            const Timestamp startTimestamp = Timer::current();
+            bool satisfied = false;
+            for (uint32_t i = 0; (i < SpinCount) && !satisfied; i++) {
+                std::this_thread::yield();
+                satisfied = predicate();
+            }
+
+            if (!satisfied) {
+                sleeperCount++;
+
+                {
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    sleepCondition.wait(lock, predicate);
+                }
+
+                sleeperCount--;
+            }
+
+            if (histogram != nullptr) {
+                histogram->record(uint64_t(Timer::deltaMicroseconds(startTimestamp, Timer::current())));
+            }
+        }
+
+        void notify();
+    };
+
+    // Cursors of a ring of slots that are written by one thread and read by another one. The producer fills the slot at the write cursor
+    // and advances it once it's done. The consumer reads the slot at the thread cursor and advances the barrier cursor once it no longer
+    // uses it, which lets the producer write on it again. The slots themselves are stored by the owner of the ring.
+    struct SPSCRing {
+        uint32_t depth = 0;
+        std::atomic<uint32_t> writeCursor = 0;
+        std::atomic<uint32_t> threadCursor = 0;
+        std::atomic<uint32_t> barrierCursor = 0;
+        AtomicWaiter waiter;
+        LatencyHistogram producerHistogram;
+        LatencyHistogram consumerHistogram;
+
+        // Must not be called while either thread is using the ring.
+        void reset(uint32_t depth, uint32_t barrierCursor);
+        uint32_t nextCursor(uint32_t cursor) const;
+        uint32_t previousWriteCursor() const;
+
+        // Producer. Blocks until the consumer has released the next slot.
+        void advanceWriteCursor();
+
+        // Producer. Makes the consumer read the last written slot again.
+        void repeatLast();
+
+        // Consumer. Blocks until there's a slot to read or the running flag is cleared. Returns false if it was cleared.
+        bool claim(const std::atomic<bool> &running, uint32_t &cursor);
+
+        // Consumer.
+        bool hasPending() const;
+        void advanceBarrier();
+
+        // Wakes up both threads so they can check any external flags they're waiting on.
+        void notify();
+    };
+};
@@ -0,0 +1,380 @@
+//
+// RT64
+//
+
+#include "rt64_task_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace RT64 {
+    // Worker running on the current thread. Tasks submitted from inside other tasks are pushed to its own queues.
+    static thread_local TaskScheduler *currentScheduler = nullptr;
+    static thread_local TaskScheduler::Worker *currentWorker = nullptr;
+
+    // TaskScheduler
+
+    TaskScheduler::TaskScheduler(uint32_t threadCount) {
+        for (uint32_t i = 0; i < threadCount; i++) {
+            std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+            worker->index = i;
+            workers.emplace_back(std::move(worker));
+        }
+
+        // The threads are only started once all the workers exist, as they can start stealing from each other right away.
+        threadsRunning = true;
+        for (std::unique_ptr<Worker> &worker : workers) {
+            worker->thread = std::make_unique<std::thread>(&TaskScheduler::threadLoop, this, worker.get());
+        }
+    }
+
+    TaskScheduler::~TaskScheduler() {
+        {
+            std::unique_lock<std::mutex> lock(sharedMutex);
+            threadsRunning = false;
+        }
+
+        taskQueued.notify_all();
+
+        for (std::unique_ptr<Worker> &worker : workers) {
+            worker->thread->join();
+        }
+
+        // Cancel the tasks that were never taken so nothing is left waiting on them.
+        std::vector<std::shared_ptr<Task>> remainingTasks;
+        for (TaskQueue &queue : sharedQueues) {
+            remainingTasks.insert(remainingTasks.end(), queue.begin(), queue.end());
+        }
+
+        for (std::unique_ptr<Worker> &worker : workers) {
+            for (TaskQueue &queue : worker->queues) {
+                remainingTasks.insert(remainingTasks.end(), queue.begin(), queue.end());
+            }
+        }
+
+        for (const std::shared_ptr<Task> &task : remainingTasks) {
+            cancel(task);
+        }
+
+        workers.clear();
+    }
+
+    uint32_t TaskScheduler::getThreadCount() const {
+        return uint32_t(workers.size());
+    }
+
+    void TaskScheduler::setClassLimit(Thread::Priority priority, uint32_t limit) {
+        assert(limit > 0);
+
+        classes[uint32_t(priority)].limit = limit;
+
+        // Raising the limit can make queued tasks runnable.
+        {
+            std::unique_lock<std::mutex> lock(sharedMutex);
+        }
+
+        taskQueued.notify_all();
+    }
+
+    void TaskScheduler::getClassStats(Thread::Priority priority, ClassStats &stats) const {
+        const PriorityClass &priorityClass = classes[uint32_t(priority)];
+        stats.limit = priorityClass.limit;
+        stats.queuedCount = priorityClass.queuedCount;
+        stats.runningCount = priorityClass.runningCount;
+        stats.completedCount = priorityClass.completedCount;
+        stats.cpuTime = priorityClass.cpuTime;
+    }
+
+    std::shared_ptr<TaskScheduler::Task> TaskScheduler::submit(Thread::Priority priority, const Callback &callback, Group *group) {
+        assert(callback != nullptr);
+
+        std::shared_ptr<Task> task = std::make_shared<Task>();
+        task->callback = callback;
+        task->priority = priority;
+        task->group = group;
+
+        if (group != nullptr) {
+            std::unique_lock<std::mutex> lock(finishedMutex);
+            group->activeCount++;
+        }
+
+        const uint32_t classIndex = uint32_t(priority);
+        classes[classIndex].queuedCount++;
+
+        if (currentScheduler == this) {
+            std::unique_lock<std::mutex> queueLock(currentWorker->queueMutex);
+            currentWorker->queues[classIndex].emplace_back(task);
+        }
+        else {
+            std::unique_lock<std::mutex> lock(sharedMutex);
+            sharedQueues[classIndex].emplace_back(task);
+        }
+
+        // The mutex must be acquired so the notification can't be missed by a thread that's about to wait.
+        {
+            std::unique_lock<std::mutex> lock(sharedMutex);
+        }
+
+        taskQueued.notify_one();
+        return task;
+    }
+
+    bool TaskScheduler::cancel(const std::shared_ptr<Task> &task) {
+        assert(task != nullptr);
+
+        TaskState expectedState = TaskState::Queued;
+        if (!task->state.compare_exchange_strong(expectedState, TaskState::Canceled)) {
+            return false;
+        }
+
+        // The task is left in its queue and discarded when a thread reaches it.
+        classes[uint32_t(task->priority)].queuedCount--;
+        finishTask(task);
+        return true;
+    }
+
+    void TaskScheduler::cancel(Group &group) {
+        std::vector<std::shared_ptr<Task>> groupTasks;
+        auto gatherTasks = [&](const TaskQueue &queue) {
+            for (const std::shared_ptr<Task> &task : queue) {
+                if (task->group == &group) {
+                    groupTasks.emplace_back(task);
+                }
+            }
+        };
+
+        {
+            std::unique_lock<std::mutex> lock(sharedMutex);
+            for (const TaskQueue &queue : sharedQueues) {
+                gatherTasks(queue);
+            }
+        }
+
+        for (std::unique_ptr<Worker> &worker : workers) {
+            std::unique_lock<std::mutex> queueLock(worker->queueMutex);
+            for (const TaskQueue &queue : worker->queues) {
+                gatherTasks(queue);
+            }
+        }
+
+        for (const std::shared_ptr<Task> &task : groupTasks) {
+            cancel(task);
+        }
+    }
+
+    void TaskScheduler::wait(const std::shared_ptr<Task> &task) {
+        assert(task != nullptr);
+
+        if (claimTask(task)) {
+            PriorityClass &priorityClass = classes[uint32_t(task->priority)];
+            priorityClass.runningCount++;
+            runTask(task);
+            priorityClass.runningCount--;
+            notifyRunnable();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(finishedMutex);
+        taskFinished.wait(lock, [&]() {
+            const TaskState state = task->state;
+            return (state == TaskState::Finished) || (state == TaskState::Canceled);
+        });
+    }
+
+    void TaskScheduler::wait(Group &group) {
+        std::unique_lock<std::mutex> lock(finishedMutex);
+        taskFinished.wait(lock, [&]() {
+            return (group.activeCount == 0);
+        });
+    }
+
+    void TaskScheduler::parallelFor(Thread::Priority priority, size_t count, const std::function<void(size_t)> &function) {
+        if (count == 0) {
+            return;
+        }
+
+        std::atomic<size_t> nextIndex = 0;
+        auto work = [&]() {
+            size_t index = nextIndex++;
+            while (index < count) {
+                function(index);
+                index = nextIndex++;
+            }
+        };
+
+        std::vector<std::shared_ptr<Task>> helperTasks;
+        const size_t helperCount = std::min(count - 1, workers.size());
+        for (size_t i = 0; i < helperCount; i++) {
+            helperTasks.emplace_back(submit(priority, work));
+        }
+
+        work();
+
+        // Helpers that were never taken are canceled instead of waited on, as all the indices are already done.
+        for (const std::shared_ptr<Task> &helperTask : helperTasks) {
+            if (!cancel(helperTask)) {
+                wait(helperTask);
+            }
+        }
+    }
+
+    bool TaskScheduler::claimTask(const std::shared_ptr<Task> &task) {
+        TaskState expectedState = TaskState::Queued;
+        if (!task->state.compare_exchange_strong(expectedState, TaskState::Running)) {
+            return false;
+        }
+
+        classes[uint32_t(task->priority)].queuedCount--;
+        return true;
+    }
+
+    void TaskScheduler::runTask(const std::shared_ptr<Task> &task) {
+        const uint64_t startCPUTime = Thread::getCurrentThreadCPUTime();
+        task->callback();
+
+        PriorityClass &priorityClass = classes[uint32_t(task->priority)];
+        priorityClass.cpuTime += Thread::getCurrentThreadCPUTime() - startCPUTime;
+        priorityClass.completedCount++;
+        task->state = TaskState::Finished;
+        finishTask(task);
+    }
+
+    void TaskScheduler::finishTask(const std::shared_ptr<Task> &task) {
+        {
+            std::unique_lock<std::mutex> lock(finishedMutex);
+            if (task->group != nullptr) {
+                assert(task->group->activeCount > 0);
+                task->group->activeCount--;
+            }
+        }
+
+        taskFinished.notify_all();
+    }
+
+    bool TaskScheduler::popTask(TaskQueue &queue, bool fromBack, std::shared_ptr<Task> &task) {
+        // Tasks that were canceled or run by the thread that waited on them are discarded.
+        while (!queue.empty()) {
+            if (fromBack) {
+                task = std::move(queue.back());
+                queue.pop_back();
+            }
+            else {
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            if (claimTask(task)) {
+                return true;
+            }
+        }
+
+        task.reset();
+        return false;
+    }
+
+    bool TaskScheduler::takeTask(Worker *worker, std::shared_ptr<Task> &task) {
+        for (uint32_t i = 0; i < PriorityCount; i++) {
+            const uint32_t classIndex = PriorityCount - i - 1;
+            PriorityClass &priorityClass = classes[classIndex];
+            if (priorityClass.queuedCount == 0) {
+                continue;
+            }
+
+            // Reserve a slot in the class before looking for one of its tasks.
+            uint32_t runningCount = priorityClass.runningCount;
+            bool slotReserved = false;
+            while (runningCount < priorityClass.limit) {
+                if (priorityClass.runningCount.compare_exchange_weak(runningCount, runningCount + 1)) {
+                    slotReserved = true;
+                    break;
+                }
+            }
+
+            if (!slotReserved) {
+                continue;
+            }
+
+            // The newest task in the thread's own queue is taken first, while the oldest ones are taken from the shared queue and the other threads.
+            bool taskFound = false;
+            {
+                std::unique_lock<std::mutex> queueLock(worker->queueMutex);
+                taskFound = popTask(worker->queues[classIndex], true, task);
+            }
+
+            if (!taskFound) {
+                std::unique_lock<std::mutex> lock(sharedMutex);
+                taskFound = popTask(sharedQueues[classIndex], false, task);
+            }
+
+            for (size_t j = 1; !taskFound && (j < workers.size()); j++) {
+                Worker *victim = workers[(worker->index + j) % workers.size()].get();
+                std::unique_lock<std::mutex> queueLock(victim->queueMutex);
+                taskFound = popTask(victim->queues[classIndex], false, task);
+            }
+
+            if (taskFound) {
+                return true;
+            }
+
+            priorityClass.runningCount--;
+            notifyRunnable();
+        }
+
+        return false;
+    }
+
+    bool TaskScheduler::hasRunnableTasks() const {
+        for (const PriorityClass &priorityClass : classes) {
+            if ((priorityClass.queuedCount > 0) && (priorityClass.runningCount < priorityClass.limit)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void TaskScheduler::notifyRunnable() {
+        if (!hasRunnableTasks()) {
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(sharedMutex);
+        }
+
+        taskQueued.notify_one();
+    }
+
+    void TaskScheduler::threadLoop(Worker *worker) {
+        Thread::setCurrentThreadName("RT64 Task");
+
+        currentScheduler = this;
+        currentWorker = worker;
+
+        Thread::Priority threadPriority = Thread::Priority::Normal;
+        std::shared_ptr<Task> task;
+        while (threadsRunning) {
+            if (takeTask(worker, task)) {
+                // The thread takes the priority of the class of the task it's running.
+                if (task->priority != threadPriority) {
+                    Thread::setCurrentThreadPriority(task->priority);
+                    threadPriority = task->priority;
+                }
+
+                runTask(task);
+                classes[uint32_t(task->priority)].runningCount--;
+                task.reset();
+                notifyRunnable();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sharedMutex);
+            taskQueued.wait(lock, [this]() {
+                return !threadsRunning || hasRunnableTasks();
+            });
+        }
+
+        currentScheduler = nullptr;
+        currentWorker = nullptr;
+    }
+};
@@ -0,0 +1,120 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rt64_thread.h"
+
+namespace RT64 {
+    // Pool of threads shared by all the background work of the application. Tasks are sorted into classes that match the thread priorities,
+    // and the amount of tasks of each class that can run at the same time can be limited. Every thread has its own queues: tasks submitted
+    // from inside another task are pushed to the queues of the thread running it, and threads that run out of tasks steal from the others.
+    struct TaskScheduler {
+        typedef std::function<void()> Callback;
+
+        static const uint32_t PriorityCount = uint32_t(Thread::Priority::Highest) + 1;
+        static const uint32_t NoLimit = UINT32_MAX;
+
+        enum class TaskState {
+            Queued,
+            Running,
+            Finished,
+            Canceled
+        };
+
+        // Keeps track of a set of tasks so they can be waited on or canceled together. Must outlive all the tasks submitted with it.
+        struct Group {
+            uint32_t activeCount = 0;
+        };
+
+        struct Task {
+            Callback callback;
+            Thread::Priority priority = Thread::Priority::Normal;
+            Group *group = nullptr;
+            std::atomic<TaskState> state = TaskState::Queued;
+        };
+
+        typedef std::deque<std::shared_ptr<Task>> TaskQueue;
+
+        struct Worker {
+            std::array<TaskQueue, PriorityCount> queues;
+            std::mutex queueMutex;
+            std::unique_ptr<std::thread> thread;
+            uint32_t index = 0;
+        };
+
+        struct PriorityClass {
+            std::atomic<uint32_t> limit = NoLimit;
+            std::atomic<uint32_t> queuedCount = 0;
+            std::atomic<uint32_t> runningCount = 0;
+            std::atomic<uint64_t> completedCount = 0;
+            std::atomic<uint64_t> cpuTime = 0;
+        };
+
+        struct ClassStats {
+            uint32_t limit = 0;
+            uint32_t queuedCount = 0;
+            uint32_t runningCount = 0;
+            uint64_t completedCount = 0;
+
+            // Accumulated time the tasks of the class have spent running on the CPU, in microseconds.
+            uint64_t cpuTime = 0;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::array<TaskQueue, PriorityCount> sharedQueues;
+        std::array<PriorityClass, PriorityCount> classes;
+        std::mutex sharedMutex;
+        std::condition_variable taskQueued;
+        std::mutex finishedMutex;
+        std::condition_variable taskFinished;
+        std::atomic<bool> threadsRunning = false;
+
+        TaskScheduler(uint32_t threadCount);
+        ~TaskScheduler();
+        uint32_t getThreadCount() const;
+
+        // Limits the amount of tasks of a class that can be run by the threads of the scheduler at the same time.
+        void setClassLimit(Thread::Priority priority, uint32_t limit);
+        void getClassStats(Thread::Priority priority, ClassStats &stats) const;
+
+        std::shared_ptr<Task> submit(Thread::Priority priority, const Callback &callback, Group *group = nullptr);
+
+        // Returns false if the task was already taken by a thread.
+        bool cancel(const std::shared_ptr<Task> &task);
+
+        // Cancels all the tasks of the group that haven't been taken by a thread yet.
+        void cancel(Group &group);
+
+        // Runs the task on the calling thread if no thread has taken it yet. Otherwise, waits for it to finish.
+        void wait(const std::shared_ptr<Task> &task);
+
+        // Waits for all the tasks of the group to finish or be canceled.
+        void wait(Group &group);
+
+        // Calls the function for every index from 0 to count. The calling thread works on the indices as well and only waits on the
+        // threads that helped, so it's safe to use from inside a task even if no other threads are available.
+        void parallelFor(Thread::Priority priority, size_t count, const std::function<void(size_t)> &function);
+
+        bool claimTask(const std::shared_ptr<Task> &task);
+        void runTask(const std::shared_ptr<Task> &task);
+        void finishTask(const std::shared_ptr<Task> &task);
+        bool popTask(TaskQueue &queue, bool fromBack, std::shared_ptr<Task> &task);
+        bool takeTask(Worker *worker, std::shared_ptr<Task> &task);
+        bool hasRunnableTasks() const;
+        void notifyRunnable();
+        void threadLoop(Worker *worker);
+    };
+};
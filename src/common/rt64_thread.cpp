@@ -12,6 +12,9 @@
 #   include "utf8conv/utf8conv.h"
 #elif defined(__linux__)
 #   include <pthread.h>
+#   include <time.h>
+#elif defined(__APPLE__)
+#   include <time.h>
 #endif
 
 namespace RT64 {
@@ -73,6 +76,29 @@ namespace RT64 {
         Sleep(millis);
 #   else
         std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+#   endif
+    }
+
+    uint64_t Thread::getCurrentThreadCPUTime() {
+#   if defined(_WIN32)
+        // Thread times are reported in 100 nanosecond intervals.
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+            return 0;
+        }
+
+        const uint64_t kernelTicks = (uint64_t(kernelTime.dwHighDateTime) << 32U) | kernelTime.dwLowDateTime;
+        const uint64_t userTicks = (uint64_t(userTime.dwHighDateTime) << 32U) | userTime.dwLowDateTime;
+        return (kernelTicks + userTicks) / 10;
+#   elif defined(__linux__) || defined(__APPLE__)
+        timespec threadTime;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &threadTime) != 0) {
+            return 0;
+        }
+
+        return uint64_t(threadTime.tv_sec) * 1000000ULL + uint64_t(threadTime.tv_nsec) / 1000ULL;
+#   else
+        static_assert(false, "Unimplemented");
 #   endif
     }
 };
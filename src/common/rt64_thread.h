@@ -21,5 +21,8 @@ namespace RT64 {
         static void setCurrentThreadName(const std::string &str);
         static void setCurrentThreadPriority(Priority priority);
         static void sleepMilliseconds(uint32_t millis);
+
+        // Time the current thread has spent running on the CPU, in microseconds.
+        static uint64_t getCurrentThreadCPUTime();
     };
 };
\ No newline at end of file
@@ -4,6 +4,20 @@
 
 #pragma once
 
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define RT64_TMEM_HASHER_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   include <emmintrin.h>
+#   define RT64_TMEM_HASHER_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   include <arm_neon.h>
+#   define RT64_TMEM_HASHER_NEON 1
+#endif
+
 // Referenced from zstd.
 
 static unsigned bitScanForward64(uint64_t val) {
@@ -45,12 +59,203 @@ namespace RT64 {
             return tmemBytesPerRow > drawBytesPerRow;
         }
 
+        // Computes the ranges of TMEM the texture can read from when it's decoded or hashed with any of the hash versions.
+        static void sampledRanges(const LoadTile &loadTile, uint16_t width, uint16_t height, uint32_t tlut, TMEMRangeList &rangeList) {
+            const uint32_t TMEMBytes = 4096;
+            const uint32_t TMEMHalfBytes = TMEMBytes >> 1;
+            const bool RGBA32 = (loadTile.siz == G_IM_SIZ_32b) && (loadTile.fmt == G_IM_FMT_RGBA);
+            const bool usesTLUT = tlut > 0;
+            const uint32_t drawBytesPerRow = std::max(uint32_t(width) << (RGBA32 ? G_IM_SIZ_16b : loadTile.siz) >> 1U, 1U);
+            const uint32_t drawBytesTotal = (loadTile.line << 3) * (std::max(height, uint16_t(1)) - 1) + drawBytesPerRow;
+            const uint32_t tmemAddress = (loadTile.tmem << 3) & (TMEMBytes - 1);
+
+            // Rows always start on a word boundary, so rounding up the size to whole words also covers the word swapping done on odd rows.
+            const uint32_t windowBytes = (drawBytesTotal + 7) & ~7U;
+            auto addWindow = [&](uint32_t regionAddress, uint32_t regionBytes, uint32_t baseAddress) {
+                baseAddress &= (regionBytes - 1);
+                if (windowBytes >= regionBytes) {
+                    rangeList.add(regionAddress, regionBytes);
+                }
+                else if ((baseAddress + windowBytes) > regionBytes) {
+                    rangeList.add(regionAddress + baseAddress, regionBytes - baseAddress);
+                    rangeList.add(regionAddress, baseAddress + windowBytes - regionBytes);
+                }
+                else {
+                    rangeList.add(regionAddress + baseAddress, windowBytes);
+                }
+            };
+
+            rangeList.count = 0;
+            if (RGBA32) {
+                // Both halves of TMEM are read at the same relative address.
+                addWindow(0, TMEMHalfBytes, tmemAddress);
+                addWindow(TMEMHalfBytes, TMEMHalfBytes, tmemAddress);
+            }
+            else if (usesTLUT) {
+                // Versions before 3 did not mask the address to the lower half of TMEM when using TLUT.
+                addWindow(0, TMEMHalfBytes, tmemAddress);
+                addWindow(0, TMEMBytes, tmemAddress);
+            }
+            else {
+                addWindow(0, TMEMBytes, tmemAddress);
+            }
+
+            if (usesTLUT) {
+                const bool CI4 = (loadTile.siz == G_IM_SIZ_4b);
+                if (CI4) {
+                    rangeList.add(TMEMHalfBytes + (loadTile.palette << 7), 0x80);
+                }
+                else {
+                    rangeList.add(TMEMHalfBytes, TMEMHalfBytes);
+                }
+            }
+        }
+
+        // Marks every byte of a block. The size of the block must be a multiple of 4.
+        static void markBytesPresentBlock(const uint8_t *bytes, uint32_t blockBytes, uint8_t *bytesPresent) {
+            for (uint32_t i = 0; i < blockBytes; i += 4) {
+                bytesPresent[bytes[i + 0]] = 1;
+                bytesPresent[bytes[i + 1]] = 1;
+                bytesPresent[bytes[i + 2]] = 1;
+                bytesPresent[bytes[i + 3]] = 1;
+            }
+        }
+
+        // Marks every byte value that is present. Storing to a table avoids the dependency chain on the bitset when parsing every byte. Blocks that
+        // repeat the last marked block are skipped with a single comparison, as indexed textures often have solid areas and repeated rows.
+        static void markBytesPresent(const uint8_t *bytes, uint32_t byteCount, uint8_t *bytesPresent) {
+            uint32_t i = 0;
+#       if defined(RT64_TMEM_HASHER_AVX2)
+            if (byteCount >= 32) {
+                __m256i previousBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes));
+                markBytesPresentBlock(bytes, 32, bytesPresent);
+                for (i = 32; (i + 32) <= byteCount; i += 32) {
+                    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bytes[i]));
+                    if (uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, previousBlock))) != UINT32_MAX) {
+                        markBytesPresentBlock(&bytes[i], 32, bytesPresent);
+                        previousBlock = block;
+                    }
+                }
+            }
+#       elif defined(RT64_TMEM_HASHER_SSE2)
+            if (byteCount >= 16) {
+                __m128i previousBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+                markBytesPresentBlock(bytes, 16, bytesPresent);
+                for (i = 16; (i + 16) <= byteCount; i += 16) {
+                    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bytes[i]));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, previousBlock)) != 0xFFFF) {
+                        markBytesPresentBlock(&bytes[i], 16, bytesPresent);
+                        previousBlock = block;
+                    }
+                }
+            }
+#       elif defined(RT64_TMEM_HASHER_NEON)
+            if (byteCount >= 16) {
+                uint8x16_t previousBlock = vld1q_u8(bytes);
+                markBytesPresentBlock(bytes, 16, bytesPresent);
+                for (i = 16; (i + 16) <= byteCount; i += 16) {
+                    const uint8x16_t block = vld1q_u8(&bytes[i]);
+                    if (vminvq_u8(vceqq_u8(block, previousBlock)) == 0) {
+                        markBytesPresentBlock(&bytes[i], 16, bytesPresent);
+                        previousBlock = block;
+                    }
+                }
+            }
+#       endif
+
+            for (; (i + 4) <= byteCount; i += 4) {
+                bytesPresent[bytes[i + 0]] = 1;
+                bytesPresent[bytes[i + 1]] = 1;
+                bytesPresent[bytes[i + 2]] = 1;
+                bytesPresent[bytes[i + 3]] = 1;
+            }
+
+            for (; i < byteCount; i++) {
+                bytesPresent[bytes[i]] = 1;
+            }
+        }
+
+        // Converts the table of present byte values into a 256-bit set.
+        static void buildByteBitset(const uint8_t *bytesPresent, uint64_t *byteBitset) {
+#       if defined(RT64_TMEM_HASHER_AVX2)
+            const __m256i zero = _mm256_setzero_si256();
+            for (uint32_t i = 0; i < 4; i++) {
+                const __m256i lowValues = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bytesPresent[i * 64]));
+                const __m256i highValues = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bytesPresent[i * 64 + 32]));
+                const uint32_t lowMask = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lowValues, zero)));
+                const uint32_t highMask = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(highValues, zero)));
+                byteBitset[i] = uint64_t(lowMask) | (uint64_t(highMask) << 32);
+            }
+#       elif defined(RT64_TMEM_HASHER_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (uint32_t i = 0; i < 4; i++) {
+                uint64_t bits = 0;
+                for (uint32_t j = 0; j < 4; j++) {
+                    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bytesPresent[i * 64 + j * 16]));
+                    const uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(values, zero))) ^ 0xFFFFU;
+                    bits |= uint64_t(mask) << (j * 16);
+                }
+
+                byteBitset[i] = bits;
+            }
+#       elif defined(RT64_TMEM_HASHER_NEON)
+            // NEON has no movemask, so every present byte is replaced by its bit weight and the weights of each half are added together.
+            static const uint8_t BitWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+            const uint8x16_t weights = vld1q_u8(BitWeights);
+            for (uint32_t i = 0; i < 4; i++) {
+                uint64_t bits = 0;
+                for (uint32_t j = 0; j < 4; j++) {
+                    const uint8x16_t values = vld1q_u8(&bytesPresent[i * 64 + j * 16]);
+                    const uint8x16_t weighted = vandq_u8(vtstq_u8(values, values), weights);
+                    const uint32_t mask = uint32_t(vaddv_u8(vget_low_u8(weighted))) | (uint32_t(vaddv_u8(vget_high_u8(weighted))) << 8);
+                    bits |= uint64_t(mask) << (j * 16);
+                }
+
+                byteBitset[i] = bits;
+            }
+#       else
+            for (uint32_t i = 0; i < 4; i++) {
+                uint64_t bits = 0;
+                for (uint32_t j = 0; j < 64; j++) {
+                    bits |= uint64_t(bytesPresent[i * 64 + j] != 0) << j;
+                }
+
+                byteBitset[i] = bits;
+            }
+#       endif
+        }
+
+        // Converts a 256-bit set of byte values into the set of 4-bit indices used by either of the nibbles of those bytes.
+        static uint64_t buildNibbleBitset(const uint64_t *byteBitset) {
+            uint64_t nibbleBitset = 0;
+            for (uint32_t i = 0; i < 4; i++) {
+                for (uint32_t j = 0; j < 4; j++) {
+                    // Every group of 16 bits corresponds to all the bytes with the same upper nibble.
+                    const uint64_t lowNibbles = (byteBitset[i] >> (j * 16)) & 0xFFFFULL;
+                    if (lowNibbles != 0) {
+                        nibbleBitset |= lowNibbles;
+                        nibbleBitset |= (1ULL << (i * 4 + j));
+                    }
+                }
+            }
+
+            return nibbleBitset;
+        }
+
         static uint64_t hash(const uint8_t *TMEM, const LoadTile &loadTile, uint16_t width, uint16_t height, uint32_t tlut, uint32_t version) {
             const uint32_t TMEMBytes = 4096;
             const uint32_t TMEMMask8 = 4095;
             const uint32_t TMEMMask16 = 2047;
-            XXH3_state_t xxh3;
-            XXH3_64bits_reset(&xxh3);
+
+            // All the bytes are gathered into a contiguous buffer and hashed at the end with a single call. This is guaranteed to produce the same
+            // result as updating the hash state with each individual range.
+            thread_local std::vector<uint8_t> hashBytes;
+            hashBytes.clear();
+
+            auto appendBytes = [&](const void *bytes, size_t byteCount) {
+                const uint8_t *bytesU8 = reinterpret_cast<const uint8_t *>(bytes);
+                hashBytes.insert(hashBytes.end(), bytesU8, bytesU8 + byteCount);
+            };
             const bool RGBA32 = (loadTile.siz == G_IM_SIZ_32b) && (loadTile.fmt == G_IM_FMT_RGBA);
             const bool usesTLUT = tlut > 0;
             bool halfTMEM = RGBA32;
@@ -65,23 +270,18 @@ namespace RT64 {
             const uint32_t drawBytesTotal = (loadTile.line << 3) * (height - 1) + drawBytesPerRow;
             const uint32_t tmemMask = halfTMEM ? TMEMMask16 : TMEMMask8;
             const uint32_t tmemAddress = (loadTile.tmem << 3) & tmemMask;
-            uint64_t tlutBitset[4] = {};
+            const bool parseTLUTIndices = (version >= 5) && usesTLUT;
+            uint8_t bytesPresent[256];
+            if (parseTLUTIndices) {
+                memset(bytesPresent, 0, sizeof(bytesPresent));
+            }
+
             auto hashUpdate = [&](const uint8_t *tmemBytes, uint32_t byteCount) {
-                XXH3_64bits_update(&xxh3, tmemBytes, byteCount);
+                appendBytes(tmemBytes, byteCount);
 
                 // Version 5 parses every byte individually if TLUT is enabled to determine the TLUT bytes that can be hashed.
-                if ((version >= 5) && usesTLUT) {
-                    if (loadTile.siz == G_IM_SIZ_4b) {
-                        for (uint32_t i = 0; i < byteCount; i++) {
-                            tlutBitset[0] |= (1ULL << (tmemBytes[i] & 0xFU));
-                            tlutBitset[0] |= (1ULL << ((tmemBytes[i] >> 4U) & 0xFU));
-                        }
-                    }
-                    else {
-                        for (uint32_t i = 0; i < byteCount; i++) {
-                            tlutBitset[tmemBytes[i] >> 6U] |= (1ULL << (tmemBytes[i] & 0x3FU));
-                        }
-                    }
+                if (parseTLUTIndices) {
+                    markBytesPresent(tmemBytes, byteCount, bytesPresent);
                 }
             };
 
@@ -149,9 +349,16 @@ namespace RT64 {
 
                 // Version 5 stores a bitset of all the indices that should be hashed.
                 if (version >= 5) {
+                    uint64_t tlutBitset[4] = {};
+                    buildByteBitset(bytesPresent, tlutBitset);
+                    if (CI4) {
+                        tlutBitset[0] = buildNibbleBitset(tlutBitset);
+                        tlutBitset[1] = tlutBitset[2] = tlutBitset[3] = 0;
+                    }
+
                     // Fast path for a full bitset for CI4.
                     if (CI4 && (tlutBitset[0] == UINT16_MAX)) {
-                        XXH3_64bits_update(&xxh3, &TMEM[paletteAddress], 0x80);
+                        appendBytes(&TMEM[paletteAddress], 0x80);
                     }
                     else {
                         const uint32_t bitsetCount = CI4 ? 1 : 4;
@@ -160,14 +367,14 @@ namespace RT64 {
                         for (uint32_t i = 0; i < bitsetCount; i++) {
                             // Fast path for a full bitset.
                             if (tlutBitset[i] == UINT64_MAX) {
-                                XXH3_64bits_update(&xxh3, &TMEM[paletteAddress + i * 0x200], 0x200);
+                                appendBytes(&TMEM[paletteAddress + i * 0x200], 0x200);
                             }
                             else {
                                 // Must check every bit individually.
                                 while (tlutBitset[i] > 0) {
                                     bitsetIndex = bitScanForward64(tlutBitset[i]);
                                     paletteIndex = (i * 0x40) + bitsetIndex;
-                                    XXH3_64bits_update(&xxh3, &TMEM[paletteAddress + paletteIndex * 8], 8);
+                                    appendBytes(&TMEM[paletteAddress + paletteIndex * 8], 8);
                                     tlutBitset[i] &= ~(1ULL << bitsetIndex);
                                 }
                             }
@@ -176,7 +383,7 @@ namespace RT64 {
                 }
                 else {
                     const int32_t bytesToHash = CI4 ? 0x80 : 0x800;
-                    XXH3_64bits_update(&xxh3, &TMEM[paletteAddress], bytesToHash);
+                    appendBytes(&TMEM[paletteAddress], bytesToHash);
                 }
             }
             
@@ -187,14 +394,14 @@ namespace RT64 {
             static_assert(sizeof(loadTile.line) == 2, "Hash must use 16-bit line.");
             static_assert(sizeof(loadTile.siz) == 1, "Hash must use 8-bit siz.");
             static_assert(sizeof(loadTile.fmt) == 1, "Hash must use 8-bit fmt.");
-            XXH3_64bits_update(&xxh3, &width, sizeof(width));
-            XXH3_64bits_update(&xxh3, &height, sizeof(height));
-            XXH3_64bits_update(&xxh3, &tlut, sizeof(tlut));
-            XXH3_64bits_update(&xxh3, &loadTile.line, sizeof(loadTile.line));
-            XXH3_64bits_update(&xxh3, &loadTile.siz, sizeof(loadTile.siz));
-            XXH3_64bits_update(&xxh3, &loadTile.fmt, sizeof(loadTile.fmt));
-
-            return XXH3_64bits_digest(&xxh3);
+            appendBytes(&width, sizeof(width));
+            appendBytes(&height, sizeof(height));
+            appendBytes(&tlut, sizeof(tlut));
+            appendBytes(&loadTile.line, sizeof(loadTile.line));
+            appendBytes(&loadTile.siz, sizeof(loadTile.siz));
+            appendBytes(&loadTile.fmt, sizeof(loadTile.fmt));
+
+            return XXH3_64bits(hashBytes.data(), hashBytes.size());
         }
 
         static bool requiresRawTMEM(const LoadTile &loadTile, uint16_t width, uint16_t height) {
@@ -28,6 +28,10 @@ namespace RT64 {
         j["internalColorFormat"] = cfg.internalColorFormat;
         j["hardwareResolve"] = cfg.hardwareResolve;
         j["idleWorkActive"] = cfg.idleWorkActive;
+        j["geometryCache"] = cfg.geometryCache;
+        j["queueDepth"] = cfg.queueDepth;
+        j["textureStreamBatchCount"] = cfg.textureStreamBatchCount;
+        j["textureStreamBatchMegabytes"] = cfg.textureStreamBatchMegabytes;
         j["developerMode"] = cfg.developerMode;
     }
 
@@ -51,6 +55,10 @@ namespace RT64 {
         cfg.internalColorFormat = j.value("internalColorFormat", defaultCfg.internalColorFormat);
         cfg.hardwareResolve = j.value("hardwareResolve", defaultCfg.hardwareResolve);
         cfg.idleWorkActive = j.value("idleWorkActive", defaultCfg.idleWorkActive);
+        cfg.geometryCache = j.value("geometryCache", defaultCfg.geometryCache);
+        cfg.queueDepth = j.value("queueDepth", defaultCfg.queueDepth);
+        cfg.textureStreamBatchCount = j.value("textureStreamBatchCount", defaultCfg.textureStreamBatchCount);
+        cfg.textureStreamBatchMegabytes = j.value("textureStreamBatchMegabytes", defaultCfg.textureStreamBatchMegabytes);
         cfg.developerMode = j.value("developerMode", defaultCfg.developerMode);
     }
 
@@ -62,6 +70,12 @@ namespace RT64 {
     // Configuration
     
     const int UserConfiguration::ResolutionMultiplierLimit = 32;
+    const int UserConfiguration::QueueDepthMinimum = 3;
+    const int UserConfiguration::QueueDepthMaximum = 8;
+    const int UserConfiguration::TextureStreamBatchCountMinimum = 1;
+    const int UserConfiguration::TextureStreamBatchCountMaximum = 256;
+    const int UserConfiguration::TextureStreamBatchMegabytesMinimum = 4;
+    const int UserConfiguration::TextureStreamBatchMegabytesMaximum = 1024;
 
     UserConfiguration::UserConfiguration() {
         graphicsAPI = GraphicsAPI::Automatic;
@@ -82,6 +96,10 @@ namespace RT64 {
         internalColorFormat = InternalColorFormat::Automatic;
         hardwareResolve = HardwareResolve::Automatic;
         idleWorkActive = true;
+        geometryCache = false;
+        queueDepth = 4;
+        textureStreamBatchCount = 16;
+        textureStreamBatchMegabytes = 64;
         developerMode = false;
     }
 
@@ -102,6 +120,9 @@ namespace RT64 {
         aspectTarget = std::clamp<double>(aspectTarget, 0.1f, 100.0f);
         extAspectTarget = std::clamp<double>(extAspectTarget, 0.1f, 100.0f);
         refreshRateTarget = std::clamp<int>(refreshRateTarget, 10, 1000);
+        queueDepth = std::clamp<int>(queueDepth, QueueDepthMinimum, QueueDepthMaximum);
+        textureStreamBatchCount = std::clamp<int>(textureStreamBatchCount, TextureStreamBatchCountMinimum, TextureStreamBatchCountMaximum);
+        textureStreamBatchMegabytes = std::clamp<int>(textureStreamBatchMegabytes, TextureStreamBatchMegabytesMinimum, TextureStreamBatchMegabytesMaximum);
 
         if (!isGraphicsAPISupported(graphicsAPI)) {
             graphicsAPI = GraphicsAPI::Automatic;
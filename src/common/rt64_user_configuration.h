@@ -11,11 +11,18 @@ using json = nlohmann::json;
 namespace RT64 {
     struct UserConfiguration {
         static const int ResolutionMultiplierLimit;
+        static const int QueueDepthMinimum;
+        static const int QueueDepthMaximum;
+        static const int TextureStreamBatchCountMinimum;
+        static const int TextureStreamBatchCountMaximum;
+        static const int TextureStreamBatchMegabytesMinimum;
+        static const int TextureStreamBatchMegabytesMaximum;
 
         enum class GraphicsAPI {
             D3D12,
             Vulkan,
             Metal,
+            Null,
             Automatic,
             OptionCount
         };
@@ -101,6 +108,10 @@ namespace RT64 {
         InternalColorFormat internalColorFormat;
         HardwareResolve hardwareResolve;
         bool idleWorkActive;
+        bool geometryCache;
+        int queueDepth;
+        int textureStreamBatchCount;
+        int textureStreamBatchMegabytes;
         bool developerMode;
 
         UserConfiguration();
@@ -118,6 +129,7 @@ namespace RT64 {
         { UserConfiguration::GraphicsAPI::D3D12, "D3D12" },
         { UserConfiguration::GraphicsAPI::Vulkan, "Vulkan" },
         { UserConfiguration::GraphicsAPI::Metal, "Metal" },
+        { UserConfiguration::GraphicsAPI::Null, "Null" },
         { UserConfiguration::GraphicsAPI::Automatic, "Automatic" },
     });
 
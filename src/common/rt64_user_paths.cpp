@@ -20,6 +20,8 @@ namespace RT64 {
     const std::filesystem::path ConfigurationFile = "rt64.json";
     const std::filesystem::path ImGuiFile = "rt64-imgui.ini";
     const std::filesystem::path LogFile = "rt64.log";
+    const std::filesystem::path ShaderCacheFile = "rt64-shader-cache.bin";
+    const std::filesystem::path PipelineCacheFile = "rt64-pipeline-cache.bin";
 
     std::filesystem::path UserPaths::detectDataPath(const std::filesystem::path &appId) {
         std::filesystem::path resultPath;
@@ -67,6 +69,8 @@ namespace RT64 {
             configurationPath = dataPath / ConfigurationFile;
             imguiPath = dataPath / ImGuiFile;
             logPath = dataPath / LogFile;
+            shaderCachePath = dataPath / ShaderCacheFile;
+            pipelineCachePath = dataPath / PipelineCacheFile;
         }
     }
 
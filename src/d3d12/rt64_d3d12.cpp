@@ -19,6 +19,7 @@
 #endif
 
 #include "utf8conv/utf8conv.h"
+#include "xxHash/xxh3.h"
 
 #ifndef NDEBUG
 #   define D3D12_DEBUG_LAYER_ENABLED
@@ -563,6 +564,10 @@ namespace RT64 {
                     return D3D12_RESOURCE_STATE_INDEX_BUFFER;
                 }
 
+                if (bufferFlags & RenderBufferFlag::INDIRECT) {
+                    return D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                }
+
                 return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
             }
         }
@@ -1433,6 +1438,7 @@ namespace RT64 {
         assert(queue->device != nullptr);
 
         this->device = queue->device;
+        this->queue = queue;
         this->type = type;
 
         D3D12_COMMAND_LIST_TYPE commandListType;
@@ -1618,6 +1624,30 @@ namespace RT64 {
         d3d->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
     }
 
+    void D3D12CommandList::drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        assert(argumentBuffer.ref != nullptr);
+        assert(device->drawCommandSignature != nullptr);
+
+        checkTopology();
+        checkFramebufferSamplePositions();
+
+        const D3D12Buffer *interfaceArgumentBuffer = static_cast<const D3D12Buffer *>(argumentBuffer.ref);
+        const D3D12Buffer *interfaceCountBuffer = static_cast<const D3D12Buffer *>(countBuffer.ref);
+        d3d->ExecuteIndirect(device->drawCommandSignature, maxDrawCount, interfaceArgumentBuffer->d3d, argumentBuffer.offset, (interfaceCountBuffer != nullptr) ? interfaceCountBuffer->d3d : nullptr, countBuffer.offset);
+    }
+
+    void D3D12CommandList::drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        assert(argumentBuffer.ref != nullptr);
+        assert(device->drawIndexedCommandSignature != nullptr);
+
+        checkTopology();
+        checkFramebufferSamplePositions();
+
+        const D3D12Buffer *interfaceArgumentBuffer = static_cast<const D3D12Buffer *>(argumentBuffer.ref);
+        const D3D12Buffer *interfaceCountBuffer = static_cast<const D3D12Buffer *>(countBuffer.ref);
+        d3d->ExecuteIndirect(device->drawIndexedCommandSignature, maxDrawCount, interfaceArgumentBuffer->d3d, argumentBuffer.offset, (interfaceCountBuffer != nullptr) ? interfaceCountBuffer->d3d : nullptr, countBuffer.offset);
+    }
+
     void D3D12CommandList::setPipeline(const RenderPipeline *pipeline) {
         assert(pipeline != nullptr);
 
@@ -1785,14 +1815,19 @@ namespace RT64 {
     void D3D12CommandList::setFramebuffer(const RenderFramebuffer *framebuffer) {
         if (framebuffer != nullptr) {
             const D3D12Framebuffer *interfaceFramebuffer = static_cast<const D3D12Framebuffer *>(framebuffer);
-            for (const D3D12Texture *target : interfaceFramebuffer->colorTargets) {
-                assert((target->layout == RenderTextureLayout::COLOR_WRITE) && "Color targets must be in color write layout when setting the framebuffer.");
-            }
-            
-            if (interfaceFramebuffer->depthTarget != nullptr) {
-                const bool depthReadLayout = (interfaceFramebuffer->depthTarget->layout == RenderTextureLayout::DEPTH_READ);
-                const bool depthWriteLayout = (interfaceFramebuffer->depthTarget->layout == RenderTextureLayout::DEPTH_WRITE);
-                assert((depthReadLayout || depthWriteLayout) && "Depth target must be in depth read or write layout when setting the framebuffer.");
+
+            // The layout tracked by the textures only corresponds to the last barrier that was recorded, so it can only be validated if the
+            // lists are recorded in the same order they're submitted in.
+            if (!outOfOrderRecording) {
+                for (const D3D12Texture *target : interfaceFramebuffer->colorTargets) {
+                    assert((target->layout == RenderTextureLayout::COLOR_WRITE) && "Color targets must be in color write layout when setting the framebuffer.");
+                }
+
+                if (interfaceFramebuffer->depthTarget != nullptr) {
+                    const bool depthReadLayout = (interfaceFramebuffer->depthTarget->layout == RenderTextureLayout::DEPTH_READ);
+                    const bool depthWriteLayout = (interfaceFramebuffer->depthTarget->layout == RenderTextureLayout::DEPTH_WRITE);
+                    assert((depthReadLayout || depthWriteLayout) && "Depth target must be in depth read or write layout when setting the framebuffer.");
+                }
             }
 
             const D3D12_CPU_DESCRIPTOR_HANDLE *colorDescriptors = !interfaceFramebuffer->colorHandles.empty() ? interfaceFramebuffer->colorHandles.data() : nullptr;
@@ -1970,6 +2005,38 @@ namespace RT64 {
         d3d->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
     }
 
+    void D3D12CommandList::resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        // Query heaps don't need to be reset before they're written to.
+    }
+
+    void D3D12CommandList::writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) {
+        assert(queryPool != nullptr);
+
+        D3D12QueryPool *interfaceQueryPool = static_cast<D3D12QueryPool *>(queryPool);
+        d3d->EndQuery(interfaceQueryPool->d3d, D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+    }
+
+    void D3D12CommandList::resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        assert(queryPool != nullptr);
+        assert(queue != nullptr);
+
+        D3D12QueryPool *interfaceQueryPool = static_cast<D3D12QueryPool *>(queryPool);
+        const D3D12Buffer *interfaceReadbackBuffer = static_cast<const D3D12Buffer *>(interfaceQueryPool->readbackBuffer.get());
+        d3d->ResolveQueryData(interfaceQueryPool->d3d, D3D12_QUERY_TYPE_TIMESTAMP, queryFirstIndex, queryCount, interfaceReadbackBuffer->d3d, queryFirstIndex * sizeof(uint64_t));
+
+        // The timestamp frequency depends on the queue the queries were written on.
+        if (interfaceQueryPool->timestampFrequency == 0) {
+            HRESULT res = queue->d3d->GetTimestampFrequency(&interfaceQueryPool->timestampFrequency);
+            if (FAILED(res)) {
+                fprintf(stderr, "GetTimestampFrequency failed with error code 0x%lX.\n", res);
+            }
+        }
+    }
+
+    void D3D12CommandList::setOutOfOrderRecording(bool enabled) {
+        outOfOrderRecording = enabled;
+    }
+
     void D3D12CommandList::checkDescriptorHeaps() {
         if (!descriptorHeapsSet) {
             ID3D12DescriptorHeap *descriptorHeaps[] = { device->viewHeapAllocator->shaderHeap, device->samplerHeapAllocator->shaderHeap };
@@ -2073,6 +2140,65 @@ namespace RT64 {
         }
     }
 
+    // D3D12QueryPool
+
+    D3D12QueryPool::D3D12QueryPool(D3D12Device *device, uint32_t queryCount) {
+        assert(device != nullptr);
+        assert(queryCount > 0);
+
+        this->device = device;
+
+        D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+        queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        queryHeapDesc.Count = queryCount;
+
+        HRESULT res = device->d3d->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&d3d));
+        if (FAILED(res)) {
+            fprintf(stderr, "CreateQueryHeap failed with error code 0x%lX.\n", res);
+            return;
+        }
+
+        readbackBuffer = device->createBuffer(RenderBufferDesc::ReadbackBuffer(queryCount * sizeof(uint64_t)));
+        results.resize(queryCount, 0);
+    }
+
+    D3D12QueryPool::~D3D12QueryPool() {
+        readbackBuffer.reset();
+
+        if (d3d != nullptr) {
+            d3d->Release();
+        }
+    }
+
+    void D3D12QueryPool::queryResults() {
+        if (timestampFrequency == 0) {
+            return;
+        }
+
+        const RenderRange readRange(0, results.size() * sizeof(uint64_t));
+        const uint64_t *ticks = reinterpret_cast<const uint64_t *>(readbackBuffer->map(0, &readRange));
+        if (ticks == nullptr) {
+            return;
+        }
+
+        // Convert the ticks to nanoseconds.
+        const double nanosecondsPerTick = 1000000000.0 / double(timestampFrequency);
+        for (size_t i = 0; i < results.size(); i++) {
+            results[i] = uint64_t(double(ticks[i]) * nanosecondsPerTick);
+        }
+
+        const RenderRange writtenRange(0, 0);
+        readbackBuffer->unmap(0, &writtenRange);
+    }
+
+    const uint64_t *D3D12QueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t D3D12QueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
     // D3D12CommandFence
 
     D3D12CommandFence::D3D12CommandFence(D3D12Device *device) {
@@ -2544,6 +2670,151 @@ namespace RT64 {
         return std::make_unique<D3D12Texture>(device, this, desc);
     }
 
+    // D3D12PipelineCache
+
+    static std::wstring toPipelineName(uint64_t hash) {
+        wchar_t pipelineName[32];
+        swprintf(pipelineName, std::size(pipelineName), L"%016llX", (unsigned long long)(hash));
+        return std::wstring(pipelineName);
+    }
+
+    static void hashShaderBytecode(XXH3_state_t *xxh3, const D3D12_SHADER_BYTECODE &bytecode) {
+        const uint64_t bytecodeLength = bytecode.BytecodeLength;
+        XXH3_64bits_update(xxh3, &bytecodeLength, sizeof(bytecodeLength));
+        if (bytecodeLength > 0) {
+            XXH3_64bits_update(xxh3, bytecode.pShaderBytecode, bytecodeLength);
+        }
+    }
+
+    static uint64_t hashPipelineDesc(const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc) {
+        XXH3_state_t xxh3;
+        XXH3_64bits_reset(&xxh3);
+        hashShaderBytecode(&xxh3, desc.CS);
+
+        // Pointers change on every run, so they're cleared before hashing the rest of the state.
+        D3D12_COMPUTE_PIPELINE_STATE_DESC stateDesc = desc;
+        stateDesc.pRootSignature = nullptr;
+        stateDesc.CS = {};
+        XXH3_64bits_update(&xxh3, &stateDesc, sizeof(stateDesc));
+        return XXH3_64bits_digest(&xxh3);
+    }
+
+    static uint64_t hashPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) {
+        XXH3_state_t xxh3;
+        XXH3_64bits_reset(&xxh3);
+        hashShaderBytecode(&xxh3, desc.VS);
+        hashShaderBytecode(&xxh3, desc.GS);
+        hashShaderBytecode(&xxh3, desc.PS);
+
+        for (UINT i = 0; i < desc.InputLayout.NumElements; i++) {
+            D3D12_INPUT_ELEMENT_DESC elementDesc = desc.InputLayout.pInputElementDescs[i];
+            XXH3_64bits_update(&xxh3, elementDesc.SemanticName, strlen(elementDesc.SemanticName));
+            elementDesc.SemanticName = nullptr;
+            XXH3_64bits_update(&xxh3, &elementDesc, sizeof(elementDesc));
+        }
+
+        // Pointers change on every run, so they're cleared before hashing the rest of the state.
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC stateDesc = desc;
+        stateDesc.pRootSignature = nullptr;
+        stateDesc.VS = {};
+        stateDesc.GS = {};
+        stateDesc.PS = {};
+        stateDesc.InputLayout.pInputElementDescs = nullptr;
+        XXH3_64bits_update(&xxh3, &stateDesc, sizeof(stateDesc));
+        return XXH3_64bits_digest(&xxh3);
+    }
+
+    D3D12PipelineCache::D3D12PipelineCache(D3D12Device *device, const void *data, uint64_t size) {
+        assert(device != nullptr);
+
+        this->device = device;
+
+        HRESULT res = E_FAIL;
+        if ((data != nullptr) && (size > 0)) {
+            initialData.assign(reinterpret_cast<const uint8_t *>(data), reinterpret_cast<const uint8_t *>(data) + size);
+            res = device->d3d->CreatePipelineLibrary(initialData.data(), initialData.size(), IID_PPV_ARGS(&d3d));
+        }
+
+        // The library can be rejected if it was created with a different driver or adapter, so start with an empty one instead.
+        if (FAILED(res)) {
+            initialData.clear();
+            res = device->d3d->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&d3d));
+        }
+
+        if (FAILED(res)) {
+            fprintf(stderr, "CreatePipelineLibrary failed with error code 0x%lX.\n", res);
+            return;
+        }
+    }
+
+    D3D12PipelineCache::~D3D12PipelineCache() {
+        if (d3d != nullptr) {
+            d3d->Release();
+        }
+    }
+
+    bool D3D12PipelineCache::getData(std::vector<uint8_t> &data) {
+        data.clear();
+
+        if (d3d == nullptr) {
+            return false;
+        }
+
+        const std::unique_lock<std::shared_mutex> libraryLock(libraryMutex);
+        data.resize(d3d->GetSerializedSize());
+        HRESULT res = d3d->Serialize(data.data(), data.size());
+        if (FAILED(res)) {
+            fprintf(stderr, "Serialize failed with error code 0x%lX.\n", res);
+            data.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    ID3D12PipelineState *D3D12PipelineCache::loadComputePipeline(uint64_t hash, const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc) {
+        if (d3d == nullptr) {
+            return nullptr;
+        }
+
+        // Loading fails if the pipeline isn't in the library or if the stored description doesn't match.
+        // The library only requires loads of the same pipeline to be synchronized.
+        ID3D12PipelineState *pipelineState = nullptr;
+        const std::wstring pipelineName = toPipelineName(hash);
+        const std::shared_lock<std::shared_mutex> libraryLock(libraryMutex);
+        const std::scoped_lock<std::mutex> nameLock(nameMutexes[hash % NameMutexCount]);
+        HRESULT res = d3d->LoadComputePipeline(pipelineName.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+        return SUCCEEDED(res) ? pipelineState : nullptr;
+    }
+
+    ID3D12PipelineState *D3D12PipelineCache::loadGraphicsPipeline(uint64_t hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc) {
+        if (d3d == nullptr) {
+            return nullptr;
+        }
+
+        // Loading fails if the pipeline isn't in the library or if the stored description doesn't match.
+        // The library only requires loads of the same pipeline to be synchronized.
+        ID3D12PipelineState *pipelineState = nullptr;
+        const std::wstring pipelineName = toPipelineName(hash);
+        const std::shared_lock<std::shared_mutex> libraryLock(libraryMutex);
+        const std::scoped_lock<std::mutex> nameLock(nameMutexes[hash % NameMutexCount]);
+        HRESULT res = d3d->LoadGraphicsPipeline(pipelineName.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+        return SUCCEEDED(res) ? pipelineState : nullptr;
+    }
+
+    void D3D12PipelineCache::storePipeline(uint64_t hash, ID3D12PipelineState *pipelineState) {
+        assert(pipelineState != nullptr);
+
+        if (d3d == nullptr) {
+            return;
+        }
+
+        // Storing fails if another pipeline already uses the same name, which is not an error worth reporting.
+        const std::wstring pipelineName = toPipelineName(hash);
+        const std::unique_lock<std::shared_mutex> libraryLock(libraryMutex);
+        d3d->StorePipeline(pipelineName.c_str(), pipelineState);
+    }
+
     // D3D12Shader
 
     D3D12Shader::D3D12Shader(D3D12Device *device, const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) {
@@ -2623,7 +2894,7 @@ namespace RT64 {
 
     // D3D12ComputePipeline
 
-    D3D12ComputePipeline::D3D12ComputePipeline(D3D12Device *device, const RenderComputePipelineDesc &desc) : D3D12Pipeline(device, Type::Compute) {
+    D3D12ComputePipeline::D3D12ComputePipeline(D3D12Device *device, const RenderComputePipelineDesc &desc, D3D12PipelineCache *pipelineCache) : D3D12Pipeline(device, Type::Compute) {
         assert(desc.pipelineLayout != nullptr);
         assert(desc.computeShader != nullptr);
         assert((desc.threadGroupSizeX > 0) && (desc.threadGroupSizeY > 0) && (desc.threadGroupSizeZ > 0));
@@ -2634,7 +2905,25 @@ namespace RT64 {
         psoDesc.pRootSignature = rootSignature->rootSignature;
         psoDesc.CS.pShaderBytecode = computeShader->d3d.data();
         psoDesc.CS.BytecodeLength = computeShader->d3d.size();
-        device->d3d->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&d3d));
+
+        uint64_t pipelineHash = 0;
+        if (pipelineCache != nullptr) {
+            pipelineHash = hashPipelineDesc(psoDesc);
+            d3d = pipelineCache->loadComputePipeline(pipelineHash, psoDesc);
+            if (d3d != nullptr) {
+                return;
+            }
+        }
+
+        HRESULT res = device->d3d->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&d3d));
+        if (FAILED(res)) {
+            fprintf(stderr, "CreateComputePipelineState failed with error code 0x%lX.\n", res);
+            return;
+        }
+
+        if (pipelineCache != nullptr) {
+            pipelineCache->storePipeline(pipelineHash, d3d);
+        }
     }
 
     D3D12ComputePipeline::~D3D12ComputePipeline() {
@@ -2650,7 +2939,7 @@ namespace RT64 {
 
     // D3D12GraphicsPipeline
 
-    D3D12GraphicsPipeline::D3D12GraphicsPipeline(D3D12Device *device, const RenderGraphicsPipelineDesc &desc) : D3D12Pipeline(device, Type::Graphics) {
+    D3D12GraphicsPipeline::D3D12GraphicsPipeline(D3D12Device *device, const RenderGraphicsPipelineDesc &desc, D3D12PipelineCache *pipelineCache) : D3D12Pipeline(device, Type::Graphics) {
         assert(desc.pipelineLayout != nullptr);
 
         topology = toD3D12(desc.primitiveTopology);
@@ -2730,7 +3019,7 @@ namespace RT64 {
             for (uint32_t j = 0; j < desc.inputSlotsCount; j++) {
                 if (renderElement.slotIndex == desc.inputSlots[j].index) {
                     inputSlotClass = toD3D12(desc.inputSlots[j].classification);
-                    instanceDataStepRate = (inputSlotClass == D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA) ? desc.inputSlots[j].stride : 0;
+                    instanceDataStepRate = (inputSlotClass == D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA) ? 1 : 0;
                     foundInputSlot = true;
                     break;
                 }
@@ -2748,7 +3037,24 @@ namespace RT64 {
 
         psoDesc.InputLayout = { inputElements.data(), UINT(inputElements.size()) };
 
-        device->d3d->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&d3d));
+        uint64_t pipelineHash = 0;
+        if (pipelineCache != nullptr) {
+            pipelineHash = hashPipelineDesc(psoDesc);
+            d3d = pipelineCache->loadGraphicsPipeline(pipelineHash, psoDesc);
+            if (d3d != nullptr) {
+                return;
+            }
+        }
+
+        HRESULT res = device->d3d->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&d3d));
+        if (FAILED(res)) {
+            fprintf(stderr, "CreateGraphicsPipelineState failed with error code 0x%lX.\n", res);
+            return;
+        }
+
+        if (pipelineCache != nullptr) {
+            pipelineCache->storePipeline(pipelineHash, d3d);
+        }
     }
 
     D3D12GraphicsPipeline::~D3D12GraphicsPipeline() {
@@ -3241,6 +3547,10 @@ namespace RT64 {
                 description.name = win32::Utf16ToUtf8(adapterDesc.Description);
                 description.dedicatedVideoMemory = adapterDesc.DedicatedVideoMemory;
                 description.vendor = RenderDeviceVendor(adapterDesc.VendorId);
+
+                // The pipeline library validates the driver on its own, but the adapter is also stored so data from a different one is never loaded.
+                const uint32_t adapterIds[4] = { adapterDesc.VendorId, adapterDesc.DeviceId, adapterDesc.SubSysId, adapterDesc.Revision };
+                memcpy(description.pipelineCacheUUID, adapterIds, sizeof(description.pipelineCacheUUID));
                 
                 LARGE_INTEGER adapterVersion = {};
                 res = adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &adapterVersion);
@@ -3324,6 +3634,36 @@ namespace RT64 {
         capabilities.presentWait = true;
         capabilities.maxTextureSize = 16384;
         capabilities.preferHDR = description.dedicatedVideoMemory > (512 * 1024 * 1024);
+        capabilities.timestampQueries = true;
+
+        // Create the command signatures used by indirect draws. They only contain the draw arguments so they don't depend on any root signature.
+        D3D12_INDIRECT_ARGUMENT_DESC drawArgumentDesc = {};
+        drawArgumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW;
+
+        D3D12_COMMAND_SIGNATURE_DESC drawSignatureDesc = {};
+        drawSignatureDesc.ByteStride = sizeof(D3D12_DRAW_ARGUMENTS);
+        drawSignatureDesc.NumArgumentDescs = 1;
+        drawSignatureDesc.pArgumentDescs = &drawArgumentDesc;
+        res = d3d->CreateCommandSignature(&drawSignatureDesc, nullptr, IID_PPV_ARGS(&drawCommandSignature));
+        if (FAILED(res)) {
+            fprintf(stderr, "CreateCommandSignature failed with error code 0x%lX.\n", res);
+        }
+
+        D3D12_INDIRECT_ARGUMENT_DESC drawIndexedArgumentDesc = {};
+        drawIndexedArgumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+        D3D12_COMMAND_SIGNATURE_DESC drawIndexedSignatureDesc = {};
+        drawIndexedSignatureDesc.ByteStride = sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+        drawIndexedSignatureDesc.NumArgumentDescs = 1;
+        drawIndexedSignatureDesc.pArgumentDescs = &drawIndexedArgumentDesc;
+        res = d3d->CreateCommandSignature(&drawIndexedSignatureDesc, nullptr, IID_PPV_ARGS(&drawIndexedCommandSignature));
+        if (FAILED(res)) {
+            fprintf(stderr, "CreateCommandSignature failed with error code 0x%lX.\n", res);
+        }
+
+        static_assert(sizeof(RenderDrawIndirectArguments) == sizeof(D3D12_DRAW_ARGUMENTS), "Indirect draw arguments must match.");
+        static_assert(sizeof(RenderDrawIndexedIndirectArguments) == sizeof(D3D12_DRAW_INDEXED_ARGUMENTS), "Indirect indexed draw arguments must match.");
+        capabilities.drawIndirectCount = (drawCommandSignature != nullptr) && (drawIndexedCommandSignature != nullptr);
 
         // Create descriptor heaps allocator.
         viewHeapAllocator = std::make_unique<D3D12DescriptorHeapAllocator>(this, ShaderDescriptorHeapSize, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -3352,12 +3692,12 @@ namespace RT64 {
         return std::make_unique<D3D12Sampler>(this, desc);
     }
 
-    std::unique_ptr<RenderPipeline> D3D12Device::createComputePipeline(const RenderComputePipelineDesc &desc) {
-        return std::make_unique<D3D12ComputePipeline>(this, desc);
+    std::unique_ptr<RenderPipeline> D3D12Device::createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) {
+        return std::make_unique<D3D12ComputePipeline>(this, desc, static_cast<D3D12PipelineCache *>(pipelineCache));
     }
 
-    std::unique_ptr<RenderPipeline> D3D12Device::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) {
-        return std::make_unique<D3D12GraphicsPipeline>(this, desc);
+    std::unique_ptr<RenderPipeline> D3D12Device::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) {
+        return std::make_unique<D3D12GraphicsPipeline>(this, desc, static_cast<D3D12PipelineCache *>(pipelineCache));
     }
 
     std::unique_ptr<RenderPipeline> D3D12Device::createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) {
@@ -3388,6 +3728,10 @@ namespace RT64 {
         return std::make_unique<D3D12PipelineLayout>(this, desc);
     }
 
+    std::unique_ptr<RenderPipelineCache> D3D12Device::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<D3D12PipelineCache>(this, data, size);
+    }
+
     std::unique_ptr<RenderCommandFence> D3D12Device::createCommandFence() {
         return std::make_unique<D3D12CommandFence>(this);
     }
@@ -3400,6 +3744,10 @@ namespace RT64 {
         return std::make_unique<D3D12Framebuffer>(this, desc);
     }
 
+    std::unique_ptr<RenderQueryPool> D3D12Device::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<D3D12QueryPool>(this, queryCount);
+    }
+
     void D3D12Device::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
         assert(meshes != nullptr);
         assert(meshCount > 0);
@@ -3587,6 +3935,16 @@ namespace RT64 {
     }
 
     void D3D12Device::release() {
+        if (drawCommandSignature != nullptr) {
+            drawCommandSignature->Release();
+            drawCommandSignature = nullptr;
+        }
+
+        if (drawIndexedCommandSignature != nullptr) {
+            drawIndexedCommandSignature->Release();
+            drawIndexedCommandSignature = nullptr;
+        }
+
         if (d3d != nullptr) {
             d3d->Release();
             d3d = nullptr;
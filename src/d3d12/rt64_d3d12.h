@@ -6,8 +6,10 @@
 
 #include "rhi/rt64_render_interface.h"
 
+#include <array>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include <d3d12.h>
@@ -150,6 +152,7 @@ namespace RT64 {
         ID3D12GraphicsCommandList4 *d3d = nullptr;
         ID3D12CommandAllocator *commandAllocator = nullptr;
         D3D12Device *device = nullptr;
+        D3D12CommandQueue *queue = nullptr;
         RenderCommandListType type = RenderCommandListType::UNKNOWN;
         const D3D12Framebuffer *targetFramebuffer = nullptr;
         const D3D12PipelineLayout *activeComputePipelineLayout = nullptr;
@@ -159,6 +162,7 @@ namespace RT64 {
         bool targetFramebufferSamplePositionsSet = false;
         bool descriptorHeapsSet = false;
         bool activeSamplePositions = false;
+        bool outOfOrderRecording = false;
         bool open = false;
 
         D3D12CommandList(D3D12CommandQueue *queue, RenderCommandListType type);
@@ -170,6 +174,8 @@ namespace RT64 {
         void traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) override;
         void drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) override;
         void drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+        void drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) override;
+        void drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) override;
         void setPipeline(const RenderPipeline *pipeline) override;
         void setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
         void setComputePushConstants(uint32_t rangeIndex, const void *data) override;
@@ -195,6 +201,10 @@ namespace RT64 {
         void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) override;
         void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) override;
         void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) override;
+        void resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) override;
+        void resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void setOutOfOrderRecording(bool enabled) override;
         void checkDescriptorHeaps();
         void notifyDescriptorHeapWasChangedExternally();
         void checkTopology();
@@ -205,6 +215,20 @@ namespace RT64 {
         void setRootDescriptorTable(D3D12DescriptorHeapAllocator *heapAllocator, D3D12DescriptorSet::HeapAllocation &heapAllocation, uint32_t rootIndex, bool setCompute);
     };
 
+    struct D3D12QueryPool : RenderQueryPool {
+        ID3D12QueryHeap *d3d = nullptr;
+        D3D12Device *device = nullptr;
+        std::unique_ptr<RenderBuffer> readbackBuffer;
+        std::vector<uint64_t> results;
+        UINT64 timestampFrequency = 0;
+
+        D3D12QueryPool(D3D12Device *device, uint32_t queryCount);
+        ~D3D12QueryPool() override;
+        void queryResults() override;
+        const uint64_t *getResults() const override;
+        uint32_t getCount() const override;
+    };
+
     struct D3D12CommandFence : RenderCommandFence {
         ID3D12Fence *d3d = nullptr;
         D3D12Device *device = nullptr;
@@ -318,6 +342,26 @@ namespace RT64 {
         std::unique_ptr<RenderTexture> createTexture(const RenderTextureDesc &desc) override;
     };
 
+    struct D3D12PipelineCache : RenderPipelineCache {
+        ID3D12PipelineLibrary *d3d = nullptr;
+        D3D12Device *device = nullptr;
+
+        // The pipeline library reads from the data it was created with during its entire lifetime.
+        std::vector<uint8_t> initialData;
+
+        // Loads can run at the same time as long as they use different names. Storing and serializing need exclusive access to the library.
+        static const uint32_t NameMutexCount = 64;
+        std::shared_mutex libraryMutex;
+        std::array<std::mutex, NameMutexCount> nameMutexes;
+
+        D3D12PipelineCache(D3D12Device *device, const void *data, uint64_t size);
+        ~D3D12PipelineCache() override;
+        bool getData(std::vector<uint8_t> &data) override;
+        ID3D12PipelineState *loadComputePipeline(uint64_t hash, const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc);
+        ID3D12PipelineState *loadGraphicsPipeline(uint64_t hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc);
+        void storePipeline(uint64_t hash, ID3D12PipelineState *pipelineState);
+    };
+
     struct D3D12Shader : RenderShader {
         std::vector<uint8_t> d3d;
         std::string entryPointName;
@@ -356,7 +400,7 @@ namespace RT64 {
     struct D3D12ComputePipeline : D3D12Pipeline {
         ID3D12PipelineState *d3d = nullptr;
 
-        D3D12ComputePipeline(D3D12Device *device, const RenderComputePipelineDesc &desc);
+        D3D12ComputePipeline(D3D12Device *device, const RenderComputePipelineDesc &desc, D3D12PipelineCache *pipelineCache);
         ~D3D12ComputePipeline() override;
         virtual RenderPipelineProgram getProgram(const std::string &name) const override;
     };
@@ -366,7 +410,7 @@ namespace RT64 {
         std::vector<RenderInputSlot> inputSlots;
         D3D12_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
 
-        D3D12GraphicsPipeline(D3D12Device *device, const RenderGraphicsPipelineDesc &desc);
+        D3D12GraphicsPipeline(D3D12Device *device, const RenderGraphicsPipelineDesc &desc, D3D12PipelineCache *pipelineCache);
         ~D3D12GraphicsPipeline() override;
         virtual RenderPipelineProgram getProgram(const std::string &name) const override;
     };
@@ -408,6 +452,8 @@ namespace RT64 {
         std::unique_ptr<D3D12DescriptorHeapAllocator> samplerHeapAllocator;
         std::unique_ptr<D3D12DescriptorHeapAllocator> colorTargetHeapAllocator;
         std::unique_ptr<D3D12DescriptorHeapAllocator> depthTargetHeapAllocator;
+        ID3D12CommandSignature *drawCommandSignature = nullptr;
+        ID3D12CommandSignature *drawIndexedCommandSignature = nullptr;
         RenderDeviceCapabilities capabilities;
         RenderDeviceDescription description;
 
@@ -416,8 +462,8 @@ namespace RT64 {
         std::unique_ptr<RenderDescriptorSet> createDescriptorSet(const RenderDescriptorSetDesc &desc) override;
         std::unique_ptr<RenderShader> createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) override;
         std::unique_ptr<RenderSampler> createSampler(const RenderSamplerDesc &desc) override;
-        std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc) override;
-        std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) override;
+        std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) override;
+        std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) override;
         std::unique_ptr<RenderPipeline> createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) override;
         std::unique_ptr<RenderCommandQueue> createCommandQueue(RenderCommandListType type) override;
         std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) override;
@@ -425,9 +471,11 @@ namespace RT64 {
         std::unique_ptr<RenderAccelerationStructure> createAccelerationStructure(const RenderAccelerationStructureDesc &desc) override;
         std::unique_ptr<RenderPool> createPool(const RenderPoolDesc &desc) override;
         std::unique_ptr<RenderPipelineLayout> createPipelineLayout(const RenderPipelineLayoutDesc &desc) override;
+        std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data, uint64_t size) override;
         std::unique_ptr<RenderCommandFence> createCommandFence() override;
         std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() override;
         std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) override;
+        std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) override;
         void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) override;
         void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) override;
         void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) override;
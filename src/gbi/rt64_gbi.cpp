@@ -459,6 +459,12 @@ namespace RT64 {
             return nullptr;
         }
 
+        return getGBIForInstance(matchingInstance);
+    }
+
+    GBI *GBIManager::getGBIForInstance(const GBIInstance *matchingInstance) {
+        assert(matchingInstance != nullptr);
+
         GBI &gbi = gbiCache[uint32_t(matchingInstance->ucode)];
         if (gbi.ucode == GBIUCode::Unknown) {
             gbi.ucode = matchingInstance->ucode;
@@ -71,6 +71,7 @@ namespace RT64 {
         ~GBIManager();
         GBI *getGBIForRDP();
         GBI *getGBIForUCode(uint8_t *RDRAM, uint32_t textAddress, uint32_t dataAddress);
+        GBI *getGBIForInstance(const GBIInstance *matchingInstance);
         void deduceGBIInformation(uint8_t *RDRAM, uint32_t textAddress, uint32_t dataAddress);
         GBIFunction getExtendedFunction() const;
     };
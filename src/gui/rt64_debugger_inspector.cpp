@@ -1231,8 +1231,9 @@ namespace RT64 {
                                                 std::filesystem::path binFilename = FileDialog::getSaveFilename({ FileFilter("BIN Files", "bin") });
                                                 if (!binFilename.empty()) {
                                                     std::ofstream o(binFilename, std::ios_base::out | std::ios_base::binary);
-                                                    if (o.is_open()) {
-                                                        o.write(reinterpret_cast<const char *>(texture->bytesTMEM.data()), texture->bytesTMEM.size());
+                                                    std::vector<uint8_t> TMEM(0x1000, 0);
+                                                    if (o.is_open() && textureCache.restoreTMEM(textureIndex, TMEM.data())) {
+                                                        o.write(reinterpret_cast<const char *>(TMEM.data()), TMEM.size());
                                                     }
                                                 }
                                             }
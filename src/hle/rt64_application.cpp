@@ -5,11 +5,13 @@
 #include "rt64_application.h"
 #include "rhi/rt64_render_hooks.h"
 
+#include <cinttypes>
 #include <filesystem>
 
 #include "common/rt64_dynamic_libraries.h"
 #include "common/rt64_elapsed_timer.h"
 #include "common/rt64_math.h"
+#include "render/rt64_pipeline_cache_file.h"
 
 #if RT_ENABLED
 #   include "res/bluenoise/LDR_64_64_64_RGB1.h"
@@ -18,10 +20,17 @@
 //#define LOG_DISPLAY_LISTS
 
 namespace RT64 {
+    // Initial size of the upload memory shared by all buffer uploaders. The ring only grows if a frame outpaces the GPU reclaiming it.
+    static const uint64_t StagingRingInitialSize = 16 * 1024 * 1024;
+
+    // Threads left out of the task scheduler for the emulation, render and present threads.
+    static const uint32_t TaskSchedulerReservedThreads = 3;
+
     // External functions to create the backends.
 
     extern std::unique_ptr<RenderInterface> CreateD3D12Interface();
     extern std::unique_ptr<RenderInterface> CreateMetalInterface();
+    extern std::unique_ptr<RenderInterface> CreateNullInterface();
 #ifdef RT64_SDL_WINDOW_VULKAN
     extern std::unique_ptr<RenderInterface> CreateVulkanInterface(RenderWindow renderWindow);
 #else
@@ -57,6 +66,24 @@ namespace RT64 {
         return vi;
     }
 
+    void Application::Core::copyVIRegisters(uint32_t *registers) const {
+        // Must match the order used by the display list capture replay.
+        registers[0] = *VI_STATUS_REG;
+        registers[1] = *VI_ORIGIN_REG;
+        registers[2] = *VI_WIDTH_REG;
+        registers[3] = *VI_INTR_REG;
+        registers[4] = *VI_V_CURRENT_LINE_REG;
+        registers[5] = *VI_TIMING_REG;
+        registers[6] = *VI_V_SYNC_REG;
+        registers[7] = *VI_H_SYNC_REG;
+        registers[8] = *VI_LEAP_REG;
+        registers[9] = *VI_H_START_REG;
+        registers[10] = *VI_V_START_REG;
+        registers[11] = *VI_V_BURST_REG;
+        registers[12] = *VI_X_SCALE_REG;
+        registers[13] = *VI_Y_SCALE_REG;
+    }
+
     // Application
 
     Application::Application(const Core &core, const ApplicationConfiguration &appConfig) {
@@ -112,12 +139,15 @@ namespace RT64 {
         }
 #   endif
 
-        // Create the application window.
+        // Create the application window. The null backend doesn't need one if the core didn't provide it, which lets it run on machines without a display.
         const char *windowTitle = "RT64";
         appWindow = std::make_unique<ApplicationWindow>();
         if (core.window != RenderWindow{}) {
             appWindow->setup(core.window, this, threadId);
         }
+        else if (userConfig.graphicsAPI == UserConfiguration::GraphicsAPI::Null) {
+            appWindow->setupHeadless(this);
+        }
         else {
             appWindow->setup(windowTitle, this);
         }
@@ -149,6 +179,10 @@ namespace RT64 {
         case UserConfiguration::GraphicsAPI::Vulkan:
             renderInterface = CreateVulkanInterfaceWrapper(appWindow->windowHandle);
             break;
+        case UserConfiguration::GraphicsAPI::Null:
+            // Records and discards all GPU work. Only useful for measuring the CPU side of the renderer.
+            renderInterface = CreateNullInterface();
+            break;
         default:
             fprintf(stderr, "Unknown Graphics API specified in configuration.\n");
             return SetupResult::InvalidGraphicsAPI;
@@ -246,13 +280,25 @@ namespace RT64 {
             initHook(renderInterface.get(), device.get());
         }
 
-        // Create all the render workers.
-        drawDataUploader = std::make_unique<BufferUploader>(device.get());
-        transformsUploader = std::make_unique<BufferUploader>(device.get());
-        tilesUploader = std::make_unique<BufferUploader>(device.get());
-        workloadExtrasUploader = std::make_unique<BufferUploader>(device.get());
-        workloadVelocityUploader = std::make_unique<BufferUploader>(device.get());
-        workloadTilesUploader = std::make_unique<BufferUploader>(device.get());
+        // Create the task scheduler that runs the shader compilation, the texture streaming, the buffer uploads and the command list recording.
+        // Leave enough cores for the emulation, render and present threads. Shader compilation can use about half of the system's available
+        // threads and texture streaming about a quarter, but together they must always leave one thread free for the uploads and the recording.
+        const uint32_t taskThreadCount = std::max(threadsAvailable, TaskSchedulerReservedThreads + 3U) - TaskSchedulerReservedThreads;
+        const uint32_t textureStreamTaskLimit = std::clamp(threadsAvailable / 4U, 1U, taskThreadCount - 2U);
+        const uint32_t rasterShaderTaskLimit = std::clamp(threadsAvailable / 2U, 1U, taskThreadCount - 1U - textureStreamTaskLimit);
+        taskScheduler = std::make_unique<TaskScheduler>(taskThreadCount);
+        taskScheduler->setClassLimit(Thread::Priority::Idle, rasterShaderTaskLimit);
+        taskScheduler->setClassLimit(Thread::Priority::Low, textureStreamTaskLimit);
+
+        // Create all the render workers. Every buffer uploader stages its data in the same ring and splits large copies across the scheduler.
+        stagingRing = std::make_unique<StagingRing>(device.get(), StagingRingInitialSize);
+        drawDataUploader = std::make_unique<BufferUploader>(device.get(), stagingRing.get(), taskScheduler.get());
+        drawDataUploader->deltaUploads = true;
+        transformsUploader = std::make_unique<BufferUploader>(device.get(), stagingRing.get(), taskScheduler.get());
+        tilesUploader = std::make_unique<BufferUploader>(device.get(), stagingRing.get(), taskScheduler.get());
+        workloadExtrasUploader = std::make_unique<BufferUploader>(device.get(), stagingRing.get(), taskScheduler.get());
+        workloadVelocityUploader = std::make_unique<BufferUploader>(device.get(), stagingRing.get(), taskScheduler.get());
+        workloadTilesUploader = std::make_unique<BufferUploader>(device.get(), stagingRing.get(), taskScheduler.get());
         framebufferGraphicsWorker = std::make_unique<RenderWorker>(device.get(), "Framebuffer Graphics", RenderCommandListType::DIRECT);
         textureDirectWorker = std::make_unique<RenderWorker>(device.get(), "Texture Direct", RenderCommandListType::DIRECT);
         textureCopyWorker = std::make_unique<RenderWorker>(device.get(), "Texture Copy", RenderCommandListType::COPY);
@@ -271,20 +317,32 @@ namespace RT64 {
             userConfig.antialiasing = UserConfiguration::Antialiasing::None;
         }
 
+        // Load the pipelines the driver compiled during previous sessions.
+        if (!userPaths.isEmpty()) {
+            pipelineCache = PipelineCacheFile::load(device.get(), userPaths.pipelineCachePath);
+        }
+        else {
+            pipelineCache = device->createPipelineCache();
+        }
+
         // Create the shader library.
         const RenderMultisampling multisampling = RasterShader::generateMultisamplingPattern(userConfig.msaaSampleCount(), device->getCapabilities().sampleLocations);
         shaderLibrary = std::make_unique<ShaderLibrary>(usesHDR, usesHardwareResolve);
+        shaderLibrary->pipelineCache = pipelineCache.get();
         shaderLibrary->setupCommonShaders(renderInterface.get(), device.get());
         shaderLibrary->setupMultisamplingShaders(renderInterface.get(), device.get(), multisampling);
 
         // Create the shader caches.
-        // Estimate the amount of shader compiler threads by trying to use about half of the system's available threads.
-        // We need the ubershader pipelines done as soon as possible, so we use a different thread count that demands more of the system.
-        const uint32_t rasterShaderThreads = std::max(threadsAvailable / 2U, 1U);
+        // We need the ubershader pipelines done as soon as possible, so they use their own threads that demand more of the system.
         const uint32_t ubershaderThreads = uint32_t(std::max(int(threadsAvailable) - 2, 1));
-        rasterShaderCache = std::make_unique<RasterShaderCache>(rasterShaderThreads, ubershaderThreads);
+        rasterShaderCache = std::make_unique<RasterShaderCache>(taskScheduler.get(), ubershaderThreads);
         rasterShaderCache->setup(device.get(), renderInterface->getCapabilities().shaderFormat, shaderLibrary.get(), multisampling);
 
+        // Pre-warm the shader cache with all the shaders that were used in previous sessions. The cache is loaded in the background.
+        if (!userPaths.isEmpty()) {
+            rasterShaderCache->loadOfflineCache(userPaths.shaderCachePath);
+        }
+
 #   if RT_ENABLED
         if (device->getCapabilities().raytracing) {
             rtShaderCache = std::make_unique<RaytracingShaderCache>(device.get(), renderInterface->getCapabilities().shaderFormat, shaderLibrary.get());
@@ -292,13 +350,13 @@ namespace RT64 {
 #   endif
 
         // Create the texture cache.
-        const uint32_t textureCacheThreads = std::max(threadsAvailable / 4U, 1U);
-        textureCache = std::make_unique<TextureCache>(textureDirectWorker.get(), textureCopyWorker.get(), textureCacheThreads, shaderLibrary.get());
+        textureCache = std::make_unique<TextureCache>(textureDirectWorker.get(), textureCopyWorker.get(), taskScheduler.get(), shaderLibrary.get());
 
         // Compute the approximate pool for texture replacements from the dedicated video memory.
         const uint64_t MinimumTexturePoolSize = 512 * 1024 * 1024;
         uint64_t texturePoolSize = std::max((device->getDescription().dedicatedVideoMemory * 2) / 3, MinimumTexturePoolSize);
         textureCache->setReplacementPoolMaxSize(texturePoolSize);
+        updateTextureStreamBatchLimits();
 
 #   if RT_ENABLED
         // Create the blue noise texture, upload it and wait for it to finish.
@@ -311,9 +369,10 @@ namespace RT64 {
         blueNoiseUploadBuffer.reset();
 #   endif
 
-        // Create the queues.
-        workloadQueue = std::make_unique<WorkloadQueue>();
-        presentQueue = std::make_unique<PresentQueue>();
+        // Create the queues with the depth specified from the configuration.
+        const uint32_t queueDepth = uint32_t(std::clamp(userConfig.queueDepth, UserConfiguration::QueueDepthMinimum, UserConfiguration::QueueDepthMaximum));
+        workloadQueue = std::make_unique<WorkloadQueue>(queueDepth);
+        presentQueue = std::make_unique<PresentQueue>(queueDepth);
 
         // Create the shared resources for the queues.
         sharedQueueResources = std::make_unique<SharedQueueResources>();
@@ -331,6 +390,8 @@ namespace RT64 {
         workloadExt.workloadExtrasUploader = workloadExtrasUploader.get();
         workloadExt.workloadVelocityUploader = workloadVelocityUploader.get();
         workloadExt.workloadTilesUploader = workloadTilesUploader.get();
+        workloadExt.stagingRing = stagingRing.get();
+        workloadExt.taskScheduler = taskScheduler.get();
         workloadExt.presentQueue = presentQueue.get();
         workloadExt.sharedResources = sharedQueueResources.get();
         workloadExt.rasterShaderCache = rasterShaderCache.get();
@@ -366,6 +427,8 @@ namespace RT64 {
         stateExt.drawDataUploader = drawDataUploader.get();
         stateExt.transformsUploader = transformsUploader.get();
         stateExt.tilesUploader = tilesUploader.get();
+        stateExt.stagingRing = stagingRing.get();
+        stateExt.taskScheduler = taskScheduler.get();
         stateExt.workloadQueue = workloadQueue.get();
         stateExt.presentQueue = presentQueue.get();
         stateExt.sharedQueueResources = sharedQueueResources.get();
@@ -404,6 +467,10 @@ namespace RT64 {
             RT64_LOG_PRINTF("Application::processDisplayLists(0x%X, 0x%X)", dlStartAddress, dlEndAddress);
 #   endif
 
+            if (displayListCapture.isOpen()) {
+                displayListCapture.writeDisplayLists(core.RDRAM, memory, dlStartAddress, dlEndAddress, isHLE, interpreter->UCode.textAddress, interpreter->UCode.dataAddress);
+            }
+
             ElapsedTimer displayListTimer;
             DisplayList *dlStart = reinterpret_cast<DisplayList *>(&memory[dlStartAddress]);
             DisplayList *dlEnd = (dlEndAddress > 0) ? reinterpret_cast<RT64::DisplayList *>(&memory[dlEndAddress]) : nullptr;
@@ -442,9 +509,34 @@ namespace RT64 {
     void Application::updateScreen() {
         appWindow->sdlCheckFilterInstallation();
         screenApiProfiler.logAndRestart();
+
+        if (displayListCapture.isOpen()) {
+            uint32_t viRegisters[DisplayListCapture::VIRegisterCount];
+            core.copyVIRegisters(viRegisters);
+            displayListCapture.writeUpdateScreen(core.RDRAM, viRegisters);
+        }
+
         state->updateScreen(core.decodeVI(), false);
     }
 
+    bool Application::beginDisplayListCapture(const std::filesystem::path &path) {
+        endDisplayListCapture();
+
+        if (!displayListCapture.open(path)) {
+            fprintf(stderr, "Unable to open %s for capturing display lists.\n", path.u8string().c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    void Application::endDisplayListCapture() {
+        if (displayListCapture.isOpen()) {
+            displayListCapture.close();
+            fprintf(stdout, "Captured %u frames (%" PRIu64 " bytes compressed to %" PRIu64 " bytes).\n", displayListCapture.frameCount, displayListCapture.uncompressedBytes, displayListCapture.compressedBytes);
+        }
+    }
+
     void Application::destroyShaderCache() {
         workloadQueue->waitForWorkloadId(state->workloadId);
         presentQueue->waitForPresentId(state->presentId);
@@ -482,6 +574,12 @@ namespace RT64 {
         rasterShaderCache->shaderUber->waitForPipelineCreation();
     }
 
+    void Application::updateTextureStreamBatchLimits() {
+        const uint32_t batchCount = uint32_t(std::clamp(userConfig.textureStreamBatchCount, UserConfiguration::TextureStreamBatchCountMinimum, UserConfiguration::TextureStreamBatchCountMaximum));
+        const uint32_t batchMegabytes = uint32_t(std::clamp(userConfig.textureStreamBatchMegabytes, UserConfiguration::TextureStreamBatchMegabytesMinimum, UserConfiguration::TextureStreamBatchMegabytesMaximum));
+        textureCache->setStreamBatchLimits(batchCount, uint64_t(batchMegabytes) * 1024 * 1024);
+    }
+
 #ifdef _WIN32
     bool Application::windowMessageFilter(unsigned int message, WPARAM wParam, LPARAM lParam) {
         if (userConfig.developerMode && (presentQueue != nullptr) && (state != nullptr) && !FileDialog::isOpen) {
@@ -555,7 +653,8 @@ namespace RT64 {
     void Application::processDeveloperShortcut(DeveloperShortcut developerShortcut) {
         switch (developerShortcut) {
         case DeveloperShortcut::Inspector: {
-            if (userConfig.developerMode) {
+            // The inspector needs a native backend to render its interface.
+            if (userConfig.developerMode && (chosenGraphicsAPI != UserConfiguration::GraphicsAPI::Null)) {
                 const std::lock_guard lock(presentQueue->inspectorMutex);
                 if (presentQueue->inspector == nullptr) {
                     presentQueue->inspector = std::make_unique<Inspector>(device.get(), swapChain.get(), chosenGraphicsAPI, appWindow->sdlWindow);
@@ -593,6 +692,8 @@ namespace RT64 {
     }
 
     void Application::end() {
+        endDisplayListCapture();
+
 #   if SCRIPT_ENABLED
         if (currentScript != nullptr) {
             currentScript->finalize();
@@ -615,13 +716,26 @@ namespace RT64 {
         workloadExtrasUploader.reset();
         workloadVelocityUploader.reset();
         workloadTilesUploader.reset();
+        stagingRing.reset();
         sharedQueueResources.reset();
+
+        // Store all the shaders that were used during the session so they can be pre-warmed on the next one.
+        if ((rasterShaderCache != nullptr) && !userPaths.isEmpty() && checkDirectoryCreated(userPaths.dataPath)) {
+            rasterShaderCache->saveOfflineCache(userPaths.shaderCachePath);
+        }
+
+        // Store the pipelines compiled by the driver so they don't need to be compiled again on the next session.
+        if ((pipelineCache != nullptr) && !userPaths.isEmpty() && checkDirectoryCreated(userPaths.dataPath)) {
+            PipelineCacheFile::save(device.get(), pipelineCache.get(), userPaths.pipelineCachePath);
+        }
+
         rasterShaderCache.reset();
 #   if RT_ENABLED
         rtShaderCache.reset();
         blueNoiseTexture.texture.reset();
 #   endif
         textureCache.reset();
+        taskScheduler.reset();
         framebufferGraphicsWorker.reset();
         textureDirectWorker.reset();
         textureCopyWorker.reset();
@@ -629,6 +743,7 @@ namespace RT64 {
         workloadGraphicsWorker.reset();
         presentGraphicsWorker.reset();
         shaderLibrary.reset();
+        pipelineCache.reset();
         device.reset();
         renderInterface.reset();
 
@@ -670,6 +785,7 @@ namespace RT64 {
 
     void Application::updateUserConfig(bool discardFBs) {
         sharedQueueResources->setUserConfig(userConfig, true);
+        updateTextureStreamBatchLimits();
     }
 
     void Application::updateEmulatorConfig() {
@@ -23,6 +23,7 @@
 #include "rhi/rt64_render_interface.h"
 
 #include "rt64_application_window.h"
+#include "rt64_display_list_capture.h"
 #include "rt64_interpreter.h"
 #include "rt64_shared_queue_resources.h"
 
@@ -91,6 +92,7 @@ namespace RT64 {
             void (*checkInterrupts)();
 
             VI decodeVI() const;
+            void copyVIRegisters(uint32_t *registers) const;
         };
 
         struct {
@@ -114,8 +116,11 @@ namespace RT64 {
         std::unique_ptr<State> state;
         std::unique_ptr<ApplicationWindow> appWindow;
         std::unique_ptr<RenderDevice> device;
+        std::unique_ptr<RenderPipelineCache> pipelineCache;
         std::unique_ptr<RenderSwapChain> swapChain;
         std::unique_ptr<RenderWorker> framebufferGraphicsWorker;
+        std::unique_ptr<StagingRing> stagingRing;
+        std::unique_ptr<TaskScheduler> taskScheduler;
         std::unique_ptr<BufferUploader> drawDataUploader;
         std::unique_ptr<BufferUploader> transformsUploader;
         std::unique_ptr<BufferUploader> tilesUploader;
@@ -138,6 +143,7 @@ namespace RT64 {
         uint32_t threadsAvailable;
         ProfilingTimer dlApiProfiler = ProfilingTimer(120);
         ProfilingTimer screenApiProfiler = ProfilingTimer(120);
+        DisplayListCaptureWriter displayListCapture;
 
 #   if RT_ENABLED
         RaytracingConfiguration rtConfig;
@@ -156,8 +162,11 @@ namespace RT64 {
         SetupResult setup(uint32_t threadId);
         void processDisplayLists(uint8_t *memory, uint32_t dlStartAddress, uint32_t dlEndAddress, bool isHLE);
         void updateScreen();
+        bool beginDisplayListCapture(const std::filesystem::path &path);
+        void endDisplayListCapture();
         void destroyShaderCache();
         void updateMultisampling();
+        void updateTextureStreamBatchLimits();
         void end();
         bool loadConfiguration();
         bool saveConfiguration();
@@ -22,6 +22,9 @@
 #include "common/rt64_common.h"
 
 namespace RT64 {
+    // Refresh rate reported when there's no display to query it from.
+    static const uint32_t HeadlessRefreshRate = 60;
+
     // ApplicationWindow
 
     ApplicationWindow *ApplicationWindow::HookedApplicationWindow = nullptr;
@@ -164,8 +167,19 @@ namespace RT64 {
 #   endif
     }
 
+    void ApplicationWindow::setupHeadless(Listener *listener) {
+        assert(listener != nullptr);
+
+        // No window is created and SDL's video subsystem is never initialized. The window handle stays empty, so this
+        // is only valid with render interfaces that don't present to a window, like the null backend.
+        this->listener = listener;
+        windowHandle = {};
+        refreshRate = HeadlessRefreshRate;
+        headless = true;
+    }
+
     void ApplicationWindow::setFullScreen(bool newFullScreen) {
-        if (newFullScreen == fullScreen) {
+        if (headless || (newFullScreen == fullScreen)) {
             return;
         }
 
@@ -226,6 +240,10 @@ namespace RT64 {
     }
 
     void ApplicationWindow::makeResizable() {
+        if (headless) {
+            return;
+        }
+
 #   ifdef _WIN32
         LONG_PTR lStyle = GetWindowLongPtr(windowHandle, GWL_STYLE);
         windowMenu = GetMenu(windowHandle);
@@ -235,6 +253,10 @@ namespace RT64 {
     }
 
     void ApplicationWindow::detectRefreshRate() {
+        if (headless) {
+            return;
+        }
+
 #   if defined(_WIN32)
         HMONITOR monitor = MonitorFromWindow(windowHandle, MONITOR_DEFAULTTONEAREST);
         MONITORINFOEX info = {};
@@ -319,6 +341,10 @@ namespace RT64 {
     }
 
     bool ApplicationWindow::detectWindowMoved() {
+        if (headless) {
+            return false;
+        }
+
         int32_t newWindowLeft = INT32_MAX;
         int32_t newWindowTop = INT32_MAX;
 
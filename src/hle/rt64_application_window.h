@@ -47,6 +47,7 @@ namespace RT64 {
         SDL_EventFilter sdlEventFilterStored = nullptr;
         void *sdlEventFilterUserdata = nullptr;
         bool sdlEventFilterInstalled = false;
+        bool headless = false;
 
 #   ifdef _WIN32
         HHOOK windowHook = nullptr;
@@ -58,6 +59,7 @@ namespace RT64 {
         ~ApplicationWindow();
         void setup(RenderWindow window, Listener *listener, uint32_t threadId);
         void setup(const char *windowTitle, Listener *listener);
+        void setupHeadless(Listener *listener);
         void setFullScreen(bool newFullScreen);
         void makeResizable();
         void detectRefreshRate();
@@ -0,0 +1,276 @@
+//
+// RT64
+//
+
+#include "rt64_display_list_capture.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include <zstd.h>
+
+namespace RT64 {
+    // Faster levels are preferred since the capture is written on the same thread the emulator submits the display lists from.
+    static const int CaptureCompressionLevel = 3;
+
+    // DisplayListCaptureWriter
+
+    bool DisplayListCaptureWriter::open(const std::filesystem::path &path) {
+        assert(!isOpen());
+
+        stream.open(path, std::ios::binary);
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        DisplayListCapture::Header header;
+        header.magic = DisplayListCapture::Magic;
+        header.version = DisplayListCapture::Version;
+        header.rdramSize = DisplayListCapture::RDRAMCaptureSize;
+        header.pageSize = DisplayListCapture::PageSize;
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        // The replay starts from cleared memory, so any pages that are not zero will be stored by the first event.
+        shadowRDRAM.clear();
+        shadowRDRAM.resize(DisplayListCapture::RDRAMCaptureSize, 0);
+        frameData.clear();
+        frameCount = 0;
+        uncompressedBytes = 0;
+        compressedBytes = 0;
+        return !stream.bad();
+    }
+
+    bool DisplayListCaptureWriter::isOpen() const {
+        return stream.is_open();
+    }
+
+    void DisplayListCaptureWriter::writeDisplayLists(const uint8_t *RDRAM, const uint8_t *memory, uint32_t dlStartAddress, uint32_t dlEndAddress, bool isHLE, uint32_t ucodeTextAddress, uint32_t ucodeDataAddress) {
+        assert(isOpen());
+        assert(RDRAM != nullptr);
+        assert(memory != nullptr);
+
+        writeChangedPages(RDRAM);
+
+        DisplayListCapture::DisplayListsEvent dlEvent;
+        dlEvent.dlStartAddress = dlStartAddress;
+        dlEvent.dlEndAddress = dlEndAddress;
+        dlEvent.isHLE = isHLE;
+        dlEvent.ucodeTextAddress = ucodeTextAddress;
+        dlEvent.ucodeDataAddress = ucodeDataAddress;
+        dlEvent.inlineSize = 0;
+
+        // RDP lists can be submitted from memory other than RDRAM. Their size is known, so they're stored along with the event.
+        const bool inlineLists = (memory != RDRAM);
+        if (inlineLists) {
+            if (isHLE || (dlEndAddress < dlStartAddress)) {
+                fprintf(stderr, "Display lists that don't come from RDRAM can't be captured.\n");
+                return;
+            }
+
+            dlEvent.inlineSize = dlEndAddress;
+        }
+
+        const DisplayListCapture::EventType eventType = DisplayListCapture::EventType::DisplayLists;
+        writeData(&eventType, sizeof(eventType));
+        writeData(&dlEvent, sizeof(dlEvent));
+
+        if (inlineLists) {
+            writeData(memory, dlEvent.inlineSize);
+        }
+    }
+
+    void DisplayListCaptureWriter::writeUpdateScreen(const uint8_t *RDRAM, const uint32_t *viRegisters) {
+        assert(isOpen());
+        assert(RDRAM != nullptr);
+        assert(viRegisters != nullptr);
+
+        writeChangedPages(RDRAM);
+
+        const DisplayListCapture::EventType eventType = DisplayListCapture::EventType::UpdateScreen;
+        writeData(&eventType, sizeof(eventType));
+        writeData(viRegisters, sizeof(uint32_t) * DisplayListCapture::VIRegisterCount);
+
+        // Every screen update marks the end of a frame.
+        flushFrame();
+    }
+
+    void DisplayListCaptureWriter::close() {
+        if (!isOpen()) {
+            return;
+        }
+
+        flushFrame();
+        stream.close();
+        shadowRDRAM.clear();
+        shadowRDRAM.shrink_to_fit();
+    }
+
+    void DisplayListCaptureWriter::writeChangedPages(const uint8_t *RDRAM) {
+        changedPages.clear();
+        for (uint32_t i = 0; i < DisplayListCapture::PageCount; i++) {
+            const uint32_t pageOffset = i * DisplayListCapture::PageSize;
+            if (memcmp(&shadowRDRAM[pageOffset], &RDRAM[pageOffset], DisplayListCapture::PageSize) != 0) {
+                changedPages.emplace_back(i);
+            }
+        }
+
+        if (changedPages.empty()) {
+            return;
+        }
+
+        const DisplayListCapture::EventType eventType = DisplayListCapture::EventType::RDRAMPages;
+        const uint32_t pageCount = uint32_t(changedPages.size());
+        writeData(&eventType, sizeof(eventType));
+        writeData(&pageCount, sizeof(pageCount));
+        for (uint32_t pageIndex : changedPages) {
+            const uint32_t pageOffset = pageIndex * DisplayListCapture::PageSize;
+            memcpy(&shadowRDRAM[pageOffset], &RDRAM[pageOffset], DisplayListCapture::PageSize);
+            writeData(&pageIndex, sizeof(pageIndex));
+            writeData(&RDRAM[pageOffset], DisplayListCapture::PageSize);
+        }
+    }
+
+    void DisplayListCaptureWriter::writeData(const void *data, size_t size) {
+        const uint8_t *dataBytes = reinterpret_cast<const uint8_t *>(data);
+        frameData.insert(frameData.end(), dataBytes, dataBytes + size);
+    }
+
+    void DisplayListCaptureWriter::flushFrame() {
+        if (frameData.empty()) {
+            return;
+        }
+
+        compressedData.resize(ZSTD_compressBound(frameData.size()));
+        size_t compressedSize = ZSTD_compress(compressedData.data(), compressedData.size(), frameData.data(), frameData.size(), CaptureCompressionLevel);
+        if (ZSTD_isError(compressedSize)) {
+            fprintf(stderr, "Failed to compress display list capture frame: %s.\n", ZSTD_getErrorName(compressedSize));
+            frameData.clear();
+            return;
+        }
+
+        const uint32_t blockSizes[2] = { uint32_t(frameData.size()), uint32_t(compressedSize) };
+        stream.write(reinterpret_cast<const char *>(blockSizes), sizeof(blockSizes));
+        stream.write(reinterpret_cast<const char *>(compressedData.data()), compressedSize);
+
+        uncompressedBytes += frameData.size();
+        compressedBytes += compressedSize;
+        frameCount++;
+        frameData.clear();
+    }
+
+    // DisplayListCaptureReader
+
+    bool DisplayListCaptureReader::open(const std::filesystem::path &path) {
+        stream.open(path, std::ios::binary);
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        DisplayListCapture::Header header;
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (stream.fail() || (header.magic != DisplayListCapture::Magic)) {
+            fprintf(stderr, "File is not a display list capture.\n");
+            return false;
+        }
+
+        if (header.version != DisplayListCapture::Version) {
+            fprintf(stderr, "Display list capture version %u is not supported.\n", header.version);
+            return false;
+        }
+
+        if ((header.rdramSize != DisplayListCapture::RDRAMCaptureSize) || (header.pageSize != DisplayListCapture::PageSize)) {
+            fprintf(stderr, "Display list capture uses an unsupported memory layout.\n");
+            return false;
+        }
+
+        frameData.clear();
+        frameCursor = 0;
+        frameCount = 0;
+        return true;
+    }
+
+    bool DisplayListCaptureReader::readEvent(uint8_t *RDRAM, DisplayListCapture::Event &event) {
+        assert(RDRAM != nullptr);
+
+        while (true) {
+            if ((frameCursor >= frameData.size()) && !readFrame()) {
+                return false;
+            }
+
+            if (!readData(&event.type, sizeof(event.type))) {
+                return false;
+            }
+
+            switch (event.type) {
+            case DisplayListCapture::EventType::RDRAMPages: {
+                uint32_t pageCount = 0;
+                if (!readData(&pageCount, sizeof(pageCount))) {
+                    return false;
+                }
+
+                for (uint32_t i = 0; i < pageCount; i++) {
+                    uint32_t pageIndex = 0;
+                    if (!readData(&pageIndex, sizeof(pageIndex)) || (pageIndex >= DisplayListCapture::PageCount)) {
+                        return false;
+                    }
+
+                    if (!readData(&RDRAM[pageIndex * DisplayListCapture::PageSize], DisplayListCapture::PageSize)) {
+                        return false;
+                    }
+                }
+
+                break;
+            }
+            case DisplayListCapture::EventType::DisplayLists:
+                if (!readData(&event.displayLists, sizeof(event.displayLists))) {
+                    return false;
+                }
+
+                event.inlineDisplayLists.resize(event.displayLists.inlineSize);
+                return readData(event.inlineDisplayLists.data(), event.inlineDisplayLists.size());
+            case DisplayListCapture::EventType::UpdateScreen:
+                return readData(event.viRegisters, sizeof(event.viRegisters));
+            default:
+                fprintf(stderr, "Unknown event found in display list capture.\n");
+                return false;
+            }
+        }
+    }
+
+    bool DisplayListCaptureReader::readFrame() {
+        uint32_t blockSizes[2] = {};
+        stream.read(reinterpret_cast<char *>(blockSizes), sizeof(blockSizes));
+        if (stream.gcount() != sizeof(blockSizes)) {
+            return false;
+        }
+
+        compressedData.resize(blockSizes[1]);
+        stream.read(reinterpret_cast<char *>(compressedData.data()), compressedData.size());
+        if (size_t(stream.gcount()) != compressedData.size()) {
+            fprintf(stderr, "Display list capture ended unexpectedly.\n");
+            return false;
+        }
+
+        frameData.resize(blockSizes[0]);
+        if (ZSTD_decompress(frameData.data(), frameData.size(), compressedData.data(), compressedData.size()) != frameData.size()) {
+            fprintf(stderr, "Failed to decompress display list capture frame.\n");
+            return false;
+        }
+
+        frameCursor = 0;
+        frameCount++;
+        return true;
+    }
+
+    bool DisplayListCaptureReader::readData(void *data, size_t size) {
+        if ((frameCursor + size) > frameData.size()) {
+            fprintf(stderr, "Display list capture frame is corrupted.\n");
+            return false;
+        }
+
+        memcpy(data, &frameData[frameCursor], size);
+        frameCursor += size;
+        return true;
+    }
+};
@@ -0,0 +1,92 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace RT64 {
+    // Stores everything the emulator feeds into the renderer so a sequence of frames can be replayed offline.
+    // The file is a header followed by one zstd compressed block per frame. Each block is a stream of events.
+    // RDRAM is stored as the pages that changed since the previous event, so the first block holds the full image.
+    namespace DisplayListCapture {
+        const uint32_t Magic = 0x434C4436; // 6DLC
+        const uint32_t Version = 1;
+        const uint32_t PageSize = 0x1000;
+        const uint32_t RDRAMCaptureSize = 0x800000;
+        const uint32_t PageCount = RDRAMCaptureSize / PageSize;
+        const uint32_t VIRegisterCount = 14;
+
+        enum class EventType : uint32_t {
+            RDRAMPages,
+            DisplayLists,
+            UpdateScreen
+        };
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t rdramSize;
+            uint32_t pageSize;
+        };
+
+        struct DisplayListsEvent {
+            uint32_t dlStartAddress;
+            uint32_t dlEndAddress;
+            uint32_t isHLE;
+            uint32_t ucodeTextAddress;
+            uint32_t ucodeDataAddress;
+
+            // Only used when the lists don't come from RDRAM. Holds the contents of the lists up to the end address.
+            uint32_t inlineSize;
+        };
+
+        struct Event {
+            EventType type;
+            DisplayListsEvent displayLists;
+            std::vector<uint8_t> inlineDisplayLists;
+            uint32_t viRegisters[VIRegisterCount];
+        };
+    };
+
+    struct DisplayListCaptureWriter {
+        std::ofstream stream;
+        std::vector<uint8_t> shadowRDRAM;
+        std::vector<uint8_t> frameData;
+        std::vector<uint8_t> compressedData;
+        std::vector<uint32_t> changedPages;
+        uint32_t frameCount = 0;
+        uint64_t uncompressedBytes = 0;
+        uint64_t compressedBytes = 0;
+
+        bool open(const std::filesystem::path &path);
+        bool isOpen() const;
+        void writeDisplayLists(const uint8_t *RDRAM, const uint8_t *memory, uint32_t dlStartAddress, uint32_t dlEndAddress, bool isHLE, uint32_t ucodeTextAddress, uint32_t ucodeDataAddress);
+        void writeUpdateScreen(const uint8_t *RDRAM, const uint32_t *viRegisters);
+        void close();
+        void writeChangedPages(const uint8_t *RDRAM);
+        void writeData(const void *data, size_t size);
+        void flushFrame();
+    };
+
+    struct DisplayListCaptureReader {
+        std::ifstream stream;
+        std::vector<uint8_t> frameData;
+        std::vector<uint8_t> compressedData;
+        size_t frameCursor = 0;
+        uint32_t frameCount = 0;
+
+        bool open(const std::filesystem::path &path);
+
+        // Applies the stored RDRAM pages to the memory until the next display list or screen update is found.
+        // Returns false when the end of the capture is reached or the capture is corrupted.
+        bool readEvent(uint8_t *RDRAM, DisplayListCapture::Event &event);
+
+        bool readFrame();
+        bool readData(void *data, size_t size);
+    };
+};
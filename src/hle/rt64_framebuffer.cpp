@@ -25,6 +25,9 @@
 #endif
 
 namespace RT64 {
+    // Approximate size of each block of RDRAM that is hashed independently to detect which rows of a framebuffer changed.
+    static const uint32_t RAMBlockTargetBytes = 4096;
+
     // Framebuffer
 
     Framebuffer::Framebuffer() {
@@ -36,7 +39,14 @@ namespace RT64 {
         maxHeight = 0;
         modifiedBytes = 0;
         RAMBytes = 0;
-        RAMHash = 0;
+        RAMBlockBytes = 0;
+        RAMBlockHashedBytes = 0;
+        RAMBlockPendingBytes = 0;
+        RAMBlockPendingHashedBytes = 0;
+        RAMBlockPendingValid = false;
+        dirtyRowStart = 0;
+        dirtyRowEnd = 0;
+        nativeSwappedValid = false;
         ditherPatterns.fill(0);
         lastWriteType = Type::None;
         lastWriteFmt = 0;
@@ -71,6 +81,129 @@ namespace RT64 {
         return (lastWriteType != Type::None) && (lastWriteType != newType);
     }
 
+    uint32_t Framebuffer::blockRowCount() const {
+        const uint32_t rowBytes = imageRowBytes(width);
+        if (rowBytes == 0) {
+            return 1;
+        }
+
+        return std::max(RAMBlockTargetBytes / rowBytes, 1U);
+    }
+
+    bool Framebuffer::checkRAMBlocks(const uint8_t *fbRAM, bool updateHashes) {
+        assert(fbRAM != nullptr);
+
+        // The block layout must match the one used for the stored hashes. Consider everything as changed otherwise.
+        const uint32_t rowBytes = imageRowBytes(width);
+        const uint32_t blockRows = blockRowCount();
+        const uint32_t blockBytes = std::max(blockRows * rowBytes, 1U);
+        const uint32_t blockCount = (RAMBytes + blockBytes - 1) / blockBytes;
+        const bool layoutChanged = (RAMBlockBytes != blockBytes) || (RAMBlockHashedBytes != RAMBytes);
+
+        // The new hashes are kept as pending so they can be committed later without hashing the blocks again.
+        RAMBlockPendingHashes.resize(blockCount);
+        RAMBlockPendingBytes = blockBytes;
+        RAMBlockPendingHashedBytes = RAMBytes;
+        RAMBlockPendingValid = true;
+
+        uint32_t firstDirtyBlock = UINT32_MAX;
+        uint32_t lastDirtyBlock = 0;
+        for (uint32_t i = 0; i < blockCount; i++) {
+            const uint32_t byteStart = i * blockBytes;
+            const uint32_t byteCount = std::min(blockBytes, RAMBytes - byteStart);
+            const uint64_t blockHash = XXH3_64bits(&fbRAM[byteStart], byteCount);
+            RAMBlockPendingHashes[i] = blockHash;
+            if (layoutChanged || (blockHash != RAMBlockHashes[i])) {
+                firstDirtyBlock = std::min(firstDirtyBlock, i);
+                lastDirtyBlock = i;
+            }
+        }
+
+        bool RAMChanged = true;
+        if (layoutChanged) {
+            dirtyRowStart = 0;
+            dirtyRowEnd = height;
+        }
+        else if (firstDirtyBlock != UINT32_MAX) {
+            dirtyRowStart = std::min(firstDirtyBlock * blockRows, height);
+            dirtyRowEnd = std::min((lastDirtyBlock + 1) * blockRows, height);
+        }
+        else {
+            dirtyRowStart = 0;
+            dirtyRowEnd = 0;
+            RAMChanged = false;
+        }
+
+        if (updateHashes) {
+            commitRAMBlocks();
+        }
+
+        return RAMChanged;
+    }
+
+    void Framebuffer::commitRAMBlocks() {
+        if (!RAMBlockPendingValid) {
+            return;
+        }
+
+        std::swap(RAMBlockHashes, RAMBlockPendingHashes);
+        RAMBlockBytes = RAMBlockPendingBytes;
+        RAMBlockHashedBytes = RAMBlockPendingHashedBytes;
+        RAMBlockPendingValid = false;
+    }
+
+    void Framebuffer::hashRAMBlocks(const uint8_t *fbRAM) {
+        checkRAMBlocks(fbRAM, true);
+
+        // The hashes now reflect contents that were never swapped into the native copy.
+        nativeSwappedValid = false;
+    }
+
+    void Framebuffer::swapRAMToNative(const uint8_t *src, uint32_t byteStart, uint32_t byteEnd) {
+        const uint32_t *srcWords = reinterpret_cast<const uint32_t *>(src) + (byteStart / sizeof(uint32_t));
+        uint32_t *dstWords = reinterpret_cast<uint32_t *>(nativeSwappedRAM.data()) + (byteStart / sizeof(uint32_t));
+        uint32_t wordsToSwap = (byteEnd - byteStart) / sizeof(uint32_t);
+        while (wordsToSwap > 0) {
+            *dstWords = _byteswap_ulong(*srcWords);
+            wordsToSwap--;
+            srcWords++;
+            dstWords++;
+        }
+    }
+
+    bool Framebuffer::swapDirtyRAMToNative(const uint8_t *fbRAM) {
+        assert(fbRAM != nullptr);
+
+        // Only the rows detected as dirty need to be swapped if the native copy still holds the rest of the framebuffer.
+        const uint32_t nativeSize = NativeTarget::getNativeSize(width, height, siz);
+        uint32_t byteStart = 0;
+        uint32_t byteEnd = nativeSize;
+        const bool dirtyRowsOnly = nativeSwappedValid && (nativeSwappedRAM.size() == nativeSize);
+        if (dirtyRowsOnly) {
+            const uint32_t rowBytes = imageRowBytes(width);
+            byteStart = std::min(dirtyRowStart * rowBytes, nativeSize) & ~3U;
+            byteEnd = std::min(((dirtyRowEnd * rowBytes) + 3U) & ~3U, nativeSize);
+        }
+        else {
+            nativeSwappedRAM.resize(nativeSize);
+        }
+
+        swapRAMToNative(fbRAM, byteStart, byteEnd);
+        nativeSwappedValid = true;
+        return dirtyRowsOnly;
+    }
+
+    uint32_t Framebuffer::copyDirtyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *fbRAM, uint8_t fmt, const ShaderLibrary *shaderLibrary) {
+        assert(worker != nullptr);
+
+        // The native target only needs to upload and compare the dirty rows if the rest of the swapped copy is the same as the last upload.
+        const bool dirtyRowsOnly = swapDirtyRAMToNative(fbRAM);
+        const uint32_t rowStart = dirtyRowsOnly ? dirtyRowStart : 0;
+        const uint32_t rowEnd = dirtyRowsOnly ? dirtyRowEnd : height;
+        uint32_t differentPixels = nativeTarget.copyFromRAM(worker, fbChange, width, height, 0, rowStart, rowEnd, siz, fmt, nativeSwappedRAM.data(), false, shaderLibrary);
+        return differentPixels;
+    }
+
     uint32_t Framebuffer::copyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, uint8_t fmt, bool invalidateTargets, const ShaderLibrary *shaderLibrary) {
         assert(worker != nullptr);
         assert(src != nullptr);
@@ -81,17 +214,12 @@ namespace RT64 {
             nativeSwappedRAM.resize(nativeSize);
         }
 
-        const uint32_t *srcWords = reinterpret_cast<const uint32_t *>(src);
-        uint32_t *dstWords = reinterpret_cast<uint32_t *>(nativeSwappedRAM.data());
-        uint32_t wordsToSwap = nativeSize / sizeof(uint32_t);
-        while (wordsToSwap > 0) {
-            *dstWords = _byteswap_ulong(*srcWords);
-            wordsToSwap--;
-            srcWords++;
-            dstWords++;
-        }
+        swapRAMToNative(src, 0, nativeSize);
+
+        // The native copy no longer matches the contents of the framebuffer in RDRAM.
+        nativeSwappedValid = false;
 
-        uint32_t differentPixels = nativeTarget.copyFromRAM(worker, fbChange, width, rowCount, rowStart, siz, fmt, nativeSwappedRAM.data(), invalidateTargets, shaderLibrary);
+        uint32_t differentPixels = nativeTarget.copyFromRAM(worker, fbChange, width, rowCount, rowStart, 0, rowCount, siz, fmt, nativeSwappedRAM.data(), invalidateTargets, shaderLibrary);
         return differentPixels;
     }
 
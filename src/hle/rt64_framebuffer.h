@@ -37,7 +37,16 @@ namespace RT64 {
         uint64_t lastWriteTimestamp;
         uint32_t modifiedBytes;
         uint32_t RAMBytes;
-        uint64_t RAMHash;
+        std::vector<uint64_t> RAMBlockHashes;
+        uint32_t RAMBlockBytes;
+        uint32_t RAMBlockHashedBytes;
+        std::vector<uint64_t> RAMBlockPendingHashes;
+        uint32_t RAMBlockPendingBytes;
+        uint32_t RAMBlockPendingHashedBytes;
+        bool RAMBlockPendingValid;
+        uint32_t dirtyRowStart;
+        uint32_t dirtyRowEnd;
+        bool nativeSwappedValid;
         std::array<uint32_t, 4> ditherPatterns;
         bool widthChanged;
         bool sizChanged;
@@ -52,6 +61,13 @@ namespace RT64 {
         bool overlaps(uint32_t start, uint32_t end) const;
         void discardLastWrite();
         bool isLastWriteDifferent(Framebuffer::Type newType) const;
+        uint32_t blockRowCount() const;
+        bool checkRAMBlocks(const uint8_t *fbRAM, bool updateHashes);
+        void commitRAMBlocks();
+        void hashRAMBlocks(const uint8_t *fbRAM);
+        void swapRAMToNative(const uint8_t *src, uint32_t byteStart, uint32_t byteEnd);
+        bool swapDirtyRAMToNative(const uint8_t *fbRAM);
+        uint32_t copyDirtyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *fbRAM, uint8_t fmt, const ShaderLibrary *shaderLibrary);
         uint32_t copyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, uint8_t fmt, bool invalidateTargets, const ShaderLibrary *shaderLibrary);
         FramebufferChange *readChangeFromBytes(RenderWorker *worker, FramebufferChangePool &fbChangePool, Type type, uint8_t fmt, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, const ShaderLibrary *shaderLibrary);
         FramebufferChange *readChangeFromStorage(RenderWorker *worker, const FramebufferStorage &fbStorage, FramebufferChangePool &fbChangePool, Type type, uint8_t fmt,
@@ -783,13 +783,8 @@ namespace RT64 {
         auto it = framebuffers.begin();
         while (it != framebuffers.end()) {
             const uint8_t *fbRAM = &RDRAM[it->first];
-            uint64_t currentHash = XXH3_64bits(fbRAM, it->second.RAMBytes);
-            if (currentHash != it->second.RAMHash) {
+            if (it->second.checkRAMBlocks(fbRAM, updateHashes)) {
                 differentFbs.push_back(&it->second);
-
-                if (updateHashes) {
-                    it->second.RAMHash = currentHash;
-                }
             }
 
             it++;
@@ -812,7 +807,7 @@ namespace RT64 {
             FramebufferChange &fbChange = fbChangePool.use(renderWorker, fbChangeType, fb->width, fb->height, shaderLibrary->usesHDR);
             const uint32_t DifferenceFractionNum = 1;
             const uint32_t DifferenceFractionDiv = 4;
-            const uint32_t differentPixels = fb->copyRAMToNativeAndChanges(renderWorker, fbChange, fbRAM, 0, fb->height, fb->lastWriteFmt, false, shaderLibrary);
+            const uint32_t differentPixels = fb->copyDirtyRAMToNativeAndChanges(renderWorker, fbChange, fbRAM, fb->lastWriteFmt, shaderLibrary);
             const uint32_t differentBytes = differentPixels << fb->siz >> 1;
             fb->modifiedBytes += differentBytes;
 
@@ -846,7 +841,7 @@ namespace RT64 {
         auto it = framebuffers.begin();
         while (it != framebuffers.end()) {
             if ((it->second.maxHeight > 0) && (it->second.RAMBytes > 0)) {
-                it->second.RAMHash = XXH3_64bits(&RDRAM[it->first], it->second.RAMBytes);
+                it->second.hashRAMBlocks(&RDRAM[it->first]);
             }
 
             it++;
@@ -391,8 +391,8 @@ namespace RT64 {
             return;
         }
 
-        thread_local std::multimap<uint64_t, GameCallMap> curCallHashMap;
-        thread_local std::multimap<uint64_t, GameCallMap> prevCallHashMap;
+        thread_local FlatMultimap<uint64_t, GameCallMap> curCallHashMap;
+        thread_local FlatMultimap<uint64_t, GameCallMap> prevCallHashMap;
         curCallHashMap.clear();
         prevCallHashMap.clear();
 
@@ -411,7 +411,7 @@ namespace RT64 {
             firstPrevWorkloadMap = &prevFrame.frameMap.workloads[firstPrevProjIndices.workloadIndex];
         }
 
-        // Build a multimap with all potential compatibilities between draw calls in the projections.
+        // Build a map with all potential compatibilities between draw calls in the projections.
         uint32_t mappedViewProjIndex = UINT32_MAX;
         for (uint32_t p = 0; p < curScene.projections.size(); p++) {
             const GameIndices::Projection &curProjIndices = curScene.projections[p];
@@ -497,14 +497,17 @@ namespace RT64 {
             buildCallHashMap(p, prevWorkload, prevProj, prevCallHashMap);
         }
 
+        curCallHashMap.sort();
+        prevCallHashMap.sort();
+
         // FIXME: Transform set needs to be done per unique workload detected.
-        thread_local std::set<IndexPair> transformCheckSet;
-        thread_local std::set<IndexPair> tileCheckSet;
+        thread_local std::vector<IndexPair> transformCheckSet;
+        thread_local std::vector<IndexPair> tileCheckSet;
         transformCheckSet.clear();
         tileCheckSet.clear();
 
         // Traverse the map and fill the set with all the combinations of transforms to check.
-        for (std::pair<uint64_t, GameCallMap> curIt : curCallHashMap) {
+        for (const std::pair<uint64_t, GameCallMap> &curIt : curCallHashMap) {
             auto prevRange = prevCallHashMap.equal_range(curIt.first);
             for (auto prevIt = prevRange.first; prevIt != prevRange.second; prevIt++) {
                 const GameIndices::Projection &curProjIndices = curScene.projections[curIt.second.sceneProjIndex];
@@ -528,7 +531,7 @@ namespace RT64 {
                         const uint32_t prevGroupIndex = prevWorkload.drawData.worldTransformGroups[prevWorldMatrix];
                         const TransformGroup &prevGroup = prevWorkload.drawData.transformGroups[prevGroupIndex];
                         if ((curGroup.matrixId == prevGroup.matrixId) && ((curGroup.matrixId == G_EX_ID_AUTO) || ((curGroup.matrixId != G_EX_ID_IGNORE) && (curGroup.ordering == G_EX_ORDER_AUTO)))) {
-                            transformCheckSet.emplace(curWorldMatrix, prevWorldMatrix);
+                            transformCheckSet.emplace_back(curWorldMatrix, prevWorldMatrix);
                         }
                     }
                 }
@@ -541,12 +544,21 @@ namespace RT64 {
                             continue;
                         }
 
-                        tileCheckSet.emplace(curCall.callDesc.tileIndex + t, prevCall.callDesc.tileIndex + t);
+                        tileCheckSet.emplace_back(curCall.callDesc.tileIndex + t, prevCall.callDesc.tileIndex + t);
                     }
                 }
             }
         }
 
+        // Sort and remove the duplicates from the combinations so they're traversed in the same order as an ordered set.
+        auto sortUniquePairs = [](std::vector<IndexPair> &pairs) {
+            std::sort(pairs.begin(), pairs.end());
+            pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        };
+
+        sortUniquePairs(transformCheckSet);
+        sortUniquePairs(tileCheckSet);
+
         // Compute all the differences between transforms and insert them into a vector that will be sorted according to the differences.
         thread_local std::vector<MatchCandidate> matchCandidates;
         matchCandidates.clear();
@@ -699,7 +711,7 @@ namespace RT64 {
         }
     }
     
-    void GameFrame::buildCallHashMap(uint32_t sceneProjIndex, const Workload &workload, const Projection &proj, std::multimap<uint64_t, GameCallMap> &hashMap) const {
+    void GameFrame::buildCallHashMap(uint32_t sceneProjIndex, const Workload &workload, const Projection &proj, FlatMultimap<uint64_t, GameCallMap> &hashMap) const {
         for (uint32_t c = 0; c < proj.gameCallCount; c++) {
             const GameCall &call = proj.gameCalls[c];
             uint32_t matrixIdHash = 0;
@@ -719,7 +731,7 @@ namespace RT64 {
         }
     }
 
-    void GameFrame::buildTransformIdMap(const Workload &workload, std::multimap<uint32_t, uint32_t> &idMap, std::vector<uint32_t> &ignoredIdVector) const {
+    void GameFrame::buildTransformIdMap(const Workload &workload, FlatMultimap<uint32_t, uint32_t> &idMap, std::vector<uint32_t> &ignoredIdVector) const {
         idMap.clear();
         ignoredIdVector.clear();
 
@@ -737,6 +749,8 @@ namespace RT64 {
                 idMap.emplace(group.matrixId, i);
             }
         }
+
+        idMap.sort();
     }
 
     uint64_t GameFrame::hashFromCall(const GameCall &call, uint32_t matrixIdHash) const {
@@ -49,6 +49,21 @@ namespace RT64 {
         }
     }
 
+    void Interpreter::loadInstanceGBI(const GBIInstance *instance) {
+        assert(instance != nullptr);
+
+        hleGBI = gbiManager.getGBIForInstance(instance);
+        state->rsp->setGBI(hleGBI);
+
+        // Force the next microcode load to detect the GBI again.
+        UCode.textAddress = 0;
+        UCode.dataAddress = 0;
+
+        if (hleGBI->resetFromTask != nullptr) {
+            hleGBI->resetFromTask(state);
+        }
+    }
+
     void Interpreter::processRDPLists(uint32_t dlStartAdddress, DisplayList *dlStart, DisplayList *dlEnd) {
         state->dlCpuProfiler.start();
 
@@ -25,6 +25,9 @@ namespace RT64 {
         Interpreter();
         void setup(State *state);
         void loadUCodeGBI(uint32_t textAddress, uint32_t dataAddress, bool resetFromTask);
+
+        // Uses the GBI of the instance directly instead of detecting it from the microcode in RDRAM.
+        void loadInstanceGBI(const GBIInstance *instance);
         void processRDPLists(uint32_t dlStartAdddress, DisplayList* dlStart, DisplayList* dlEnd);
         void processDisplayLists(uint32_t dlStartAdddress, DisplayList *dlStart);
     };
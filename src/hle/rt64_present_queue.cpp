@@ -12,64 +12,34 @@
 namespace RT64 {
     // PresentQueue
 
-    PresentQueue::PresentQueue() {
+    PresentQueue::PresentQueue(uint32_t depth) : presents(depth) {
         reset();
     }
 
     PresentQueue::~PresentQueue() {
         presentThreadRunning = false;
-        cursorCondition.notify_all();
+        ring.notify();
 
         if (presentThread != nullptr) {
             presentThread->join();
             delete presentThread;
         }
 
-        presentIdCondition.notify_all();
+        presentIdWaiter.notify();
     }
 
     void PresentQueue::reset() {
-        threadCursor = 0;
-        writeCursor = 0;
-        barrierCursor = 0;
+        ring.reset(uint32_t(presents.size()), 0);
         presentId = 0;
     }
 
     void PresentQueue::advanceToNextPresent() {
-        int nextWriteCursor = (writeCursor + 1) % presents.size();
-
-        // Stall the thread until the barrier is lifted if we're trying to write on a present being used by the GPU.
-        bool waitForBarrier;
-        do {
-            const std::scoped_lock lock(cursorMutex);
-            waitForBarrier = (nextWriteCursor == barrierCursor);
-        } while (waitForBarrier);
-
-        // Modify the cursor and notify anything waiting on the queue.
-        {
-            const std::scoped_lock lock(cursorMutex);
-            writeCursor = nextWriteCursor;
-        }
-
-        cursorCondition.notify_all();
+        // Stalls the thread until the barrier is lifted if we're trying to write on a present being used by the GPU.
+        ring.advanceWriteCursor();
     }
 
     void PresentQueue::repeatLastPresent() {
-        {
-            const std::scoped_lock lock(cursorMutex);
-            threadCursor = previousWriteCursor();
-        }
-
-        cursorCondition.notify_all();
-    }
-
-    uint32_t PresentQueue::previousWriteCursor() const {
-        if (writeCursor > 0) {
-            return writeCursor - 1;
-        }
-        else {
-            return uint32_t(presents.size()) - 1;
-        }
+        ring.repeatLast();
     }
 
     void PresentQueue::waitForIdle() {
@@ -77,8 +47,7 @@ namespace RT64 {
     }
 
     void PresentQueue::waitForPresentId(uint64_t waitId) {
-        std::unique_lock<std::mutex> presentLock(presentIdMutex);
-        presentIdCondition.wait(presentLock, [&]() {
+        presentIdWaiter.wait([&]() {
             return (waitId <= presentId) || !presentThreadRunning;
         });
     }
@@ -87,6 +56,7 @@ namespace RT64 {
         this->ext = ext;
 
         viRenderer = std::make_unique<VIRenderer>();
+        gpuProfiler.setup(ext.device);
 
         presentThreadRunning = true;
         presentThread = new std::thread(&PresentQueue::threadLoop, this);
@@ -307,10 +277,13 @@ namespace RT64 {
                 RenderFramebuffer *swapChainFramebuffer = swapChainFramebuffers[swapChainIndex].get();
                 RenderCommandList *commandList = ext.presentGraphicsWorker->commandList.get();
                 commandList->begin();
+                gpuProfiler.begin(commandList);
+                gpuProfiler.beginPass(commandList, "Present");
                 commandList->barriers(RenderBarrierStage::GRAPHICS, RenderTextureBarrier(swapChainTexture, RenderTextureLayout::COLOR_WRITE));
                 
                 VIRenderer::RenderParams renderParams;
                 if (colorTarget != nullptr) {
+                    GPUProfilerScope profilerScope(&gpuProfiler, commandList, "Target resolve");
                     renderParams.device = ext.device;
                     renderParams.commandList = commandList;
                     renderParams.swapChain = ext.swapChain;
@@ -341,6 +314,7 @@ namespace RT64 {
                 commandList->clearColor();
 
                 if (renderParams.texture != nullptr) {
+                    GPUProfilerScope profilerScope(&gpuProfiler, commandList, "VI");
                     commandList->barriers(RenderBarrierStage::GRAPHICS, RenderTextureBarrier(renderParams.texture, RenderTextureLayout::SHADER_READ));
                     viRenderer->render(renderParams);
                 }
@@ -353,16 +327,20 @@ namespace RT64 {
                 {
                     const std::scoped_lock lock(inspectorMutex);
                     if (inspector != nullptr) {
+                        GPUProfilerScope profilerScope(&gpuProfiler, commandList, "Inspector");
                         inspector->draw(commandList);
                     }
                     
                     commandList->barriers(RenderBarrierStage::NONE, RenderTextureBarrier(swapChainTexture, RenderTextureLayout::PRESENT));
+                    gpuProfiler.endPass(commandList);
+                    gpuProfiler.end(commandList);
                     commandList->end();
                     const RenderCommandList *commandList = ext.presentGraphicsWorker->commandList.get();
                     RenderCommandSemaphore *waitSemaphore = acquiredSemaphore.get();
                     RenderCommandSemaphore *signalSemaphore = drawSemaphore.get();
                     ext.presentGraphicsWorker->commandQueue->executeCommandLists(&commandList, 1, &waitSemaphore, 1, &signalSemaphore, 1, ext.presentGraphicsWorker->commandFence.get());
                     ext.presentGraphicsWorker->wait();
+                    gpuProfiler.log();
                 }
             }
 
@@ -424,12 +402,8 @@ namespace RT64 {
     }
 
     void PresentQueue::notifyPresentId(const Present &present) {
-        {
-            std::scoped_lock<std::mutex> cursorLock(presentIdMutex);
-            presentId = present.presentId;
-        }
-
-        presentIdCondition.notify_all();
+        presentId = present.presentId;
+        presentIdWaiter.notify();
     }
 
     bool PresentQueue::detectPresentWait() {
@@ -453,8 +427,7 @@ namespace RT64 {
     }
     
     void PresentQueue::threadAdvanceBarrier() {
-        std::scoped_lock<std::mutex> cursorLock(cursorMutex);
-        barrierCursor = (barrierCursor + 1) % presents.size();
+        ring.advanceBarrier();
     }
 
     void PresentQueue::threadLoop() {
@@ -473,17 +446,10 @@ namespace RT64 {
         const bool displayTiming = ext.device->getCapabilities().displayTiming;
         bool swapChainValid = !ext.swapChain->needsResize();
         while (presentThreadRunning) {
-            {
-                std::unique_lock<std::mutex> cursorLock(cursorMutex);
-                cursorCondition.wait(cursorLock, [&]() {
-                    return (writeCursor != threadCursor) || !presentThreadRunning;
-                });
-
-                if (presentThreadRunning) {
-                    processCursor = threadCursor;
-                    threadCursor = (threadCursor + 1) % presents.size();
-                    skipPresent = (writeCursor != threadCursor);
-                }
+            uint32_t claimedCursor = 0;
+            if (ring.claim(presentThreadRunning, claimedCursor)) {
+                processCursor = int(claimedCursor);
+                skipPresent = ring.hasPending();
             }
 
             if (processCursor >= 0) {
@@ -5,15 +5,15 @@
 #pragma once
 
 #include "common/rt64_profiling_timer.h"
+#include "common/rt64_spsc_ring.h"
 #include "gui/rt64_inspector.h"
+#include "render/rt64_gpu_profiler.h"
 #include "render/rt64_vi_renderer.h"
 
 #include "rt64_application_window.h"
 #include "rt64_present.h"
 #include "rt64_shared_queue_resources.h"
 
-#define PRESENT_QUEUE_SIZE 4
-
 namespace RT64 {
     struct WorkloadQueue;
 
@@ -30,15 +30,10 @@ namespace RT64 {
         };
 
         External ext;
-        std::array<Present, PRESENT_QUEUE_SIZE> presents;
-        int threadCursor;
-        int writeCursor;
-        int barrierCursor;
-        std::mutex cursorMutex;
-        std::condition_variable cursorCondition;
-        uint64_t presentId;
-        std::mutex presentIdMutex;
-        std::condition_variable presentIdCondition;
+        std::vector<Present> presents;
+        SPSCRing ring;
+        std::atomic<uint64_t> presentId;
+        AtomicWaiter presentIdWaiter;
         std::thread *presentThread = nullptr;
         std::mutex threadMutex;
         std::atomic<bool> presentThreadRunning = false;
@@ -54,16 +49,16 @@ namespace RT64 {
         std::unique_ptr<VIRenderer> viRenderer;
         std::unique_ptr<Inspector> inspector;
         ProfilingTimer presentProfiler = ProfilingTimer(120);
+        GPUProfiler gpuProfiler;
         Timestamp presentTimestamp;
         VIHistory viHistory;
         bool presentWaitEnabled = false;
 
-        PresentQueue();
+        PresentQueue(uint32_t depth);
         ~PresentQueue();
         void reset();
         void advanceToNextPresent();
         void repeatLastPresent();
-        uint32_t previousWriteCursor() const;
         void waitForIdle();
         void waitForPresentId(uint64_t waitId);
         void setup(const External &ext);
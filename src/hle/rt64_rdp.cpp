@@ -120,7 +120,7 @@ namespace RT64 {
             state->flush();
             state->submitFramebufferPair(colorImage.changed ? FramebufferPair::FlushReason::ColorImageChanged : FramebufferPair::FlushReason::DepthImageChanged);
 
-            const int workloadCursor = state->ext.workloadQueue->writeCursor;
+            const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
             Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
             workload.addFramebufferPair(colorImage.address, colorImage.fmt, colorImage.siz, colorImage.width, depthImage.address);
             colorImage.changed = false;
@@ -171,7 +171,7 @@ namespace RT64 {
     }
     
     void RDP::checkImageOverlap(uint32_t addressStart, uint32_t addressEnd) {
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         FramebufferPair &fbPair = workload.fbPairs[workload.currentFramebufferPairIndex()];
         const FixedRect colorRect = fbPair.drawColorRect;
@@ -579,7 +579,7 @@ namespace RT64 {
         assert(((t.siz != G_IM_SIZ_32b) || (t.fmt == G_IM_FMT_RGBA)) && "Other 32-bit formats than RGBA32 are not currently supported.");
 #   endif
 
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         const bool warningsEnabled = state->ext.userConfig->developerMode;
         if (warningsEnabled) {
@@ -707,7 +707,7 @@ namespace RT64 {
 #   endif
 
         // Check for warnings in developer mode.
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         const bool warningsEnabled = state->ext.userConfig->developerMode;
         if (warningsEnabled) {
@@ -758,7 +758,7 @@ namespace RT64 {
 #   endif
         
         // Check for warnings in developer mode.
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         const bool warningsEnabled = state->ext.userConfig->developerMode;
         if (warningsEnabled) {
@@ -1060,7 +1060,7 @@ namespace RT64 {
         checkFramebufferPair();
 
         // Change projection to triangles.
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         FramebufferPair &fbPair = workload.fbPairs[workload.currentFramebufferPairIndex()];
         if (!fbPair.inProjection(0, Projection::Type::Triangle)) {
@@ -1145,7 +1145,7 @@ namespace RT64 {
         state->flush();
 
         // Change projection to rectangle.
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         FramebufferPair &fbPair = workload.fbPairs[workload.currentFramebufferPairIndex()];
         if (!fbPair.inProjection(0, Projection::Type::Rectangle)) {
@@ -1284,7 +1284,7 @@ namespace RT64 {
     }
 
     void RDP::updateCallTexcoords(float u, float v) {
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         for (uint32_t t = 0; t < state->drawCall.tileCount; t++) {
             DrawCallTile &callTile = workload.drawData.callTiles[state->drawCall.tileIndex + t];
@@ -17,8 +17,7 @@ namespace RT64 {
     // TextureManager
 
     void TextureManager::uploadEmpty(State *state, TextureCache *textureCache, uint64_t creationFrame, uint16_t width, uint16_t height, uint64_t replacementHash) {
-        if (hashSet.find(replacementHash) == hashSet.end()) {
-            hashSet.insert(replacementHash);
+        if (hashSet.insert(replacementHash)) {
             textureCache->queueGPUUploadTMEM(replacementHash, creationFrame, nullptr, 0, width, height, 0, LoadTile(), false);
         }
     }
@@ -31,8 +30,7 @@ namespace RT64 {
         XXH3_64bits_update(&xxh3, &byteOffset, sizeof(byteOffset));
         XXH3_64bits_update(&xxh3, &byteCount, sizeof(byteCount));
         const uint64_t hash = XXH3_64bits_digest(&xxh3);
-        if (hashSet.find(hash) == hashSet.end()) {
-            hashSet.insert(hash);
+        if (hashSet.insert(hash)) {
             textureCache->queueGPUUploadTMEM(hash, creationFrame, TMEM, RDP_TMEM_BYTES, width, height, 0, LoadTile(), false);
         }
         
@@ -52,8 +50,7 @@ namespace RT64 {
     uint64_t TextureManager::uploadTexture(State *state, const LoadTile &loadTile, TextureCache *textureCache, uint64_t creationFrame, uint16_t width, uint16_t height, uint32_t tlut) {
         const uint8_t *TMEM = reinterpret_cast<const uint8_t *>(state->rdp->TMEM);
         uint64_t hash = TMEMHasher::hash(TMEM, loadTile, width, height, tlut, TMEMHasher::CurrentHashVersion);
-        if (hashSet.find(hash) == hashSet.end()) {
-            hashSet.insert(hash);
+        if (hashSet.insert(hash)) {
             textureCache->queueGPUUploadTMEM(hash, creationFrame, TMEM, RDP_TMEM_BYTES, width, height, tlut, loadTile, true);
         }
 
@@ -66,23 +63,25 @@ namespace RT64 {
     }
 
     void TextureManager::dumpTexture(uint64_t hash, State *state, const LoadTile &loadTile, uint16_t width, uint16_t height, uint32_t tlut) {
-        if (dumpedSet.find(hash) != dumpedSet.end()) {
+        // Insert into set regardless of whether the dump is successful or not.
+        if (!dumpedSet.insert(hash)) {
             return;
         }
-
-        // Insert into set regardless of whether the dump is successful or not.
-        dumpedSet.insert(hash);
         
-        // Dump the entirety of TMEM.
+        // Only copy the memory snapshots here. The files are written by the dumper's thread.
+        std::unique_ptr<TextureDumper::Job> job = dumper.acquireJob();
         char baseName[64];
         snprintf(baseName, sizeof(baseName), "%016" PRIx64 ".v%u", hash, TMEMHasher::CurrentHashVersion);
-        std::filesystem::path dumpTmemPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".tmem");
-        std::ofstream dumpTmemStream(dumpTmemPath, std::ios::binary);
-        if (dumpTmemStream.is_open()) {
-            const char *TMEM = reinterpret_cast<const char *>(state->rdp->TMEM);
-            dumpTmemStream.write(TMEM, RDP_TMEM_BYTES);
-            dumpTmemStream.close();
-        }
+        job->directory = state->dumpingTexturesDirectory;
+        job->baseName = baseName;
+        job->archive = dumpToArchive;
+        job->loadTile = loadTile;
+        job->width = width;
+        job->height = height;
+
+        // Dump the entirety of TMEM.
+        const uint8_t *TMEM = reinterpret_cast<const uint8_t *>(state->rdp->TMEM);
+        job->tmemBytes.assign(TMEM, TMEM + RDP_TMEM_BYTES);
 
         // Dump the RDRAM last loaded into the TMEM address pointed to by the tile. Required for generating hashes used by Rice.
         const LoadOperation &loadOp = state->rdp->rice.lastLoadOpByTMEM[loadTile.tmem];
@@ -110,28 +109,13 @@ namespace RT64 {
         uint32_t loadTileBpr = width << loadTile.siz >> 1;
         rdramCount = std::max(rdramCount, std::max(loadTileBpr, commonBytesPerRow) * height);
 
-        if (rdramCount > 0) {
-            std::filesystem::path dumpRdramPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.rdram");
-            std::ofstream dumpRdramStream(dumpRdramPath, std::ios::binary);
-            if (dumpRdramStream.is_open()) {
-                const char *RDRAM = reinterpret_cast<const char *>(state->RDRAM);
-                dumpRdramStream.write(&RDRAM[rdramStart], rdramCount);
-                dumpRdramStream.close();
-            }
-
-            std::filesystem::path dumpRdramInfoPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.json");
-            std::ofstream dumpRdramInfoStream(dumpRdramInfoPath);
-            if (dumpRdramInfoStream.is_open()) {
-                json jroot;
-                jroot["tile"] = loadOp.tile;
-                jroot["type"] = loadOp.type;
-                jroot["texture"] = loadOp.texture;
-                dumpRdramInfoStream << std::setw(4) << jroot << std::endl;
-                dumpRdramInfoStream.close();
-            }
-        }
+        job->dumpRdram = (rdramCount > 0);
+        job->loadOp = loadOp;
+        job->rdramBytes.assign(&state->RDRAM[rdramStart], &state->RDRAM[rdramStart] + rdramCount);
         
         // Repeat a similar process for dumping the palette.
+        job->dumpPalette = (tlut > 0);
+        job->paletteRdramBytes.clear();
         if (tlut > 0) {
             const bool CI4 = (loadTile.siz == G_IM_SIZ_4b);
             const int32_t paletteTMEM = (RDP_TMEM_WORDS >> 1) + (CI4 ? (loadTile.palette << 4) : 0);
@@ -142,51 +126,22 @@ namespace RT64 {
             const uint32_t wordsPerRow = ((paletteLoadOp.tile.lrs >> 2) - (paletteLoadOp.tile.uls >> 2)) + 1;
             uint32_t paletteRdramStart = paletteLoadOp.texture.address + paletteBytesOffset + paletteBytesPerRow * (paletteLoadOp.tile.ult >> 2);
             uint32_t paletteRdramCount = (rowCount - 1) * paletteBytesPerRow + (wordsPerRow << 3);
-            if (paletteRdramCount > 0) {
-                std::filesystem::path dumpPaletteRdramPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.palette.rdram");
-                std::ofstream dumpPaletteRdramStream(dumpPaletteRdramPath, std::ios::binary);
-                if (dumpPaletteRdramStream.is_open()) {
-                    const char *RDRAM = reinterpret_cast<const char *>(state->RDRAM);
-                    dumpPaletteRdramStream.write(&RDRAM[paletteRdramStart], paletteRdramCount);
-                    dumpPaletteRdramStream.close();
-                }
-            }
-
-            std::filesystem::path dumpPaletteRdramInfoPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.palette.json");
-            std::ofstream dumpPaletteRdramInfoStream(dumpPaletteRdramInfoPath);
-            if (dumpPaletteRdramInfoStream.is_open()) {
-                json jroot;
-                jroot["tile"] = paletteLoadOp.tile;
-                jroot["type"] = paletteLoadOp.type;
-                jroot["texture"] = paletteLoadOp.texture;
-                dumpPaletteRdramInfoStream << std::setw(4) << jroot << std::endl;
-                dumpPaletteRdramInfoStream.close();
-            }
+            job->paletteLoadOp = paletteLoadOp;
+            job->paletteRdramBytes.assign(&state->RDRAM[paletteRdramStart], &state->RDRAM[paletteRdramStart] + paletteRdramCount);
         }
 
-        // Dump the parameters of the tile into a JSON file.
-        std::filesystem::path dumpTilePath = state->dumpingTexturesDirectory / (std::string(baseName) + ".tile.json");
-        std::ofstream dumpTileStream(dumpTilePath);
-        if (dumpTileStream.is_open()) {
-            json jroot;
-            jroot["tile"] = loadTile;
-            jroot["width"] = width;
-            jroot["height"] = height;
-
-            // Serialize the TLUT into an enum instead.
-            if (tlut == G_TT_RGBA16) {
-                jroot["tlut"] = LoadTLUT::RGBA16;
-            }
-            else if (tlut == G_TT_IA16) {
-                jroot["tlut"] = LoadTLUT::IA16;
-            }
-            else {
-                jroot["tlut"] = LoadTLUT::None;
-            }
-
-            dumpTileStream << std::setw(4) << jroot << std::endl;
-            dumpTileStream.close();
+        // Serialize the TLUT into an enum instead.
+        if (tlut == G_TT_RGBA16) {
+            job->tlut = LoadTLUT::RGBA16;
+        }
+        else if (tlut == G_TT_IA16) {
+            job->tlut = LoadTLUT::IA16;
         }
+        else {
+            job->tlut = LoadTLUT::None;
+        }
+
+        dumper.submitJob(std::move(job));
     }
 
     void TextureManager::removeHashes(const std::vector<uint64_t> &hashes) {
@@ -6,15 +6,19 @@
 
 #include <set>
 
+#include "common/rt64_flat_hash_map.h"
 #include "hle/rt64_draw_call.h"
+#include "hle/rt64_texture_dumper.h"
 #include "render/rt64_texture_cache.h"
 
 namespace RT64 {
     struct State;
 
     struct TextureManager {
-        std::set<uint64_t> hashSet;
-        std::set<uint64_t> dumpedSet;
+        FlatHashSet hashSet;
+        FlatHashSet dumpedSet;
+        TextureDumper dumper;
+        bool dumpToArchive = false;
 
         void uploadEmpty(State *state, TextureCache *textureCache, uint64_t creationFrame, uint16_t width, uint16_t height, uint64_t replacementHash);
         uint64_t uploadTMEM(State *state, const LoadTile &loadTile, TextureCache *textureCache, uint64_t creationFrame, uint16_t byteOffset, uint16_t byteCount, uint16_t width, uint16_t height, uint32_t tlut);
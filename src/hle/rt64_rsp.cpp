@@ -320,6 +320,11 @@ namespace RT64 {
         const Vertex *dlVerts = reinterpret_cast<const Vertex *>(state->fromRDRAM(rdramAddress));
         memcpy(&vertices[dstIndex], dlVerts, sizeof(Vertex) * vtxCount);
         setVertexCommon<true>(dstIndex, dstIndex + vtxCount);
+
+        // Vertices loaded directly from RDRAM can be reused from the geometry cache if the same load was done before.
+        if (state->ext.userConfig->geometryCache) {
+            state->geometryCache->addVertices(rdramAddress, dlVerts, sizeof(Vertex) * vtxCount, vtxCount, indices[dstIndex]);
+        }
     }
     
     void RSP::setVertexPD(uint32_t address, uint8_t vtxCount, uint32_t dstIndex) {
@@ -354,7 +359,7 @@ namespace RT64 {
             return;
         }
 
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         const uint32_t rdramAddress = fromSegmentedMasked(address);
         const VertexEXV1 *dlVerts = reinterpret_cast<const VertexEXV1 *>(state->fromRDRAM(rdramAddress));
@@ -386,7 +391,7 @@ namespace RT64 {
     }
     
     void RSP::addCurrentProjection(Projection::Type type) {
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         if (extended.viewProjMatrixIdStackChanged) {
             extended.curViewProjMatrixIdGroupIndex = int(workload.drawData.transformGroups.size());
@@ -417,7 +422,7 @@ namespace RT64 {
 
     template<bool addEmptyVelocity>
     void RSP::setVertexCommon(uint8_t dstIndex, uint8_t dstMax) {
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
 
         if (extended.modelMatrixIdStackChanged) {
@@ -644,7 +649,7 @@ namespace RT64 {
         }
 
         // If the vertex was used already in the frame, then we create a new copy instead.
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         auto &normColBytes = workload.drawData.normColBytes;
         auto &tcFloats = workload.drawData.tcFloats;
@@ -690,6 +695,7 @@ namespace RT64 {
         // Modify the attributes.
         switch (dstAttribute) {
         case G_MWO_POINT_RGBA: {
+            state->geometryCache->invalidateVertex(globalIndex);
             normColBytes[globalIndex * 4 + 0] = (value >> 24) & 0xFF;
             normColBytes[globalIndex * 4 + 1] = (value >> 16) & 0xFF;
             normColBytes[globalIndex * 4 + 2] = (value >> 8) & 0xFF;
@@ -736,7 +742,7 @@ namespace RT64 {
     
     void RSP::branchZ(uint32_t branchDl, uint16_t vtxIndex, uint32_t zValue, DisplayList **dl) {
         const bool forceBranch = state->ext.enhancementConfig->f3dex.forceBranch || extended.forceBranch;
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         const Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         const uint32_t globalIndex = indices[vtxIndex];
         const float screenZ = workload.drawData.posScreen[globalIndex][2] * DepthRange;
@@ -749,7 +755,7 @@ namespace RT64 {
 
     void RSP::branchW(uint32_t branchDl, uint16_t vtxIndex, uint32_t wValue, DisplayList **dl) {
         const bool forceBranch = state->ext.enhancementConfig->f3dex.forceBranch || extended.forceBranch;
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         const Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         const uint32_t globalIndex = indices[vtxIndex];
         const float posW = workload.drawData.posTransformed[globalIndex][3];
@@ -953,7 +959,7 @@ namespace RT64 {
         state->rdp->checkFramebufferPair();
         
         // We must add the current projection again if we're not in the right state.
-        const int workloadCursor = state->ext.workloadQueue->writeCursor;
+        const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
         FramebufferPair &fbPair = workload.fbPairs[workload.currentFramebufferPairIndex()];
         const Projection::Type projType = getCurrentProjectionType();
@@ -1100,12 +1106,10 @@ namespace RT64 {
 
         if (idIsAddress && editGroup) {
             const uint32_t rdramAddress = fromSegmentedMasked(id);
-            const int workloadCursor = state->ext.workloadQueue->writeCursor;
+            const int workloadCursor = state->ext.workloadQueue->ring.writeCursor;
             Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
 
-            auto range = workload.physicalAddressTransformMap.equal_range(rdramAddress);
-            for (auto it = range.first; it != range.second; it++) {
-                uint32_t matrix_id = it->second;
+            workload.physicalAddressTransformMap.forEach(rdramAddress, [&](uint32_t matrix_id) {
                 if (proj && (matrix_id < workload.drawData.viewProjTransformGroups.size())) {
                     uint32_t groupIndex = workload.drawData.viewProjTransformGroups[matrix_id];
                     setGroupProperties(&workload.drawData.transformGroups[groupIndex], false);
@@ -1114,7 +1118,7 @@ namespace RT64 {
                     uint32_t groupIndex = workload.drawData.worldTransformGroups[matrix_id];
                     setGroupProperties(&workload.drawData.transformGroups[groupIndex], false);
                 }
-            }
+            });
         }
         else {
             auto &stack = proj ? extended.viewProjMatrixIdStack : extended.modelMatrixIdStack;
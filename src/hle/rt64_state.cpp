@@ -28,6 +28,9 @@
 #define MI_INTR_SP          0x00000001
 
 namespace RT64 {
+    // Amount of vertices the geometry cache can keep resident before it starts over.
+    static const uint32_t GeometryCacheVertexCapacity = 512 * 1024;
+
     const float ShiftScaleMap[] = {
         1.0f,
         1.0f / 2.0f,
@@ -70,8 +73,9 @@ namespace RT64 {
         this->ext = ext;
 
         rspProcessor = std::make_unique<RSPProcessor>(ext.device);
-        framebufferRenderer = std::make_unique<FramebufferRenderer>(ext.framebufferGraphicsWorker, false, ext.createdGraphicsAPI, ext.shaderLibrary);
+        framebufferRenderer = std::make_unique<FramebufferRenderer>(ext.framebufferGraphicsWorker, false, ext.createdGraphicsAPI, ext.shaderLibrary, ext.stagingRing, ext.taskScheduler);
         renderFramebufferManager = std::make_unique<RenderFramebufferManager>(ext.device);
+        geometryCache = std::make_unique<GeometryCache>(ext.device, GeometryCacheVertexCapacity);
 
         const RenderMultisampling multisampling = RasterShader::generateMultisamplingPattern(ext.userConfig->msaaSampleCount(), ext.device->getCapabilities().sampleLocations);
         renderTargetManager.setMultisampling(multisampling);
@@ -93,6 +97,9 @@ namespace RT64 {
         rsp->reset();
         rdp->reset();
         resetDrawCall();
+
+        // Make sure all texture dumps queued before the reset are written to disk.
+        textureManager.dumper.flush();
     }
 
     void State::resetDrawCall() {
@@ -237,7 +244,7 @@ namespace RT64 {
                 }
             }
 
-            const int workloadCursor = ext.workloadQueue->writeCursor;
+            const int workloadCursor = ext.workloadQueue->ring.writeCursor;
             Workload &workload = ext.workloadQueue->workloads[workloadCursor];
             if (drawCall.tileCount > 0) {
                 DrawData &drawData = workload.drawData;
@@ -442,7 +449,7 @@ namespace RT64 {
         }
 
         // Assign some parameters to the draw call.
-        const int workloadCursor = ext.workloadQueue->writeCursor;
+        const int workloadCursor = ext.workloadQueue->ring.writeCursor;
         Workload &workload = ext.workloadQueue->workloads[workloadCursor];
         FramebufferPair &fbPair = workload.fbPairs[workload.currentFramebufferPairIndex()];
         drawCall.cullBothMask = rsp->cullBothMask;
@@ -506,7 +513,7 @@ namespace RT64 {
     }
     
     void State::submitFramebufferPair(FramebufferPair::FlushReason flushReason) {
-        const int workloadCursor = ext.workloadQueue->writeCursor;
+        const int workloadCursor = ext.workloadQueue->ring.writeCursor;
         Workload &workload = ext.workloadQueue->workloads[workloadCursor];
 
         // Ignore if the amount of framebuffer pairs isn't bigger than the amount of framebuffer pairs submitted.
@@ -598,7 +605,7 @@ namespace RT64 {
         assert(drawFbOperations.empty() && "There should be no pending framebuffer operations when this is started.");
         assert(drawFbDiscards.empty() && "There should be no pending framebuffer discards when this is started.");
 
-        const int workloadCursor = ext.workloadQueue->writeCursor;
+        const int workloadCursor = ext.workloadQueue->ring.writeCursor;
         Workload &workload = ext.workloadQueue->workloads[workloadCursor];
         const uint32_t fbPairIndex = workload.currentFramebufferPairIndex();
         {
@@ -741,7 +748,7 @@ namespace RT64 {
         submitFramebufferPair(FramebufferPair::FlushReason::ProcessDisplayListsEnd);
 
         // Append any framebuffer operations to the end of the last framebuffer pair.
-        int workloadCursor = ext.workloadQueue->writeCursor;
+        int workloadCursor = ext.workloadQueue->ring.writeCursor;
         Workload &workload = ext.workloadQueue->workloads[workloadCursor];
         if (hasFramebufferOperationsPending()) {
             // If no framebuffer pair is present to do this, we make a placeholder one with the current images.
@@ -1071,8 +1078,10 @@ namespace RT64 {
         workload.drawData.gpuTiles.resize(workload.drawData.callTiles.size());
 
         // Start uploading the entire draw data for all the framebuffer pairs that were processed.
+        thread_local std::vector<std::pair<size_t, size_t>> cachedVertexRanges;
+        geometryCache->submit(&workload.drawBuffers.positionBuffer, &workload.drawBuffers.normalColorBuffer, cachedVertexRanges);
         workload.updateDrawDataRanges();
-        workload.uploadDrawData(ext.framebufferGraphicsWorker, ext.drawDataUploader);
+        workload.uploadDrawData(ext.framebufferGraphicsWorker, ext.drawDataUploader, cachedVertexRanges);
         workload.updateOutputBuffers(ext.framebufferGraphicsWorker);
 
         // Upload the transforms directly.
@@ -1286,16 +1295,18 @@ namespace RT64 {
 
                 // Synchronize the draw data uploaders and the processors the first time.
                 RSPProcessor *queuedProcessor = nullptr;
+                GeometryCache *queuedGeometryCache = nullptr;
                 if (!firstSynchronizationPerformed) {
                     bufferUploaders.emplace_back(ext.drawDataUploader);
                     bufferUploaders.emplace_back(ext.transformsUploader);
                     queuedProcessor = rspProcessor.get();
+                    queuedGeometryCache = geometryCache.get();
                     firstSynchronizationPerformed = true;
                 }
 
                 // Record all setup previous to drawing any of the recorded framebuffers.
                 framebufferRenderer->endFramebuffers(ext.framebufferGraphicsWorker, &workload.drawBuffers, &workload.outputBuffers, false);
-                framebufferRenderer->recordSetup(ext.framebufferGraphicsWorker, bufferUploaders, queuedProcessor, nullptr, &workload.outputBuffers, false);
+                framebufferRenderer->recordSetup(ext.framebufferGraphicsWorker, bufferUploaders, queuedGeometryCache, queuedProcessor, nullptr, &workload.outputBuffers, false);
 
                 // Record the command list for the framebuffer pairs.
                 pairCursor = framebufferPairCursor;
@@ -1523,8 +1534,10 @@ namespace RT64 {
             ext.transformsUploader->commandListBeforeBarriers(ext.framebufferGraphicsWorker);
             ext.drawDataUploader->commandListCopyResources(ext.framebufferGraphicsWorker);
             ext.transformsUploader->commandListCopyResources(ext.framebufferGraphicsWorker);
+            geometryCache->commandListCopyResources(ext.framebufferGraphicsWorker);
             ext.drawDataUploader->commandListAfterBarriers(ext.framebufferGraphicsWorker);
             ext.transformsUploader->commandListAfterBarriers(ext.framebufferGraphicsWorker);
+            geometryCache->commandListFillResources(ext.framebufferGraphicsWorker);
             ext.framebufferGraphicsWorker->commandList->end();
             ext.drawDataUploader->wait();
             ext.transformsUploader->wait();
@@ -1535,7 +1548,7 @@ namespace RT64 {
 
         // Evict from the texture cache that are too old and should no longer be maintained.
         // The texture manager should also be notified of any hashes that were removed.
-        if (ext.textureCache->evict(workloadCounter, evictedTextureHashes)) {
+        if (ext.textureCache->evict(workloadCounter, ext.workloadQueue->ring.depth, evictedTextureHashes)) {
             textureManager.removeHashes(evictedTextureHashes);
         }
 
@@ -1574,7 +1587,7 @@ namespace RT64 {
         screenCpuProfiler.reset();
 
         // Inspect the current workload before submission.
-        lastWorkloadIndex = ext.workloadQueue->writeCursor;
+        lastWorkloadIndex = ext.workloadQueue->ring.writeCursor;
         if (ext.userConfig->developerMode) {
             inspect();
         }
@@ -1764,7 +1777,7 @@ namespace RT64 {
         }
 
         // Reset the next workload.
-        workloadCursor = ext.workloadQueue->writeCursor;
+        workloadCursor = ext.workloadQueue->ring.writeCursor;
         Workload &nextWorkload = ext.workloadQueue->workloads[workloadCursor];
         nextWorkload.begin(workloadCounter++);
 
@@ -1793,8 +1806,8 @@ namespace RT64 {
             ext.presentQueue->waitForIdle();
 
             // Re-submit the last workload and present to the queue.
-            Workload &lastWorkload = ext.workloadQueue->workloads[ext.workloadQueue->previousWriteCursor()];
-            Present &lastPresent = ext.presentQueue->presents[ext.presentQueue->previousWriteCursor()];
+            Workload &lastWorkload = ext.workloadQueue->workloads[ext.workloadQueue->ring.previousWriteCursor()];
+            Present &lastPresent = ext.presentQueue->presents[ext.presentQueue->ring.previousWriteCursor()];
             advanceWorkload(lastWorkload, true);
             advancePresent(lastPresent, true);
             ext.workloadQueue->repeatLastWorkload();
@@ -1805,7 +1818,7 @@ namespace RT64 {
             }
         }
         
-        const int presentCursor = ext.presentQueue->writeCursor;
+        const int presentCursor = ext.presentQueue->ring.writeCursor;
         Present &present = ext.presentQueue->presents[presentCursor];
         present.fbOperations.clear();
         present.storage.clear();
@@ -1851,8 +1864,7 @@ namespace RT64 {
                 // Ensure both the siz and width are the same.
                 if ((screenFbSize.x == screenFb->width) && (screenFbSiz == screenFb->siz)) {
                     const uint8_t *fbRAM = &RDRAM[screenFb->addressStart];
-                    uint64_t currentHash = XXH3_64bits(fbRAM, screenFb->RAMBytes);
-                    if (currentHash != screenFb->RAMHash) {
+                    if (screenFb->checkRAMBlocks(fbRAM, false)) {
                         {
                             RenderWorkerExecution workerExecution(worker);
                             thread_local std::vector<uint32_t> fbDiscards;
@@ -1865,12 +1877,13 @@ namespace RT64 {
                                 renderTargetManager, resolutionScale, 0, workloadCounter, nullptr);
                         }
 
-                        // Only update the hash if it's not a discard.
+                        // Only commit the hashes computed by the check if it's not a discard.
                         if (present.fbOperations.front().type == FramebufferOperation::Type::WriteChanges) {
-                            screenFb->RAMHash = currentHash;
+                            screenFb->commitRAMBlocks();
                             fbChangesMade = true;
                         }
                         else {
+                            screenFb->nativeSwappedValid = false;
                             present.fbOperations.clear();
                         }
                     }
@@ -2039,7 +2052,7 @@ namespace RT64 {
                     ImGui::Text("User Configuration (persistent)");
                     ImGui::Separator();
 
-                    genConfigChanged = ImGui::Combo("Graphics API", reinterpret_cast<int *>(&userConfig.graphicsAPI), "D3D12\0Vulkan\0Metal\0Automatic\0") || genConfigChanged;
+                    genConfigChanged = ImGui::Combo("Graphics API", reinterpret_cast<int *>(&userConfig.graphicsAPI), "D3D12\0Vulkan\0Metal\0Null\0Automatic\0") || genConfigChanged;
 
                     if (!UserConfiguration::isGraphicsAPISupported(userConfig.graphicsAPI)) {
                         ImGui::Text("This API is not available on this platform!");
@@ -2123,6 +2136,14 @@ namespace RT64 {
 
                     genConfigChanged = ImGui::Checkbox("Three-Point Filtering", &userConfig.threePointFiltering) || genConfigChanged;
                     genConfigChanged = ImGui::Checkbox("High Performance State", &userConfig.idleWorkActive) || genConfigChanged;
+                    genConfigChanged = ImGui::Checkbox("Geometry Cache", &userConfig.geometryCache) || genConfigChanged;
+                    genConfigChanged = ImGui::SliderInt("Queue Depth", &userConfig.queueDepth, UserConfiguration::QueueDepthMinimum, UserConfiguration::QueueDepthMaximum) || genConfigChanged;
+                    if (uint32_t(userConfig.queueDepth) != ext.workloadQueue->ring.depth) {
+                        ImGui::Text("You must restart the application for this change to be applied.");
+                    }
+
+                    genConfigChanged = ImGui::SliderInt("Texture Stream Batch Count", &userConfig.textureStreamBatchCount, UserConfiguration::TextureStreamBatchCountMinimum, UserConfiguration::TextureStreamBatchCountMaximum) || genConfigChanged;
+                    genConfigChanged = ImGui::SliderInt("Texture Stream Batch Size (MB)", &userConfig.textureStreamBatchMegabytes, UserConfiguration::TextureStreamBatchMegabytesMinimum, UserConfiguration::TextureStreamBatchMegabytesMaximum) || genConfigChanged;
                     
                     // Emulator configuration.
                     ImGui::NewLine();
@@ -2217,6 +2238,8 @@ namespace RT64 {
                     const bool saveDirectory = ImGui::Button("Save directory");
                     ImGui::SameLine();
                     const bool dumpTextures = ImGui::Button(dumpingTexturesDirectory.empty() ? "Start dumping textures" : "Stop dumping textures");
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Bundle dumps", &textureManager.dumpToArchive);
                     if (loadPack) {
                         std::filesystem::path newPack = FileDialog::getOpenFilename({ FileFilter("RTZ Files", "rtz") });
                         if (!newPack.empty()) {
@@ -2238,6 +2261,7 @@ namespace RT64 {
                             textureManager.dumpedSet.clear();
                         }
                         else {
+                            textureManager.dumper.flush();
                             dumpingTexturesDirectory.clear();
                         }
                     }
@@ -2397,6 +2421,9 @@ namespace RT64 {
                         const double viChangedProfilerAverage = viChangedProfiler.average();
                         const double screenCpuProfilerAverage = screenCpuProfiler.average();
                         const double textureStreamAverage = ext.textureCache->getAverageStreamLoadTime() / 1000.0;
+                        const size_t textureStreamQueueDepth = ext.textureCache->getStreamQueueDepth();
+                        uint64_t textureStreamWaitP50, textureStreamWaitP90, textureStreamWaitP99;
+                        ext.textureCache->getStreamWaitTimePercentiles(textureStreamWaitP50, textureStreamWaitP90, textureStreamWaitP99);
                         ImGui::Text("Average Present (OS): %fms (%.1f FPS)\n", averagePresent, 1000.0 / averagePresent);
                         ImGui::Text("Average Renderer: %fms (%.1f FPS)\n", averageRenderer, 1000.0 / averageRenderer);
                         ImGui::Text("Average Matching (CPU): %fms (%.1f FPS)\n", averageMatching, 1000.0 / averageMatching);
@@ -2416,6 +2443,140 @@ namespace RT64 {
                         ImGui::Text("Texture Pool Cached: %.1f MB\n", double(poolCached) / megabyteSize);
                         ImGui::Text("Texture Pool Limit: %1.f MB\n", double(poolLimit) / megabyteSize);
                         ImGui::Text("Average Texture Stream: %fms\n", textureStreamAverage);
+                        ImGui::Text("Texture Stream Queue: %zu\n", textureStreamQueueDepth);
+                        ImGui::Text("Texture Stream Wait (P50/P90/P99): %.2f/%.2f/%.2fms\n", textureStreamWaitP50 / 1000.0, textureStreamWaitP90 / 1000.0, textureStreamWaitP99 / 1000.0);
+
+                        // Show the uploaders the state waits on before it can submit.
+                        const BufferUploader *bufferUploaders[] = { ext.drawDataUploader, ext.transformsUploader };
+                        const char *bufferUploaderNames[] = { "Draw Data", "Transforms" };
+                        ImGui::NewLine();
+                        for (uint32_t i = 0; i < std::size(bufferUploaders); i++) {
+                            const BufferUploader *uploader = bufferUploaders[i];
+                            ImGui::Text("Upload %s: %.1f MB in %u chunks, copy %fms, wait %fms\n", bufferUploaderNames[i], double(uploader->copiedBytes) / megabyteSize, uploader->copiedChunks.load(), uploader->copyProfiler.average(), uploader->waitProfiler.average());
+                        }
+
+                        // Show how much of every draw data stream actually had to be uploaded in the last workload.
+                        if (ImGui::CollapsingHeader("Draw Data Streams")) {
+                            thread_local std::vector<BufferUploader::UploadStats> uploadStats;
+                            ext.drawDataUploader->getUploadStats(uploadStats);
+                            for (const BufferUploader::UploadStats &stats : uploadStats) {
+                                if (stats.rangeBytes > 0) {
+                                    ImGui::Text("%s: %.1f KB of %.1f KB\n", stats.name, double(stats.uploadedBytes) / 1024.0, double(stats.rangeBytes) / 1024.0);
+                                }
+                            }
+                        }
+
+                        // Show how busy every class of the task scheduler is.
+                        if (ImGui::CollapsingHeader("Task Scheduler")) {
+                            const Thread::Priority taskPriorities[] = { Thread::Priority::Idle, Thread::Priority::Low, Thread::Priority::Normal, Thread::Priority::High };
+                            const char *taskPriorityNames[] = { "Idle (Shaders)", "Low (Texture Streaming)", "Normal (Buffer Uploads)", "High (Command Recording)" };
+                            ImGui::Text("Task Threads: %u\n", ext.taskScheduler->getThreadCount());
+                            for (uint32_t i = 0; i < std::size(taskPriorities); i++) {
+                                TaskScheduler::ClassStats classStats;
+                                ext.taskScheduler->getClassStats(taskPriorities[i], classStats);
+                                if (classStats.limit == TaskScheduler::NoLimit) {
+                                    ImGui::Text("%s: %u queued, %u running, %" PRIu64 " done, %.2fs CPU\n", taskPriorityNames[i], classStats.queuedCount, classStats.runningCount, classStats.completedCount, classStats.cpuTime / 1000000.0);
+                                }
+                                else {
+                                    ImGui::Text("%s: %u queued, %u/%u running, %" PRIu64 " done, %.2fs CPU\n", taskPriorityNames[i], classStats.queuedCount, classStats.runningCount, classStats.limit, classStats.completedCount, classStats.cpuTime / 1000000.0);
+                                }
+                            }
+                        }
+
+                        if (ImGui::CollapsingHeader("Queue Latency")) {
+                            SPSCRing *rings[] = { &ext.workloadQueue->ring, &ext.presentQueue->ring };
+                            const char *ringNames[] = { "Workload", "Present" };
+                            auto limitText = [](uint64_t limit) {
+                                const uint64_t lastLimit = LatencyHistogram::getBucketLimit(LatencyHistogram::BucketCount - 2);
+                                return (limit == UINT64_MAX) ? (">= " + std::to_string(lastLimit) + "us") : ("< " + std::to_string(limit) + "us");
+                            };
+
+                            auto printHistogram = [&](const char *ringName, const char *sideName, const LatencyHistogram &histogram) {
+                                const std::string p50Text = limitText(histogram.getPercentileLimit(0.50));
+                                const std::string p99Text = limitText(histogram.getPercentileLimit(0.99));
+                                ImGui::Text("%s %s: %" PRIu64 " waits, p50 %s, p99 %s, %.2fs blocked\n", ringName, sideName, histogram.getCount(), p50Text.c_str(), p99Text.c_str(), histogram.totalMicroseconds / 1000000.0);
+                            };
+
+                            for (uint32_t i = 0; i < std::size(rings); i++) {
+                                ImGui::Text("%s Queue Depth: %u\n", ringNames[i], rings[i]->depth);
+                                printHistogram(ringNames[i], "Producer", rings[i]->producerHistogram);
+                                printHistogram(ringNames[i], "Consumer", rings[i]->consumerHistogram);
+                            }
+
+                            if (ImGui::Button("Reset Latency")) {
+                                for (SPSCRing *ring : rings) {
+                                    ring->producerHistogram.reset();
+                                    ring->consumerHistogram.reset();
+                                }
+                            }
+                        }
+
+                        // Show the geometry cache statistics of the last workload.
+                        if (userConfig.geometryCache) {
+                            const uint32_t geometryHits = geometryCache->hitCount;
+                            const uint32_t geometryLoads = geometryHits + geometryCache->missCount;
+                            const double geometryHitRatio = (geometryLoads > 0) ? (100.0 * geometryHits) / geometryLoads : 0.0;
+                            ImGui::Text("Geometry Cache: %u/%u loads hit (%.1f%%), %.1f KB saved, %u resets\n", geometryHits, geometryLoads, geometryHitRatio, double(geometryCache->savedBytes) / 1024.0, geometryCache->resetCount.load());
+                        }
+                    }
+
+                    ImGui::Text("Raster Calls: %u (%u draws after merging)\n", ext.workloadQueue->rasterCallCount.load(), ext.workloadQueue->rasterDrawCount.load());
+
+                    if (ext.workloadQueue->commandListRecorder != nullptr) {
+                        ImGui::Text("Parallel Framebuffers: %u (up to %u recording tasks)\n", ext.workloadQueue->parallelFramebufferCount.load(), ext.workloadQueue->commandListRecorder->getParallelCount());
+                    }
+
+                    // Show the GPU time of every pass measured with timestamp queries.
+                    GPUProfiler *gpuProfilers[] = { &ext.workloadQueue->gpuProfiler, &ext.presentQueue->gpuProfiler };
+                    const char *gpuProfilerNames[] = { "GPU Workload", "GPU Present" };
+                    for (uint32_t p = 0; p < std::size(gpuProfilers); p++) {
+                        GPUProfiler &gpuProfiler = *gpuProfilers[p];
+                        if (!gpuProfiler.isEnabled()) {
+                            continue;
+                        }
+
+                        ImGui::PushID(p);
+                        if (ImPlot::BeginPlot(gpuProfilerNames[p])) {
+                            const int Stride = static_cast<int>(sizeof(double));
+                            std::scoped_lock<std::mutex> passLock(gpuProfiler.passMutex);
+                            ImPlot::SetupAxis(ImAxis_Y1, "ms", ImPlotAxisFlags_AutoFit);
+                            for (const GPUProfiler::Pass &pass : gpuProfiler.passes) {
+                                ImPlot::PlotLine<double>(pass.name.c_str(), pass.timer.data(), static_cast<int>(pass.timer.size()), 1.0, 0.0, ImPlotLineFlags_None, pass.timer.index(), Stride);
+                            }
+
+                            ImPlot::EndPlot();
+
+                            for (const GPUProfiler::Pass &pass : gpuProfiler.passes) {
+                                ImGui::Text("Average %s (GPU): %fms\n", pass.name.c_str(), pass.timer.average());
+                            }
+                        }
+
+                        if (ImGui::Button("Export GPU timings")) {
+                            std::filesystem::path csvPath = FileDialog::getSaveFilename({ FileFilter("CSV Files", "csv") });
+                            if (!csvPath.empty() && !gpuProfiler.exportCSV(csvPath)) {
+                                fprintf(stderr, "Unable to export the GPU timings to %s.\n", csvPath.u8string().c_str());
+                            }
+                        }
+
+                        ImGui::PopID();
+                    }
+
+                    DisplayListCaptureWriter &displayListCapture = ext.app->displayListCapture;
+                    if (ImGui::Button(displayListCapture.isOpen() ? "Stop capturing display lists" : "Start capturing display lists")) {
+                        if (displayListCapture.isOpen()) {
+                            ext.app->endDisplayListCapture();
+                        }
+                        else {
+                            std::filesystem::path capturePath = FileDialog::getSaveFilename({ FileFilter("Display List Captures", "dlc") });
+                            if (!capturePath.empty()) {
+                                ext.app->beginDisplayListCapture(capturePath);
+                            }
+                        }
+                    }
+
+                    if (displayListCapture.isOpen()) {
+                        ImGui::SameLine();
+                        ImGui::Text("%u frames captured", displayListCapture.frameCount);
                     }
 
                     bool changed = false;
@@ -2503,6 +2664,9 @@ namespace RT64 {
                     case UserConfiguration::GraphicsAPI::Metal:
                         ImGui::Text("Graphics API: Metal");
                         break;
+                    case UserConfiguration::GraphicsAPI::Null:
+                        ImGui::Text("Graphics API: Null");
+                        break;
                     default:
                         ImGui::Text("Graphics API: Unknown");
                         break;
@@ -2582,6 +2746,7 @@ namespace RT64 {
             configurationSaveQueued = true;
             userConfig.validate();
             ext.sharedQueueResources->setUserConfig(userConfig, resConfigChanged);
+            ext.app->updateTextureStreamBatchLimits();
         }
 
         if (enhanceConfigChanged) {
@@ -2684,7 +2849,7 @@ namespace RT64 {
             flush();
 
             if (activeSpriteCommand.callCount > 0) {
-                const int workloadCursor = ext.workloadQueue->writeCursor;
+                const int workloadCursor = ext.workloadQueue->ring.writeCursor;
                 Workload &workload = ext.workloadQueue->workloads[workloadCursor];
                 workload.spriteCommands.emplace_back(activeSpriteCommand);
             }
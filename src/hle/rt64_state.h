@@ -13,6 +13,7 @@
 #include "preset/rt64_preset_draw_call.h"
 #include "preset/rt64_preset_material.h"
 #include "render/rt64_framebuffer_renderer.h"
+#include "render/rt64_geometry_cache.h"
 #include "render/rt64_render_worker.h"
 #include "render/rt64_raster_shader_cache.h"
 #include "render/rt64_render_target_manager.h"
@@ -50,6 +51,8 @@ namespace RT64 {
             BufferUploader *drawDataUploader;
             BufferUploader *transformsUploader;
             BufferUploader *tilesUploader;
+            StagingRing *stagingRing;
+            TaskScheduler *taskScheduler;
             WorkloadQueue *workloadQueue;
             PresentQueue *presentQueue;
             SharedQueueResources *sharedQueueResources;
@@ -79,6 +82,7 @@ namespace RT64 {
         RenderTargetManager renderTargetManager;
         std::unique_ptr<RenderFramebufferManager> renderFramebufferManager;
         std::unique_ptr<RSPProcessor> rspProcessor;
+        std::unique_ptr<GeometryCache> geometryCache;
         std::vector<interop::PointLight> scriptLights;
         uint64_t workloadCounter;
         std::vector<uint64_t> evictedTextureHashes;
@@ -0,0 +1,223 @@
+//
+// RT64
+//
+
+#include "rt64_texture_dumper.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "common/rt64_thread.h"
+
+namespace RT64 {
+    // TextureDumper::Job
+
+    uint64_t TextureDumper::Job::byteCount() const {
+        return tmemBytes.size() + rdramBytes.size() + paletteRdramBytes.size();
+    }
+
+    // TextureDumper
+
+    TextureDumper::~TextureDumper() {
+        flush();
+
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            writerRunning = false;
+        }
+
+        jobQueueChanged.notify_all();
+
+        if (writerThread != nullptr) {
+            writerThread->join();
+            writerThread.reset();
+        }
+    }
+
+    std::unique_ptr<TextureDumper::Job> TextureDumper::acquireJob() {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        if (jobPool.empty()) {
+            return std::make_unique<Job>();
+        }
+        else {
+            std::unique_ptr<Job> job = std::move(jobPool.back());
+            jobPool.pop_back();
+            return job;
+        }
+    }
+
+    void TextureDumper::submitJob(std::unique_ptr<Job> job) {
+        assert(job != nullptr);
+
+        const uint64_t jobBytes = job->byteCount();
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+
+            // The writer thread is only started the first time a texture is dumped.
+            if (writerThread == nullptr) {
+                writerRunning = true;
+                writerThread = std::make_unique<std::thread>(&TextureDumper::writerLoop, this);
+            }
+
+            // Stall the emulation thread until the writer catches up if the queued snapshots exceed the budget.
+            // A job bigger than the entire budget is still accepted once the queue is empty.
+            jobQueueDrained.wait(lock, [&]() {
+                return (queuedBytes == 0) || ((queuedBytes + jobBytes) <= maxQueuedBytes);
+            });
+
+            queuedBytes += jobBytes;
+            jobQueue.emplace_back(std::move(job));
+        }
+
+        jobQueueChanged.notify_all();
+    }
+
+    void TextureDumper::flush() {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobQueueDrained.wait(lock, [this]() {
+            return jobQueue.empty() && (activeJobCount == 0);
+        });
+    }
+
+    void TextureDumper::writeFile(const Job &job, const std::string &extension, const void *data, size_t size) {
+        const std::string fileName = job.baseName + extension;
+        if (job.archive) {
+            writeArchiveEntry(job, fileName, data, size);
+            return;
+        }
+
+        std::ofstream fileStream(job.directory / fileName, std::ios::binary);
+        if (fileStream.is_open()) {
+            fileStream.write(reinterpret_cast<const char *>(data), size);
+            fileStream.close();
+        }
+    }
+
+    void TextureDumper::writeJson(const Job &job, const std::string &extension, const json &jroot) {
+        std::stringstream jsonStream;
+        jsonStream << std::setw(4) << jroot << std::endl;
+        const std::string jsonString = jsonStream.str();
+        writeFile(job, extension, jsonString.data(), jsonString.size());
+    }
+
+    void TextureDumper::writeArchiveEntry(const Job &job, const std::string &fileName, const void *data, size_t size) {
+        // Dumps are appended to an uncompressed tar archive so they can be extracted with standard tools.
+        const std::filesystem::path jobArchivePath = job.directory / "dump.tar";
+        if (!archiveStream.is_open() || (archivePath != jobArchivePath)) {
+            archiveStream.close();
+            archiveStream.open(jobArchivePath, std::ios::binary | std::ios::app);
+            archivePath = jobArchivePath;
+        }
+
+        if (!archiveStream.is_open()) {
+            return;
+        }
+
+        // The end of archive marker is omitted so new entries can always be appended at the end of the file.
+        const uint32_t BlockSize = 512;
+        char header[BlockSize] = {};
+        const uint64_t modificationTime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        assert(fileName.size() < 100);
+        strncpy(&header[0], fileName.c_str(), 99);
+        snprintf(&header[100], 8, "%07o", 0644U);
+        snprintf(&header[108], 8, "%07o", 0U);
+        snprintf(&header[116], 8, "%07o", 0U);
+        snprintf(&header[124], 12, "%011llo", (unsigned long long)(size));
+        snprintf(&header[136], 12, "%011llo", (unsigned long long)(modificationTime));
+        header[156] = '0';
+        memcpy(&header[257], "ustar", 6);
+        memcpy(&header[263], "00", 2);
+
+        // The checksum is computed while its own field is filled with spaces.
+        memset(&header[148], ' ', 8);
+        uint32_t checksum = 0;
+        for (uint32_t i = 0; i < BlockSize; i++) {
+            checksum += uint8_t(header[i]);
+        }
+
+        snprintf(&header[148], 7, "%06o", checksum);
+        header[155] = ' ';
+
+        const char padding[BlockSize] = {};
+        archiveStream.write(header, BlockSize);
+        archiveStream.write(reinterpret_cast<const char *>(data), size);
+        archiveStream.write(padding, (BlockSize - (size % BlockSize)) % BlockSize);
+    }
+
+    void TextureDumper::writeJob(const Job &job) {
+        writeFile(job, ".tmem", job.tmemBytes.data(), job.tmemBytes.size());
+
+        if (job.dumpRdram) {
+            writeFile(job, ".rice.rdram", job.rdramBytes.data(), job.rdramBytes.size());
+
+            json jroot;
+            jroot["tile"] = job.loadOp.tile;
+            jroot["type"] = job.loadOp.type;
+            jroot["texture"] = job.loadOp.texture;
+            writeJson(job, ".rice.json", jroot);
+        }
+
+        if (job.dumpPalette) {
+            if (!job.paletteRdramBytes.empty()) {
+                writeFile(job, ".rice.palette.rdram", job.paletteRdramBytes.data(), job.paletteRdramBytes.size());
+            }
+
+            json jroot;
+            jroot["tile"] = job.paletteLoadOp.tile;
+            jroot["type"] = job.paletteLoadOp.type;
+            jroot["texture"] = job.paletteLoadOp.texture;
+            writeJson(job, ".rice.palette.json", jroot);
+        }
+
+        json jroot;
+        jroot["tile"] = job.loadTile;
+        jroot["width"] = job.width;
+        jroot["height"] = job.height;
+        jroot["tlut"] = job.tlut;
+        writeJson(job, ".tile.json", jroot);
+    }
+
+    void TextureDumper::writerLoop() {
+        Thread::setCurrentThreadName("RT64 Texture Dumper");
+
+        std::vector<std::unique_ptr<Job>> batchJobs;
+        std::unique_lock<std::mutex> lock(jobMutex);
+        while (writerRunning) {
+            jobQueueChanged.wait(lock, [this]() {
+                return !writerRunning || !jobQueue.empty();
+            });
+
+            if (jobQueue.empty()) {
+                continue;
+            }
+
+            // Take every job that has been queued so far and write them without holding the lock.
+            batchJobs.swap(jobQueue);
+            activeJobCount = uint32_t(batchJobs.size());
+            lock.unlock();
+
+            for (const std::unique_ptr<Job> &job : batchJobs) {
+                writeJob(*job);
+            }
+
+            // Close the archive after every batch so its contents are complete on disk while the writer is idle.
+            if (archiveStream.is_open()) {
+                archiveStream.close();
+            }
+
+            lock.lock();
+            for (std::unique_ptr<Job> &job : batchJobs) {
+                queuedBytes -= job->byteCount();
+                jobPool.emplace_back(std::move(job));
+            }
+
+            batchJobs.clear();
+            activeJobCount = 0;
+            jobQueueDrained.notify_all();
+        }
+    }
+};
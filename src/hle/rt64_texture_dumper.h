@@ -0,0 +1,71 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/rt64_load_types.h"
+
+namespace RT64 {
+    // Writes texture dumps on a background thread so the emulation thread only has to copy the memory snapshots.
+    struct TextureDumper {
+        struct Job {
+            std::filesystem::path directory;
+            std::string baseName;
+            bool archive = false;
+            LoadTile loadTile;
+            uint16_t width = 0;
+            uint16_t height = 0;
+            LoadTLUT tlut = LoadTLUT::None;
+            bool dumpRdram = false;
+            bool dumpPalette = false;
+            LoadOperation loadOp;
+            LoadOperation paletteLoadOp;
+            std::vector<uint8_t> tmemBytes;
+            std::vector<uint8_t> rdramBytes;
+            std::vector<uint8_t> paletteRdramBytes;
+
+            uint64_t byteCount() const;
+        };
+
+        std::vector<std::unique_ptr<Job>> jobQueue;
+        std::vector<std::unique_ptr<Job>> jobPool;
+        std::mutex jobMutex;
+        std::condition_variable jobQueueChanged;
+        std::condition_variable jobQueueDrained;
+        uint64_t queuedBytes = 0;
+        uint64_t maxQueuedBytes = 64 * 1024 * 1024;
+        uint32_t activeJobCount = 0;
+        bool writerRunning = false;
+        std::unique_ptr<std::thread> writerThread;
+        std::filesystem::path archivePath;
+        std::ofstream archiveStream;
+
+        TextureDumper() = default;
+        ~TextureDumper();
+
+        // Returns a job from the pool. The snapshot buffers keep their previous capacity to avoid reallocating them on every dump.
+        std::unique_ptr<Job> acquireJob();
+
+        // Queues the job for writing. Blocks the caller while the queued snapshots exceed the memory budget.
+        void submitJob(std::unique_ptr<Job> job);
+
+        // Waits until all the queued jobs have been written to disk.
+        void flush();
+
+        void writeFile(const Job &job, const std::string &extension, const void *data, size_t size);
+        void writeJson(const Job &job, const std::string &extension, const json &jroot);
+        void writeArchiveEntry(const Job &job, const std::string &fileName, const void *data, size_t size);
+        void writeJob(const Job &job);
+        void writerLoop();
+    };
+};
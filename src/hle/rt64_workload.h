@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/rt64_flat_hash_map.h"
+#include "common/rt64_flat_multimap.h"
 #include "render/rt64_buffer_uploader.h"
 #include "shared/rt64_extra_params.h"
 #include "shared/rt64_gpu_tile.h"
@@ -222,8 +224,8 @@ namespace RT64 {
         uint32_t viOriginalRate;
         DebuggerRenderer debuggerRenderer;
         DebuggerCamera debuggerCamera;
-        std::multimap<uint32_t, uint32_t> transformIdMap;
-        std::multimap<uint32_t, uint32_t> physicalAddressTransformMap;
+        FlatMultimap<uint32_t, uint32_t> transformIdMap;
+        FlatHashMultimap<uint32_t> physicalAddressTransformMap;
         std::vector<uint32_t> transformIgnoredIds;
         uint64_t workloadId = 0;
         uint64_t presentId = 0;
@@ -240,7 +242,7 @@ namespace RT64 {
         void resetRSPOutputBuffers();
         void resetWorldOutputBuffers();
         void updateDrawDataRanges();
-        void uploadDrawData(RenderWorker *worker, BufferUploader *bufferUploader);
+        void uploadDrawData(RenderWorker *worker, BufferUploader *bufferUploader, const std::vector<std::pair<size_t, size_t>> &cachedVertexRanges);
         void updateOutputBuffers(RenderWorker *worker);
         void nextDrawDataRanges();
         void begin(uint64_t submissionFrame);
@@ -16,13 +16,13 @@ namespace RT64 {
 
     // WorkloadQueue
 
-    WorkloadQueue::WorkloadQueue() {
+    WorkloadQueue::WorkloadQueue(uint32_t depth) : workloads(depth) {
         reset();
     }
 
     WorkloadQueue::~WorkloadQueue() {
         threadsRunning = false;
-        cursorCondition.notify_all();
+        ring.notify();
         idleCondition.notify_all();
 
         if (renderThread != nullptr) {
@@ -35,7 +35,7 @@ namespace RT64 {
             delete idleThread;
         }
 
-        workloadIdCondition.notify_all();
+        workloadIdWaiter.notify();
     }
 
     void WorkloadQueue::reset() {
@@ -43,48 +43,18 @@ namespace RT64 {
             w.reset();
         }
 
-        threadCursor = 0;
-        writeCursor = 0;
-        barrierCursor = int(workloads.size()) - 1;
+        ring.reset(uint32_t(workloads.size()), uint32_t(workloads.size()) - 1);
         workloadId = 0;
         lastPresentId = 0;
     }
 
     void WorkloadQueue::advanceToNextWorkload() {
-        int nextWriteCursor = (writeCursor + 1) % workloads.size();
-
-        // Stall the thread until the barrier is lifted if we're trying to write on a workload being used by the GPU.
-        bool waitForBarrier;
-        do {
-            const std::scoped_lock lock(cursorMutex);
-            waitForBarrier = (nextWriteCursor == barrierCursor);
-        } while (waitForBarrier);
-
-        // Modify the cursor and notify anything waiting on the queue.
-        {
-            const std::scoped_lock lock(cursorMutex);
-            writeCursor = nextWriteCursor;
-        }
-
-        cursorCondition.notify_all();
+        // Stalls the thread until the barrier is lifted if we're trying to write on a workload being used by the GPU.
+        ring.advanceWriteCursor();
     }
 
     void WorkloadQueue::repeatLastWorkload() {
-        {
-            const std::scoped_lock lock(cursorMutex);
-            threadCursor = previousWriteCursor();
-        }
-
-        cursorCondition.notify_all();
-    }
-
-    uint32_t WorkloadQueue::previousWriteCursor() const {
-        if (writeCursor > 0) {
-            return writeCursor - 1;
-        }
-        else {
-            return uint32_t(workloads.size()) - 1;
-        }
+        ring.repeatLast();
     }
 
     void WorkloadQueue::waitForIdle() {
@@ -92,8 +62,7 @@ namespace RT64 {
     }
 
     void WorkloadQueue::waitForWorkloadId(uint64_t waitId) {
-        std::unique_lock<std::mutex> workloadLock(workloadIdMutex);
-        workloadIdCondition.wait(workloadLock, [&]() {
+        workloadIdWaiter.wait([&]() {
             return (waitId <= workloadId) || !threadsRunning;
         });
     }
@@ -103,12 +72,19 @@ namespace RT64 {
 
         rspProcessor = std::make_unique<RSPProcessor>(ext.device);
         vertexProcessor = std::make_unique<VertexProcessor>(ext.device);
-        framebufferRenderer = std::make_unique<FramebufferRenderer>(ext.workloadGraphicsWorker, true, ext.createdGraphicsAPI, ext.shaderLibrary);
+        framebufferRenderer = std::make_unique<FramebufferRenderer>(ext.workloadGraphicsWorker, true, ext.createdGraphicsAPI, ext.shaderLibrary, ext.stagingRing, ext.taskScheduler);
+        gpuProfiler.setup(ext.device);
+        framebufferRenderer->gpuProfiler = &gpuProfiler;
+
+        // The task scheduler already leaves enough cores for the emulation, render and present threads.
+        const uint32_t recorderParallelCount = std::min(ext.taskScheduler->getThreadCount(), uint32_t(WORKLOAD_RECORDER_MAX_THREADS));
+        commandListRecorder = std::make_unique<CommandListRecorder>(ext.workloadGraphicsWorker, RenderCommandListType::DIRECT, ext.taskScheduler, recorderParallelCount);
+
         renderFramebufferManager = std::make_unique<RenderFramebufferManager>(ext.device);
 
-        projectionProcessor.setup(ext.workloadGraphicsWorker);
-        transformProcessor.setup(ext.workloadGraphicsWorker);
-        tileProcessor.setup(ext.workloadGraphicsWorker);
+        projectionProcessor.setup(ext.workloadGraphicsWorker, ext.stagingRing, ext.taskScheduler);
+        transformProcessor.setup(ext.workloadGraphicsWorker, ext.stagingRing, ext.taskScheduler);
+        tileProcessor.setup(ext.workloadGraphicsWorker, ext.stagingRing, ext.taskScheduler);
 
         threadsRunning = true;
         renderThread = new std::thread(&WorkloadQueue::renderThreadLoop, this);
@@ -311,8 +287,12 @@ namespace RT64 {
             projParams.curFrameWeight = curFrameWeight;
             projParams.prevFrameWeight = prevFrameWeight;
             projParams.aspectRatioScale = workloadConfig.aspectRatioScale;
+            projectionProfiler.reset();
+            projectionProfiler.start();
             projectionProcessor.process(projParams);
             projectionProcessor.upload(projParams);
+            projectionProfiler.end();
+            projectionProfiler.log();
             uploadProjections = true;
         }
 
@@ -326,8 +306,12 @@ namespace RT64 {
             transformParams.prevFrame = &prevFrame;
             transformParams.curFrameWeight = curFrameWeight;
             transformParams.prevFrameWeight = prevFrameWeight;
+            transformProfiler.reset();
+            transformProfiler.start();
             transformProcessor.process(transformParams);
             transformProcessor.upload(transformParams);
+            transformProfiler.end();
+            transformProfiler.log();
             uploadTransforms = true;
         }
 
@@ -340,8 +324,12 @@ namespace RT64 {
             tileParams.prevFrame = &prevFrame;
             tileParams.curFrameWeight = curFrameWeight;
             tileParams.prevFrameWeight = prevFrameWeight;
+            tileProfiler.reset();
+            tileProfiler.start();
             tileProcessor.process(tileParams);
             tileProcessor.upload(tileParams);
+            tileProfiler.end();
+            tileProfiler.log();
             uploadTiles = true;
         }
 
@@ -677,19 +665,29 @@ namespace RT64 {
 #       endif
 
             workerMutex.lock();
-            ext.workloadGraphicsWorker->commandList->begin();
+            RenderCommandList *commandList = ext.workloadGraphicsWorker->commandList.get();
+            commandList->begin();
+            commandListRecorder->begin(ext.workloadGraphicsWorker);
+            gpuProfiler.begin(commandList);
+            gpuProfiler.beginPass(commandList, "Workload");
             framebufferRenderer->endFramebuffers(ext.workloadGraphicsWorker, &workload.drawBuffers, &workload.outputBuffers, workloadConfig.raytracingEnabled);
-            framebufferRenderer->recordSetup(ext.workloadGraphicsWorker, bufferUploaders, processRSP ? rspProcessor.get() : nullptr, processWorldVertices ? vertexProcessor.get() : nullptr, &workload.outputBuffers, workloadConfig.raytracingEnabled);
+            framebufferRenderer->recordSetup(ext.workloadGraphicsWorker, bufferUploaders, nullptr, processRSP ? rspProcessor.get() : nullptr, processWorldVertices ? vertexProcessor.get() : nullptr, &workload.outputBuffers, workloadConfig.raytracingEnabled);
             
-            // Record all framebuffer pairs.
+            // Record all framebuffer pairs. The scenes of independent framebuffers are recorded by scheduler tasks into their own command lists.
+            const bool parallelRecording = (commandListRecorder->getParallelCount() > 0);
+            uint32_t parallelFramebuffers = 0;
             uint32_t framebufferIndex = 0;
             for (uint32_t f = 0; f < fbPairCount; f++) {
                 const FramebufferPair &fbPair = workload.fbPairs[f];
                 bool validTargets = getTargetsFromPair(f);
-                fbManager.recordOperations(ext.workloadGraphicsWorker, &workload.fbChangePool, &workload.fbStorage, ext.shaderLibrary, ext.textureCache,
-                    fbPair.startFbOperations, targetManager, fixedResScale, f, workload.submissionFrame);
+                {
+                    GPUProfilerScope profilerScope(&gpuProfiler, commandList, "Framebuffer operations");
+                    fbManager.recordOperations(ext.workloadGraphicsWorker, &workload.fbChangePool, &workload.fbStorage, ext.shaderLibrary, ext.textureCache,
+                        fbPair.startFbOperations, targetManager, fixedResScale, f, workload.submissionFrame);
+                }
 
                 if (validTargets) {
+                    gpuProfiler.beginPass(commandList, "Framebuffer reads");
                     const auto &colorImg = fbPair.colorImage;
                     const auto &depthImg = fbPair.depthImage;
                     bool colorFormatUpdated = false;
@@ -765,8 +763,27 @@ namespace RT64 {
                             depthFb->readHeight = depthFb->height;
                         }
                     }
-                    
-                    framebufferRenderer->recordFramebuffer(ext.workloadGraphicsWorker, framebufferIndex++);
+
+                    gpuProfiler.endPass(commandList);
+
+                    if (parallelRecording && framebufferRenderer->canRecordFramebufferInParallel(framebufferIndex)) {
+                        FramebufferRenderer *renderer = framebufferRenderer.get();
+                        RenderWorker *worker = ext.workloadGraphicsWorker;
+                        const uint32_t recordIndex = framebufferIndex;
+                        framebufferRenderer->recordFramebufferBarriers(commandList, recordIndex);
+                        commandListRecorder->recordParallel([renderer, worker, recordIndex](RenderCommandList *parallelList) {
+                            renderer->recordFramebufferScenes(worker, parallelList, recordIndex, nullptr);
+                        });
+
+                        // The worker continues recording on a new command list.
+                        commandList = ext.workloadGraphicsWorker->commandList.get();
+                        parallelFramebuffers++;
+                    }
+                    else {
+                        framebufferRenderer->recordFramebuffer(ext.workloadGraphicsWorker, framebufferIndex);
+                    }
+
+                    framebufferIndex++;
 
                     // Transition the render targets in case the present queue will show them so it doesn't have to perform transitions.
                     if (colorTarget != nullptr && depthTarget != nullptr) {
@@ -809,15 +826,21 @@ namespace RT64 {
                         depthFb->lastWriteTimestamp = writeTimestamp;
                     }
                 }
-                
+
+                GPUProfilerScope profilerScope(&gpuProfiler, commandList, "Framebuffer operations");
                 fbManager.recordOperations(ext.workloadGraphicsWorker, &workload.fbChangePool, &workload.fbStorage, ext.shaderLibrary, ext.textureCache,
                     fbPair.endFbOperations, targetManager, fixedResScale, f, workload.submissionFrame);
             }
 
-            ext.workloadGraphicsWorker->commandList->end();
+            gpuProfiler.endPass(commandList);
+            gpuProfiler.end(commandList);
             framebufferRenderer->waitForUploaders();
-            ext.workloadGraphicsWorker->execute();
+            commandListRecorder->execute();
+            rasterCallCount = framebufferRenderer->rasterCallCount.load();
+            rasterDrawCount = framebufferRenderer->rasterDrawCount.load();
+            parallelFramebufferCount = parallelFramebuffers;
             ext.workloadGraphicsWorker->wait();
+            gpuProfiler.log();
             workerMutex.unlock();
 
             // Indicate to the texture cache it's safe to delete the textures if no locks are active.
@@ -836,17 +859,12 @@ namespace RT64 {
     }
 
     void WorkloadQueue::threadAdvanceBarrier() {
-        std::scoped_lock<std::mutex> cursorLock(cursorMutex);
-        barrierCursor = (barrierCursor + 1) % workloads.size();
+        ring.advanceBarrier();
     }
 
     void WorkloadQueue::threadAdvanceWorkloadId(uint64_t newWorkloadId) {
-        {
-            std::scoped_lock<std::mutex> cursorLock(workloadIdMutex);
-            workloadId = newWorkloadId;
-        }
-
-        workloadIdCondition.notify_all();
+        workloadId = newWorkloadId;
+        workloadIdWaiter.notify();
     }
 
     void WorkloadQueue::renderThreadLoop() {
@@ -860,16 +878,9 @@ namespace RT64 {
         int processCursor = -1;
         bool frameReduction = false;
         while (threadsRunning) {
-            {
-                std::unique_lock<std::mutex> cursorLock(cursorMutex);
-                cursorCondition.wait(cursorLock, [&]() {
-                    return (writeCursor != threadCursor) || !threadsRunning;
-                });
-
-                if (threadsRunning) {
-                    processCursor = threadCursor;
-                    threadCursor = (threadCursor + 1) % workloads.size();
-                }
+            uint32_t claimedCursor = 0;
+            if (ring.claim(threadsRunning, claimedCursor)) {
+                processCursor = int(claimedCursor);
             }
 
             if (processCursor >= 0) {
@@ -1100,10 +1111,7 @@ namespace RT64 {
 
                     // For every additional frame, we increase the frames available and notify the present queue.
                     if (generateInterpolatedFrames && (usingMSAA || (frame > 0))) {
-                        {
-                            std::scoped_lock<std::mutex> cursorLock(cursorMutex);
-                            skipWorkloadNow = ((frame + 1) < displayFrames) && (writeCursor != threadCursor);
-                        }
+                        skipWorkloadNow = ((frame + 1) < displayFrames) && ring.hasPending();
 
                         {
                             std::scoped_lock<std::mutex> managerLock(ext.sharedResources->interpolatedMutex);
@@ -8,8 +8,11 @@
 
 #include "common/rt64_enhancement_configuration.h"
 #include "common/rt64_profiling_timer.h"
+#include "common/rt64_spsc_ring.h"
 #include "common/rt64_user_configuration.h"
+#include "render/rt64_command_list_recorder.h"
 #include "render/rt64_framebuffer_renderer.h"
+#include "render/rt64_gpu_profiler.h"
 #include "render/rt64_projection_processor.h"
 #include "render/rt64_raster_shader_cache.h"
 #include "render/rt64_tile_processor.h"
@@ -22,7 +25,7 @@
 #   include "render/rt64_raytracing_shader_cache.h"
 #endif
 
-#define WORKLOAD_QUEUE_SIZE 4
+#define WORKLOAD_RECORDER_MAX_THREADS 4
 
 namespace RT64 {
     struct PresentQueue;
@@ -34,6 +37,8 @@ namespace RT64 {
             BufferUploader *workloadExtrasUploader = nullptr;
             BufferUploader *workloadVelocityUploader = nullptr;
             BufferUploader *workloadTilesUploader = nullptr;
+            StagingRing *stagingRing = nullptr;
+            TaskScheduler *taskScheduler = nullptr;
             PresentQueue *presentQueue = nullptr;
             SharedQueueResources *sharedResources = nullptr;
             RasterShaderCache *rasterShaderCache = nullptr;
@@ -61,16 +66,11 @@ namespace RT64 {
         };
 
         External ext;
-        std::array<Workload, WORKLOAD_QUEUE_SIZE> workloads;
-        int threadCursor;
-        int writeCursor;
-        int barrierCursor;
-        std::mutex cursorMutex;
-        std::condition_variable cursorCondition;
-        uint64_t workloadId;
+        std::vector<Workload> workloads;
+        SPSCRing ring;
+        std::atomic<uint64_t> workloadId;
         uint64_t lastPresentId;
-        std::mutex workloadIdMutex;
-        std::condition_variable workloadIdCondition;
+        AtomicWaiter workloadIdWaiter;
         std::thread *renderThread = nullptr;
         std::thread *idleThread = nullptr;
         bool idleActive = false;
@@ -82,7 +82,11 @@ namespace RT64 {
         std::atomic<bool> rtEnabled = false;
         std::atomic<bool> ubershadersOnly = false;
         std::atomic<bool> ubershadersVisible = false;
+        std::atomic<uint32_t> rasterCallCount = 0;
+        std::atomic<uint32_t> rasterDrawCount = 0;
+        std::atomic<uint32_t> parallelFramebufferCount = 0;
         std::unique_ptr<FramebufferRenderer> framebufferRenderer;
+        std::unique_ptr<CommandListRecorder> commandListRecorder;
         std::unique_ptr<RenderFramebufferManager> renderFramebufferManager;
         TileProcessor tileProcessor;
         TransformProcessor transformProcessor;
@@ -94,16 +98,19 @@ namespace RT64 {
         ProfilingTimer rendererProfiler = ProfilingTimer(120);
         ProfilingTimer matchingProfiler = ProfilingTimer(120);
         ProfilingTimer workloadProfiler = ProfilingTimer(120);
+        ProfilingTimer projectionProfiler = ProfilingTimer(120);
+        ProfilingTimer transformProfiler = ProfilingTimer(120);
+        ProfilingTimer tileProfiler = ProfilingTimer(120);
+        GPUProfiler gpuProfiler;
         std::array<GameFrame, 2> gameFrames;
         uint32_t prevFrameIndex = uint32_t(gameFrames.size()) - 1;
         uint32_t curFrameIndex = 0;
 
-        WorkloadQueue();
+        WorkloadQueue(uint32_t depth);
         ~WorkloadQueue();
         void reset();
         void advanceToNextWorkload();
         void repeatLastWorkload();
-        uint32_t previousWriteCursor() const;
         void waitForIdle();
         void waitForWorkloadId(uint64_t waitId);
         void setup(const External &ext);
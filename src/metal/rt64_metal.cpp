@@ -1321,7 +1321,7 @@ namespace RT64 {
             MTL::VertexBufferLayoutDescriptor *layout = vertexDescriptor->layouts()->object(vertexBufferIndex);
             layout->setStride(inputSlot.stride);
             layout->setStepFunction(mapVertexStepFunction(inputSlot.classification));
-            layout->setStepRate((layout->stepFunction() == MTL::VertexStepFunctionPerInstance) ? inputSlot.stride : 1);
+            layout->setStepRate(1);
         }
 
         for (uint32_t i = 0; i < desc.inputElementsCount; i++) {
@@ -1936,6 +1936,15 @@ namespace RT64 {
         activeRenderEncoder->drawIndexedPrimitives(currentPrimitiveType, indexCountPerInstance, currentIndexType, indexBuffer, indexBufferOffset + (startIndexLocation * sizeof(uint32_t)), instanceCount, baseVertexLocation, startInstanceLocation);
     }
 
+    void MetalCommandList::drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        // Metal can't read the draw count from a buffer without converting the arguments into an indirect command buffer first.
+        assert(false && "Indirect draws with a count buffer are not supported.");
+    }
+
+    void MetalCommandList::drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        assert(false && "Indirect draws with a count buffer are not supported.");
+    }
+
     void MetalCommandList::setPipeline(const RenderPipeline *pipeline) {
         assert(pipeline != nullptr);
 
@@ -2549,6 +2558,46 @@ namespace RT64 {
         // TODO: Unimplemented.
     }
 
+    void MetalCommandList::resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        // Counter sample buffers don't need to be reset before they're written to.
+    }
+
+    void MetalCommandList::writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) {
+        assert(queryPool != nullptr);
+
+        MetalQueryPool *interfaceQueryPool = static_cast<MetalQueryPool *>(queryPool);
+        if (interfaceQueryPool->mtl == nullptr) {
+            return;
+        }
+
+        // Timestamps can only be sampled at encoder boundaries on most GPUs, so an empty blit pass is encoded to sample it.
+        endOtherEncoders(EncoderType::None);
+        activeType = EncoderType::None;
+
+        NS::AutoreleasePool *releasePool = NS::AutoreleasePool::alloc()->init();
+
+        MTL::BlitPassDescriptor *blitDescriptor = MTL::BlitPassDescriptor::alloc()->init();
+        MTL::BlitPassSampleBufferAttachmentDescriptor *sampleAttachment = blitDescriptor->sampleBufferAttachments()->object(0);
+        sampleAttachment->setSampleBuffer(interfaceQueryPool->mtl);
+        sampleAttachment->setStartOfEncoderSampleIndex(queryIndex);
+        sampleAttachment->setEndOfEncoderSampleIndex(MTL::CounterDontSample);
+
+        MTL::BlitCommandEncoder *timestampEncoder = mtl->blitCommandEncoder(blitDescriptor);
+        timestampEncoder->setLabel(MTLSTR("Timestamp Blit Encoder"));
+        timestampEncoder->endEncoding();
+
+        blitDescriptor->release();
+        releasePool->release();
+    }
+
+    void MetalCommandList::resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        // Query results are resolved directly from the shared sample buffer when requested.
+    }
+
+    void MetalCommandList::setOutOfOrderRecording(bool enabled) {
+        // No validation depends on the recording order.
+    }
+
     void MetalCommandList::endOtherEncoders(EncoderType type) {
         if (activeType == type) {
           // Early return for the most likely case.
@@ -2820,6 +2869,98 @@ namespace RT64 {
     }
 
 
+    // MetalQueryPool
+
+    MetalQueryPool::MetalQueryPool(MetalDevice *device, uint32_t queryCount) {
+        assert(device != nullptr);
+        assert(queryCount > 0);
+
+        this->device = device;
+
+        NS::AutoreleasePool *releasePool = NS::AutoreleasePool::alloc()->init();
+
+        MTL::CounterSet *timestampCounterSet = nullptr;
+        NS::Array *counterSets = device->mtl->counterSets();
+        for (NS::UInteger i = 0; (counterSets != nullptr) && (i < counterSets->count()); i++) {
+            MTL::CounterSet *counterSet = counterSets->object<MTL::CounterSet>(i);
+            if (counterSet->name()->isEqualToString(MTL::CommonCounterSetTimestamp)) {
+                timestampCounterSet = counterSet;
+                break;
+            }
+        }
+
+        if (timestampCounterSet != nullptr) {
+            MTL::CounterSampleBufferDescriptor *sampleBufferDescriptor = MTL::CounterSampleBufferDescriptor::alloc()->init();
+            sampleBufferDescriptor->setCounterSet(timestampCounterSet);
+            sampleBufferDescriptor->setStorageMode(MTL::StorageModeShared);
+            sampleBufferDescriptor->setSampleCount(queryCount);
+            sampleBufferDescriptor->setLabel(MTLSTR("RT64 Query Pool"));
+
+            NS::Error *error = nullptr;
+            mtl = device->mtl->newCounterSampleBuffer(sampleBufferDescriptor, &error);
+            if (error != nullptr) {
+                fprintf(stderr, "MTLDevice newCounterSampleBufferWithDescriptor: failed with error %s.\n", error->localizedDescription()->utf8String());
+                mtl = nullptr;
+            }
+
+            sampleBufferDescriptor->release();
+        }
+        else {
+            fprintf(stderr, "Timestamp counter set is not supported by the device.\n");
+        }
+
+        releasePool->release();
+
+        // The GPU timestamps are calibrated against the CPU clock, which is measured in nanoseconds.
+        device->mtl->sampleTimestamps(&calibrationCPUTimestamp, &calibrationGPUTimestamp);
+        results.resize(queryCount, 0);
+    }
+
+    MetalQueryPool::~MetalQueryPool() {
+        if (mtl != nullptr) {
+            mtl->release();
+        }
+    }
+
+    void MetalQueryPool::queryResults() {
+        if (mtl == nullptr) {
+            return;
+        }
+
+        NS::AutoreleasePool *releasePool = NS::AutoreleasePool::alloc()->init();
+
+        NS::Data *resolvedData = mtl->resolveCounterRange(NS::Range(0, results.size()));
+        if (resolvedData != nullptr) {
+            MTL::Timestamp cpuTimestamp = 0;
+            MTL::Timestamp gpuTimestamp = 0;
+            device->mtl->sampleTimestamps(&cpuTimestamp, &gpuTimestamp);
+
+            double nanosecondsPerTick = 1.0;
+            if (gpuTimestamp > calibrationGPUTimestamp) {
+                nanosecondsPerTick = double(cpuTimestamp - calibrationCPUTimestamp) / double(gpuTimestamp - calibrationGPUTimestamp);
+            }
+
+            const MTL::CounterResultTimestamp *timestamps = reinterpret_cast<const MTL::CounterResultTimestamp *>(resolvedData->mutableBytes());
+            const size_t timestampCount = std::min(results.size(), size_t(resolvedData->length() / sizeof(MTL::CounterResultTimestamp)));
+            for (size_t i = 0; i < timestampCount; i++) {
+                // Samples that weren't written keep their previous values.
+                if (timestamps[i].timestamp != MTL::CounterErrorValue) {
+                    results[i] = uint64_t(double(timestamps[i].timestamp - calibrationGPUTimestamp) * nanosecondsPerTick);
+                }
+            }
+        }
+
+        releasePool->release();
+    }
+
+    const uint64_t *MetalQueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t MetalQueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
     // MetalCommandFence
 
     MetalCommandFence::MetalCommandFence(MetalDevice *device) {
@@ -2914,6 +3055,21 @@ namespace RT64 {
         dispatch_semaphore_wait(metalFence->semaphore, DISPATCH_TIME_FOREVER);
     }
 
+    // MetalPipelineCache
+
+    MetalPipelineCache::MetalPipelineCache(MetalDevice *device, const void *data, uint64_t size) {
+        assert(device != nullptr);
+
+        // Pipelines aren't stored in a cache yet, so they rely on the shader cache of the system instead.
+    }
+
+    MetalPipelineCache::~MetalPipelineCache() { }
+
+    bool MetalPipelineCache::getData(std::vector<uint8_t> &data) {
+        data.clear();
+        return false;
+    }
+
     // MetalPipelineLayout
 
     MetalPipelineLayout::MetalPipelineLayout(MetalDevice *device, const RenderPipelineLayoutDesc &desc) {
@@ -2969,6 +3125,8 @@ namespace RT64 {
         capabilities.scalarBlockLayout = true;
         capabilities.presentWait = false;
         capabilities.preferHDR = mtl->recommendedMaxWorkingSetSize() > (512 * 1024 * 1024);
+        capabilities.timestampQueries = mtl->supportsCounterSampling(MTL::CounterSamplingPointAtStageBoundary);
+        capabilities.drawIndirectCount = false;
         description.name = "Metal";
     }
 
@@ -2988,11 +3146,11 @@ namespace RT64 {
         return std::make_unique<MetalSampler>(this, desc);
     }
 
-    std::unique_ptr<RenderPipeline> MetalDevice::createComputePipeline(const RenderComputePipelineDesc &desc) {
+    std::unique_ptr<RenderPipeline> MetalDevice::createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) {
         return std::make_unique<MetalComputePipeline>(this, desc);
     }
 
-    std::unique_ptr<RenderPipeline> MetalDevice::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) {
+    std::unique_ptr<RenderPipeline> MetalDevice::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) {
         return std::make_unique<MetalGraphicsPipeline>(this, desc);
     }
 
@@ -3025,6 +3183,10 @@ namespace RT64 {
         return std::make_unique<MetalPipelineLayout>(this, desc);
     }
 
+    std::unique_ptr<RenderPipelineCache> MetalDevice::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<MetalPipelineCache>(this, data, size);
+    }
+
     std::unique_ptr<RenderCommandFence> MetalDevice::createCommandFence() {
         return std::make_unique<MetalCommandFence>(this);
     }
@@ -3037,6 +3199,10 @@ namespace RT64 {
         return std::make_unique<MetalFramebuffer>(this, desc);
     }
 
+    std::unique_ptr<RenderQueryPool> MetalDevice::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<MetalQueryPool>(this, queryCount);
+    }
+
     void MetalDevice::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
         // TODO: Unimplemented (Raytracing).
     }
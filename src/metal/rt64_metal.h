@@ -348,6 +348,8 @@ namespace RT64 {
         void traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) override;
         void drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) override;
         void drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+        void drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) override;
+        void drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) override;
         void setPipeline(const RenderPipeline *pipeline) override;
         void setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
         void setComputePushConstants(uint32_t rangeIndex, const void *data) override;
@@ -373,6 +375,10 @@ namespace RT64 {
         void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) override;
         void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) override;
         void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) override;
+        void resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) override;
+        void resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void setOutOfOrderRecording(bool enabled) override;
 
         void endOtherEncoders(EncoderType type);
         void checkActiveComputeEncoder();
@@ -388,6 +394,20 @@ namespace RT64 {
         void setCommonClearState() const;
     };
 
+    struct MetalQueryPool : RenderQueryPool {
+        MTL::CounterSampleBuffer *mtl = nullptr;
+        MetalDevice *device = nullptr;
+        MTL::Timestamp calibrationCPUTimestamp = 0;
+        MTL::Timestamp calibrationGPUTimestamp = 0;
+        std::vector<uint64_t> results;
+
+        MetalQueryPool(MetalDevice *device, uint32_t queryCount);
+        ~MetalQueryPool() override;
+        void queryResults() override;
+        const uint64_t *getResults() const override;
+        uint32_t getCount() const override;
+    };
+
     struct MetalCommandFence : RenderCommandFence {
         dispatch_semaphore_t semaphore;
 
@@ -541,6 +561,12 @@ namespace RT64 {
         RenderPipelineProgram getProgram(const std::string &name) const override;
     };
 
+    struct MetalPipelineCache : RenderPipelineCache {
+        MetalPipelineCache(MetalDevice *device, const void *data, uint64_t size);
+        ~MetalPipelineCache() override;
+        bool getData(std::vector<uint8_t> &data) override;
+    };
+
     struct MetalPipelineLayout : RenderPipelineLayout {
         std::vector<RenderPushConstantRange> pushConstantRanges;
         uint32_t setLayoutCount = 0;
@@ -562,8 +588,8 @@ namespace RT64 {
         std::unique_ptr<RenderDescriptorSet> createDescriptorSet(const RenderDescriptorSetDesc &desc) override;
         std::unique_ptr<RenderShader> createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) override;
         std::unique_ptr<RenderSampler> createSampler(const RenderSamplerDesc &desc) override;
-        std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc) override;
-        std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) override;
+        std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) override;
+        std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) override;
         std::unique_ptr<RenderPipeline> createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) override;
         std::unique_ptr<RenderCommandQueue> createCommandQueue(RenderCommandListType type) override;
         std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) override;
@@ -571,9 +597,11 @@ namespace RT64 {
         std::unique_ptr<RenderAccelerationStructure> createAccelerationStructure(const RenderAccelerationStructureDesc &desc) override;
         std::unique_ptr<RenderPool> createPool(const RenderPoolDesc &desc) override;
         std::unique_ptr<RenderPipelineLayout> createPipelineLayout(const RenderPipelineLayoutDesc &desc) override;
+        std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data, uint64_t size) override;
         std::unique_ptr<RenderCommandFence> createCommandFence() override;
         std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() override;
         std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) override;
+        std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) override;
         void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) override;
         void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) override;
         void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) override;
@@ -0,0 +1,819 @@
+//
+// RT64
+//
+
+#include "rt64_null.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+namespace RT64 {
+    // Size of the swap chain textures, as the null device can't query the size of the window.
+    static const uint32_t NullSwapChainWidth = 1280;
+    static const uint32_t NullSwapChainHeight = 720;
+
+    static uint64_t nullTextureMemorySize(const RenderTextureDesc &desc) {
+        const uint32_t formatSize = RenderFormatSize(desc.format);
+        const uint32_t blockWidth = RenderFormatBlockWidth(desc.format);
+        const uint32_t sampleCount = std::max(uint32_t(desc.multisampling.sampleCount), 1U);
+        const uint32_t mipLevels = std::max(uint32_t(desc.mipLevels), 1U);
+        uint64_t memorySize = 0;
+        for (uint32_t i = 0; i < mipLevels; i++) {
+            const uint32_t mipWidth = std::max(desc.width >> i, 1U);
+            const uint32_t mipHeight = std::max(desc.height >> i, 1U);
+            const uint32_t mipDepth = (desc.dimension == RenderTextureDimension::TEXTURE_3D) ? std::max(uint32_t(desc.depth) >> i, 1U) : std::max(uint32_t(desc.depth), 1U);
+            const uint64_t blockCountX = (mipWidth + blockWidth - 1) / blockWidth;
+            const uint64_t blockCountY = (mipHeight + blockWidth - 1) / blockWidth;
+            memorySize += blockCountX * blockCountY * mipDepth * formatSize * sampleCount;
+        }
+
+        return memorySize;
+    }
+
+    // NullBuffer
+
+    NullBuffer::NullBuffer(NullDevice *device, NullPool *pool, const RenderBufferDesc &desc) {
+        assert(device != nullptr);
+
+        this->device = device;
+        this->pool = pool;
+        this->desc = desc;
+
+        memory.resize(desc.size, 0);
+    }
+
+    NullBuffer::~NullBuffer() { }
+
+    void *NullBuffer::map(uint32_t subresource, const RenderRange *readRange) {
+        return memory.data();
+    }
+
+    void NullBuffer::unmap(uint32_t subresource, const RenderRange *writtenRange) { }
+
+    std::unique_ptr<RenderBufferFormattedView> NullBuffer::createBufferFormattedView(RenderFormat format) {
+        return std::make_unique<NullBufferFormattedView>(this, format);
+    }
+
+    void NullBuffer::setName(const std::string &name) { }
+
+    // NullBufferFormattedView
+
+    NullBufferFormattedView::NullBufferFormattedView(NullBuffer *buffer, RenderFormat format) {
+        assert(buffer != nullptr);
+
+        this->buffer = buffer;
+        this->format = format;
+    }
+
+    NullBufferFormattedView::~NullBufferFormattedView() { }
+
+    // NullTexture
+
+    NullTexture::NullTexture(NullDevice *device, NullPool *pool, const RenderTextureDesc &desc) {
+        assert(device != nullptr);
+
+        this->device = device;
+        this->pool = pool;
+        this->desc = desc;
+
+        memory.resize(nullTextureMemorySize(desc), 0);
+    }
+
+    NullTexture::~NullTexture() { }
+
+    std::unique_ptr<RenderTextureView> NullTexture::createTextureView(const RenderTextureViewDesc &desc) {
+        return std::make_unique<NullTextureView>(this, desc);
+    }
+
+    void NullTexture::setName(const std::string &name) { }
+
+    // NullTextureView
+
+    NullTextureView::NullTextureView(NullTexture *texture, const RenderTextureViewDesc &desc) {
+        assert(texture != nullptr);
+
+        this->texture = texture;
+        this->desc = desc;
+    }
+
+    NullTextureView::~NullTextureView() { }
+
+    // NullAccelerationStructure
+
+    NullAccelerationStructure::NullAccelerationStructure(const RenderAccelerationStructureDesc &desc) {
+        this->desc = desc;
+    }
+
+    NullAccelerationStructure::~NullAccelerationStructure() { }
+
+    // NullPool
+
+    NullPool::NullPool(NullDevice *device, const RenderPoolDesc &desc) {
+        assert(device != nullptr);
+
+        this->device = device;
+        this->desc = desc;
+    }
+
+    NullPool::~NullPool() { }
+
+    std::unique_ptr<RenderBuffer> NullPool::createBuffer(const RenderBufferDesc &desc) {
+        return std::make_unique<NullBuffer>(device, this, desc);
+    }
+
+    std::unique_ptr<RenderTexture> NullPool::createTexture(const RenderTextureDesc &desc) {
+        return std::make_unique<NullTexture>(device, this, desc);
+    }
+
+    // NullDescriptorSet
+
+    NullDescriptorSet::NullDescriptorSet(const RenderDescriptorSetDesc &desc) {
+        for (uint32_t i = 0; i < desc.descriptorRangesCount; i++) {
+            const bool boundlessRange = desc.lastRangeIsBoundless && (i == (desc.descriptorRangesCount - 1));
+            // Boundless ranges always hold at least one descriptor, like they do on the other backends.
+            descriptorCount += boundlessRange ? std::max(desc.boundlessRangeSize, 1U) : desc.descriptorRanges[i].count;
+        }
+    }
+
+    NullDescriptorSet::~NullDescriptorSet() { }
+
+    void NullDescriptorSet::setBuffer(uint32_t descriptorIndex, const RenderBuffer *buffer, uint64_t bufferSize, const RenderBufferStructuredView *bufferStructuredView, const RenderBufferFormattedView *bufferFormattedView) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    void NullDescriptorSet::setTexture(uint32_t descriptorIndex, const RenderTexture *texture, RenderTextureLayout textureLayout, const RenderTextureView *textureView) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    void NullDescriptorSet::setSampler(uint32_t descriptorIndex, const RenderSampler *sampler) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    void NullDescriptorSet::setAccelerationStructure(uint32_t descriptorIndex, const RenderAccelerationStructure *accelerationStructure) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    // NullSwapChain
+
+    NullSwapChain::NullSwapChain(NullCommandQueue *commandQueue, RenderWindow renderWindow, uint32_t textureCount, RenderFormat format) {
+        assert(commandQueue != nullptr);
+        assert(textureCount > 0);
+
+        this->commandQueue = commandQueue;
+        this->renderWindow = renderWindow;
+
+        width = NullSwapChainWidth;
+        height = NullSwapChainHeight;
+
+        const RenderTextureDesc textureDesc = RenderTextureDesc::ColorTarget(width, height, format);
+        for (uint32_t i = 0; i < textureCount; i++) {
+            textures.emplace_back(std::make_unique<NullTexture>(commandQueue->device, nullptr, textureDesc));
+        }
+    }
+
+    NullSwapChain::~NullSwapChain() { }
+
+    bool NullSwapChain::present(uint32_t textureIndex, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount) {
+        assert(textureIndex < textures.size());
+        return true;
+    }
+
+    void NullSwapChain::wait() { }
+
+    bool NullSwapChain::resize() {
+        return true;
+    }
+
+    bool NullSwapChain::needsResize() const {
+        return false;
+    }
+
+    void NullSwapChain::setVsyncEnabled(bool vsyncEnabled) {
+        this->vsyncEnabled = vsyncEnabled;
+    }
+
+    bool NullSwapChain::isVsyncEnabled() const {
+        return vsyncEnabled;
+    }
+
+    uint32_t NullSwapChain::getWidth() const {
+        return width;
+    }
+
+    uint32_t NullSwapChain::getHeight() const {
+        return height;
+    }
+
+    RenderTexture *NullSwapChain::getTexture(uint32_t textureIndex) {
+        assert(textureIndex < textures.size());
+        return textures[textureIndex].get();
+    }
+
+    uint32_t NullSwapChain::getTextureCount() const {
+        return uint32_t(textures.size());
+    }
+
+    bool NullSwapChain::acquireTexture(RenderCommandSemaphore *signalSemaphore, uint32_t *textureIndex) {
+        assert(textureIndex != nullptr);
+
+        *textureIndex = textureCursor;
+        textureCursor = (textureCursor + 1) % textures.size();
+        return true;
+    }
+
+    RenderWindow NullSwapChain::getWindow() const {
+        return renderWindow;
+    }
+
+    bool NullSwapChain::isEmpty() const {
+        return false;
+    }
+
+    uint32_t NullSwapChain::getRefreshRate() const {
+        return 60;
+    }
+
+    // NullFramebuffer
+
+    NullFramebuffer::NullFramebuffer(const RenderFramebufferDesc &desc) {
+        // All attachments must have the same size, so it's enough to use the first one that is found.
+        const RenderTexture *firstAttachment = (desc.colorAttachmentsCount > 0) ? desc.colorAttachments[0] : desc.depthAttachment;
+        if (firstAttachment != nullptr) {
+            const NullTexture *interfaceTexture = static_cast<const NullTexture *>(firstAttachment);
+            width = interfaceTexture->desc.width;
+            height = interfaceTexture->desc.height;
+        }
+    }
+
+    NullFramebuffer::~NullFramebuffer() { }
+
+    uint32_t NullFramebuffer::getWidth() const {
+        return width;
+    }
+
+    uint32_t NullFramebuffer::getHeight() const {
+        return height;
+    }
+
+    // NullCommandList
+
+    NullCommandList::NullCommandList(NullDevice *device, RenderCommandListType type) {
+        assert(device != nullptr);
+        assert(type != RenderCommandListType::UNKNOWN);
+
+        this->device = device;
+        this->type = type;
+    }
+
+    NullCommandList::~NullCommandList() { }
+
+    void NullCommandList::begin() {
+        assert(!open);
+
+        commands.clear();
+        open = true;
+    }
+
+    void NullCommandList::end() {
+        assert(open);
+
+        open = false;
+    }
+
+    void NullCommandList::barriers(RenderBarrierStages stages, const RenderBufferBarrier *bufferBarriers, uint32_t bufferBarriersCount, const RenderTextureBarrier *textureBarriers, uint32_t textureBarriersCount) {
+        NullCommand &command = record(NullCommandType::Barriers);
+        command.args[0] = stages;
+        command.args[1] = bufferBarriersCount;
+        command.args[2] = textureBarriersCount;
+    }
+
+    void NullCommandList::dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) {
+        NullCommand &command = record(NullCommandType::Dispatch);
+        command.args[0] = threadGroupCountX;
+        command.args[1] = threadGroupCountY;
+        command.args[2] = threadGroupCountZ;
+    }
+
+    void NullCommandList::traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) {
+        NullCommand &command = record(NullCommandType::TraceRays);
+        command.args[0] = width;
+        command.args[1] = height;
+        command.args[2] = depth;
+        command.objects[0] = shaderBindingTable.ref;
+        command.offsets[0] = shaderBindingTable.offset;
+    }
+
+    void NullCommandList::drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) {
+        NullCommand &command = record(NullCommandType::DrawInstanced);
+        command.args[0] = vertexCountPerInstance;
+        command.args[1] = instanceCount;
+        command.args[2] = startVertexLocation;
+        command.args[3] = startInstanceLocation;
+    }
+
+    void NullCommandList::drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) {
+        NullCommand &command = record(NullCommandType::DrawIndexedInstanced);
+        command.args[0] = indexCountPerInstance;
+        command.args[1] = instanceCount;
+        command.args[2] = startIndexLocation;
+        command.args[3] = uint32_t(baseVertexLocation);
+        command.args[4] = startInstanceLocation;
+    }
+
+    void NullCommandList::drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        NullCommand &command = record(NullCommandType::DrawIndirect);
+        command.args[0] = maxDrawCount;
+        command.objects[0] = argumentBuffer.ref;
+        command.objects[1] = countBuffer.ref;
+        command.offsets[0] = argumentBuffer.offset;
+        command.offsets[1] = countBuffer.offset;
+    }
+
+    void NullCommandList::drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        NullCommand &command = record(NullCommandType::DrawIndexedIndirect);
+        command.args[0] = maxDrawCount;
+        command.objects[0] = argumentBuffer.ref;
+        command.objects[1] = countBuffer.ref;
+        command.offsets[0] = argumentBuffer.offset;
+        command.offsets[1] = countBuffer.offset;
+    }
+
+    void NullCommandList::setPipeline(const RenderPipeline *pipeline) {
+        record(NullCommandType::SetPipeline).objects[0] = pipeline;
+    }
+
+    void NullCommandList::setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) {
+        record(NullCommandType::SetPipelineLayout).objects[0] = pipelineLayout;
+    }
+
+    void NullCommandList::setComputePushConstants(uint32_t rangeIndex, const void *data) {
+        record(NullCommandType::SetPushConstants).args[0] = rangeIndex;
+    }
+
+    void NullCommandList::setComputeDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) {
+        NullCommand &command = record(NullCommandType::SetDescriptorSet);
+        command.args[0] = setIndex;
+        command.objects[0] = descriptorSet;
+    }
+
+    void NullCommandList::setGraphicsPipelineLayout(const RenderPipelineLayout *pipelineLayout) {
+        record(NullCommandType::SetPipelineLayout).objects[0] = pipelineLayout;
+    }
+
+    void NullCommandList::setGraphicsPushConstants(uint32_t rangeIndex, const void *data) {
+        record(NullCommandType::SetPushConstants).args[0] = rangeIndex;
+    }
+
+    void NullCommandList::setGraphicsDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) {
+        NullCommand &command = record(NullCommandType::SetDescriptorSet);
+        command.args[0] = setIndex;
+        command.objects[0] = descriptorSet;
+    }
+
+    void NullCommandList::setRaytracingPipelineLayout(const RenderPipelineLayout *pipelineLayout) {
+        record(NullCommandType::SetPipelineLayout).objects[0] = pipelineLayout;
+    }
+
+    void NullCommandList::setRaytracingPushConstants(uint32_t rangeIndex, const void *data) {
+        record(NullCommandType::SetPushConstants).args[0] = rangeIndex;
+    }
+
+    void NullCommandList::setRaytracingDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) {
+        NullCommand &command = record(NullCommandType::SetDescriptorSet);
+        command.args[0] = setIndex;
+        command.objects[0] = descriptorSet;
+    }
+
+    void NullCommandList::setIndexBuffer(const RenderIndexBufferView *view) {
+        NullCommand &command = record(NullCommandType::SetIndexBuffer);
+        if (view != nullptr) {
+            command.objects[0] = view->buffer.ref;
+            command.offsets[0] = view->buffer.offset;
+            command.size = view->size;
+        }
+    }
+
+    void NullCommandList::setVertexBuffers(uint32_t startSlot, const RenderVertexBufferView *views, uint32_t viewCount, const RenderInputSlot *inputSlots) {
+        NullCommand &command = record(NullCommandType::SetVertexBuffers);
+        command.args[0] = startSlot;
+        command.args[1] = viewCount;
+    }
+
+    void NullCommandList::setViewports(const RenderViewport *viewports, uint32_t count) {
+        record(NullCommandType::SetViewports).args[0] = count;
+    }
+
+    void NullCommandList::setScissors(const RenderRect *scissorRects, uint32_t count) {
+        record(NullCommandType::SetScissors).args[0] = count;
+    }
+
+    void NullCommandList::setFramebuffer(const RenderFramebuffer *framebuffer) {
+        record(NullCommandType::SetFramebuffer).objects[0] = framebuffer;
+    }
+
+    void NullCommandList::clearColor(uint32_t attachmentIndex, RenderColor colorValue, const RenderRect *clearRects, uint32_t clearRectsCount) {
+        NullCommand &command = record(NullCommandType::ClearColor);
+        command.args[0] = attachmentIndex;
+        command.args[1] = clearRectsCount;
+    }
+
+    void NullCommandList::clearDepth(bool clearDepth, float depthValue, const RenderRect *clearRects, uint32_t clearRectsCount) {
+        NullCommand &command = record(NullCommandType::ClearDepth);
+        command.args[0] = clearDepth;
+        command.args[1] = clearRectsCount;
+    }
+
+    void NullCommandList::copyBufferRegion(RenderBufferReference dstBuffer, RenderBufferReference srcBuffer, uint64_t size) {
+        NullCommand &command = record(NullCommandType::CopyBufferRegion);
+        command.objects[0] = dstBuffer.ref;
+        command.objects[1] = srcBuffer.ref;
+        command.offsets[0] = dstBuffer.offset;
+        command.offsets[1] = srcBuffer.offset;
+        command.size = size;
+    }
+
+    void NullCommandList::copyTextureRegion(const RenderTextureCopyLocation &dstLocation, const RenderTextureCopyLocation &srcLocation, uint32_t dstX, uint32_t dstY, uint32_t dstZ, const RenderBox *srcBox) {
+        NullCommand &command = record(NullCommandType::CopyTextureRegion);
+        command.args[0] = dstX;
+        command.args[1] = dstY;
+        command.args[2] = dstZ;
+        command.objects[0] = (dstLocation.texture != nullptr) ? static_cast<const void *>(dstLocation.texture) : static_cast<const void *>(dstLocation.buffer);
+        command.objects[1] = (srcLocation.texture != nullptr) ? static_cast<const void *>(srcLocation.texture) : static_cast<const void *>(srcLocation.buffer);
+    }
+
+    void NullCommandList::copyBuffer(const RenderBuffer *dstBuffer, const RenderBuffer *srcBuffer) {
+        NullCommand &command = record(NullCommandType::CopyBuffer);
+        command.objects[0] = dstBuffer;
+        command.objects[1] = srcBuffer;
+    }
+
+    void NullCommandList::copyTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) {
+        NullCommand &command = record(NullCommandType::CopyTexture);
+        command.objects[0] = dstTexture;
+        command.objects[1] = srcTexture;
+    }
+
+    void NullCommandList::resolveTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) {
+        NullCommand &command = record(NullCommandType::ResolveTexture);
+        command.objects[0] = dstTexture;
+        command.objects[1] = srcTexture;
+    }
+
+    void NullCommandList::resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) {
+        NullCommand &command = record(NullCommandType::ResolveTexture);
+        command.args[0] = dstX;
+        command.args[1] = dstY;
+        command.objects[0] = dstTexture;
+        command.objects[1] = srcTexture;
+    }
+
+    void NullCommandList::buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) {
+        NullCommand &command = record(NullCommandType::BuildAccelerationStructure);
+        command.args[0] = buildInfo.meshCount;
+        command.objects[0] = dstAccelerationStructure;
+    }
+
+    void NullCommandList::buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) {
+        NullCommand &command = record(NullCommandType::BuildAccelerationStructure);
+        command.args[0] = buildInfo.instanceCount;
+        command.objects[0] = dstAccelerationStructure;
+    }
+
+    void NullCommandList::resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        NullCommand &command = record(NullCommandType::ResetQueryPool);
+        command.args[0] = queryFirstIndex;
+        command.args[1] = queryCount;
+        command.objects[0] = queryPool;
+    }
+
+    void NullCommandList::writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) {
+        NullCommand &command = record(NullCommandType::WriteTimestamp);
+        command.args[0] = queryIndex;
+        command.objects[0] = queryPool;
+    }
+
+    void NullCommandList::resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        NullCommand &command = record(NullCommandType::ResolveQueryPool);
+        command.args[0] = queryFirstIndex;
+        command.args[1] = queryCount;
+        command.objects[0] = queryPool;
+    }
+
+    void NullCommandList::setOutOfOrderRecording(bool enabled) {
+        // No validation depends on the recording order.
+    }
+
+    NullCommand &NullCommandList::record(NullCommandType type) {
+        assert(open && "Command list must be open to record commands.");
+
+        NullCommand &command = commands.emplace_back();
+        command.type = type;
+        return command;
+    }
+
+    // NullCommandFence
+
+    NullCommandFence::NullCommandFence() { }
+
+    NullCommandFence::~NullCommandFence() { }
+
+    // NullCommandSemaphore
+
+    NullCommandSemaphore::NullCommandSemaphore() { }
+
+    NullCommandSemaphore::~NullCommandSemaphore() { }
+
+    // NullCommandQueue
+
+    NullCommandQueue::NullCommandQueue(NullDevice *device, RenderCommandListType type) {
+        assert(device != nullptr);
+        assert(type != RenderCommandListType::UNKNOWN);
+
+        this->device = device;
+        this->type = type;
+    }
+
+    NullCommandQueue::~NullCommandQueue() { }
+
+    std::unique_ptr<RenderCommandList> NullCommandQueue::createCommandList(RenderCommandListType type) {
+        return std::make_unique<NullCommandList>(device, type);
+    }
+
+    std::unique_ptr<RenderSwapChain> NullCommandQueue::createSwapChain(RenderWindow renderWindow, uint32_t textureCount, RenderFormat format) {
+        return std::make_unique<NullSwapChain>(this, renderWindow, textureCount, format);
+    }
+
+    void NullCommandQueue::executeCommandLists(const RenderCommandList **commandLists, uint32_t commandListCount, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount, RenderCommandSemaphore **signalSemaphores, uint32_t signalSemaphoreCount, RenderCommandFence *signalFence) {
+        assert(commandLists != nullptr);
+
+        // Command lists are executed right away, so semaphores and fences are always signaled by the time this function returns.
+        std::unique_lock<std::mutex> executeLock(executeMutex);
+        for (uint32_t i = 0; i < commandListCount; i++) {
+            const NullCommandList *interfaceCommandList = static_cast<const NullCommandList *>(commandLists[i]);
+            assert(!interfaceCommandList->open && "Command list must be closed before it's executed.");
+
+            for (const NullCommand &command : interfaceCommandList->commands) {
+                executeCommand(command);
+            }
+
+            executedCommandCount += interfaceCommandList->commands.size();
+        }
+    }
+
+    void NullCommandQueue::waitForCommandFence(RenderCommandFence *fence) { }
+
+    void NullCommandQueue::executeCommand(const NullCommand &command) {
+        // Only the commands that have an effect the CPU can observe are executed.
+        switch (command.type) {
+        case NullCommandType::CopyBufferRegion: {
+            NullBuffer *dstBuffer = const_cast<NullBuffer *>(static_cast<const NullBuffer *>(command.objects[0]));
+            const NullBuffer *srcBuffer = static_cast<const NullBuffer *>(command.objects[1]);
+            assert((command.offsets[0] + command.size) <= dstBuffer->memory.size());
+            assert((command.offsets[1] + command.size) <= srcBuffer->memory.size());
+            memmove(dstBuffer->memory.data() + command.offsets[0], srcBuffer->memory.data() + command.offsets[1], command.size);
+            break;
+        }
+        case NullCommandType::CopyBuffer: {
+            NullBuffer *dstBuffer = const_cast<NullBuffer *>(static_cast<const NullBuffer *>(command.objects[0]));
+            const NullBuffer *srcBuffer = static_cast<const NullBuffer *>(command.objects[1]);
+            memmove(dstBuffer->memory.data(), srcBuffer->memory.data(), std::min(dstBuffer->memory.size(), srcBuffer->memory.size()));
+            break;
+        }
+        case NullCommandType::WriteTimestamp: {
+            NullQueryPool *queryPool = const_cast<NullQueryPool *>(static_cast<const NullQueryPool *>(command.objects[0]));
+            assert(command.args[0] < queryPool->results.size());
+
+            // Use the CPU time at execution, which makes measured passes show up as empty.
+            const auto currentTime = std::chrono::steady_clock::now().time_since_epoch();
+            queryPool->results[command.args[0]] = std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime).count();
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // NullQueryPool
+
+    NullQueryPool::NullQueryPool(uint32_t queryCount) {
+        results.resize(queryCount, 0);
+    }
+
+    NullQueryPool::~NullQueryPool() { }
+
+    void NullQueryPool::queryResults() {
+        // The results are already written when the command lists are executed.
+    }
+
+    const uint64_t *NullQueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t NullQueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
+    // NullShader
+
+    NullShader::NullShader(const char *entryPointName, RenderShaderFormat format) {
+        this->entryPointName = (entryPointName != nullptr) ? entryPointName : std::string();
+        this->format = format;
+    }
+
+    NullShader::~NullShader() { }
+
+    // NullSampler
+
+    NullSampler::NullSampler(const RenderSamplerDesc &desc) {
+        this->desc = desc;
+    }
+
+    NullSampler::~NullSampler() { }
+
+    // NullPipeline
+
+    NullPipeline::NullPipeline(Type type) {
+        this->type = type;
+    }
+
+    NullPipeline::~NullPipeline() { }
+
+    RenderPipelineProgram NullPipeline::getProgram(const std::string &name) const {
+        return RenderPipelineProgram();
+    }
+
+    // NullPipelineCache
+
+    NullPipelineCache::NullPipelineCache(const void *data, uint64_t size) {
+        if ((data != nullptr) && (size > 0)) {
+            const uint8_t *dataBytes = reinterpret_cast<const uint8_t *>(data);
+            this->data.assign(dataBytes, dataBytes + size);
+        }
+    }
+
+    NullPipelineCache::~NullPipelineCache() { }
+
+    bool NullPipelineCache::getData(std::vector<uint8_t> &data) {
+        data = this->data;
+        return true;
+    }
+
+    // NullPipelineLayout
+
+    NullPipelineLayout::NullPipelineLayout() { }
+
+    NullPipelineLayout::~NullPipelineLayout() { }
+
+    // NullDevice
+
+    NullDevice::NullDevice(NullInterface *renderInterface) {
+        assert(renderInterface != nullptr);
+
+        this->renderInterface = renderInterface;
+
+        description.name = "Null Device";
+        capabilities.descriptorIndexing = true;
+        capabilities.scalarBlockLayout = true;
+        capabilities.maxTextureSize = 16384;
+        capabilities.timestampQueries = true;
+        capabilities.drawIndirectCount = true;
+    }
+
+    NullDevice::~NullDevice() { }
+
+    std::unique_ptr<RenderDescriptorSet> NullDevice::createDescriptorSet(const RenderDescriptorSetDesc &desc) {
+        return std::make_unique<NullDescriptorSet>(desc);
+    }
+
+    std::unique_ptr<RenderShader> NullDevice::createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) {
+        return std::make_unique<NullShader>(entryPointName, format);
+    }
+
+    std::unique_ptr<RenderSampler> NullDevice::createSampler(const RenderSamplerDesc &desc) {
+        return std::make_unique<NullSampler>(desc);
+    }
+
+    std::unique_ptr<RenderPipeline> NullDevice::createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) {
+        return std::make_unique<NullPipeline>(NullPipeline::Type::Compute);
+    }
+
+    std::unique_ptr<RenderPipeline> NullDevice::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) {
+        return std::make_unique<NullPipeline>(NullPipeline::Type::Graphics);
+    }
+
+    std::unique_ptr<RenderPipeline> NullDevice::createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) {
+        return std::make_unique<NullPipeline>(NullPipeline::Type::Raytracing);
+    }
+
+    std::unique_ptr<RenderCommandQueue> NullDevice::createCommandQueue(RenderCommandListType type) {
+        return std::make_unique<NullCommandQueue>(this, type);
+    }
+
+    std::unique_ptr<RenderBuffer> NullDevice::createBuffer(const RenderBufferDesc &desc) {
+        return std::make_unique<NullBuffer>(this, nullptr, desc);
+    }
+
+    std::unique_ptr<RenderTexture> NullDevice::createTexture(const RenderTextureDesc &desc) {
+        return std::make_unique<NullTexture>(this, nullptr, desc);
+    }
+
+    std::unique_ptr<RenderAccelerationStructure> NullDevice::createAccelerationStructure(const RenderAccelerationStructureDesc &desc) {
+        return std::make_unique<NullAccelerationStructure>(desc);
+    }
+
+    std::unique_ptr<RenderPool> NullDevice::createPool(const RenderPoolDesc &desc) {
+        return std::make_unique<NullPool>(this, desc);
+    }
+
+    std::unique_ptr<RenderPipelineLayout> NullDevice::createPipelineLayout(const RenderPipelineLayoutDesc &desc) {
+        return std::make_unique<NullPipelineLayout>();
+    }
+
+    std::unique_ptr<RenderPipelineCache> NullDevice::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<NullPipelineCache>(data, size);
+    }
+
+    std::unique_ptr<RenderCommandFence> NullDevice::createCommandFence() {
+        return std::make_unique<NullCommandFence>();
+    }
+
+    std::unique_ptr<RenderCommandSemaphore> NullDevice::createCommandSemaphore() {
+        return std::make_unique<NullCommandSemaphore>();
+    }
+
+    std::unique_ptr<RenderFramebuffer> NullDevice::createFramebuffer(const RenderFramebufferDesc &desc) {
+        return std::make_unique<NullFramebuffer>(desc);
+    }
+
+    std::unique_ptr<RenderQueryPool> NullDevice::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<NullQueryPool>(queryCount);
+    }
+
+    void NullDevice::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
+        buildInfo.meshCount = meshCount;
+        buildInfo.primitiveCount = 0;
+        buildInfo.preferFastBuild = preferFastBuild;
+        buildInfo.preferFastTrace = preferFastTrace;
+        buildInfo.scratchSize = 0;
+        buildInfo.accelerationStructureSize = 0;
+    }
+
+    void NullDevice::setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) {
+        buildInfo.instancesBufferData.clear();
+        buildInfo.instanceCount = instanceCount;
+        buildInfo.preferFastBuild = preferFastBuild;
+        buildInfo.preferFastTrace = preferFastTrace;
+        buildInfo.scratchSize = 0;
+        buildInfo.accelerationStructureSize = 0;
+    }
+
+    void NullDevice::setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) {
+        tableInfo.tableBufferData.clear();
+        tableInfo.groups = RenderShaderBindingGroupsInfo();
+    }
+
+    const RenderDeviceCapabilities &NullDevice::getCapabilities() const {
+        return capabilities;
+    }
+
+    const RenderDeviceDescription &NullDevice::getDescription() const {
+        return description;
+    }
+
+    RenderSampleCounts NullDevice::getSampleCountsSupported(RenderFormat format) const {
+        return RenderSampleCount::COUNT_1 | RenderSampleCount::COUNT_2 | RenderSampleCount::COUNT_4 | RenderSampleCount::COUNT_8;
+    }
+
+    bool NullDevice::beginCapture() {
+        return false;
+    }
+
+    bool NullDevice::endCapture() {
+        return false;
+    }
+
+    // NullInterface
+
+    NullInterface::NullInterface() {
+        // SPIR-V is the only shader format that is available on all platforms.
+        capabilities.shaderFormat = RenderShaderFormat::SPIRV;
+    }
+
+    NullInterface::~NullInterface() { }
+
+    std::unique_ptr<RenderDevice> NullInterface::createDevice() {
+        return std::make_unique<NullDevice>(this);
+    }
+
+    const RenderInterfaceCapabilities &NullInterface::getCapabilities() const {
+        return capabilities;
+    }
+
+    // Global creation function.
+
+    std::unique_ptr<RenderInterface> CreateNullInterface() {
+        return std::make_unique<NullInterface>();
+    }
+};
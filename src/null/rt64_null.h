@@ -0,0 +1,339 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rhi/rt64_render_interface.h"
+
+#include <mutex>
+
+namespace RT64 {
+    struct NullBuffer;
+    struct NullCommandQueue;
+    struct NullDevice;
+    struct NullInterface;
+    struct NullPool;
+    struct NullQueryPool;
+    struct NullTexture;
+
+    enum class NullCommandType {
+        Barriers,
+        Dispatch,
+        TraceRays,
+        DrawInstanced,
+        DrawIndexedInstanced,
+        DrawIndirect,
+        DrawIndexedIndirect,
+        SetPipeline,
+        SetPipelineLayout,
+        SetPushConstants,
+        SetDescriptorSet,
+        SetIndexBuffer,
+        SetVertexBuffers,
+        SetViewports,
+        SetScissors,
+        SetFramebuffer,
+        ClearColor,
+        ClearDepth,
+        CopyBufferRegion,
+        CopyTextureRegion,
+        CopyBuffer,
+        CopyTexture,
+        ResolveTexture,
+        BuildAccelerationStructure,
+        ResetQueryPool,
+        WriteTimestamp,
+        ResolveQueryPool,
+        Count
+    };
+
+    // Every command recorded by a command list is stored with the same layout so the stream can be inspected after recording.
+    // The meaning of the arguments depends on the type. Objects are stored as the interface pointers that were passed to the command.
+    struct NullCommand {
+        NullCommandType type = NullCommandType::Count;
+        uint32_t args[5] = {};
+        const void *objects[2] = {};
+        uint64_t offsets[2] = {};
+        uint64_t size = 0;
+    };
+
+    struct NullBuffer : RenderBuffer {
+        NullDevice *device = nullptr;
+        NullPool *pool = nullptr;
+        RenderBufferDesc desc;
+        std::vector<uint8_t> memory;
+
+        NullBuffer(NullDevice *device, NullPool *pool, const RenderBufferDesc &desc);
+        ~NullBuffer() override;
+        void *map(uint32_t subresource, const RenderRange *readRange) override;
+        void unmap(uint32_t subresource, const RenderRange *writtenRange) override;
+        std::unique_ptr<RenderBufferFormattedView> createBufferFormattedView(RenderFormat format) override;
+        void setName(const std::string &name) override;
+    };
+
+    struct NullBufferFormattedView : RenderBufferFormattedView {
+        NullBuffer *buffer = nullptr;
+        RenderFormat format = RenderFormat::UNKNOWN;
+
+        NullBufferFormattedView(NullBuffer *buffer, RenderFormat format);
+        ~NullBufferFormattedView() override;
+    };
+
+    struct NullTexture : RenderTexture {
+        NullDevice *device = nullptr;
+        NullPool *pool = nullptr;
+        RenderTextureDesc desc;
+        std::vector<uint8_t> memory;
+
+        NullTexture(NullDevice *device, NullPool *pool, const RenderTextureDesc &desc);
+        ~NullTexture() override;
+        std::unique_ptr<RenderTextureView> createTextureView(const RenderTextureViewDesc &desc) override;
+        void setName(const std::string &name) override;
+    };
+
+    struct NullTextureView : RenderTextureView {
+        NullTexture *texture = nullptr;
+        RenderTextureViewDesc desc;
+
+        NullTextureView(NullTexture *texture, const RenderTextureViewDesc &desc);
+        ~NullTextureView() override;
+    };
+
+    struct NullAccelerationStructure : RenderAccelerationStructure {
+        RenderAccelerationStructureDesc desc;
+
+        NullAccelerationStructure(const RenderAccelerationStructureDesc &desc);
+        ~NullAccelerationStructure() override;
+    };
+
+    struct NullPool : RenderPool {
+        NullDevice *device = nullptr;
+        RenderPoolDesc desc;
+
+        NullPool(NullDevice *device, const RenderPoolDesc &desc);
+        ~NullPool() override;
+        std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) override;
+        std::unique_ptr<RenderTexture> createTexture(const RenderTextureDesc &desc) override;
+    };
+
+    struct NullDescriptorSet : RenderDescriptorSet {
+        uint32_t descriptorCount = 0;
+
+        NullDescriptorSet(const RenderDescriptorSetDesc &desc);
+        ~NullDescriptorSet() override;
+        void setBuffer(uint32_t descriptorIndex, const RenderBuffer *buffer, uint64_t bufferSize, const RenderBufferStructuredView *bufferStructuredView, const RenderBufferFormattedView *bufferFormattedView) override;
+        void setTexture(uint32_t descriptorIndex, const RenderTexture *texture, RenderTextureLayout textureLayout, const RenderTextureView *textureView) override;
+        void setSampler(uint32_t descriptorIndex, const RenderSampler *sampler) override;
+        void setAccelerationStructure(uint32_t descriptorIndex, const RenderAccelerationStructure *accelerationStructure) override;
+    };
+
+    struct NullSwapChain : RenderSwapChain {
+        NullCommandQueue *commandQueue = nullptr;
+        RenderWindow renderWindow = {};
+        std::vector<std::unique_ptr<NullTexture>> textures;
+        uint32_t textureCursor = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool vsyncEnabled = true;
+
+        NullSwapChain(NullCommandQueue *commandQueue, RenderWindow renderWindow, uint32_t textureCount, RenderFormat format);
+        ~NullSwapChain() override;
+        bool present(uint32_t textureIndex, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount) override;
+        void wait() override;
+        bool resize() override;
+        bool needsResize() const override;
+        void setVsyncEnabled(bool vsyncEnabled) override;
+        bool isVsyncEnabled() const override;
+        uint32_t getWidth() const override;
+        uint32_t getHeight() const override;
+        RenderTexture *getTexture(uint32_t textureIndex) override;
+        uint32_t getTextureCount() const override;
+        bool acquireTexture(RenderCommandSemaphore *signalSemaphore, uint32_t *textureIndex) override;
+        RenderWindow getWindow() const override;
+        bool isEmpty() const override;
+        uint32_t getRefreshRate() const override;
+    };
+
+    struct NullFramebuffer : RenderFramebuffer {
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        NullFramebuffer(const RenderFramebufferDesc &desc);
+        ~NullFramebuffer() override;
+        uint32_t getWidth() const override;
+        uint32_t getHeight() const override;
+    };
+
+    struct NullCommandList : RenderCommandList {
+        NullDevice *device = nullptr;
+        RenderCommandListType type = RenderCommandListType::UNKNOWN;
+        std::vector<NullCommand> commands;
+        bool open = false;
+
+        NullCommandList(NullDevice *device, RenderCommandListType type);
+        ~NullCommandList() override;
+        void begin() override;
+        void end() override;
+        void barriers(RenderBarrierStages stages, const RenderBufferBarrier *bufferBarriers, uint32_t bufferBarriersCount, const RenderTextureBarrier *textureBarriers, uint32_t textureBarriersCount) override;
+        void dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) override;
+        void traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) override;
+        void drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) override;
+        void drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+        void drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) override;
+        void drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) override;
+        void setPipeline(const RenderPipeline *pipeline) override;
+        void setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
+        void setComputePushConstants(uint32_t rangeIndex, const void *data) override;
+        void setComputeDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) override;
+        void setGraphicsPipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
+        void setGraphicsPushConstants(uint32_t rangeIndex, const void *data) override;
+        void setGraphicsDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) override;
+        void setRaytracingPipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
+        void setRaytracingPushConstants(uint32_t rangeIndex, const void *data) override;
+        void setRaytracingDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) override;
+        void setIndexBuffer(const RenderIndexBufferView *view) override;
+        void setVertexBuffers(uint32_t startSlot, const RenderVertexBufferView *views, uint32_t viewCount, const RenderInputSlot *inputSlots) override;
+        void setViewports(const RenderViewport *viewports, uint32_t count) override;
+        void setScissors(const RenderRect *scissorRects, uint32_t count) override;
+        void setFramebuffer(const RenderFramebuffer *framebuffer) override;
+        void clearColor(uint32_t attachmentIndex, RenderColor colorValue, const RenderRect *clearRects, uint32_t clearRectsCount) override;
+        void clearDepth(bool clearDepth, float depthValue, const RenderRect *clearRects, uint32_t clearRectsCount) override;
+        void copyBufferRegion(RenderBufferReference dstBuffer, RenderBufferReference srcBuffer, uint64_t size) override;
+        void copyTextureRegion(const RenderTextureCopyLocation &dstLocation, const RenderTextureCopyLocation &srcLocation, uint32_t dstX, uint32_t dstY, uint32_t dstZ, const RenderBox *srcBox) override;
+        void copyBuffer(const RenderBuffer *dstBuffer, const RenderBuffer *srcBuffer) override;
+        void copyTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) override;
+        void resolveTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) override;
+        void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) override;
+        void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) override;
+        void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) override;
+        void resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) override;
+        void resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void setOutOfOrderRecording(bool enabled) override;
+        NullCommand &record(NullCommandType type);
+    };
+
+    struct NullCommandFence : RenderCommandFence {
+        NullCommandFence();
+        ~NullCommandFence() override;
+    };
+
+    struct NullCommandSemaphore : RenderCommandSemaphore {
+        NullCommandSemaphore();
+        ~NullCommandSemaphore() override;
+    };
+
+    struct NullCommandQueue : RenderCommandQueue {
+        NullDevice *device = nullptr;
+        RenderCommandListType type = RenderCommandListType::UNKNOWN;
+        std::mutex executeMutex;
+        uint64_t executedCommandCount = 0;
+
+        NullCommandQueue(NullDevice *device, RenderCommandListType type);
+        ~NullCommandQueue() override;
+        std::unique_ptr<RenderCommandList> createCommandList(RenderCommandListType type) override;
+        std::unique_ptr<RenderSwapChain> createSwapChain(RenderWindow renderWindow, uint32_t textureCount, RenderFormat format) override;
+        void executeCommandLists(const RenderCommandList **commandLists, uint32_t commandListCount, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount, RenderCommandSemaphore **signalSemaphores, uint32_t signalSemaphoreCount, RenderCommandFence *signalFence) override;
+        void waitForCommandFence(RenderCommandFence *fence) override;
+        void executeCommand(const NullCommand &command);
+    };
+
+    struct NullQueryPool : RenderQueryPool {
+        std::vector<uint64_t> results;
+
+        NullQueryPool(uint32_t queryCount);
+        ~NullQueryPool() override;
+        void queryResults() override;
+        const uint64_t *getResults() const override;
+        uint32_t getCount() const override;
+    };
+
+    struct NullShader : RenderShader {
+        std::string entryPointName;
+        RenderShaderFormat format = RenderShaderFormat::UNKNOWN;
+
+        NullShader(const char *entryPointName, RenderShaderFormat format);
+        ~NullShader() override;
+    };
+
+    struct NullSampler : RenderSampler {
+        RenderSamplerDesc desc;
+
+        NullSampler(const RenderSamplerDesc &desc);
+        ~NullSampler() override;
+    };
+
+    struct NullPipeline : RenderPipeline {
+        enum class Type {
+            Unknown,
+            Compute,
+            Graphics,
+            Raytracing
+        };
+
+        Type type = Type::Unknown;
+
+        NullPipeline(Type type);
+        ~NullPipeline() override;
+        RenderPipelineProgram getProgram(const std::string &name) const override;
+    };
+
+    struct NullPipelineCache : RenderPipelineCache {
+        std::vector<uint8_t> data;
+
+        NullPipelineCache(const void *data, uint64_t size);
+        ~NullPipelineCache() override;
+        bool getData(std::vector<uint8_t> &data) override;
+    };
+
+    struct NullPipelineLayout : RenderPipelineLayout {
+        NullPipelineLayout();
+        ~NullPipelineLayout() override;
+    };
+
+    // Device that doesn't require a GPU. Buffers and textures are allocated in CPU memory and command lists are only recorded into
+    // a stream of commands. Buffer copies are performed on the CPU when the command lists are executed and fences complete immediately.
+    struct NullDevice : RenderDevice {
+        NullInterface *renderInterface = nullptr;
+        RenderDeviceCapabilities capabilities;
+        RenderDeviceDescription description;
+
+        NullDevice(NullInterface *renderInterface);
+        ~NullDevice() override;
+        std::unique_ptr<RenderDescriptorSet> createDescriptorSet(const RenderDescriptorSetDesc &desc) override;
+        std::unique_ptr<RenderShader> createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) override;
+        std::unique_ptr<RenderSampler> createSampler(const RenderSamplerDesc &desc) override;
+        std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) override;
+        std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) override;
+        std::unique_ptr<RenderPipeline> createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) override;
+        std::unique_ptr<RenderCommandQueue> createCommandQueue(RenderCommandListType type) override;
+        std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) override;
+        std::unique_ptr<RenderTexture> createTexture(const RenderTextureDesc &desc) override;
+        std::unique_ptr<RenderAccelerationStructure> createAccelerationStructure(const RenderAccelerationStructureDesc &desc) override;
+        std::unique_ptr<RenderPool> createPool(const RenderPoolDesc &desc) override;
+        std::unique_ptr<RenderPipelineLayout> createPipelineLayout(const RenderPipelineLayoutDesc &desc) override;
+        std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data, uint64_t size) override;
+        std::unique_ptr<RenderCommandFence> createCommandFence() override;
+        std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() override;
+        std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) override;
+        std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) override;
+        void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) override;
+        void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) override;
+        void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) override;
+        const RenderDeviceCapabilities &getCapabilities() const override;
+        const RenderDeviceDescription &getDescription() const override;
+        RenderSampleCounts getSampleCountsSupported(RenderFormat format) const override;
+        bool beginCapture() override;
+        bool endCapture() override;
+    };
+
+    struct NullInterface : RenderInterface {
+        RenderInterfaceCapabilities capabilities;
+
+        NullInterface();
+        ~NullInterface() override;
+        std::unique_ptr<RenderDevice> createDevice() override;
+        const RenderInterfaceCapabilities &getCapabilities() const override;
+    };
+};
@@ -6,10 +6,23 @@
 #include <cstring>
 
 #include "common/rt64_thread.h"
+#include "xxHash/xxh3.h"
 
 #include "rt64_buffer_uploader.h"
 
 namespace RT64 {
+    // Uploads smaller than this are copied by the uploader's task alone, as waking up other threads would cost more than the copy itself.
+    static const uint64_t ParallelCopyThreshold = 1024 * 1024;
+
+    // Size the uploads are split into when the copies are spread across the scheduler's threads.
+    static const uint64_t ParallelCopyChunkSize = 256 * 1024;
+
+    // Size of the blocks that are compared against the last upload when delta uploads are enabled.
+    static const uint64_t DeltaUploadBlockSize = 4 * 1024;
+
+    // Uploads with a higher ratio of changed blocks are copied in full, as splitting them would only add more copy commands.
+    static const double DeltaUploadMaxChangeRatio = 0.5;
+
     // Common functions.
 
     static uint64_t roundUp(uint64_t value, uint64_t powerOf2Alignment) {
@@ -22,61 +35,174 @@ namespace RT64 {
         return (srcData != nullptr) && (srcDataIndexRange.second > srcDataIndexRange.first);
     }
 
+    void BufferUploader::Upload::segments(std::vector<std::pair<size_t, size_t>> &indexRanges) const {
+        indexRanges.clear();
+
+        size_t segmentStart = srcDataIndexRange.first;
+        for (const std::pair<size_t, size_t> &skipRange : skipIndexRanges) {
+            const size_t skipStart = std::clamp(skipRange.first, segmentStart, srcDataIndexRange.second);
+            const size_t skipEnd = std::clamp(skipRange.second, skipStart, srcDataIndexRange.second);
+            if (skipStart > segmentStart) {
+                indexRanges.emplace_back(segmentStart, skipStart);
+            }
+
+            segmentStart = skipEnd;
+        }
+
+        if (srcDataIndexRange.second > segmentStart) {
+            indexRanges.emplace_back(segmentStart, srcDataIndexRange.second);
+        }
+    }
+
     // BufferUploader
 
-    BufferUploader::BufferUploader(RenderDevice *device) {
+    BufferUploader::BufferUploader(RenderDevice *device, StagingRing *stagingRing, TaskScheduler *taskScheduler) {
         assert(device != nullptr);
+        assert(stagingRing != nullptr);
+        assert(taskScheduler != nullptr);
 
         this->device = device;
-        workAvailable = false;
-        thread = new std::thread(&BufferUploader::threadLoop, this);
+        this->stagingRing = stagingRing;
+        this->taskScheduler = taskScheduler;
     }
 
     BufferUploader::~BufferUploader() {
-        running = false;
-        workCondition.notify_all();
-        thread->join();
-        delete thread;
+        waitForCopyTask();
+        releaseAllocations();
     }
 
-    void BufferUploader::threadLoop() {
-        Thread::setCurrentThreadName("RT64 Buffer");
+    void BufferUploader::copyUploads() {
+        copyProfiler.reset();
+        copyProfiler.start();
+
+        pendingCopies.clear();
+        for (size_t i = 0; i < pendingUploads.size(); i++) {
+            queueCopies(pendingUploads[i], pendingAllocations[i]);
+        }
 
-        running = true;
+        uint64_t totalSize = 0;
+        for (const Copy &copy : pendingCopies) {
+            totalSize += copy.size;
+        }
 
-        while (running) {
-            std::unique_lock<std::mutex> queueLock(workMutex);
-            workCondition.wait(queueLock, [this]() {
-                return !running || workAvailable;
+        if (totalSize >= ParallelCopyThreshold) {
+            taskScheduler->parallelFor(Thread::Priority::Normal, pendingCopies.size(), [this](size_t copyIndex) {
+                const Copy &copy = pendingCopies[copyIndex];
+                memcpy(copy.dstData, copy.srcData, copy.size);
             });
-            
-            if (running) {
-                for (const Upload &u : pendingUploads) {
-                    threadUpload(u);
+        }
+        else {
+            for (const Copy &copy : pendingCopies) {
+                memcpy(copy.dstData, copy.srcData, copy.size);
+            }
+        }
+
+        copyProfiler.end();
+        copyProfiler.log();
+        copiedBytes = totalSize;
+        copiedChunks = uint32_t(pendingCopies.size());
+    }
+
+    void BufferUploader::queueCopies(const Upload &upload, const StagingRing::Allocation &allocation) {
+        if (!upload.valid()) {
+            return;
+        }
+
+        // The staging memory is persistently mapped, so only the range that changed needs to be copied.
+        assert(allocation.valid());
+        thread_local std::vector<std::pair<size_t, size_t>> segments;
+        upload.segments(segments);
+        for (const std::pair<size_t, size_t> &segment : segments) {
+            const size_t srcOffset = segment.first * upload.srcDataStride;
+            const size_t srcSize = (segment.second - segment.first) * upload.srcDataStride;
+            const size_t dstOffset = (segment.first - upload.srcDataIndexRange.first) * upload.srcDataStride;
+            const uint8_t *srcData = static_cast<const uint8_t *>(upload.srcData) + srcOffset;
+            for (size_t chunkOffset = 0; chunkOffset < srcSize; chunkOffset += ParallelCopyChunkSize) {
+                const size_t chunkSize = std::min(size_t(ParallelCopyChunkSize), srcSize - chunkOffset);
+                pendingCopies.emplace_back(Copy{ allocation.data + dstOffset + chunkOffset, srcData + chunkOffset, chunkSize });
+            }
+        }
+    }
+
+    void BufferUploader::skipUnchangedBlocks(Upload &upload) {
+        // Blocks are aligned to the start of the buffer and hashed in full even if the range starts in the middle of one.
+        BufferPair &bufferPair = *upload.dstPair;
+        const size_t stride = upload.srcDataStride;
+        const size_t blockElements = std::max(size_t(DeltaUploadBlockSize / stride), size_t(1));
+        const size_t firstBlock = upload.srcDataIndexRange.first / blockElements;
+        const size_t blockCount = (upload.srcDataIndexRange.second + blockElements - 1) / blockElements;
+        const size_t hashedBlockCount = bufferPair.blockHashes.size();
+        if (bufferPair.blockHashes.size() < blockCount) {
+            bufferPair.blockHashes.resize(blockCount, 0);
+        }
+
+        thread_local std::vector<std::pair<size_t, size_t>> unchangedRanges;
+        unchangedRanges.clear();
+
+        size_t changedBlocks = 0;
+        const uint8_t *srcData = static_cast<const uint8_t *>(upload.srcData);
+        for (size_t b = firstBlock; b < blockCount; b++) {
+            const size_t blockStart = b * blockElements;
+            const size_t blockEnd = std::min(blockStart + blockElements, upload.srcDataIndexRange.second);
+            const size_t blockBytes = (blockEnd - blockStart) * stride;
+            const uint64_t blockHash = XXH3_64bits_withSeed(srcData + blockStart * stride, blockBytes, blockBytes);
+            if ((b < hashedBlockCount) && (bufferPair.blockHashes[b] == blockHash)) {
+                const size_t skipStart = std::max(blockStart, upload.srcDataIndexRange.first);
+                if (!unchangedRanges.empty() && (unchangedRanges.back().second == skipStart)) {
+                    unchangedRanges.back().second = blockEnd;
+                }
+                else {
+                    unchangedRanges.emplace_back(skipStart, blockEnd);
                 }
             }
+            else {
+                bufferPair.blockHashes[b] = blockHash;
+                changedBlocks++;
+            }
+        }
+
+        // The hashes are still valid if the upload falls back to copying everything.
+        if (changedBlocks > ((blockCount - firstBlock) * DeltaUploadMaxChangeRatio)) {
+            return;
+        }
+
+        upload.skipIndexRanges.insert(upload.skipIndexRanges.end(), unchangedRanges.begin(), unchangedRanges.end());
+        std::sort(upload.skipIndexRanges.begin(), upload.skipIndexRanges.end());
+    }
 
-            {
-                std::unique_lock<std::mutex> readyLock(readyMutex);
-                workAvailable = false;
+    void BufferUploader::updateUploadStats() {
+        thread_local std::vector<std::pair<size_t, size_t>> segments;
+        std::unique_lock<std::mutex> statsLock(uploadStatsMutex);
+        uploadStats.resize(pendingUploads.size());
+        for (size_t i = 0; i < pendingUploads.size(); i++) {
+            const Upload &u = pendingUploads[i];
+            UploadStats &stats = uploadStats[i];
+            stats.name = u.name;
+            stats.rangeBytes = 0;
+            stats.uploadedBytes = 0;
+            if (!u.valid()) {
+                continue;
             }
 
-            readyCondition.notify_all();
+            u.segments(segments);
+            stats.rangeBytes = (u.srcDataIndexRange.second - u.srcDataIndexRange.first) * u.srcDataStride;
+            for (const std::pair<size_t, size_t> &segment : segments) {
+                stats.uploadedBytes += (segment.second - segment.first) * u.srcDataStride;
+            }
         }
     }
 
-    void BufferUploader::threadUpload(const Upload &upload) {
-        if (!upload.valid()) {
-            return;
+    void BufferUploader::getUploadStats(std::vector<UploadStats> &stats) const {
+        std::unique_lock<std::mutex> statsLock(uploadStatsMutex);
+        stats = uploadStats;
+    }
+
+    void BufferUploader::releaseAllocations() {
+        for (StagingRing::Allocation &allocation : pendingAllocations) {
+            stagingRing->release(allocation);
         }
 
-        assert(upload.dstPair != nullptr);
-        const size_t srcOffset = upload.srcDataIndexRange.first * upload.srcDataStride;
-        const size_t srcSize = (upload.srcDataIndexRange.second - upload.srcDataIndexRange.first) * upload.srcDataStride;
-        const RenderRange writtenRange(srcOffset, srcOffset + srcSize);
-        uint8_t *dstData = static_cast<uint8_t *>(upload.dstPair->uploadBuffer->map());
-        memcpy(dstData + srcOffset, static_cast<const uint8_t *>(upload.srcData) + srcOffset, srcSize);
-        upload.dstPair->uploadBuffer->unmap(0, &writtenRange);
+        pendingAllocations.clear();
     }
 
     void BufferUploader::updateResources(RenderWorker *worker, std::vector<Upload> &blankUploads) {
@@ -89,12 +215,12 @@ namespace RT64 {
             }
 
             bufferPair.defaultViews.clear();
+            bufferPair.blockHashes.clear();
             
-            // Recreate the buffer pair.
+            // Recreate the buffer. The upload memory comes from the staging ring, so only the device local side needs to grow.
             const uint64_t BlockAlignment = 256;
             bufferPair.allocatedSize = std::max(uint64_t((requiredSize * 3) / 2), BlockAlignment);
             bufferPair.allocatedSize = roundUp(bufferPair.allocatedSize, BlockAlignment);
-            bufferPair.uploadBuffer = worker->device->createBuffer(RenderBufferDesc::UploadBuffer(bufferPair.allocatedSize));
             bufferPair.defaultBuffer = worker->device->createBuffer(RenderBufferDesc::DefaultBuffer(bufferPair.allocatedSize, u.bufferFlags));
 
             bufferPair.defaultViews.reserve(u.formatViews.size());
@@ -108,14 +234,39 @@ namespace RT64 {
     }
 
     void BufferUploader::submit(RenderWorker *worker, const std::vector<Upload> &uploads) {
-        {
-            std::unique_lock<std::mutex> queueLock(workMutex);
-            pendingUploads = uploads;
-            updateResources(worker, pendingUploads);
-            workAvailable = true;
+        // The copies of the previous submission must be finished before its uploads are replaced.
+        waitForCopyTask();
+
+        pendingUploads = uploads;
+        updateResources(worker, pendingUploads);
+
+        // Buffers written by uploaders without delta uploads no longer match the hashes of their blocks.
+        for (Upload &u : pendingUploads) {
+            if (!u.valid()) {
+                continue;
+            }
+
+            if (deltaUploads) {
+                skipUnchangedBlocks(u);
+            }
+            else {
+                u.dstPair->blockHashes.clear();
+            }
+        }
+
+        updateUploadStats();
+
+        // The previous uploads can't be recorded anymore, so their staging memory can be given back as soon as the GPU is done with it.
+        releaseAllocations();
+        pendingAllocations.resize(pendingUploads.size());
+        for (size_t i = 0; i < pendingUploads.size(); i++) {
+            const Upload &u = pendingUploads[i];
+            if (u.valid()) {
+                pendingAllocations[i] = stagingRing->allocate((u.srcDataIndexRange.second - u.srcDataIndexRange.first) * u.srcDataStride);
+            }
         }
 
-        workCondition.notify_all();
+        copyTask = taskScheduler->submit(Thread::Priority::Normal, [this]() { copyUploads(); });
     }
 
     void BufferUploader::commandListBeforeBarriers(RenderWorker *worker) {
@@ -137,14 +288,23 @@ namespace RT64 {
     }
 
     void BufferUploader::commandListCopyResources(RenderWorker *worker) {
-        for (const Upload &u : pendingUploads) {
+        thread_local std::vector<std::pair<size_t, size_t>> segments;
+        for (size_t i = 0; i < pendingUploads.size(); i++) {
+            const Upload &u = pendingUploads[i];
             if (!u.valid()) {
                 continue;
             }
 
-            const uint64_t srcOffset = u.srcDataIndexRange.first * u.srcDataStride;
-            const uint64_t srcSize = (u.srcDataIndexRange.second - u.srcDataIndexRange.first) * u.srcDataStride;
-            worker->commandList->copyBufferRegion(u.dstPair->defaultBuffer->at(srcOffset), u.dstPair->uploadBuffer->at(srcOffset), srcSize);
+            const StagingRing::Allocation &allocation = pendingAllocations[i];
+            u.segments(segments);
+            for (const std::pair<size_t, size_t> &segment : segments) {
+                const uint64_t dstOffset = segment.first * u.srcDataStride;
+                const uint64_t srcOffset = allocation.offset + (segment.first - u.srcDataIndexRange.first) * u.srcDataStride;
+                const uint64_t srcSize = (segment.second - segment.first) * u.srcDataStride;
+                worker->commandList->copyBufferRegion(u.dstPair->defaultBuffer->at(dstOffset), allocation.buffer->at(srcOffset), srcSize);
+            }
+
+            stagingRing->markUsed(allocation, worker);
         }
     }
 
@@ -166,10 +326,19 @@ namespace RT64 {
         }
     }
     
+    void BufferUploader::waitForCopyTask() {
+        // The copies are done by the calling thread instead if no other thread has started them yet.
+        if (copyTask != nullptr) {
+            taskScheduler->wait(copyTask);
+            copyTask.reset();
+        }
+    }
+
     void BufferUploader::wait() {
-        std::unique_lock<std::mutex> readyLock(readyMutex);
-        readyCondition.wait(readyLock, [this]() {
-            return !workAvailable;
-        });
+        waitProfiler.reset();
+        waitProfiler.start();
+        waitForCopyTask();
+        waitProfiler.end();
+        waitProfiler.log();
     }
 };
\ No newline at end of file
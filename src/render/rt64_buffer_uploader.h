@@ -5,19 +5,23 @@
 #pragma once
 
 #include <mutex>
-#include <thread>
 #include <atomic>
-#include <condition_variable>
+
+#include "common/rt64_profiling_timer.h"
+#include "common/rt64_task_scheduler.h"
 
 #include "rt64_render_worker.h"
+#include "rt64_staging_ring.h"
 
 namespace RT64 {
     struct BufferPair {
-        std::unique_ptr<RenderBuffer> uploadBuffer;
         std::unique_ptr<RenderBuffer> defaultBuffer;
         std::vector<std::unique_ptr<RenderBufferFormattedView>> defaultViews;
         uint64_t allocatedSize = 0;
 
+        // Hashes of the blocks of data last uploaded into the buffer by an uploader with delta uploads enabled.
+        std::vector<uint64_t> blockHashes;
+
         const RenderBuffer *get() const {
             return defaultBuffer.get();
         }
@@ -40,29 +44,62 @@ namespace RT64 {
             RenderBufferFlags bufferFlags;
             std::vector<RenderFormat> formatViews;
             BufferPair *dstPair;
+            const char *name = nullptr;
+
+            // Sorted ranges inside the index range that are written to the destination by other means and don't need to be copied.
+            std::vector<std::pair<size_t, size_t>> skipIndexRanges;
 
             bool valid() const;
+            void segments(std::vector<std::pair<size_t, size_t>> &indexRanges) const;
+        };
+
+        struct Copy {
+            void *dstData;
+            const void *srcData;
+            size_t size;
         };
 
-        std::thread *thread;
-        std::atomic<bool> running;
-        bool workAvailable;
-        std::mutex workMutex;
-        std::mutex readyMutex;
-        std::condition_variable workCondition;
-        std::condition_variable readyCondition;
         RenderDevice *device;
+        StagingRing *stagingRing;
+        TaskScheduler *taskScheduler;
+        std::shared_ptr<TaskScheduler::Task> copyTask;
         std::vector<Upload> pendingUploads;
+        std::vector<StagingRing::Allocation> pendingAllocations;
+        std::vector<Copy> pendingCopies;
+
+        // Only the blocks that changed since the last upload into the same buffer are copied when enabled.
+        bool deltaUploads = false;
+
+        struct UploadStats {
+            const char *name = nullptr;
+            uint64_t rangeBytes = 0;
+            uint64_t uploadedBytes = 0;
+        };
+
+        // Bytes each of the uploads of the last submission covered and the ones that were actually copied.
+        std::vector<UploadStats> uploadStats;
+        mutable std::mutex uploadStatsMutex;
+
+        // Time spent by the uploader's task on the copies and by the callers of wait(), in milliseconds.
+        ProfilingTimer copyProfiler = ProfilingTimer(120);
+        ProfilingTimer waitProfiler = ProfilingTimer(120);
+        std::atomic<uint64_t> copiedBytes = 0;
+        std::atomic<uint32_t> copiedChunks = 0;
 
-        BufferUploader(RenderDevice *device);
+        BufferUploader(RenderDevice *device, StagingRing *stagingRing, TaskScheduler *taskScheduler);
         ~BufferUploader();
-        void threadLoop();
-        void threadUpload(const Upload &upload);
+        void copyUploads();
+        void queueCopies(const Upload &upload, const StagingRing::Allocation &allocation);
+        void skipUnchangedBlocks(Upload &upload);
+        void updateUploadStats();
+        void getUploadStats(std::vector<UploadStats> &stats) const;
+        void releaseAllocations();
         void updateResources(RenderWorker *worker, std::vector<Upload> &blankUploads); // Upload data does not need to be filled in with valid data, only the sizes.
         void commandListBeforeBarriers(RenderWorker *worker);
         void commandListCopyResources(RenderWorker *worker);
         void commandListAfterBarriers(RenderWorker *worker);
         void submit(RenderWorker *worker, const std::vector<Upload> &uploads);
+        void waitForCopyTask();
         void wait();
     };
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+//
+// RT64
+//
+
+#include "rt64_command_list_recorder.h"
+
+#include <cassert>
+
+namespace RT64 {
+    // Recording is on the critical path of every workload, so it's run ahead of all the other tasks.
+    static const Thread::Priority JobTaskPriority = Thread::Priority::High;
+
+    // CommandListRecorder
+
+    CommandListRecorder::CommandListRecorder(RenderWorker *worker, RenderCommandListType commandListType, TaskScheduler *taskScheduler, uint32_t parallelCount) {
+        assert(worker != nullptr);
+        assert((taskScheduler != nullptr) || (parallelCount == 0));
+
+        commandQueue = worker->commandQueue.get();
+        this->commandListType = commandListType;
+        this->taskScheduler = taskScheduler;
+        this->parallelCount = parallelCount;
+    }
+
+    CommandListRecorder::~CommandListRecorder() {
+        for (const std::shared_ptr<TaskScheduler::Task> &jobTask : jobTasks) {
+            taskScheduler->wait(jobTask);
+        }
+    }
+
+    uint32_t CommandListRecorder::getParallelCount() const {
+        return parallelCount;
+    }
+
+    void CommandListRecorder::begin(RenderWorker *worker) {
+        assert(worker != nullptr);
+        assert(recordingWorker == nullptr);
+        assert(workerCommandList == nullptr);
+
+        // The lists used by the previous execution can be reused now since the worker waited for them to finish.
+        for (std::unique_ptr<RenderCommandList> &commandList : usedCommandLists) {
+            commandListPool.emplace_back(std::move(commandList));
+        }
+
+        usedCommandLists.clear();
+        submissionLists.clear();
+        recordingWorker = worker;
+    }
+
+    void CommandListRecorder::recordParallel(const RecordCallback &callback) {
+        assert(recordingWorker != nullptr);
+
+        // Close the current list of the worker and replace it with a new one after queuing the parallel one.
+        RenderCommandList *currentList = recordingWorker->commandList.get();
+        currentList->end();
+        submissionLists.emplace_back(currentList);
+
+        if (workerCommandList == nullptr) {
+            workerCommandList = std::move(recordingWorker->commandList);
+        }
+        else {
+            usedCommandLists.emplace_back(std::move(recordingWorker->commandList));
+        }
+
+        std::unique_ptr<RenderCommandList> parallelList = acquireCommandList();
+        submissionLists.emplace_back(parallelList.get());
+
+        if (parallelCount == 0) {
+            parallelList->begin();
+            callback(parallelList.get());
+            parallelList->end();
+        }
+        else {
+            // A new task is only needed if the ones that are already running can't take more jobs.
+            bool submitTask = false;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobQueue.emplace_back(Job{ parallelList.get(), callback });
+                if (activeJobTaskCount < parallelCount) {
+                    activeJobTaskCount++;
+                    submitTask = true;
+                }
+            }
+
+            if (submitTask) {
+                jobTasks.emplace_back(taskScheduler->submit(JobTaskPriority, [this]() { recordJobs(true); }));
+            }
+        }
+
+        usedCommandLists.emplace_back(std::move(parallelList));
+        recordingWorker->commandList = acquireCommandList();
+        recordingWorker->commandList->begin();
+    }
+
+    void CommandListRecorder::execute() {
+        assert(recordingWorker != nullptr);
+
+        RenderCommandList *currentList = recordingWorker->commandList.get();
+        currentList->end();
+        submissionLists.emplace_back(currentList);
+
+        // The worker's thread records the jobs no task has taken yet. Tasks that were never started are run on this thread and find no jobs left.
+        recordJobs(false);
+
+        for (const std::shared_ptr<TaskScheduler::Task> &jobTask : jobTasks) {
+            taskScheduler->wait(jobTask);
+        }
+
+        jobTasks.clear();
+        assert(jobQueue.empty() && (activeJobTaskCount == 0));
+
+        commandQueue->executeCommandLists(submissionLists.data(), uint32_t(submissionLists.size()), nullptr, 0, nullptr, 0, recordingWorker->commandFence.get());
+        recordingWorker->submittedCount++;
+
+        // Give the original list back to the worker so it can keep using it outside of the recorder.
+        if (workerCommandList != nullptr) {
+            usedCommandLists.emplace_back(std::move(recordingWorker->commandList));
+            recordingWorker->commandList = std::move(workerCommandList);
+        }
+
+        recordingWorker = nullptr;
+    }
+
+    std::unique_ptr<RenderCommandList> CommandListRecorder::acquireCommandList() {
+        std::unique_ptr<RenderCommandList> commandList;
+        if (commandListPool.empty()) {
+            commandList = commandQueue->createCommandList(commandListType);
+        }
+        else {
+            commandList = std::move(commandListPool.back());
+            commandListPool.pop_back();
+        }
+
+        // The lists are only recorded out of order if the jobs are recorded by the tasks while the worker keeps recording.
+        commandList->setOutOfOrderRecording(parallelCount > 0);
+        return commandList;
+    }
+
+    void CommandListRecorder::recordJobs(bool fromTask) {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        while (!jobQueue.empty()) {
+            // Jobs are taken in the order they were queued, but they can finish in any order since they're submitted later.
+            Job job = std::move(jobQueue.front());
+            jobQueue.pop_front();
+            lock.unlock();
+
+            job.commandList->begin();
+            job.callback(job.commandList);
+            job.commandList->end();
+
+            lock.lock();
+        }
+
+        // A task only stops once it finds the queue empty while holding the mutex, so any job queued afterwards submits a new task.
+        if (fromTask) {
+            activeJobTaskCount--;
+        }
+    }
+};
@@ -0,0 +1,61 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/rt64_task_scheduler.h"
+
+#include "rt64_render_worker.h"
+
+namespace RT64 {
+    // Splits the recording of a worker's command list into multiple command lists that are submitted in order.
+    // Independent sections can be recorded by tasks of the scheduler while the worker keeps recording the rest.
+    struct CommandListRecorder {
+        typedef std::function<void(RenderCommandList *commandList)> RecordCallback;
+
+        struct Job {
+            RenderCommandList *commandList = nullptr;
+            RecordCallback callback;
+        };
+
+        RenderCommandQueue *commandQueue = nullptr;
+        RenderCommandListType commandListType = RenderCommandListType::DIRECT;
+        std::vector<std::unique_ptr<RenderCommandList>> commandListPool;
+        std::vector<std::unique_ptr<RenderCommandList>> usedCommandLists;
+        std::vector<const RenderCommandList *> submissionLists;
+        std::unique_ptr<RenderCommandList> workerCommandList;
+        RenderWorker *recordingWorker = nullptr;
+        TaskScheduler *taskScheduler = nullptr;
+        uint32_t parallelCount = 0;
+        std::deque<Job> jobQueue;
+        std::mutex jobMutex;
+        std::vector<std::shared_ptr<TaskScheduler::Task>> jobTasks;
+        uint32_t activeJobTaskCount = 0;
+
+        // Up to the parallel count of tasks record the queued jobs at the same time. Everything is recorded by the worker's thread if it's zero.
+        CommandListRecorder(RenderWorker *worker, RenderCommandListType commandListType, TaskScheduler *taskScheduler, uint32_t parallelCount);
+        ~CommandListRecorder();
+        uint32_t getParallelCount() const;
+
+        // Must be called right after the worker's command list has been opened.
+        void begin(RenderWorker *worker);
+
+        // Closes the worker's current command list and queues a new one that is recorded by the callback on the task scheduler.
+        // The worker continues recording on a new command list that will be submitted after the one recorded by the callback.
+        void recordParallel(const RecordCallback &callback);
+
+        // Closes the worker's current command list, waits for all the callbacks to finish and executes every list in order.
+        // The worker's original command list is restored afterwards. The worker must wait on its fence before calling begin() again.
+        void execute();
+
+        std::unique_ptr<RenderCommandList> acquireCommandList();
+        void recordJobs(bool fromTask);
+    };
+};
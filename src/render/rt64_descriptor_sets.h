@@ -212,6 +212,7 @@ namespace RT64 {
         uint32_t gFilteredDirectLight;
         uint32_t gFilteredIndirectLight;
         uint32_t gBlueNoise;
+        uint32_t rawVertexRenderIndices;
 
         FramebufferRendererDescriptorCommonSet(const SamplerLibrary &samplerLibrary, bool raytracing, RenderDevice *device = nullptr) {
             builder.begin();
@@ -282,6 +283,7 @@ namespace RT64 {
             gFilteredDirectLight = builder.addReadWriteTexture(65);
             gFilteredIndirectLight = builder.addReadWriteTexture(66);
             gBlueNoise = builder.addTexture(67);
+            rawVertexRenderIndices = builder.addStructuredBuffer(68);
             builder.end();
 
             if (device != nullptr) {
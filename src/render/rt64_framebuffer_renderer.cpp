@@ -4,6 +4,9 @@
 
 #include "rt64_framebuffer_renderer.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "../include/rt64_extended_gbi.h"
 
 #include "common/rt64_elapsed_timer.h"
@@ -154,13 +157,60 @@ namespace RT64 {
         return { v.x, v.y, v.z, v.w };
     }
 
+    bool isRawVertexCall(const InstanceDrawCall &drawCall) {
+        return (drawCall.type == InstanceDrawCall::Type::RawTriangles) || (drawCall.type == InstanceDrawCall::Type::RegularRect);
+    }
+
+    bool canDrawCallsShareState(const InstanceDrawCall &previousCall, const InstanceDrawCall &drawCall) {
+        const bool trianglesCall = (previousCall.type == InstanceDrawCall::Type::IndexedTriangles) || isRawVertexCall(previousCall);
+        if (!trianglesCall || (drawCall.type != previousCall.type)) {
+            return false;
+        }
+
+        // Indexed calls must use the same index buffer.
+        const auto &prevTriangles = previousCall.triangles;
+        const auto &triangles = drawCall.triangles;
+        if ((drawCall.type == InstanceDrawCall::Type::IndexedTriangles) && (prevTriangles.vertexTestZ != triangles.vertexTestZ)) {
+            return false;
+        }
+
+        // Post blend dither noise uses the render index from the push constants and must be drawn right after its own call.
+        if (prevTriangles.postBlendDitherNoise || triangles.postBlendDitherNoise) {
+            return false;
+        }
+
+        if ((prevTriangles.pipeline != triangles.pipeline) || (prevTriangles.viewport != triangles.viewport) || (prevTriangles.scissor != triangles.scissor)) {
+            return false;
+        }
+
+        // Calls with empty viewports or scissors are skipped when drawing.
+        if (triangles.viewport.isEmpty() || triangles.scissor.isEmpty()) {
+            return false;
+        }
+
+        // Calls must require the same depth access so no pass changes are needed in between.
+        const interop::OtherMode prevOtherMode = prevTriangles.shaderDesc.otherMode;
+        const interop::OtherMode otherMode = triangles.shaderDesc.otherMode;
+        return ((prevOtherMode.zMode() == ZMODE_DEC) == (otherMode.zMode() == ZMODE_DEC)) && (prevOtherMode.zUpd() == otherMode.zUpd());
+    }
+
+    bool canMergeDrawCalls(const InstanceDrawCall &previousCall, const InstanceDrawCall &drawCall) {
+        // Indexed calls can share vertices with other calls, so only calls that read their own raw vertices can identify themselves by the vertex index.
+        if (!isRawVertexCall(previousCall) || !canDrawCallsShareState(previousCall, drawCall)) {
+            return false;
+        }
+
+        const auto &prevTriangles = previousCall.triangles;
+        return (prevTriangles.indexStart + prevTriangles.faceCount * 3) == drawCall.triangles.indexStart;
+    }
+
     // RasterScene
 
     RasterScene::RasterScene() { }
 
     // FramebufferRenderer
     
-    FramebufferRenderer::FramebufferRenderer(RenderWorker *worker, bool rtSupport, UserConfiguration::GraphicsAPI graphicsAPI, const ShaderLibrary *shaderLibrary) {
+    FramebufferRenderer::FramebufferRenderer(RenderWorker *worker, bool rtSupport, UserConfiguration::GraphicsAPI graphicsAPI, const ShaderLibrary *shaderLibrary, StagingRing *stagingRing, TaskScheduler *taskScheduler) {
         assert(worker != nullptr);
 
         this->shaderLibrary = shaderLibrary;
@@ -169,7 +219,8 @@ namespace RT64 {
         frameParams.viewUbershaders = false;
         frameParams.ditherNoiseStrength = 1.0f;
 
-        shaderUploader = std::make_unique<BufferUploader>(worker->device);
+        shaderUploader = std::make_unique<BufferUploader>(worker->device, stagingRing, taskScheduler);
+        drawIndirectSupport = worker->device->getCapabilities().drawIndirectCount;
         descCommonSet = std::make_unique<FramebufferRendererDescriptorCommonSet>(shaderLibrary->samplerLibrary, worker->device->getCapabilities().raytracing, worker->device);
 
 #   if RT_ENABLED
@@ -191,7 +242,13 @@ namespace RT64 {
         instanceDrawCallVector.clear();
         hitGroupVector.clear();
         renderIndicesVector.clear();
+        rawVertexRenderIndicesVector.clear();
+        drawIndirectArgumentsVector.clear();
+        drawIndexedIndirectArgumentsVector.clear();
+        drawIndirectCountsVector.clear();
         rspSmoothNormalVector.clear();
+        rasterCallCount = 0;
+        rasterDrawCount = 0;
         frameParams.viewUbershaders = ubershadersVisible;
         frameParams.ditherNoiseStrength = ditherNoiseStrength;
         framebufferCount = 0;
@@ -232,13 +289,35 @@ namespace RT64 {
 
     void FramebufferRenderer::updateTextureCache(TextureCache *textureCache) {
         const std::unique_lock<std::mutex> textureMapLock(textureCache->textureMapMutex);
-        textureCacheVersions = textureCache->textureMap.versions;
-        textureCacheTextures = textureCache->textureMap.textures;
-        textureCacheTextureReplacements = textureCache->textureMap.textureReplacements;
-        textureCacheFreeSpaces = textureCache->textureMap.freeSpaces;
+        const TextureMap &textureMap = textureCache->textureMap;
+        if (textureCacheFullRefresh || (textureCacheChangeLogCursor < textureMap.changeLogStart)) {
+            // The entire map is copied on the first update or when the changes since the last update are no longer in the log.
+            textureCacheVersions = textureMap.versions;
+            textureCacheTextures = textureMap.textures;
+            textureCacheTextureReplacements = textureMap.textureReplacements;
+            textureCacheChangedIndices.clear();
+            textureCacheFullRefresh = true;
+        }
+        else {
+            // Only copy the entries of the textures that changed since the last update.
+            const size_t textureCount = textureMap.textures.size();
+            textureCacheVersions.resize(textureCount, 0);
+            textureCacheTextures.resize(textureCount, nullptr);
+            textureCacheTextureReplacements.resize(textureCount, nullptr);
+
+            const size_t logStart = size_t(textureCacheChangeLogCursor - textureMap.changeLogStart);
+            for (size_t i = logStart; i < textureMap.changeLog.size(); i++) {
+                const uint32_t textureIndex = textureMap.changeLog[i];
+                textureCacheVersions[textureIndex] = textureMap.versions[textureIndex];
+                textureCacheTextures[textureIndex] = textureMap.textures[textureIndex];
+                textureCacheTextureReplacements[textureIndex] = textureMap.textureReplacements[textureIndex];
+                textureCacheChangedIndices.emplace_back(textureIndex);
+            }
+        }
+
+        textureCacheChangeLogCursor = textureMap.getChangeLogEnd();
         textureCacheSize = static_cast<uint32_t>(textureCacheTextures.size());
-        textureCacheGlobalVersion = textureCache->textureMap.globalVersion;
-        textureCacheReplacementMapEnabled = textureCache->textureMap.replacementMapEnabled;
+        textureCacheReplacementMapEnabled = textureMap.replacementMapEnabled;
         dynamicTextureViewVector.clear();
         dynamicTextureBarrierVector.clear();
     }
@@ -297,16 +376,29 @@ namespace RT64 {
     }
 
     uint32_t FramebufferRenderer::getDestinationIndex() {
-        uint32_t dstIndex;
-        if (textureCacheFreeSpaces.empty()) {
-            dstIndex = textureCacheSize++;
+        // Dynamic views are always placed after the textures of the cache so they never overwrite a slot the cache might reuse.
+        return textureCacheSize++;
+    }
+
+    void FramebufferRenderer::updateDescriptorTexture(uint32_t textureIndex) {
+        if (textureCacheVersions[textureIndex] == descriptorTextureVersions[textureIndex]) {
+            return;
         }
-        else {
-            dstIndex = textureCacheFreeSpaces.back();
-            textureCacheFreeSpaces.pop_back();
+
+        descriptorTextureVersions[textureIndex] = textureCacheVersions[textureIndex];
+        if (textureCacheTextures[textureIndex] == nullptr) {
+            return;
         }
 
-        return dstIndex;
+        if (textureCacheReplacementMapEnabled && (textureCacheTextureReplacements[textureIndex] != nullptr)) {
+            descTextureSet->setTexture(textureIndex, textureCacheTextureReplacements[textureIndex]->texture.get(), RenderTextureLayout::SHADER_READ);
+        }
+        else if (textureCacheTextures[textureIndex]->texture != nullptr) {
+            descTextureSet->setTexture(textureIndex, textureCacheTextures[textureIndex]->texture.get(), RenderTextureLayout::SHADER_READ);
+        }
+        else {
+            descTextureSet->setTexture(textureIndex, textureCacheTextures[textureIndex]->tmem.get(), RenderTextureLayout::SHADER_READ);
+        }
     }
     
     uint32_t FramebufferRenderer::getTextureIndex(RenderTarget *renderTarget) {
@@ -337,8 +429,8 @@ namespace RT64 {
 
         if (createSet || (descriptorTextureReplacementMapEnabled != textureCacheReplacementMapEnabled)) {
             descriptorTextureVersions.clear();
-            descriptorTextureGlobalVersion = 0;
             descriptorTextureReplacementMapEnabled = textureCacheReplacementMapEnabled;
+            textureCacheFullRefresh = true;
         }
 
 #   if RT_ENABLED
@@ -393,40 +485,37 @@ namespace RT64 {
 
         descCommonSet->setBuffer(descCommonSet->FrParams, frameParamsBuffer.get(), sizeof(interop::FrameParams));
         descCommonSet->setBuffer(descCommonSet->instanceRenderIndices, renderIndicesBuffer.get(), RenderBufferStructuredView(sizeof(interop::RenderIndices)));
+        descCommonSet->setBuffer(descCommonSet->rawVertexRenderIndices, rawVertexRenderIndicesBuffer.get(), RenderBufferStructuredView(sizeof(uint32_t)));
         descCommonSet->setBuffer(descCommonSet->instanceRDPParams, drawBuffers->rdpParamsBuffer.get(), RenderBufferStructuredView(sizeof(interop::RDPParams)));
         descCommonSet->setBuffer(descCommonSet->RDPTiles, drawBuffers->rdpTilesBuffer.get(), RenderBufferStructuredView(sizeof(interop::RDPTile)));
         descCommonSet->setBuffer(descCommonSet->GPUTiles, drawBuffers->gpuTilesBuffer.get(), RenderBufferStructuredView(sizeof(interop::GPUTile)));
         descCommonSet->setBuffer(descCommonSet->DynamicRenderParams, drawBuffers->renderParamsBuffer.get(), RenderBufferStructuredView(sizeof(interop::RenderParams)));
 
+        // Indexed and raw vertex draws read the render index from the same instance attribute.
+        const RenderVertexBufferView instanceRenderIndicesView(RenderBufferReference(instanceRenderIndicesBuffer.get()), uint32_t(sizeof(uint32_t) * instanceRenderIndicesVector.size()));
+        indexedVertexViews[3] = instanceRenderIndicesView;
+        rawVertexViews[3] = instanceRenderIndicesView;
+
         // Make sure the versions vector matches the texture cache size.
         descriptorTextureVersions.resize(textureCacheSize, 0);
 
-        // Update texture vector with static textures from the cache and dynamic resource views.
-        if (descriptorTextureGlobalVersion != textureCacheGlobalVersion) {
+        // Update texture vector with static textures from the cache and dynamic resource views. Only the textures that changed since
+        // the last update are visited unless the entire set must be written again.
+        if (textureCacheFullRefresh) {
             const uint32_t textureVersionSize = static_cast<uint32_t>(textureCacheVersions.size());
             for (uint32_t i = 0; i < textureVersionSize; i++) {
-                if (textureCacheVersions[i] == descriptorTextureVersions[i]) {
-                    continue;
-                }
-
-                descriptorTextureVersions[i] = textureCacheVersions[i];
-                if (textureCacheTextures[i] == nullptr) {
-                    continue;
-                }
-
-                if (textureCacheReplacementMapEnabled && (textureCacheTextureReplacements[i] != nullptr)) {
-                    descTextureSet->setTexture(i, textureCacheTextureReplacements[i]->texture.get(), RenderTextureLayout::SHADER_READ);
-                }
-                else if (textureCacheTextures[i]->texture != nullptr) {
-                    descTextureSet->setTexture(i, textureCacheTextures[i]->texture.get(), RenderTextureLayout::SHADER_READ);
-                }
-                else {
-                    descTextureSet->setTexture(i, textureCacheTextures[i]->tmem.get(), RenderTextureLayout::SHADER_READ);
-                }
+                updateDescriptorTexture(i);
             }
 
-            descriptorTextureGlobalVersion = textureCacheGlobalVersion;
+            textureCacheFullRefresh = false;
         }
+        else {
+            for (uint32_t textureIndex : textureCacheChangedIndices) {
+                updateDescriptorTexture(textureIndex);
+            }
+        }
+
+        textureCacheChangedIndices.clear();
 
         for (const DynamicTextureView &dynamicView : dynamicTextureViewVector) {
             descTextureSet->setTexture(dynamicView.dstIndex, dynamicView.texture, RenderTextureLayout::SHADER_READ, dynamicView.textureView);
@@ -471,7 +560,7 @@ namespace RT64 {
 #   endif
     }
 
-    bool FramebufferRenderer::submitDepthAccess(RenderWorker *worker, RenderFramebufferStorage *fbStorage, bool readOnly, bool &depthState) {
+    bool FramebufferRenderer::submitDepthAccess(RenderCommandList *commandList, RenderFramebufferStorage *fbStorage, bool readOnly, bool &depthState) {
         if (depthState == readOnly) {
             return false;
         }
@@ -479,19 +568,124 @@ namespace RT64 {
         RenderFramebuffer *renderFramebuffer = readOnly ? fbStorage->colorWriteDepthRead.get() : fbStorage->colorDepthWrite.get();
         const RenderTextureLayout depthReadState = RenderTextureLayout::DEPTH_READ;
         const RenderTextureLayout depthWriteState = RenderTextureLayout::DEPTH_WRITE;
-        worker->commandList->barriers(RenderBarrierStage::GRAPHICS, RenderTextureBarrier(fbStorage->depthTarget->texture.get(), readOnly ? depthReadState : RenderTextureLayout::DEPTH_WRITE));
-        worker->commandList->setFramebuffer(renderFramebuffer);
+        commandList->barriers(RenderBarrierStage::GRAPHICS, RenderTextureBarrier(fbStorage->depthTarget->texture.get(), readOnly ? depthReadState : RenderTextureLayout::DEPTH_WRITE));
+        commandList->setFramebuffer(renderFramebuffer);
         depthState = readOnly;
         return true;
     }
     
-    void FramebufferRenderer::submitRasterScene(RenderWorker *worker, const Framebuffer &framebuffer, RenderFramebufferStorage *fbStorage, const RasterScene &rasterScene, bool &depthState) {
+    uint32_t FramebufferRenderer::getMergedFaceCount(const RasterScene &rasterScene, uint32_t scenePosition) const {
+        uint32_t faceCount = 0;
+        for (uint32_t k = 0; k < rasterScene.drawCounts[scenePosition]; k++) {
+            faceCount += instanceDrawCallVector[rasterScene.instanceIndices[scenePosition + k]].triangles.faceCount;
+        }
+
+        return faceCount;
+    }
+
+    bool FramebufferRenderer::isRasterSceneDepthReadRequired(const RasterScene &rasterScene) const {
+        for (uint32_t i : rasterScene.instanceIndices) {
+            const InstanceDrawCall &drawCall = instanceDrawCallVector[i];
+            switch (drawCall.type) {
+            case InstanceDrawCall::Type::IndexedTriangles:
+            case InstanceDrawCall::Type::RawTriangles:
+            case InstanceDrawCall::Type::RegularRect:
+                if (drawCall.triangles.shaderDesc.otherMode.zMode() == ZMODE_DEC) {
+                    return true;
+                }
+
+                break;
+            case InstanceDrawCall::Type::VertexTestZ:
+                return true;
+            default:
+                break;
+            }
+        }
+
+        return false;
+    }
+
+    void FramebufferRenderer::mergeRasterScene(RasterScene &rasterScene) const {
+        const uint32_t callCount = static_cast<uint32_t>(rasterScene.instanceIndices.size());
+        rasterScene.drawCounts.resize(callCount);
+
+        uint32_t drawPosition = 0;
+        for (uint32_t j = 0; j < callCount; j++) {
+            const InstanceDrawCall &drawCall = instanceDrawCallVector[rasterScene.instanceIndices[j]];
+            if ((j > 0) && canMergeDrawCalls(instanceDrawCallVector[rasterScene.instanceIndices[j - 1]], drawCall)) {
+                rasterScene.drawCounts[drawPosition]++;
+                rasterScene.drawCounts[j] = 0;
+            }
+            else {
+                drawPosition = j;
+                rasterScene.drawCounts[j] = 1;
+            }
+        }
+    }
+
+    void FramebufferRenderer::buildRasterSceneIndirectDraws(RasterScene &rasterScene) {
+        rasterScene.indirectDraws.clear();
+
+        const uint32_t callCount = static_cast<uint32_t>(rasterScene.instanceIndices.size());
+        uint32_t runStart = 0;
+        while (runStart < callCount) {
+            // Extend the run with all the following draws that can be recorded with the same state as the first one.
+            const InstanceDrawCall &startCall = instanceDrawCallVector[rasterScene.instanceIndices[runStart]];
+            uint32_t runEnd = runStart + rasterScene.drawCounts[runStart];
+            uint32_t runDrawCount = 1;
+            while ((runEnd < callCount) && canDrawCallsShareState(startCall, instanceDrawCallVector[rasterScene.instanceIndices[runEnd]])) {
+                runEnd += rasterScene.drawCounts[runEnd];
+                runDrawCount++;
+            }
+
+            if (runDrawCount > 1) {
+                const bool indexed = (startCall.type == InstanceDrawCall::Type::IndexedTriangles);
+                RasterIndirectDraw indirectDraw;
+                indirectDraw.sceneStart = runStart;
+                indirectDraw.sceneCount = runEnd - runStart;
+                indirectDraw.argumentStart = static_cast<uint32_t>(indexed ? drawIndexedIndirectArgumentsVector.size() : drawIndirectArgumentsVector.size());
+                indirectDraw.drawCount = runDrawCount;
+                indirectDraw.countIndex = static_cast<uint32_t>(drawIndirectCountsVector.size());
+
+                // The render index is used as the start instance so the vertex shader can read it from the instance attribute.
+                for (uint32_t j = runStart; j < runEnd; j += rasterScene.drawCounts[j]) {
+                    const uint32_t instanceIndex = rasterScene.instanceIndices[j];
+                    const uint32_t vertexCount = getMergedFaceCount(rasterScene, j) * 3;
+                    const uint32_t indexStart = instanceDrawCallVector[instanceIndex].triangles.indexStart;
+                    if (indexed) {
+                        RenderDrawIndexedIndirectArguments &arguments = drawIndexedIndirectArgumentsVector.emplace_back();
+                        arguments.indexCountPerInstance = vertexCount;
+                        arguments.instanceCount = 1;
+                        arguments.startIndexLocation = indexStart;
+                        arguments.baseVertexLocation = 0;
+                        arguments.startInstanceLocation = instanceIndex;
+                    }
+                    else {
+                        RenderDrawIndirectArguments &arguments = drawIndirectArgumentsVector.emplace_back();
+                        arguments.vertexCountPerInstance = vertexCount;
+                        arguments.instanceCount = 1;
+                        arguments.startVertexLocation = indexStart;
+                        arguments.startInstanceLocation = instanceIndex;
+                    }
+                }
+
+                drawIndirectCountsVector.emplace_back(runDrawCount);
+                rasterScene.indirectDraws.emplace_back(indirectDraw);
+            }
+
+            runStart = runEnd;
+        }
+    }
+
+    void FramebufferRenderer::submitRasterScene(RenderCommandList *commandList, const Framebuffer &framebuffer, RenderFramebufferStorage *fbStorage, const RasterScene &rasterScene, bool &depthState) {
         InstanceDrawCall::Type previousCallType = InstanceDrawCall::Type::Unknown;
         bool previousVertexTestZ = false;
         const RenderPipeline *previousPipeline = nullptr;
         RenderViewport previousViewport;
         RenderRect previousScissor;
         interop::RasterParams rasterParams;
+        uint32_t sceneRasterCallCount = 0;
+        uint32_t sceneRasterDrawCount = 0;
         RenderDescriptorSet *descRealFbSet = framebuffer.descRealFbSet->get();
         RenderDescriptorSet *descDummyFbSet = framebuffer.descDummyFbSet->get();
 
@@ -501,31 +695,44 @@ namespace RT64 {
             previousPipeline = nullptr;
             previousViewport = RenderViewport();
             previousScissor = RenderRect();
-            worker->commandList->setGraphicsPipelineLayout(rendererPipelineLayout);
-            worker->commandList->setGraphicsDescriptorSet(descCommonSet->get(), 0);
-            worker->commandList->setGraphicsDescriptorSet(descTextureSet->get(), 1);
-            worker->commandList->setGraphicsDescriptorSet(descTextureSet->get(), 2);
-            worker->commandList->setGraphicsDescriptorSet(depthState ? descRealFbSet : descDummyFbSet, 3);
+            commandList->setGraphicsPipelineLayout(rendererPipelineLayout);
+            commandList->setGraphicsDescriptorSet(descCommonSet->get(), 0);
+            commandList->setGraphicsDescriptorSet(descTextureSet->get(), 1);
+            commandList->setGraphicsDescriptorSet(descTextureSet->get(), 2);
+            commandList->setGraphicsDescriptorSet(depthState ? descRealFbSet : descDummyFbSet, 3);
         };
 
         auto switchToDepthRead = [&]() {
-            if (submitDepthAccess(worker, fbStorage, true, depthState)) {
-                worker->commandList->setGraphicsDescriptorSet(descRealFbSet, 3);
+            if (submitDepthAccess(commandList, fbStorage, true, depthState)) {
+                commandList->setGraphicsDescriptorSet(descRealFbSet, 3);
             }
         };
 
         auto switchToDepthWrite = [&]() {
-            if (submitDepthAccess(worker, fbStorage, false, depthState)) {
-                worker->commandList->setGraphicsDescriptorSet(descDummyFbSet, 3);
+            if (submitDepthAccess(commandList, fbStorage, false, depthState)) {
+                commandList->setGraphicsDescriptorSet(descDummyFbSet, 3);
+            }
+        };
+
+        // The render index is used as the start instance so the vertex shader can read it from the instance attribute.
+        auto drawCallTriangles = [&](const InstanceDrawCall &drawCall, uint32_t faceCount, uint32_t renderIndex) {
+            if (drawCall.type == InstanceDrawCall::Type::IndexedTriangles) {
+                commandList->drawIndexedInstanced(faceCount * 3, 1, drawCall.triangles.indexStart, 0, renderIndex);
+            }
+            else {
+                commandList->drawInstanced(faceCount * 3, 1, drawCall.triangles.indexStart, renderIndex);
             }
         };
 
-        auto drawCallTriangles = [&](const InstanceDrawCall &drawCall) {
+        auto drawCallIndirect = [&](const InstanceDrawCall &drawCall, const RasterIndirectDraw &indirectDraw) {
+            const RenderBufferReference countBuffer(drawIndirectCountsBuffer.get(), sizeof(uint32_t) * indirectDraw.countIndex);
             if (drawCall.type == InstanceDrawCall::Type::IndexedTriangles) {
-                worker->commandList->drawIndexedInstanced(drawCall.triangles.faceCount * 3, 1, drawCall.triangles.indexStart, 0, 0);
+                const RenderBufferReference argumentBuffer(drawIndexedIndirectArgumentsBuffer.get(), sizeof(RenderDrawIndexedIndirectArguments) * indirectDraw.argumentStart);
+                commandList->drawIndexedIndirect(argumentBuffer, indirectDraw.drawCount, countBuffer);
             }
             else {
-                worker->commandList->drawInstanced(drawCall.triangles.faceCount * 3, 1, drawCall.triangles.indexStart, 0);
+                const RenderBufferReference argumentBuffer(drawIndirectArgumentsBuffer.get(), sizeof(RenderDrawIndirectArguments) * indirectDraw.argumentStart);
+                commandList->drawIndirect(argumentBuffer, indirectDraw.drawCount, countBuffer);
             }
         };
 
@@ -533,7 +740,17 @@ namespace RT64 {
             switchToGraphicsPipeline();
         }
         
-        for (uint32_t i : rasterScene.instanceIndices) {
+        assert(rasterScene.drawCounts.size() == rasterScene.instanceIndices.size());
+        const uint32_t sceneCallCount = static_cast<uint32_t>(rasterScene.instanceIndices.size());
+        uint32_t indirectDrawIndex = 0;
+        for (uint32_t j = 0; j < sceneCallCount; j++) {
+            // The call was already drawn as part of a previous one.
+            const uint32_t drawCount = rasterScene.drawCounts[j];
+            if (drawCount == 0) {
+                continue;
+            }
+
+            const uint32_t i = rasterScene.instanceIndices[j];
             const InstanceDrawCall &drawCall = instanceDrawCallVector[i];
             switch (drawCall.type) {
             case InstanceDrawCall::Type::IndexedTriangles: 
@@ -546,14 +763,14 @@ namespace RT64 {
                 if (typeDifferent || testZDifferent) {
                     switch (drawCall.type) {
                     case InstanceDrawCall::Type::IndexedTriangles:
-                        worker->commandList->setVertexBuffers(0, indexedVertexViews.data(), uint32_t(indexedVertexViews.size()), vertexInputSlots.data());
-                        worker->commandList->setIndexBuffer(drawCall.triangles.vertexTestZ ? &testZIndexBufferView : &indexBufferView);
+                        commandList->setVertexBuffers(0, indexedVertexViews.data(), uint32_t(indexedVertexViews.size()), vertexInputSlots.data());
+                        commandList->setIndexBuffer(drawCall.triangles.vertexTestZ ? &testZIndexBufferView : &indexBufferView);
                         previousVertexTestZ = drawCall.triangles.vertexTestZ;
                         break;
                     case InstanceDrawCall::Type::RawTriangles:
                     case InstanceDrawCall::Type::RegularRect:
-                        worker->commandList->setVertexBuffers(0, rawVertexViews.data(), uint32_t(rawVertexViews.size()), vertexInputSlots.data());
-                        worker->commandList->setIndexBuffer(nullptr);
+                        commandList->setVertexBuffers(0, rawVertexViews.data(), uint32_t(rawVertexViews.size()), vertexInputSlots.data());
+                        commandList->setIndexBuffer(nullptr);
                         break;
                     default:
                         assert(false && "Unknown draw call type.");
@@ -584,37 +801,53 @@ namespace RT64 {
                 
                 if (previousViewport != triangles.viewport) {
                     rasterParams.halfPixelOffset = { 1.0f / triangles.viewport.width, -1.0f / triangles.viewport.height};
-                    worker->commandList->setViewports(triangles.viewport);
+                    commandList->setViewports(triangles.viewport);
                     previousViewport = triangles.viewport;
                 }
 
                 if (previousScissor != triangles.scissor) {
-                    worker->commandList->setScissors(triangles.scissor);
+                    commandList->setScissors(triangles.scissor);
                     previousScissor = triangles.scissor;
                 }
 
                 if (previousPipeline != triangles.pipeline) {
-                    worker->commandList->setPipeline(triangles.pipeline);
+                    commandList->setPipeline(triangles.pipeline);
                     previousPipeline = triangles.pipeline;
                 }
                 
                 rasterParams.renderIndex = i;
-                worker->commandList->setGraphicsPushConstants(0, &rasterParams);
-                drawCallTriangles(drawCall);
+                rasterParams.renderIndexFromVertex = isRawVertexCall(drawCall) ? 1 : 0;
+                commandList->setGraphicsPushConstants(0, &rasterParams);
+                sceneRasterDrawCount++;
+
+                // Record the entire run of draws that share the same state with a single indirect draw.
+                const bool indirectDrawAvailable = (indirectDrawIndex < rasterScene.indirectDraws.size());
+                if (indirectDrawAvailable && (rasterScene.indirectDraws[indirectDrawIndex].sceneStart == j)) {
+                    const RasterIndirectDraw &indirectDraw = rasterScene.indirectDraws[indirectDrawIndex];
+                    drawCallIndirect(drawCall, indirectDraw);
+                    sceneRasterCallCount += indirectDraw.sceneCount;
+                    j += indirectDraw.sceneCount - 1;
+                    indirectDrawIndex++;
+                    break;
+                }
+
+                const uint32_t faceCount = getMergedFaceCount(rasterScene, j);
+                drawCallTriangles(drawCall, faceCount, i);
+                sceneRasterCallCount += drawCount;
 
                 // Simulate dither noise.
                 if (triangles.postBlendDitherNoise) {
                     if (triangles.postBlendDitherNoiseNegative) {
-                        worker->commandList->setPipeline(postBlendDitherNoiseSubNegativePipeline);
+                        commandList->setPipeline(postBlendDitherNoiseSubNegativePipeline);
                     }
                     else {
-                        worker->commandList->setPipeline(postBlendDitherNoiseAddPipeline);
-                        drawCallTriangles(drawCall);
+                        commandList->setPipeline(postBlendDitherNoiseAddPipeline);
+                        drawCallTriangles(drawCall, faceCount, i);
 
-                        worker->commandList->setPipeline(postBlendDitherNoiseSubPipeline);
+                        commandList->setPipeline(postBlendDitherNoiseSubPipeline);
                     }
 
-                    drawCallTriangles(drawCall);
+                    drawCallTriangles(drawCall, faceCount, i);
                     previousPipeline = nullptr;
                 }
 
@@ -627,10 +860,10 @@ namespace RT64 {
                 const RenderRect *clearRects = rectCoversWholeTarget ? nullptr : &clearRect.rect;
                 uint32_t clearRectCount = rectCoversWholeTarget ? 0 : 1;
                 if (fbStorage->colorTarget != nullptr) {
-                    worker->commandList->clearColor(0, clearRect.color, clearRects, clearRectCount);
+                    commandList->clearColor(0, clearRect.color, clearRects, clearRectCount);
                 }
                 else {
-                    worker->commandList->clearDepth(true, clearRect.depth, clearRects, clearRectCount);
+                    commandList->clearDepth(true, clearRect.depth, clearRects, clearRectCount);
                 }
 
                 break;
@@ -644,14 +877,14 @@ namespace RT64 {
 
                 const bool useMSAA = (fbStorage->colorTarget->multisampling.sampleCount > 0);
                 const auto &rspVertexTestZ = useMSAA ? shaderLibrary->rspVertexTestZMS : shaderLibrary->rspVertexTestZ;
-                worker->commandList->barriers(RenderBarrierStage::COMPUTE, RenderBufferBarrier(testZIndexBuffer, RenderBufferAccess::WRITE));
-                worker->commandList->setPipeline(rspVertexTestZ.pipeline.get());
-                worker->commandList->setComputePipelineLayout(rspVertexTestZ.pipelineLayout.get());
-                worker->commandList->setComputePushConstants(0, &testZCB);
-                worker->commandList->setComputeDescriptorSet(vertexTestZSet->get(), 0);
-                worker->commandList->setComputeDescriptorSet(descRealFbSet, 1);
-                worker->commandList->dispatch(1, 1, 1);
-                worker->commandList->barriers(RenderBarrierStage::GRAPHICS, RenderBufferBarrier(testZIndexBuffer, RenderBufferAccess::READ));
+                commandList->barriers(RenderBarrierStage::COMPUTE, RenderBufferBarrier(testZIndexBuffer, RenderBufferAccess::WRITE));
+                commandList->setPipeline(rspVertexTestZ.pipeline.get());
+                commandList->setComputePipelineLayout(rspVertexTestZ.pipelineLayout.get());
+                commandList->setComputePushConstants(0, &testZCB);
+                commandList->setComputeDescriptorSet(vertexTestZSet->get(), 0);
+                commandList->setComputeDescriptorSet(descRealFbSet, 1);
+                commandList->dispatch(1, 1, 1);
+                commandList->barriers(RenderBarrierStage::GRAPHICS, RenderBufferBarrier(testZIndexBuffer, RenderBufferAccess::READ));
 
                 switchToGraphicsPipeline();
                 break;
@@ -662,7 +895,12 @@ namespace RT64 {
             }
         }
 
-        // Mark targets for resolve.
+        // The counters are only updated once per scene since scenes can be recorded from multiple threads.
+        rasterCallCount += sceneRasterCallCount;
+        rasterDrawCount += sceneRasterDrawCount;
+    }
+
+    void FramebufferRenderer::markTargetsForResolve(RenderFramebufferStorage *fbStorage) {
         if (fbStorage->colorTarget != nullptr) {
             fbStorage->colorTarget->markForResolve();
         }
@@ -1194,7 +1432,7 @@ namespace RT64 {
         }
     }
 
-    void FramebufferRenderer::recordSetup(RenderWorker *worker, std::vector<BufferUploader *> bufferUploaders, RSPProcessor *rspProcessor,
+    void FramebufferRenderer::recordSetup(RenderWorker *worker, std::vector<BufferUploader *> bufferUploaders, GeometryCache *geometryCache, RSPProcessor *rspProcessor,
         VertexProcessor *vertexProcessor, const OutputBuffers *outputBuffers, bool rtEnabled) {
         if (!dummyColorTargetTransitioned) {
             worker->commandList->barriers(RenderBarrierStage::GRAPHICS_AND_COMPUTE, RenderTextureBarrier(dummyColorTarget.get(), RenderTextureLayout::SHADER_READ));
@@ -1206,27 +1444,40 @@ namespace RT64 {
             dummyDepthTargetTransitioned = true;
         }
 
-        for (BufferUploader *uploader : bufferUploaders) {
-            uploader->commandListBeforeBarriers(worker);
-        }
+        {
+            GPUProfilerScope profilerScope(gpuProfiler, worker->commandList.get(), "Uploads");
+            for (BufferUploader *uploader : bufferUploaders) {
+                uploader->commandListBeforeBarriers(worker);
+            }
 
-        shaderUploader->commandListBeforeBarriers(worker);
+            shaderUploader->commandListBeforeBarriers(worker);
 
-        for (BufferUploader *uploader : bufferUploaders) {
-            uploader->commandListCopyResources(worker);
-        }
+            for (BufferUploader *uploader : bufferUploaders) {
+                uploader->commandListCopyResources(worker);
+            }
 
-        shaderUploader->commandListCopyResources(worker);
+            shaderUploader->commandListCopyResources(worker);
 
-        for (BufferUploader *uploader : bufferUploaders) {
-            uploader->commandListAfterBarriers(worker);
+            if (geometryCache != nullptr) {
+                geometryCache->commandListCopyResources(worker);
+            }
+
+            for (BufferUploader *uploader : bufferUploaders) {
+                uploader->commandListAfterBarriers(worker);
+            }
+
+            if (geometryCache != nullptr) {
+                geometryCache->commandListFillResources(worker);
+            }
         }
 
         if (rspProcessor != nullptr) {
+            GPUProfilerScope profilerScope(gpuProfiler, worker->commandList.get(), "RSP");
             rspProcessor->recordCommandList(worker, shaderLibrary, outputBuffers);
         }
 
         if (vertexProcessor != nullptr) {
+            GPUProfilerScope profilerScope(gpuProfiler, worker->commandList.get(), "World vertices");
             vertexProcessor->recordCommandList(worker, shaderLibrary, outputBuffers);
         }
 
@@ -1252,7 +1503,33 @@ namespace RT64 {
         }
     }
 
+    bool FramebufferRenderer::canRecordFramebufferInParallel(uint32_t framebufferIndex) const {
+        // Only framebuffers that never change the depth access can be recorded separately, as the barriers must be recorded in order.
+        const RenderTargetDrawCall &targetDrawCall = framebufferVector[framebufferIndex].renderTargetDrawCall;
+        uint32_t callCount = 0;
+        for (const auto &pair : targetDrawCall.sceneIndices) {
+            if (pair.second) {
+                return false;
+            }
+
+            const RasterScene &rasterScene = targetDrawCall.rasterScenes[pair.first];
+            if (rasterScene.depthReadRequired) {
+                return false;
+            }
+
+            callCount += uint32_t(rasterScene.instanceIndices.size());
+        }
+
+        // Recording small framebuffers on a different thread costs more than recording them directly.
+        return callCount >= ParallelRecordingMinimumCalls;
+    }
+
     void FramebufferRenderer::recordFramebuffer(RenderWorker *worker, uint32_t framebufferIndex) {
+        recordFramebufferBarriers(worker->commandList.get(), framebufferIndex);
+        recordFramebufferScenes(worker, worker->commandList.get(), framebufferIndex, gpuProfiler);
+    }
+
+    void FramebufferRenderer::recordFramebufferBarriers(RenderCommandList *commandList, uint32_t framebufferIndex) {
         // Submit all transition barriers first.
         thread_local std::vector<RenderTextureBarrier> startBarriers;
         startBarriers.clear();
@@ -1270,13 +1547,26 @@ namespace RT64 {
         }
 
         startBarriers.emplace_back(RenderTextureBarrier(depthTarget->texture.get(), RenderTextureLayout::DEPTH_WRITE));
-        worker->commandList->barriers(RenderBarrierStage::GRAPHICS, startBarriers);
+        commandList->barriers(RenderBarrierStage::GRAPHICS, startBarriers);
+
+        // Mark the targets for resolve here instead of while recording the scenes, as scenes can be recorded from other threads.
+        for (const auto &pair : targetDrawCall.sceneIndices) {
+            if (!pair.second) {
+                markTargetsForResolve(targetDrawCall.fbStorage);
+                break;
+            }
+        }
+    }
 
+    void FramebufferRenderer::recordFramebufferScenes(RenderWorker *worker, RenderCommandList *commandList, uint32_t framebufferIndex, GPUProfiler *profiler) {
+        const Framebuffer &framebuffer = framebufferVector[framebufferIndex];
+        const RenderTargetDrawCall &targetDrawCall = framebuffer.renderTargetDrawCall;
         bool depthState = false;
-        worker->commandList->setFramebuffer(targetDrawCall.fbStorage->colorDepthWrite.get());
+        commandList->setFramebuffer(targetDrawCall.fbStorage->colorDepthWrite.get());
         for (const auto &pair : targetDrawCall.sceneIndices) {
 #       if RT_ENABLED
             if (pair.second) {
+                GPUProfilerScope profilerScope(profiler, commandList, "Raytracing scenes");
                 const auto &rtScene = targetDrawCall.rtScenes[pair.first];
 
                 // Draw all the interleaved rasterized buffers that will be used in the render target.
@@ -1287,18 +1577,19 @@ namespace RT64 {
                     const uint32_t sceneIndex = rtScene.interleavedRasters[i].rasterSceneIndex;
                     RenderTarget *colorRenderTarget = rtResources->interleavedColorTargetVector[i].get();
                     RenderTarget *depthRenderTarget = rtResources->interleavedDepthTargetVector[i].get();
-                    worker->commandList->barriers(RenderBarrierStage::GRAPHICS, {
+                    commandList->barriers(RenderBarrierStage::GRAPHICS, {
                         RenderTextureBarrier(colorRenderTarget->texture.get(), RenderTextureLayout::COLOR_WRITE),
                         RenderTextureBarrier(depthRenderTarget->texture.get(), RenderTextureLayout::DEPTH_WRITE)
                     });
 
                     RenderFramebufferStorage *fbStorage = rtResources->interleavedFramebufferStorageVector[i].get();
-                    worker->commandList->setFramebuffer(fbStorage->colorDepthWrite.get());
-                    worker->commandList->clearColor();
-                    worker->commandList->clearDepth();
+                    commandList->setFramebuffer(fbStorage->colorDepthWrite.get());
+                    commandList->clearColor();
+                    commandList->clearDepth();
 
-                    submitDepthAccess(worker, fbStorage, false, interleavedDepthState);
-                    submitRasterScene(worker, framebuffer, fbStorage, targetDrawCall.rasterScenes[sceneIndex], interleavedDepthState);
+                    submitDepthAccess(commandList, fbStorage, false, interleavedDepthState);
+                    submitRasterScene(commandList, framebuffer, fbStorage, targetDrawCall.rasterScenes[sceneIndex], interleavedDepthState);
+                    markTargetsForResolve(fbStorage);
 
                     // Resolve the interleaved scene.
                     // TODO: Depth textures need to be thrown into a separate view vector for multisampled textures.
@@ -1309,18 +1600,19 @@ namespace RT64 {
                 }
 
                 if (!interleavedBarriers.empty()) {
-                    worker->commandList->barriers(RenderBarrierStage::COMPUTE, interleavedBarriers);
+                    commandList->barriers(RenderBarrierStage::COMPUTE, interleavedBarriers);
                 }
 
-                submitDepthAccess(worker, targetDrawCall.fbStorage, true, depthState);
+                submitDepthAccess(commandList, targetDrawCall.fbStorage, true, depthState);
                 submitRaytracingScene(worker, targetDrawCall.fbStorage->colorTarget, rtScene);
             }
             else
 #       endif
             {
+                GPUProfilerScope profilerScope(profiler, commandList, "Raster scenes");
                 const RasterScene &rasterScene = targetDrawCall.rasterScenes[pair.first];
-                submitDepthAccess(worker, targetDrawCall.fbStorage, false, depthState);
-                submitRasterScene(worker, framebuffer, targetDrawCall.fbStorage, rasterScene, depthState);
+                submitDepthAccess(commandList, targetDrawCall.fbStorage, false, depthState);
+                submitRasterScene(commandList, framebuffer, targetDrawCall.fbStorage, rasterScene, depthState);
             }
         }
     }
@@ -1406,6 +1698,7 @@ namespace RT64 {
         vertexInputSlots[0] = RenderInputSlot(0, PosStride);
         vertexInputSlots[1] = RenderInputSlot(1, TcStride);
         vertexInputSlots[2] = RenderInputSlot(2, ColStride);
+        vertexInputSlots[3] = RenderInputSlot(3, sizeof(uint32_t), RenderInputSlotClassification::PER_INSTANCE_DATA);
         indexedVertexViews[0] = RenderVertexBufferView(RenderBufferReference(screenPosRes), PosStride * vertexCount);
         indexedVertexViews[1] = RenderVertexBufferView(RenderBufferReference(tcRes), TcStride * vertexCount);
         indexedVertexViews[2] = RenderVertexBufferView(RenderBufferReference(shadedColRes), ColStride * vertexCount);
@@ -1420,6 +1713,13 @@ namespace RT64 {
         auto checkRasterScene = [&](RasterScene &rasterScene) {
             if (!rasterScene.instanceIndices.empty()) {
                 uint32_t sceneIndex = static_cast<uint32_t>(targetDrawCall.rasterScenes.size());
+                mergeRasterScene(rasterScene);
+                if (drawIndirectSupport) {
+                    buildRasterSceneIndirectDraws(rasterScene);
+                }
+
+                rasterScene.depthReadRequired = isRasterSceneDepthReadRequired(rasterScene);
+
                 targetDrawCall.rasterScenes.push_back(rasterScene);
                 targetDrawCall.sceneIndices.push_back({ sceneIndex, false });
                 rasterScene.instanceIndices.clear();
@@ -1756,6 +2056,17 @@ namespace RT64 {
 #           endif
                 {
                     rasterScene.instanceIndices.push_back(instanceIndex);
+
+                    // Store the render index of every raw vertex so consecutive calls can be merged into a single draw.
+                    if (isRawVertexCall(instanceDrawCall)) {
+                        const uint32_t rawVertexStart = instanceDrawCall.triangles.indexStart;
+                        const uint32_t rawVertexEnd = rawVertexStart + instanceDrawCall.triangles.faceCount * 3;
+                        if (rawVertexRenderIndicesVector.size() < rawVertexEnd) {
+                            rawVertexRenderIndicesVector.resize(rawVertexEnd, 0);
+                        }
+
+                        std::fill(rawVertexRenderIndicesVector.begin() + rawVertexStart, rawVertexRenderIndicesVector.begin() + rawVertexEnd, instanceIndex);
+                    }
                 }
 
                 instanceDrawCallVector.push_back(instanceDrawCall);
@@ -1770,12 +2081,46 @@ namespace RT64 {
     }
 
     void FramebufferRenderer::endFramebuffers(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers, bool rtEnabled) {
+        // Must have at least one element in the vector.
+        if (rawVertexRenderIndicesVector.empty()) {
+            rawVertexRenderIndicesVector.emplace_back(0);
+        }
+
         bool shaderViewRtEnabled = false;
         std::vector<BufferUploader::Upload> shaderUploads = {
             { renderIndicesVector.data(), { 0, renderIndicesVector.size() }, sizeof(interop::RenderIndices), RenderBufferFlag::STORAGE, { }, &renderIndicesBuffer},
+            { rawVertexRenderIndicesVector.data(), { 0, rawVertexRenderIndicesVector.size() }, sizeof(uint32_t), RenderBufferFlag::STORAGE, { }, &rawVertexRenderIndicesBuffer},
             { &frameParams, { 0, 1 }, sizeof(interop::FrameParams), RenderBufferFlag::CONSTANT, { }, &frameParamsBuffer}
         };
 
+        // Every call reads its own index from the instance attribute, so the contents only need to be uploaded again when more calls are used.
+        const size_t instanceRenderIndicesSize = std::max(instanceDrawCallVector.size(), size_t(1));
+        if ((instanceRenderIndicesVector.size() < instanceRenderIndicesSize) || (instanceRenderIndicesBuffer.get() == nullptr)) {
+            const size_t previousSize = instanceRenderIndicesVector.size();
+            instanceRenderIndicesVector.resize(std::max(instanceRenderIndicesSize, previousSize));
+            std::iota(instanceRenderIndicesVector.begin() + previousSize, instanceRenderIndicesVector.end(), uint32_t(previousSize));
+            shaderUploads.push_back({ instanceRenderIndicesVector.data(), { 0, instanceRenderIndicesVector.size() }, sizeof(uint32_t), RenderBufferFlag::VERTEX, { }, &instanceRenderIndicesBuffer });
+        }
+
+        if (drawIndirectSupport) {
+            // Must have at least one element in the vectors.
+            if (drawIndirectArgumentsVector.empty()) {
+                drawIndirectArgumentsVector.emplace_back();
+            }
+
+            if (drawIndexedIndirectArgumentsVector.empty()) {
+                drawIndexedIndirectArgumentsVector.emplace_back();
+            }
+
+            if (drawIndirectCountsVector.empty()) {
+                drawIndirectCountsVector.emplace_back(0);
+            }
+
+            shaderUploads.push_back({ drawIndirectArgumentsVector.data(), { 0, drawIndirectArgumentsVector.size() }, sizeof(RenderDrawIndirectArguments), RenderBufferFlag::INDIRECT, { }, &drawIndirectArgumentsBuffer });
+            shaderUploads.push_back({ drawIndexedIndirectArgumentsVector.data(), { 0, drawIndexedIndirectArgumentsVector.size() }, sizeof(RenderDrawIndexedIndirectArguments), RenderBufferFlag::INDIRECT, { }, &drawIndexedIndirectArgumentsBuffer });
+            shaderUploads.push_back({ drawIndirectCountsVector.data(), { 0, drawIndirectCountsVector.size() }, sizeof(uint32_t), RenderBufferFlag::INDIRECT, { }, &drawIndirectCountsBuffer });
+        }
+
 #   if RT_ENABLED
         // FIXME: Add support for multiple raytracing scenes.
         Framebuffer *chosenFramebuffer = nullptr;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdint.h>
 
 #include "common/rt64_emulator_configuration.h"
@@ -19,6 +20,8 @@
 #include "rt64_buffer_uploader.h"
 #include "rt64_descriptor_sets.h"
 #include "rt64_framebuffer_renderer_call.h"
+#include "rt64_geometry_cache.h"
+#include "rt64_gpu_profiler.h"
 #include "rt64_raster_shader_cache.h"
 #include "rt64_render_target.h"
 #include "rt64_rsp_processor.h"
@@ -36,9 +39,26 @@ namespace RT64 {
         const RenderTextureView *textureView = nullptr;
     };
 
+    struct RasterIndirectDraw {
+        uint32_t sceneStart;
+        uint32_t sceneCount;
+        uint32_t argumentStart;
+        uint32_t drawCount;
+        uint32_t countIndex;
+    };
+
     struct RasterScene {
         std::vector<uint32_t> instanceIndices;
 
+        // Number of consecutive calls drawn by the call at the same position. Calls merged into a previous one are zero.
+        std::vector<uint32_t> drawCounts;
+
+        // Runs of draws that share the same state and are recorded with a single indirect draw. Sorted by their start in the scene.
+        std::vector<RasterIndirectDraw> indirectDraws;
+
+        // Whether any of the calls needs to read from the depth target while it's bound.
+        bool depthReadRequired = false;
+
         RasterScene();
     };
 
@@ -59,27 +79,41 @@ namespace RT64 {
     };
 
     struct FramebufferRenderer {
+        static const uint32_t ParallelRecordingMinimumCalls = 64;
+
         std::vector<uint32_t> textureCacheVersions;
         std::vector<Texture *> textureCacheTextures;
         std::vector<Texture *> textureCacheTextureReplacements;
-        std::vector<uint32_t> textureCacheFreeSpaces;
+        std::vector<uint32_t> textureCacheChangedIndices;
+        uint64_t textureCacheChangeLogCursor = 0;
         uint32_t textureCacheSize = 0;
-        uint32_t textureCacheGlobalVersion = 0;
+        bool textureCacheFullRefresh = true;
         bool textureCacheReplacementMapEnabled = false;
         std::vector<InstanceDrawCall> instanceDrawCallVector;
         std::vector<RenderPipelineProgram> hitGroupVector;
         std::vector<interop::RenderIndices> renderIndicesVector;
+        std::vector<uint32_t> rawVertexRenderIndicesVector;
+        std::vector<uint32_t> instanceRenderIndicesVector;
+        std::vector<RenderDrawIndirectArguments> drawIndirectArgumentsVector;
+        std::vector<RenderDrawIndexedIndirectArguments> drawIndexedIndirectArgumentsVector;
+        std::vector<uint32_t> drawIndirectCountsVector;
         std::vector<DynamicTextureView> dynamicTextureViewVector;
         std::vector<RenderTextureBarrier> dynamicTextureBarrierVector;
         std::unique_ptr<BufferUploader> shaderUploader;
         std::vector<RSPSmoothNormalGenerationCB> rspSmoothNormalVector;
-        std::array<RenderInputSlot, 3> vertexInputSlots;
-        std::array<RenderVertexBufferView, 3> indexedVertexViews;
-        std::array<RenderVertexBufferView, 3> rawVertexViews;
+        std::array<RenderInputSlot, 4> vertexInputSlots;
+        std::array<RenderVertexBufferView, 4> indexedVertexViews;
+        std::array<RenderVertexBufferView, 4> rawVertexViews;
         RenderIndexBufferView indexBufferView;
         RenderBuffer *testZIndexBuffer = nullptr;
         RenderIndexBufferView testZIndexBufferView;
         BufferPair renderIndicesBuffer;
+        BufferPair rawVertexRenderIndicesBuffer;
+        BufferPair instanceRenderIndicesBuffer;
+        BufferPair drawIndirectArgumentsBuffer;
+        BufferPair drawIndexedIndirectArgumentsBuffer;
+        BufferPair drawIndirectCountsBuffer;
+        bool drawIndirectSupport = false;
         BufferPair interleavedRastersBuffer;
         uint32_t interleavedRastersCount = 0;
         BufferPair frameParamsBuffer;
@@ -96,12 +130,14 @@ namespace RT64 {
         bool dummyColorTargetTransitioned = false;
         bool dummyDepthTargetTransitioned = false;
         std::vector<uint32_t> descriptorTextureVersions;
-        uint32_t descriptorTextureGlobalVersion = 0;
         bool descriptorTextureReplacementMapEnabled = false;
         std::unique_ptr<RSPSmoothNormalDescriptorSet> smoothDescSet;
         std::unique_ptr<RSPVertexTestZDescriptorSet> vertexTestZSet;
         interop::FrameParams frameParams;
         const ShaderLibrary *shaderLibrary = nullptr;
+        GPUProfiler *gpuProfiler = nullptr;
+        std::atomic<uint32_t> rasterCallCount = 0;
+        std::atomic<uint32_t> rasterDrawCount = 0;
 
 #   if RT_ENABLED
         const RenderTexture *blueNoiseTexture = nullptr;
@@ -149,7 +185,7 @@ namespace RT64 {
             uint32_t maxGameCall;
         };
 
-        FramebufferRenderer(RenderWorker *worker, bool rtSupport, UserConfiguration::GraphicsAPI graphicsAPI, const ShaderLibrary *shaderLibrary);
+        FramebufferRenderer(RenderWorker *worker, bool rtSupport, UserConfiguration::GraphicsAPI graphicsAPI, const ShaderLibrary *shaderLibrary, StagingRing *stagingRing, TaskScheduler *taskScheduler);
         ~FramebufferRenderer();
         void resetFramebuffers(RenderWorker *worker, bool ubershadersVisible, float ditherNoiseStrength, const RenderMultisampling &multisampling);
         void updateTextureCache(TextureCache *textureCache);
@@ -158,17 +194,30 @@ namespace RT64 {
         uint32_t getTextureIndex(RenderTarget *renderTarget);
         uint32_t getTextureIndex(const FramebufferManager::TileCopy &tileCopy);
         void updateMultisampling();
+        void updateDescriptorTexture(uint32_t textureIndex);
         void updateShaderDescriptorSet(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers, bool raytracingEnabled);
         void updateRSPSmoothNormalSet(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers);
         void updateRSPVertexTestZSet(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers);
         void updateShaderViews(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers, bool raytracingEnabled);
         void submitRSPSmoothNormalCompute(RenderWorker *worker, const OutputBuffers *outputBuffers);
-        bool submitDepthAccess(RenderWorker *worker, RenderFramebufferStorage *fbStorage, bool readOnly, bool &depthState);
-        void submitRasterScene(RenderWorker *worker, const Framebuffer &framebuffer, RenderFramebufferStorage *fbStorage, const RasterScene &rasterScene, bool &depthState);
+        bool submitDepthAccess(RenderCommandList *commandList, RenderFramebufferStorage *fbStorage, bool readOnly, bool &depthState);
+        uint32_t getMergedFaceCount(const RasterScene &rasterScene, uint32_t scenePosition) const;
+        bool isRasterSceneDepthReadRequired(const RasterScene &rasterScene) const;
+        void mergeRasterScene(RasterScene &rasterScene) const;
+        void buildRasterSceneIndirectDraws(RasterScene &rasterScene);
+        void submitRasterScene(RenderCommandList *commandList, const Framebuffer &framebuffer, RenderFramebufferStorage *fbStorage, const RasterScene &rasterScene, bool &depthState);
+        void markTargetsForResolve(RenderFramebufferStorage *fbStorage);
         void addFramebuffer(const DrawParams &p);
         void endFramebuffers(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers, bool rtEnabled);
-        void recordSetup(RenderWorker *worker, std::vector<BufferUploader *> bufferUploaders, RSPProcessor *rspProcessor, VertexProcessor *vertexProcessor, const OutputBuffers *outputBuffers, bool rtEnabled);
+        void recordSetup(RenderWorker *worker, std::vector<BufferUploader *> bufferUploaders, GeometryCache *geometryCache, RSPProcessor *rspProcessor, VertexProcessor *vertexProcessor, const OutputBuffers *outputBuffers, bool rtEnabled);
+        bool canRecordFramebufferInParallel(uint32_t framebufferIndex) const;
         void recordFramebuffer(RenderWorker *worker, uint32_t framebufferIndex);
+
+        // Recording a framebuffer can be split so the scenes are recorded on a different command list than the barriers.
+        // The scenes of a framebuffer can only be recorded from another thread if canRecordFramebufferInParallel() is true.
+        // Scenes that use raytracing must be recorded on the worker's command list.
+        void recordFramebufferBarriers(RenderCommandList *commandList, uint32_t framebufferIndex);
+        void recordFramebufferScenes(RenderWorker *worker, RenderCommandList *commandList, uint32_t framebufferIndex, GPUProfiler *profiler);
         void waitForUploaders();
         void advanceFrame(bool rtEnabled);
 
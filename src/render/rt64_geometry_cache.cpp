@@ -0,0 +1,211 @@
+//
+// RT64
+//
+
+#include "rt64_geometry_cache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include "xxHash/xxh3.h"
+
+namespace RT64 {
+    // Sizes of the streams in the draw data that are stored in the cache.
+    static const uint64_t PositionStride = sizeof(int16_t) * 3;
+    static const uint64_t NormalColorStride = sizeof(uint8_t) * 4;
+
+    // GeometryCache
+
+    GeometryCache::GeometryCache(RenderDevice *device, uint32_t vertexCapacity) {
+        assert(device != nullptr);
+        assert(vertexCapacity > 0);
+
+        this->device = device;
+        this->vertexCapacity = vertexCapacity;
+        positionBuffer = device->createBuffer(RenderBufferDesc::DefaultBuffer(vertexCapacity * PositionStride));
+        normalColorBuffer = device->createBuffer(RenderBufferDesc::DefaultBuffer(vertexCapacity * NormalColorStride));
+    }
+
+    void GeometryCache::addVertices(uint32_t address, const void *data, uint32_t byteCount, uint32_t vertexCount, uint32_t drawIndex) {
+        if ((vertexCount == 0) || (vertexCount > vertexCapacity)) {
+            return;
+        }
+
+        // The address and the size are mixed into the hash, but they're stored in the entry as well to verify there's no collision.
+        const uint64_t entryHash = XXH3_64bits_withSeed(data, byteCount, (uint64_t(address) << 32U) | byteCount);
+        auto entryIt = entries.find(entryHash);
+        if (entryIt != entries.end()) {
+            const Entry &entry = entryIt->second;
+            if (entry.filled && (entry.address == address) && (entry.byteCount == byteCount) && (entry.vertexCount == vertexCount)) {
+                pendingReferences.emplace_back(Reference{ entryHash, drawIndex, entry.cacheIndex, vertexCount, false });
+                pendingHitCount++;
+            }
+            else {
+                pendingMissCount++;
+            }
+
+            return;
+        }
+
+        // Start over when the cache is full. Anything still referencing the previous entries is recorded before the new ones are filled.
+        if ((vertexHead + vertexCount) > vertexCapacity) {
+            clear();
+        }
+
+        Entry &entry = entries[entryHash];
+        entry.address = address;
+        entry.byteCount = byteCount;
+        entry.cacheIndex = vertexHead;
+        entry.vertexCount = vertexCount;
+        entry.filled = false;
+        pendingReferences.emplace_back(Reference{ entryHash, drawIndex, vertexHead, vertexCount, true });
+        pendingMissCount++;
+        vertexHead += vertexCount;
+    }
+
+    void GeometryCache::invalidateVertex(uint32_t drawIndex) {
+        for (auto it = pendingReferences.rbegin(); it != pendingReferences.rend(); it++) {
+            if ((drawIndex < it->drawIndex) || (drawIndex >= (it->drawIndex + it->vertexCount))) {
+                continue;
+            }
+
+            // The entry can't be filled from data that was modified. A hit is uploaded from the draw data instead.
+            if (it->fill) {
+                auto entryIt = entries.find(it->entryHash);
+                if ((entryIt != entries.end()) && (entryIt->second.cacheIndex == it->cacheIndex)) {
+                    entries.erase(entryIt);
+                }
+            }
+            else {
+                pendingHitCount--;
+                pendingMissCount++;
+            }
+
+            pendingReferences.erase(std::next(it).base());
+            return;
+        }
+    }
+
+    void GeometryCache::submit(const BufferPair *positionPair, const BufferPair *normalColorPair, std::vector<std::pair<size_t, size_t>> &cachedVertexRanges) {
+        assert(positionPair != nullptr);
+        assert(normalColorPair != nullptr);
+
+        // Entries from a previous submission that was never recorded will never be filled.
+        for (const Reference &reference : submittedReferences) {
+            if (!reference.fill) {
+                continue;
+            }
+
+            auto entryIt = entries.find(reference.entryHash);
+            if ((entryIt != entries.end()) && (entryIt->second.cacheIndex == reference.cacheIndex) && !entryIt->second.filled) {
+                entries.erase(entryIt);
+            }
+        }
+
+        this->positionPair = positionPair;
+        this->normalColorPair = normalColorPair;
+        submittedReferences.swap(pendingReferences);
+        pendingReferences.clear();
+
+        uint64_t hitVertexCount = 0;
+        cachedVertexRanges.clear();
+        for (const Reference &reference : submittedReferences) {
+            if (!reference.fill) {
+                cachedVertexRanges.emplace_back(reference.drawIndex, reference.drawIndex + reference.vertexCount);
+                hitVertexCount += reference.vertexCount;
+            }
+        }
+
+        hitCount = pendingHitCount;
+        missCount = pendingMissCount;
+        savedBytes = hitVertexCount * (PositionStride + NormalColorStride);
+        pendingHitCount = 0;
+        pendingMissCount = 0;
+    }
+
+    void GeometryCache::commandListCopyResources(RenderWorker *worker) {
+        for (const Reference &reference : submittedReferences) {
+            if (!reference.fill) {
+                copyStreams(worker, reference, false);
+            }
+        }
+    }
+
+    void GeometryCache::commandListFillResources(RenderWorker *worker) {
+        bool fillsPending = false;
+        for (const Reference &reference : submittedReferences) {
+            fillsPending = fillsPending || reference.fill;
+        }
+
+        if (fillsPending) {
+            RenderBuffer *drawPositionBuffer = positionPair->defaultBuffer.get();
+            RenderBuffer *drawNormalColorBuffer = normalColorPair->defaultBuffer.get();
+            const RenderBufferBarrier beforeBarriers[] = {
+                RenderBufferBarrier(positionBuffer.get(), RenderBufferAccess::WRITE),
+                RenderBufferBarrier(normalColorBuffer.get(), RenderBufferAccess::WRITE),
+                RenderBufferBarrier(drawPositionBuffer, RenderBufferAccess::READ),
+                RenderBufferBarrier(drawNormalColorBuffer, RenderBufferAccess::READ)
+            };
+
+            worker->commandList->barriers(RenderBarrierStage::COPY, beforeBarriers, uint32_t(std::size(beforeBarriers)));
+
+            for (const Reference &reference : submittedReferences) {
+                if (!reference.fill) {
+                    continue;
+                }
+
+                copyStreams(worker, reference, true);
+
+                auto entryIt = entries.find(reference.entryHash);
+                if ((entryIt != entries.end()) && (entryIt->second.cacheIndex == reference.cacheIndex)) {
+                    entryIt->second.filled = true;
+                }
+            }
+
+            // The cache buffers are left ready to be copied from when recording the next workload.
+            const RenderBufferBarrier cacheBarriers[] = {
+                RenderBufferBarrier(positionBuffer.get(), RenderBufferAccess::READ),
+                RenderBufferBarrier(normalColorBuffer.get(), RenderBufferAccess::READ)
+            };
+
+            const RenderBufferBarrier drawBarriers[] = {
+                RenderBufferBarrier(drawPositionBuffer, RenderBufferAccess::READ),
+                RenderBufferBarrier(drawNormalColorBuffer, RenderBufferAccess::READ)
+            };
+
+            worker->commandList->barriers(RenderBarrierStage::COPY, cacheBarriers, uint32_t(std::size(cacheBarriers)));
+            worker->commandList->barriers(RenderBarrierStage::ALL, drawBarriers, uint32_t(std::size(drawBarriers)));
+        }
+
+        submittedReferences.clear();
+    }
+
+    void GeometryCache::clear() {
+        entries.clear();
+        vertexHead = 0;
+        resetCount++;
+
+        // Fills of the entries that were just discarded could overlap with the ones of the new entries.
+        auto isFill = [](const Reference &reference) { return reference.fill; };
+        pendingReferences.erase(std::remove_if(pendingReferences.begin(), pendingReferences.end(), isFill), pendingReferences.end());
+        submittedReferences.erase(std::remove_if(submittedReferences.begin(), submittedReferences.end(), isFill), submittedReferences.end());
+    }
+
+    void GeometryCache::copyStreams(RenderWorker *worker, const Reference &reference, bool toCache) {
+        const uint64_t drawPositionOffset = reference.drawIndex * PositionStride;
+        const uint64_t drawNormalColorOffset = reference.drawIndex * NormalColorStride;
+        const uint64_t cachePositionOffset = reference.cacheIndex * PositionStride;
+        const uint64_t cacheNormalColorOffset = reference.cacheIndex * NormalColorStride;
+        RenderBuffer *drawPositionBuffer = positionPair->defaultBuffer.get();
+        RenderBuffer *drawNormalColorBuffer = normalColorPair->defaultBuffer.get();
+        if (toCache) {
+            worker->commandList->copyBufferRegion(positionBuffer->at(cachePositionOffset), drawPositionBuffer->at(drawPositionOffset), reference.vertexCount * PositionStride);
+            worker->commandList->copyBufferRegion(normalColorBuffer->at(cacheNormalColorOffset), drawNormalColorBuffer->at(drawNormalColorOffset), reference.vertexCount * NormalColorStride);
+        }
+        else {
+            worker->commandList->copyBufferRegion(drawPositionBuffer->at(drawPositionOffset), positionBuffer->at(cachePositionOffset), reference.vertexCount * PositionStride);
+            worker->commandList->copyBufferRegion(drawNormalColorBuffer->at(drawNormalColorOffset), normalColorBuffer->at(cacheNormalColorOffset), reference.vertexCount * NormalColorStride);
+        }
+    }
+};
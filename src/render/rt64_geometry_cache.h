@@ -0,0 +1,72 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <atomic>
+#include <unordered_map>
+
+#include "rt64_buffer_uploader.h"
+
+namespace RT64 {
+    // Keeps the position and normal/color streams of vertex loads resident in device memory across workloads. Loads are identified by
+    // their RDRAM address, their size and a hash of their contents. The draw data buffers are filled with GPU copies from the cache when
+    // the load is found, and the cache is filled from the draw data buffers after they're uploaded when it isn't.
+    struct GeometryCache {
+        struct Entry {
+            uint32_t address = 0;
+            uint32_t byteCount = 0;
+            uint32_t cacheIndex = 0;
+            uint32_t vertexCount = 0;
+            bool filled = false;
+        };
+
+        struct Reference {
+            uint64_t entryHash = 0;
+            uint32_t drawIndex = 0;
+            uint32_t cacheIndex = 0;
+            uint32_t vertexCount = 0;
+            bool fill = false;
+        };
+
+        RenderDevice *device;
+        std::unique_ptr<RenderBuffer> positionBuffer;
+        std::unique_ptr<RenderBuffer> normalColorBuffer;
+        uint32_t vertexCapacity = 0;
+        uint32_t vertexHead = 0;
+        std::unordered_map<uint64_t, Entry> entries;
+        std::vector<Reference> pendingReferences;
+        std::vector<Reference> submittedReferences;
+        const BufferPair *positionPair = nullptr;
+        const BufferPair *normalColorPair = nullptr;
+        uint32_t pendingHitCount = 0;
+        uint32_t pendingMissCount = 0;
+
+        // Statistics of the last submitted workload.
+        std::atomic<uint32_t> hitCount = 0;
+        std::atomic<uint32_t> missCount = 0;
+        std::atomic<uint64_t> savedBytes = 0;
+        std::atomic<uint32_t> resetCount = 0;
+
+        GeometryCache(RenderDevice *device, uint32_t vertexCapacity);
+
+        // Must be called after the vertices were appended to the draw data at the draw index.
+        void addVertices(uint32_t address, const void *data, uint32_t byteCount, uint32_t vertexCount, uint32_t drawIndex);
+
+        // Must be called when the draw data of a vertex that was added since the last submission is modified.
+        void invalidateVertex(uint32_t drawIndex);
+
+        // Moves all the pending references so they can be recorded and returns the vertex ranges the upload of the streams can skip.
+        void submit(const BufferPair *positionPair, const BufferPair *normalColorPair, std::vector<std::pair<size_t, size_t>> &cachedVertexRanges);
+
+        // Must be recorded while the draw data buffers are still being written to by the uploader.
+        void commandListCopyResources(RenderWorker *worker);
+
+        // Must be recorded after the draw data buffers have been uploaded.
+        void commandListFillResources(RenderWorker *worker);
+
+        void clear();
+        void copyStreams(RenderWorker *worker, const Reference &reference, bool toCache);
+    };
+};
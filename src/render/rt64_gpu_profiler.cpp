@@ -0,0 +1,186 @@
+//
+// RT64
+//
+
+#include "rt64_gpu_profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace RT64 {
+    // GPUProfiler
+
+    void GPUProfiler::setup(RenderDevice *device, uint32_t maxQueryCount) {
+        assert(device != nullptr);
+        assert(maxQueryCount >= 2);
+
+        if (device->getCapabilities().timestampQueries) {
+            queryPool = device->createQueryPool(maxQueryCount);
+            queryCount = maxQueryCount;
+        }
+    }
+
+    bool GPUProfiler::isEnabled() const {
+        return queryPool != nullptr;
+    }
+
+    void GPUProfiler::begin(RenderCommandList *commandList) {
+        assert(commandList != nullptr);
+        assert(!recording);
+
+        scopes.clear();
+        openScopes.clear();
+        droppedScopes = 0;
+        recording = true;
+
+        if (isEnabled()) {
+            commandList->resetQueryPool(queryPool.get(), 0, queryCount);
+        }
+    }
+
+    void GPUProfiler::beginPass(RenderCommandList *commandList, const char *name) {
+        assert(commandList != nullptr);
+        assert(recording);
+
+        // The scope is still pushed if it doesn't fit so endPass() can be matched correctly.
+        const uint32_t scopeIndex = uint32_t(scopes.size());
+        const uint32_t beginQueryIndex = scopeIndex * 2;
+        if (!isEnabled() || ((beginQueryIndex + 2) > queryCount)) {
+            openScopes.emplace_back(UINT32_MAX);
+            droppedScopes++;
+            return;
+        }
+
+        Scope scope;
+        scope.passIndex = findPass(name);
+        scope.beginQueryIndex = beginQueryIndex;
+        scope.endQueryIndex = beginQueryIndex + 1;
+        scopes.emplace_back(scope);
+        openScopes.emplace_back(scopeIndex);
+        commandList->writeTimestamp(queryPool.get(), scope.beginQueryIndex);
+    }
+
+    void GPUProfiler::endPass(RenderCommandList *commandList) {
+        assert(commandList != nullptr);
+        assert(recording);
+        assert(!openScopes.empty() && "Every pass must begin before it ends.");
+
+        const uint32_t scopeIndex = openScopes.back();
+        openScopes.pop_back();
+        if (scopeIndex != UINT32_MAX) {
+            commandList->writeTimestamp(queryPool.get(), scopes[scopeIndex].endQueryIndex);
+        }
+    }
+
+    void GPUProfiler::end(RenderCommandList *commandList) {
+        assert(commandList != nullptr);
+        assert(recording);
+        assert(openScopes.empty() && "Every pass must end before the profiler ends.");
+
+        if (isEnabled() && !scopes.empty()) {
+            commandList->resolveQueryPool(queryPool.get(), 0, uint32_t(scopes.size()) * 2);
+        }
+
+        recording = false;
+    }
+
+    void GPUProfiler::log() {
+        assert(!recording);
+
+        if (!isEnabled()) {
+            return;
+        }
+
+        queryPool->queryResults();
+
+        const uint64_t *results = queryPool->getResults();
+        std::scoped_lock<std::mutex> passLock(passMutex);
+        for (Pass &pass : passes) {
+            pass.timer.reset();
+            pass.frameCount = 0;
+        }
+
+        for (const Scope &scope : scopes) {
+            const uint64_t beginTime = results[scope.beginQueryIndex];
+            const uint64_t endTime = results[scope.endQueryIndex];
+            Pass &pass = passes[scope.passIndex];
+            pass.timer.accumulation += (endTime > beginTime) ? (endTime - beginTime) / 1000000.0 : 0.0;
+            pass.frameCount++;
+        }
+
+        for (Pass &pass : passes) {
+            pass.timer.log();
+        }
+
+        loggedFrames++;
+    }
+
+    bool GPUProfiler::exportCSV(const std::filesystem::path &path) {
+        std::ofstream csvStream(path);
+        if (!csvStream.is_open()) {
+            return false;
+        }
+
+        std::scoped_lock<std::mutex> passLock(passMutex);
+        csvStream << "Frame";
+        for (const Pass &pass : passes) {
+            csvStream << "," << pass.name << " (ms)";
+        }
+
+        csvStream << std::endl;
+
+        if (!passes.empty()) {
+            // All passes share the same history index since they're logged together on every frame.
+            const size_t historySize = passes[0].timer.size();
+            const size_t rowCount = std::min(size_t(loggedFrames), historySize);
+            const uint32_t firstFrame = loggedFrames - uint32_t(rowCount);
+            for (size_t i = 0; i < rowCount; i++) {
+                csvStream << (firstFrame + i);
+                for (const Pass &pass : passes) {
+                    const size_t historyIndex = (pass.timer.index() + historySize - rowCount + i) % historySize;
+                    csvStream << "," << pass.timer.data()[historyIndex];
+                }
+
+                csvStream << std::endl;
+            }
+        }
+
+        return !csvStream.bad();
+    }
+
+    uint32_t GPUProfiler::findPass(const char *name) {
+        assert(name != nullptr);
+
+        std::scoped_lock<std::mutex> passLock(passMutex);
+        for (uint32_t i = 0; i < passes.size(); i++) {
+            if (strcmp(passes[i].name.c_str(), name) == 0) {
+                return i;
+            }
+        }
+
+        // Passes discovered later start at the same history position as the rest so the histories stay aligned.
+        Pass &newPass = passes.emplace_back();
+        newPass.name = name;
+        newPass.timer.historyIndex = loggedFrames % newPass.timer.size();
+        return uint32_t(passes.size() - 1);
+    }
+
+    // GPUProfilerScope
+
+    GPUProfilerScope::GPUProfilerScope(GPUProfiler *profiler, RenderCommandList *commandList, const char *name) {
+        this->profiler = profiler;
+        this->commandList = commandList;
+
+        if (profiler != nullptr) {
+            profiler->beginPass(commandList, name);
+        }
+    }
+
+    GPUProfilerScope::~GPUProfilerScope() {
+        if (profiler != nullptr) {
+            profiler->endPass(commandList);
+        }
+    }
+};
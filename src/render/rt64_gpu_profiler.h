@@ -0,0 +1,75 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/rt64_profiling_timer.h"
+#include "rhi/rt64_render_interface.h"
+
+namespace RT64 {
+    // Measures the GPU time spent on named passes of a command list with timestamp queries.
+    // Passes with the same name that are recorded multiple times in a frame are accumulated together.
+    struct GPUProfiler {
+        struct Pass {
+            std::string name;
+            ProfilingTimer timer = ProfilingTimer(120);
+            uint32_t frameCount = 0;
+        };
+
+        struct Scope {
+            uint32_t passIndex = 0;
+            uint32_t beginQueryIndex = 0;
+            uint32_t endQueryIndex = 0;
+        };
+
+        std::unique_ptr<RenderQueryPool> queryPool;
+        uint32_t queryCount = 0;
+        std::vector<Scope> scopes;
+        std::vector<uint32_t> openScopes;
+        uint32_t droppedScopes = 0;
+        bool recording = false;
+
+        // Must be locked before reading the passes from a different thread than the one logging them.
+        std::mutex passMutex;
+        std::vector<Pass> passes;
+        uint32_t loggedFrames = 0;
+
+        GPUProfiler() = default;
+        void setup(RenderDevice *device, uint32_t maxQueryCount = 1024);
+        bool isEnabled() const;
+
+        // Must be called right after the command list has been opened.
+        void begin(RenderCommandList *commandList);
+
+        // Scopes can be nested. Scopes that don't fit in the query pool are dropped.
+        void beginPass(RenderCommandList *commandList, const char *name);
+        void endPass(RenderCommandList *commandList);
+
+        // Must be called right before the command list is closed.
+        void end(RenderCommandList *commandList);
+
+        // Must be called after the GPU has finished executing the command list.
+        void log();
+
+        // Writes the history of every pass as CSV, with one row per logged frame ordered from oldest to newest.
+        bool exportCSV(const std::filesystem::path &path);
+
+        uint32_t findPass(const char *name);
+    };
+
+    // RAII convenience class for measuring a pass inside a scope. Does nothing if the profiler is null.
+
+    struct GPUProfilerScope {
+        GPUProfiler *profiler;
+        RenderCommandList *commandList;
+
+        GPUProfilerScope(GPUProfiler *profiler, RenderCommandList *commandList, const char *name);
+        ~GPUProfilerScope();
+    };
+};
@@ -2,6 +2,7 @@
 // RT64
 //
 
+#include <algorithm>
 #include <cstring>
 
 #include "rt64_native_target.h"
@@ -23,6 +24,7 @@ namespace RT64 {
         if (readBufferHistoryCount > 1) {
             std::swap(readBufferHistory.front(), readBufferHistory.back());
             readBufferHistoryCount = 1;
+            uploadedValid = false;
         }
 
         writeBufferHistoryCount = 0;
@@ -60,8 +62,11 @@ namespace RT64 {
         return rowSize * height;
     }
 
-    uint32_t NativeTarget::copyFromRAM(RenderWorker *worker, FramebufferChange &emptyFbChange, uint32_t width, uint32_t height, uint32_t rowStart, uint8_t siz, uint8_t fmt, const uint8_t *data, bool invalidateTargets, const ShaderLibrary *shaderLibrary) {
+    uint32_t NativeTarget::copyFromRAM(RenderWorker *worker, FramebufferChange &emptyFbChange, uint32_t width, uint32_t height, uint32_t rowStart, uint32_t dirtyRowStart, uint32_t dirtyRowEnd,
+        uint8_t siz, uint8_t fmt, const uint8_t *data, bool invalidateTargets, const ShaderLibrary *shaderLibrary)
+    {
         assert(worker != nullptr);
+        assert(dirtyRowStart <= dirtyRowEnd);
 
         // Create the buffers for change count readback if they've not been created yet.
         if ((changeCountBuffer == nullptr) || (changeReadbackBuffer == nullptr)) {
@@ -101,6 +106,13 @@ namespace RT64 {
             createReadBuffer(worker, readBuffer, bufferSize);
         }
 
+        // The rows outside of the dirty range can be copied from the previous buffer if it still holds the last upload with the same layout.
+        const bool uploadDirtyRows = (previousReadBuffer != nullptr) && uploadedValid && (uploadedWidth == width) && (uploadedHeight == height) && (uploadedSiz == siz);
+        const uint32_t uploadRowStart = uploadDirtyRows ? std::min(dirtyRowStart, height) : 0;
+        const uint32_t uploadRowEnd = uploadDirtyRows ? std::min(dirtyRowEnd, height) : height;
+        const uint32_t uploadOffset = getNativeSize(width, uploadRowStart, siz);
+        const uint32_t uploadSize = getNativeSize(width, uploadRowEnd - uploadRowStart, siz);
+
         if (readBuffer.nativeUploadBuffer == nullptr) {
             readBuffer.nativeUploadBuffer = worker->device->createBuffer(RenderBufferDesc::UploadBuffer(readBuffer.nativeBufferSize));
         }
@@ -134,8 +146,8 @@ namespace RT64 {
             readBuffer.readDescSet->setBuffer(readBuffer.readDescSet->gCurInput, previousReadBuffer->nativeBuffer.get(), previousReadBuffer->nativeBufferSize, previousBufferView);
         }
 
-        void *dstData = readBuffer.nativeUploadBuffer->map();
-        memcpy(dstData, data, bufferSize);
+        uint8_t *dstData = reinterpret_cast<uint8_t *>(readBuffer.nativeUploadBuffer->map());
+        memcpy(dstData + uploadOffset, data + uploadOffset, uploadSize);
         readBuffer.nativeUploadBuffer->unmap();
 
         if (hasCurrentResource) {
@@ -149,9 +161,45 @@ namespace RT64 {
         }
         
         // Copy the native upload resource to the dedicated resource.
-        worker->commandList->barriers(RenderBarrierStage::COPY, RenderBufferBarrier(readBuffer.nativeBuffer.get(), RenderBufferAccess::WRITE));
-        worker->commandList->copyBufferRegion(readBuffer.nativeBuffer.get(), readBuffer.nativeUploadBuffer.get(), bufferSize);
-        worker->commandList->barriers(RenderBarrierStage::COMPUTE, RenderBufferBarrier(readBuffer.nativeBuffer.get(), RenderBufferAccess::READ));
+        if (uploadDirtyRows) {
+            RenderBufferBarrier copyBarriers[] = {
+                RenderBufferBarrier(previousReadBuffer->nativeBuffer.get(), RenderBufferAccess::READ),
+                RenderBufferBarrier(readBuffer.nativeBuffer.get(), RenderBufferAccess::WRITE)
+            };
+
+            worker->commandList->barriers(RenderBarrierStage::COPY, copyBarriers, uint32_t(std::size(copyBarriers)));
+
+            const uint32_t uploadEnd = uploadOffset + uploadSize;
+            if (uploadOffset > 0) {
+                worker->commandList->copyBufferRegion(readBuffer.nativeBuffer.get(), previousReadBuffer->nativeBuffer.get(), uploadOffset);
+            }
+
+            if (uploadSize > 0) {
+                worker->commandList->copyBufferRegion(readBuffer.nativeBuffer->at(uploadOffset), readBuffer.nativeUploadBuffer->at(uploadOffset), uploadSize);
+            }
+
+            if (uploadEnd < bufferSize) {
+                worker->commandList->copyBufferRegion(readBuffer.nativeBuffer->at(uploadEnd), previousReadBuffer->nativeBuffer->at(uploadEnd), bufferSize - uploadEnd);
+            }
+
+            RenderBufferBarrier computeBarriers[] = {
+                RenderBufferBarrier(previousReadBuffer->nativeBuffer.get(), RenderBufferAccess::READ),
+                RenderBufferBarrier(readBuffer.nativeBuffer.get(), RenderBufferAccess::READ)
+            };
+
+            worker->commandList->barriers(RenderBarrierStage::COMPUTE, computeBarriers, uint32_t(std::size(computeBarriers)));
+        }
+        else {
+            worker->commandList->barriers(RenderBarrierStage::COPY, RenderBufferBarrier(readBuffer.nativeBuffer.get(), RenderBufferAccess::WRITE));
+            worker->commandList->copyBufferRegion(readBuffer.nativeBuffer.get(), readBuffer.nativeUploadBuffer.get(), bufferSize);
+            worker->commandList->barriers(RenderBarrierStage::COMPUTE, RenderBufferBarrier(readBuffer.nativeBuffer.get(), RenderBufferAccess::READ));
+        }
+
+        // The new buffer holds the uploaded contents until the target is written to.
+        uploadedWidth = width;
+        uploadedHeight = height;
+        uploadedSiz = siz;
+        uploadedValid = true;
 
         // Setup the native constants.
         interop::FbCommonCB nativeCB;
@@ -162,6 +210,8 @@ namespace RT64 {
         nativeCB.ditherPattern = 0;
         nativeCB.ditherRandomSeed = 0;
         nativeCB.usesHDR = shaderLibrary->usesHDR;
+        nativeCB.dirtyRowStart = uploadRowStart;
+        nativeCB.dirtyRowEnd = uploadRowEnd;
 
         // Assert for formats that have not been implemented yet because hardware verification is pending.
         assert((nativeCB.siz != G_IM_SIZ_4b) && "Unimplemented 4 bits Readback mode.");
@@ -236,6 +286,9 @@ namespace RT64 {
 
         srcTarget->resolveTarget(worker, shaderLibrary);
 
+        // The most recent read buffer will no longer hold the last contents uploaded from RAM.
+        uploadedValid = false;
+
         if (srcTarget->fbWriteDescSet == nullptr) {
             srcTarget->fbWriteDescSet = std::make_unique<FramebufferWriteDescriptorTextureSet>(worker->device);
             srcTarget->fbWriteDescSet->setTexture(srcTarget->fbWriteDescSet->gInput, srcTarget->getResolvedTexture(), RenderTextureLayout::SHADER_READ, srcTarget->getResolvedTextureView());
@@ -249,6 +302,8 @@ namespace RT64 {
         nativeCB.ditherPattern = ditherPattern;
         nativeCB.ditherRandomSeed = ditherRandomSeed;
         nativeCB.usesHDR = shaderLibrary->usesHDR;
+        nativeCB.dirtyRowStart = 0;
+        nativeCB.dirtyRowEnd = 0;
 
         // Assert for formats that have not been implemented yet because hardware verification is pending.
         assert((nativeCB.siz != G_IM_SIZ_4b) && "Unimplemented 4 bits Writeback mode.");
@@ -44,6 +44,10 @@ namespace RT64 {
         uint32_t readBufferHistoryCount = 0;
         uint32_t writeBufferHistoryCount = 0;
         uint32_t writeBufferHistoryIndex = 0;
+        uint32_t uploadedWidth = 0;
+        uint32_t uploadedHeight = 0;
+        uint8_t uploadedSiz = 0;
+        bool uploadedValid = false;
 
         NativeTarget();
         ~NativeTarget();
@@ -52,8 +56,10 @@ namespace RT64 {
         void createReadBuffer(RenderWorker *worker, ReadBuffer &readBuffer, uint32_t bufferSize);
         RenderFormat getBufferFormat(uint8_t siz) const;
 
-        // Returns the amount of different pixels.
-        uint32_t copyFromRAM(RenderWorker *worker, FramebufferChange &emptyFbChange, uint32_t width, uint32_t height, uint32_t rowStart, uint8_t siz, uint8_t fmt, const uint8_t *data, bool invalidateTargets, const ShaderLibrary *shaderLibrary);
+        // Returns the amount of different pixels. Only the rows between dirtyRowStart and dirtyRowEnd are uploaded and compared if the previous
+        // upload is still the current contents of the target. All other rows must be identical to the ones from the previous upload.
+        uint32_t copyFromRAM(RenderWorker *worker, FramebufferChange &emptyFbChange, uint32_t width, uint32_t height, uint32_t rowStart, uint32_t dirtyRowStart, uint32_t dirtyRowEnd,
+            uint8_t siz, uint8_t fmt, const uint8_t *data, bool invalidateTargets, const ShaderLibrary *shaderLibrary);
         void copyToNative(RenderWorker *worker, RenderTarget *srcTarget, uint32_t rowWidth, uint32_t rowStart, uint32_t rowEnd, uint8_t siz, uint8_t fmt, uint32_t ditherPattern, uint32_t ditherRandomSeed, const ShaderLibrary *shaderLibrary);
         void copyToRAM(uint32_t rowStart, uint32_t rowEnd, uint32_t width, uint8_t siz, uint8_t *data);
 
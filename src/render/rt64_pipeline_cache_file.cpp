@@ -0,0 +1,95 @@
+//
+// RT64
+//
+
+#include "rt64_pipeline_cache_file.h"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "xxHash/xxh3.h"
+
+namespace RT64 {
+    static const uint32_t PipelineCacheFileMagic = 0x43505452U;
+    static const uint32_t PipelineCacheFileVersion = 1U;
+    static const uint64_t PipelineCacheFileMaxDataSize = 1024ULL * 1024ULL * 1024ULL;
+
+    static void fillHeader(const RenderDeviceDescription &description, PipelineCacheFileHeader &header) {
+        header.magic = PipelineCacheFileMagic;
+        header.version = PipelineCacheFileVersion;
+        header.vendor = uint32_t(description.vendor);
+        header.driverVersion = description.driverVersion;
+        memcpy(header.pipelineCacheUUID, description.pipelineCacheUUID, sizeof(header.pipelineCacheUUID));
+    }
+
+    // PipelineCacheFile
+
+    std::unique_ptr<RenderPipelineCache> PipelineCacheFile::load(RenderDevice *device, const std::filesystem::path &path) {
+        assert(device != nullptr);
+
+        std::ifstream cacheStream(path, std::ios::binary);
+        if (!cacheStream.is_open()) {
+            return device->createPipelineCache();
+        }
+
+        // Any difference in the device or driver invalidates the data, as the driver is not guaranteed to validate it on its own.
+        PipelineCacheFileHeader expectedHeader;
+        PipelineCacheFileHeader cacheHeader;
+        fillHeader(device->getDescription(), expectedHeader);
+        cacheStream.read(reinterpret_cast<char *>(&cacheHeader), sizeof(PipelineCacheFileHeader));
+        if (cacheStream.fail() ||
+            (cacheHeader.magic != expectedHeader.magic) ||
+            (cacheHeader.version != expectedHeader.version) ||
+            (cacheHeader.vendor != expectedHeader.vendor) ||
+            (cacheHeader.driverVersion != expectedHeader.driverVersion) ||
+            (memcmp(cacheHeader.pipelineCacheUUID, expectedHeader.pipelineCacheUUID, sizeof(cacheHeader.pipelineCacheUUID)) != 0) ||
+            (cacheHeader.dataSize > PipelineCacheFileMaxDataSize))
+        {
+            return device->createPipelineCache();
+        }
+
+        std::vector<uint8_t> cacheData(cacheHeader.dataSize);
+        cacheStream.read(reinterpret_cast<char *>(cacheData.data()), cacheData.size());
+        if (cacheStream.fail() || (XXH3_64bits(cacheData.data(), cacheData.size()) != cacheHeader.dataHash)) {
+            return device->createPipelineCache();
+        }
+
+        return device->createPipelineCache(cacheData.data(), cacheData.size());
+    }
+
+    bool PipelineCacheFile::save(RenderDevice *device, RenderPipelineCache *pipelineCache, const std::filesystem::path &path) {
+        assert(device != nullptr);
+        assert(pipelineCache != nullptr);
+
+        std::vector<uint8_t> cacheData;
+        if (!pipelineCache->getData(cacheData) || cacheData.empty()) {
+            return false;
+        }
+
+        // Write to a temporary file first so a partially written cache never replaces a valid one.
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream cacheStream(tempPath, std::ios::binary);
+            if (!cacheStream.is_open()) {
+                return false;
+            }
+
+            PipelineCacheFileHeader cacheHeader;
+            fillHeader(device->getDescription(), cacheHeader);
+            cacheHeader.dataSize = cacheData.size();
+            cacheHeader.dataHash = XXH3_64bits(cacheData.data(), cacheData.size());
+            cacheStream.write(reinterpret_cast<const char *>(&cacheHeader), sizeof(PipelineCacheFileHeader));
+            cacheStream.write(reinterpret_cast<const char *>(cacheData.data()), cacheData.size());
+            if (cacheStream.fail()) {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        return !ec;
+    }
+};
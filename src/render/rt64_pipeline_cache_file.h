@@ -0,0 +1,29 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <filesystem>
+
+#include "rhi/rt64_render_interface.h"
+
+namespace RT64 {
+    struct PipelineCacheFileHeader {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t vendor = 0;
+        uint32_t reserved = 0;
+        uint64_t driverVersion = 0;
+        uint8_t pipelineCacheUUID[16] = {};
+        uint64_t dataSize = 0;
+        uint64_t dataHash = 0;
+    };
+
+    // Stores the driver's pipeline cache on disk. The data is only loaded back if it was saved with the same device and driver.
+    struct PipelineCacheFile {
+        // Always returns a valid cache. The cache will be empty if the file doesn't exist or isn't valid for the device.
+        static std::unique_ptr<RenderPipelineCache> load(RenderDevice *device, const std::filesystem::path &path);
+        static bool save(RenderDevice *device, RenderPipelineCache *pipelineCache, const std::filesystem::path &path);
+    };
+};
@@ -25,7 +25,7 @@ namespace RT64 {
 
         ProjectionProcessor();
         ~ProjectionProcessor();
-        void setup(RenderWorker *worker);
+        void setup(RenderWorker *worker, StagingRing *stagingRing, TaskScheduler *taskScheduler);
         void process(const ProcessParams &p);
         void processScene(const ProcessParams &p, const GameScene &scene, size_t sceneIndex, bool useScissorDetection);
         void upload(const ProcessParams &p);
@@ -52,17 +52,20 @@ namespace RT64 {
     static const RenderFormat RasterPositionFormat = RenderFormat::R32G32B32A32_FLOAT;
     static const RenderFormat RasterTexcoordFormat = RenderFormat::R32G32_FLOAT;
     static const RenderFormat RasterColorFormat = RenderFormat::R32G32B32A32_FLOAT;
+    static const RenderFormat RasterRenderIndexFormat = RenderFormat::R32_UINT;
 
-    static const RenderInputSlot RasterInputSlots[3] = {
+    static const RenderInputSlot RasterInputSlots[4] = {
         RenderInputSlot(0, RenderFormatSize(RasterPositionFormat)),
         RenderInputSlot(1, RenderFormatSize(RasterTexcoordFormat)),
-        RenderInputSlot(2, RenderFormatSize(RasterColorFormat))
+        RenderInputSlot(2, RenderFormatSize(RasterColorFormat)),
+        RenderInputSlot(3, RenderFormatSize(RasterRenderIndexFormat), RenderInputSlotClassification::PER_INSTANCE_DATA)
     };
 
-    static const RenderInputElement RasterInputElements[3] = {
+    static const RenderInputElement RasterInputElements[4] = {
         RenderInputElement("POSITION", 0, 0, RasterPositionFormat, 0, 0),
         RenderInputElement("TEXCOORD", 0, 1, RasterTexcoordFormat, 1, 0),
-        RenderInputElement("COLOR", 0, 2, RasterColorFormat, 2, 0)
+        RenderInputElement("COLOR", 0, 2, RasterColorFormat, 2, 0),
+        RenderInputElement("RENDERINDEX", 0, 3, RasterRenderIndexFormat, 3, 0)
     };
 
     // OptimizerCacheSPIRV
@@ -85,7 +88,7 @@ namespace RT64 {
     // RasterShader
 
     RasterShader::RasterShader(RenderDevice *device, const ShaderDescription &desc, const RenderPipelineLayout *pipelineLayout, RenderShaderFormat shaderFormat, const RenderMultisampling &multisampling, 
-        const ShaderCompiler *shaderCompiler, const OptimizerCacheSPIRV *optimizerCacheSPIRV)
+        const ShaderCompiler *shaderCompiler, const OptimizerCacheSPIRV *optimizerCacheSPIRV, RasterShaderBinary *shaderBinary, RenderPipelineCache *pipelineCache)
     {
         assert(device != nullptr);
 
@@ -98,7 +101,13 @@ namespace RT64 {
 #ifdef __APPLE__
         std::vector<RenderSpecConstant> specConstants;
 #endif
-        if (shaderFormat == RenderShaderFormat::SPIRV) {
+        // A binary loaded from the offline cache skips optimization or compilation entirely. Only formats that produce a binary per description can use it.
+        const bool binaryFormat = (shaderFormat == RenderShaderFormat::SPIRV) || (shaderFormat == RenderShaderFormat::DXIL);
+        if (binaryFormat && (shaderBinary != nullptr) && !shaderBinary->empty()) {
+            vertexShader = device->createShader(shaderBinary->vertexShader.data(), shaderBinary->vertexShader.size(), "VSMain", shaderFormat);
+            pixelShader = device->createShader(shaderBinary->pixelShader.data(), shaderBinary->pixelShader.size(), "PSMain", shaderFormat);
+        }
+        else if (shaderFormat == RenderShaderFormat::SPIRV) {
             // Choose the pre-compiled shader permutations.
             const respv::Shader *VS = nullptr;
             const respv::Shader *PS = nullptr;
@@ -136,6 +145,11 @@ namespace RT64 {
 
             vertexShader = device->createShader(optimizedVS.data(), optimizedVS.size(), "VSMain", shaderFormat);
             pixelShader = device->createShader(optimizedPS.data(), optimizedPS.size(), "PSMain", shaderFormat);
+
+            if (shaderBinary != nullptr) {
+                shaderBinary->vertexShader = optimizedVS;
+                shaderBinary->pixelShader = optimizedPS;
+            }
         }
         else if (shaderFormat == RenderShaderFormat::METAL) {
 #       ifdef __APPLE__
@@ -206,6 +220,13 @@ namespace RT64 {
             vertexShader = device->createShader(blobVS->GetBufferPointer(), blobVS->GetBufferSize(), "VSMain", shaderFormat);
             pixelShader = device->createShader(blobPS->GetBufferPointer(), blobPS->GetBufferSize(), "PSMain", shaderFormat);
 
+            if (shaderBinary != nullptr) {
+                const uint8_t *blobVSBytes = reinterpret_cast<const uint8_t *>(blobVS->GetBufferPointer());
+                const uint8_t *blobPSBytes = reinterpret_cast<const uint8_t *>(blobPS->GetBufferPointer());
+                shaderBinary->vertexShader.assign(blobVSBytes, blobVSBytes + blobVS->GetBufferSize());
+                shaderBinary->pixelShader.assign(blobPSBytes, blobPSBytes + blobPS->GetBufferSize());
+            }
+
             // Blobs can be discarded once the shaders are created.
             blobVSLibraries[0]->Release();
             blobVSLibraries[1]->Release();
@@ -222,6 +243,7 @@ namespace RT64 {
         const bool copyMode = (desc.otherMode.cycleType() == G_CYC_COPY);
         PipelineCreation creation;
         creation.device = device;
+        creation.pipelineCache = pipelineCache;
         creation.pipelineLayout = pipelineLayout;
         creation.vertexShader = vertexShader.get();
         creation.pixelShader = pixelShader.get();
@@ -249,25 +271,30 @@ namespace RT64 {
         vss << std::string_view(RenderParamsText, sizeof(RenderParamsText));
         vss << "RenderParams getRenderParams() {" + renderParamsCode + "; return rp; }";
         vss <<
-            "void RasterVS(const RenderParams, in float4, in float2, in float4, out float4, out float2, out float4, out float4);"
+            "void RasterVS(const RenderParams, uint, uint, in float4, in float2, in float4, out float4, out float2, out float4, out float4, out uint);"
             "[shader(\"vertex\")]"
             "void VSMain("
+            "   in uint iVertexId : SV_VertexID,"
             "   in float4 iPosition : POSITION,"
             "   in float2 iUV : TEXCOORD,"
             "   in float4 iColor : COLOR,"
+            "   in uint iRenderIndex : RENDERINDEX,"
             "   out float4 oPosition : SV_POSITION,"
             "   out float2 oUV : TEXCOORD,"
             "   out float4 oSmoothColor : COLOR0";
 
         if (!desc.flags.smoothShade) {
-            vss << ", out float4 oFlatColor : COLOR1) {";
+            vss << ", out float4 oFlatColor : COLOR1";
         }
-        else {
-            vss << ") { float4 oFlatColor;";
+
+        vss << ", nointerpolation out uint oRenderIndex : RENDERINDEX) {";
+
+        if (desc.flags.smoothShade) {
+            vss << "float4 oFlatColor;";
         }
 
         vss <<
-            "   RasterVS(getRenderParams(), iPosition, iUV, iColor, oPosition, oUV, oSmoothColor, oFlatColor);"
+            "   RasterVS(getRenderParams(), iVertexId, iRenderIndex, iPosition, iUV, iColor, oPosition, oUV, oSmoothColor, oFlatColor, oRenderIndex);"
             "}";
 
         // Generate pixel shader.
@@ -275,7 +302,7 @@ namespace RT64 {
         pss << std::string_view(RenderParamsText, sizeof(RenderParamsText));
         pss << "RenderParams getRenderParams() {" + renderParamsCode + "; return rp; }";
         pss <<
-            "bool RasterPS(const RenderParams, float4, float2, float4, float4, bool, out float4, out float4);"
+            "bool RasterPS(const RenderParams, uint, float4, float2, float4, float4, bool, out float4, out float4);"
             "[shader(\"pixel\")]"
             "void PSMain("
             "  in float4 vertexPosition : SV_POSITION"
@@ -287,6 +314,7 @@ namespace RT64 {
         }
 
         pss <<
+            ", nointerpolation in uint renderIndex : RENDERINDEX"
             ", out float4 pixelColor : SV_TARGET0"
             ", out float4 pixelAlpha : SV_TARGET1"
             ") {";
@@ -298,7 +326,7 @@ namespace RT64 {
         pss <<
             "   float4 resultColor;"
             "   float4 resultAlpha;"
-            "   if (!RasterPS(getRenderParams(), vertexPosition, vertexUV, vertexSmoothColor, vertexFlatColor, false, resultColor, resultAlpha)) discard;"
+            "   if (!RasterPS(getRenderParams(), renderIndex, vertexPosition, vertexUV, vertexSmoothColor, vertexFlatColor, false, resultColor, resultAlpha)) discard;"
             "   pixelColor = resultColor;"
             "   pixelAlpha = resultAlpha;"
             "}";
@@ -344,7 +372,7 @@ namespace RT64 {
             targetBlend.dstBlendAlpha = RenderBlend::ONE;
         }
 
-        return c.device->createGraphicsPipeline(pipelineDesc);
+        return c.device->createGraphicsPipeline(pipelineDesc, c.pipelineCache);
     }
     
     RenderMultisampling RasterShader::generateMultisamplingPattern(RenderSampleCounts sampleCount, bool sampleLocationsSupported) {
@@ -399,9 +427,9 @@ namespace RT64 {
     const uint64_t RasterShaderUber::RasterVSLibraryHash = XXH3_64bits(RasterVSLibraryBlobDXIL, sizeof(RasterVSLibraryBlobDXIL));
     const uint64_t RasterShaderUber::RasterPSLibraryHash = XXH3_64bits(RasterPSLibraryBlobDXIL, sizeof(RasterPSLibraryBlobDXIL));
 #else
-    // Shader hashes are not required in other platforms as they don't use a shader cache.
-    const uint64_t RasterShaderUber::RasterVSLibraryHash = 0;
-    const uint64_t RasterShaderUber::RasterPSLibraryHash = 0;
+    // Other platforms specialize the SPIR-V permutations instead, so those are used to invalidate the offline shader cache.
+    const uint64_t RasterShaderUber::RasterVSLibraryHash = XXH3_64bits(RasterVSSpecConstantBlobSPIRV, sizeof(RasterVSSpecConstantBlobSPIRV)) ^ XXH3_64bits(RasterVSSpecConstantFlatBlobSPIRV, sizeof(RasterVSSpecConstantFlatBlobSPIRV));
+    const uint64_t RasterShaderUber::RasterPSLibraryHash = XXH3_64bits(RasterPSSpecConstantBlobSPIRV, sizeof(RasterPSSpecConstantBlobSPIRV)) ^ XXH3_64bits(RasterPSSpecConstantFlatBlobSPIRV, sizeof(RasterPSSpecConstantFlatBlobSPIRV));
 #endif
 
     RasterShaderUber::RasterShaderUber(RenderDevice *device, RenderShaderFormat shaderFormat, const RenderMultisampling &multisampling, const ShaderLibrary *shaderLibrary, uint32_t threadCount) {
@@ -464,6 +492,7 @@ namespace RT64 {
 
         PipelineCreation creation;
         creation.device = device;
+        creation.pipelineCache = shaderLibrary->pipelineCache;
         creation.pipelineLayout = pipelineLayout.get();
         creation.vertexShader = vertexShader.get();
         creation.pixelShader = pixelShader.get();
@@ -544,14 +573,14 @@ namespace RT64 {
         targetBlend.dstBlendAlpha = RenderBlend::ONE;
         targetBlend.blendOpAlpha = RenderBlendOperation::ADD;
 
-        postBlendDitherNoiseAddPipeline = device->createGraphicsPipeline(postBlendDesc);
+        postBlendDitherNoiseAddPipeline = device->createGraphicsPipeline(postBlendDesc, shaderLibrary->pipelineCache);
 
         postBlendDesc.pixelShader = postBlendSubPixelShader.get();
         targetBlend.blendOp = RenderBlendOperation::REV_SUBTRACT;
-        postBlendDitherNoiseSubPipeline = device->createGraphicsPipeline(postBlendDesc);
+        postBlendDitherNoiseSubPipeline = device->createGraphicsPipeline(postBlendDesc, shaderLibrary->pipelineCache);
 
         postBlendDesc.pixelShader = postBlendSubNegativePixelShader.get();
-        postBlendDitherNoiseSubNegativePipeline = device->createGraphicsPipeline(postBlendDesc);
+        postBlendDitherNoiseSubNegativePipeline = device->createGraphicsPipeline(postBlendDesc, shaderLibrary->pipelineCache);
     }
 
     RasterShaderUber::~RasterShaderUber() {
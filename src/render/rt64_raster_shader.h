@@ -41,6 +41,7 @@ namespace RT64 {
 
     struct PipelineCreation {
         RenderDevice *device;
+        RenderPipelineCache *pipelineCache;
         const RenderPipelineLayout *pipelineLayout;
         const RenderShader *vertexShader;
         const RenderShader *pixelShader;
@@ -60,13 +61,22 @@ namespace RT64 {
         std::string pixelShader;
     };
 
+    struct RasterShaderBinary {
+        std::vector<uint8_t> vertexShader;
+        std::vector<uint8_t> pixelShader;
+
+        bool empty() const {
+            return vertexShader.empty() || pixelShader.empty();
+        }
+    };
+
     struct RasterShader {
         ShaderDescription desc;
         RenderDevice *device;
         std::unique_ptr<RenderPipeline> pipeline;
 
         RasterShader(RenderDevice *device, const ShaderDescription &desc, const RenderPipelineLayout *pipelineLayout, RenderShaderFormat shaderFormat, const RenderMultisampling &multisampling, 
-            const ShaderCompiler *shaderCompiler, const OptimizerCacheSPIRV *optimizerCacheSPIRV);
+            const ShaderCompiler *shaderCompiler, const OptimizerCacheSPIRV *optimizerCacheSPIRV, RasterShaderBinary *shaderBinary = nullptr, RenderPipelineCache *pipelineCache = nullptr);
 
         ~RasterShader();
         static RasterShaderText generateShaderText(const ShaderDescription &desc, bool multisampling);
@@ -4,95 +4,127 @@
 
 #include "rt64_raster_shader_cache.h"
 
+#include <algorithm>
+
+#include "xxHash/xxh3.h"
+
 #include "common/rt64_thread.h"
 
 #define ENABLE_OPTIMIZED_SHADER_GENERATION
 
 namespace RT64 {
-    // RasterShaderCache::CompilationThread
-    
-    RasterShaderCache::CompilationThread::CompilationThread(RasterShaderCache *shaderCache) {
-        assert(shaderCache != nullptr);
+    static const uint32_t RasterShaderCacheMagic = 0x43535352U;
+    static const uint32_t RasterShaderCacheVersion = 4U;
+    static const uint32_t RasterShaderCacheMaxBinarySize = 16 * 1024 * 1024;
+
+    // Limits for the entries stored in the offline cache. Entries that haven't been used by the application for the maximum amount of sessions
+    // are discarded, and only the most recently used ones are stored if there are more entries than the limit.
+    static const uint32_t RasterShaderCacheMaxEntries = 8192;
+    static const uint32_t RasterShaderCacheMaxSessionAge = 32;
+
+    // RasterShaderCache
+
+    RasterShaderCache::RasterShaderCache(TaskScheduler *taskScheduler, uint32_t ubershaderThreadCount) {
+        assert(taskScheduler != nullptr);
 
-        this->shaderCache = shaderCache;
+        this->taskScheduler = taskScheduler;
+        this->ubershaderThreadCount = ubershaderThreadCount;
 
-        thread = std::make_unique<std::thread>(&CompilationThread::loop, this);
-        threadRunning = false;
+#if defined(ENABLE_OPTIMIZED_SHADER_GENERATION) && defined(_WIN32)
+        shaderCompiler = std::make_unique<ShaderCompiler>();
+#endif
     }
 
-    RasterShaderCache::CompilationThread::~CompilationThread() {
-        threadRunning = false;
-        shaderCache->descQueueChanged.notify_all();
-        thread->join();
-        thread.reset(nullptr);
+    RasterShaderCache::~RasterShaderCache() {
+        if (offlineLoadTask != nullptr) {
+            taskScheduler->cancel(offlineLoadTask);
+            taskScheduler->wait(offlineLoadTask);
+        }
+
+        waitForAll();
     }
 
-    void RasterShaderCache::CompilationThread::loop() {
-        Thread::setCurrentThreadName("RT64 Shader");
-
-        // The shader compilation thread should have idle priority by default as the application can use the ubershader in the meantime.
-        Thread::setCurrentThreadPriority(Thread::Priority::Idle);
-
-        threadRunning = true;
-
-        while (threadRunning) {
-            ShaderDescription shaderDesc;
-            bool fromPriorityQueue = false;
-            
-            // Check the top of the queue or wait if it's empty.
-            {
-                std::unique_lock<std::mutex> queueLock(shaderCache->descQueueMutex);
-                shaderCache->descQueueActiveCount--;
-                shaderCache->descQueueChanged.wait(queueLock, [this]() {
-                    return !threadRunning || !shaderCache->descQueue.empty();
-                });
-
-                shaderCache->descQueueActiveCount++;
-                if (!shaderCache->descQueue.empty()) {
-                    shaderDesc = shaderCache->descQueue.front();
-                    shaderCache->descQueue.pop();
-                    fromPriorityQueue = true;
-                }
+    void RasterShaderCache::queueCompilations(size_t count) {
+#ifdef ENABLE_OPTIMIZED_SHADER_GENERATION
+        // Every task compiles whichever description is at the top of the queues when it runs. The compilation tasks have idle priority
+        // by default as the application can use the ubershader in the meantime.
+        for (size_t i = 0; i < count; i++) {
+            taskScheduler->submit(Thread::Priority::Idle, [this]() { compileNext(); }, &compilationGroup);
+        }
+#endif
+    }
+
+    void RasterShaderCache::compileNext() {
+        // Shaders submitted by the application always take priority over the ones being pre-warmed.
+        ShaderDescription shaderDesc;
+        bool submittedByApplication = false;
+        {
+            const std::unique_lock<std::mutex> queueLock(descQueueMutex);
+            if (!descQueue.empty()) {
+                shaderDesc = descQueue.front();
+                descQueue.pop();
+                submittedByApplication = true;
             }
-            
-            // Compile the shader at the top of the queue.
-            if (fromPriorityQueue) {
-                assert((shaderCache->shaderUber != nullptr) && "Ubershader should've been created by the time a new shader is submitted to the cache.");
-                const RenderPipelineLayout *uberPipelineLayout = shaderCache->shaderUber->pipelineLayout.get();
-                const RenderMultisampling multisampling = shaderCache->multisampling;
-                std::unique_ptr<RasterShader> newShader = std::make_unique<RasterShader>(shaderCache->device, shaderDesc, uberPipelineLayout, shaderCache->shaderFormat, multisampling, shaderCache->shaderCompiler.get(), &shaderCache->optimizerCacheSPIRV);
-
-                {
-                    const std::unique_lock<std::mutex> lock(shaderCache->GPUShadersMutex);
-                    shaderCache->GPUShaders[shaderDesc.hash()] = std::move(newShader);
-                }
+            else if (!prewarmQueue.empty()) {
+                shaderDesc = prewarmQueue.front();
+                prewarmQueue.pop();
+            }
+            else {
+                return;
             }
         }
-    }
 
-    // RasterShaderCache
+        // The same description can be in both queues. Skip it if it was already compiled.
+        const uint64_t shaderHash = shaderDesc.hash();
+        bool alreadyCompiled = false;
+        {
+            const std::unique_lock<std::mutex> lock(GPUShadersMutex);
+            alreadyCompiled = (GPUShaders.find(shaderHash) != GPUShaders.end());
+        }
 
-    RasterShaderCache::RasterShaderCache(uint32_t threadCount, uint32_t ubershaderThreadCount) {
-        assert(threadCount > 0);
+        if (alreadyCompiled) {
+            // Pre-warmed shaders still count as used when the application submits them.
+            if (submittedByApplication) {
+                const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+                auto entryIt = offlineEntries.find(shaderHash);
+                if (entryIt != offlineEntries.end()) {
+                    entryIt->second.usedThisSession = true;
+                }
+            }
 
-        this->threadCount = threadCount;
-        this->ubershaderThreadCount = ubershaderThreadCount;
+            return;
+        }
 
-#ifdef ENABLE_OPTIMIZED_SHADER_GENERATION
-#   ifdef _WIN32
-        shaderCompiler = std::make_unique<ShaderCompiler>();
-#   endif
+        // Use the binary from the offline cache if it's available.
+        RasterShaderBinary shaderBinary;
+        {
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+            auto entryIt = offlineEntries.find(shaderHash);
+            if (entryIt != offlineEntries.end()) {
+                shaderBinary = entryIt->second.binary;
+            }
+        }
 
-        descQueueActiveCount = threadCount;
+        assert((shaderUber != nullptr) && "Ubershader should've been created by the time a new shader is submitted to the cache.");
+        const bool binaryCached = !shaderBinary.empty();
+        const RenderPipelineLayout *uberPipelineLayout = shaderUber->pipelineLayout.get();
+        std::unique_ptr<RasterShader> newShader = std::make_unique<RasterShader>(device, shaderDesc, uberPipelineLayout, shaderFormat, multisampling, shaderCompiler.get(), &optimizerCacheSPIRV, &shaderBinary, pipelineCache);
 
-        for (uint32_t t = 0; t < threadCount; t++) {
-            compilationThreads.push_back(std::make_unique<CompilationThread>(this));
+        {
+            const std::unique_lock<std::mutex> lock(GPUShadersMutex);
+            GPUShaders[shaderHash] = std::move(newShader);
         }
-#endif
-    }
 
-    RasterShaderCache::~RasterShaderCache() {
-        compilationThreads.clear();
+        // Store the description and the binary that was produced so it can be saved to the offline cache.
+        {
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+            OfflineEntry &offlineEntry = offlineEntries[shaderHash];
+            offlineEntry.desc = shaderDesc;
+            offlineEntry.usedThisSession = offlineEntry.usedThisSession || submittedByApplication;
+            if (!binaryCached) {
+                offlineEntry.binary = std::move(shaderBinary);
+            }
+        }
     }
 
     void RasterShaderCache::setup(RenderDevice *device, RenderShaderFormat shaderFormat, const ShaderLibrary *shaderLibrary, const RenderMultisampling &multisampling) {
@@ -101,6 +133,7 @@ namespace RT64 {
         this->device = device;
         this->shaderFormat = shaderFormat;
         this->multisampling = multisampling;
+        this->pipelineCache = shaderLibrary->pipelineCache;
 
         shaderUber = std::make_unique<RasterShaderUber>(device, shaderFormat, multisampling, shaderLibrary, ubershaderThreadCount);
         usesHDR = shaderLibrary->usesHDR;
@@ -109,6 +142,29 @@ namespace RT64 {
         if (shaderFormat == RenderShaderFormat::SPIRV) {
             optimizerCacheSPIRV.initialize();
         }
+
+        // Any binaries stored in the offline cache are only valid for the same shader libraries and multisampling configuration.
+        XXH3_state_t xxh3;
+        XXH3_64bits_reset(&xxh3);
+        XXH3_64bits_update(&xxh3, &RasterShaderUber::RasterVSLibraryHash, sizeof(uint64_t));
+        XXH3_64bits_update(&xxh3, &RasterShaderUber::RasterPSLibraryHash, sizeof(uint64_t));
+        XXH3_64bits_update(&xxh3, &shaderFormat, sizeof(RenderShaderFormat));
+        XXH3_64bits_update(&xxh3, &multisampling.sampleCount, sizeof(RenderSampleCounts));
+        XXH3_64bits_update(&xxh3, &multisampling.sampleLocationsEnabled, sizeof(bool));
+        XXH3_64bits_update(&xxh3, multisampling.sampleLocations, sizeof(multisampling.sampleLocations));
+        XXH3_64bits_update(&xxh3, &usesHDR, sizeof(bool));
+        const uint64_t newConfigurationHash = XXH3_64bits_digest(&xxh3);
+        if (newConfigurationHash != configurationHash) {
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+            for (auto &it : offlineEntries) {
+                it.second.binary = RasterShaderBinary();
+            }
+
+            configurationHash = newConfigurationHash;
+        }
+
+        // Recompile all the descriptions that were seen before in the background.
+        prewarm();
     }
 
     void RasterShaderCache::submit(const ShaderDescription &desc) {
@@ -131,20 +187,193 @@ namespace RT64 {
             descQueue.push(desc);
         }
 
-        descQueueChanged.notify_all();
+        queueCompilations(1);
+    }
+    
+    void RasterShaderCache::prewarm() {
+        size_t prewarmCount = 0;
+        {
+            const std::unique_lock<std::mutex> queueLock(descQueueMutex);
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+            if (offlineEntries.empty()) {
+                return;
+            }
+
+            for (const auto &it : offlineEntries) {
+                prewarmQueue.push(it.second.desc);
+            }
+
+            prewarmCount = offlineEntries.size();
+        }
+
+        queueCompilations(prewarmCount);
+    }
+
+    void RasterShaderCache::loadOfflineCache(const std::filesystem::path &path) {
+        if (offlineLoadTask != nullptr) {
+            taskScheduler->wait(offlineLoadTask);
+        }
+
+        // The file is read by a background task so it doesn't delay the setup. The entries are pre-warmed as soon as they're loaded.
+        offlineLoadTask = taskScheduler->submit(Thread::Priority::Idle, [this, path]() {
+            if (readOfflineCache(path)) {
+                prewarm();
+            }
+        });
+    }
+
+    bool RasterShaderCache::readOfflineCache(const std::filesystem::path &path) {
+        std::ifstream cacheStream(path, std::ios::binary);
+        if (!cacheStream.is_open()) {
+            return false;
+        }
+
+        RasterShaderCacheHeader cacheHeader;
+        cacheStream.read(reinterpret_cast<char *>(&cacheHeader), sizeof(RasterShaderCacheHeader));
+        if (cacheStream.fail() || (cacheHeader.magic != RasterShaderCacheMagic) || (cacheHeader.version != RasterShaderCacheVersion)) {
+            return false;
+        }
+
+        // Descriptions are still worth pre-warming if the configuration changed, but the binaries must be discarded.
+        uint64_t expectedConfigurationHash = 0;
+        {
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+            expectedConfigurationHash = configurationHash;
+        }
+
+        const bool binariesValid = (cacheHeader.configurationHash == expectedConfigurationHash);
+        std::unordered_map<uint64_t, OfflineEntry> loadedEntries;
+        for (uint32_t i = 0; i < cacheHeader.entryCount; i++) {
+            RasterShaderCacheEntryHeader entryHeader;
+            cacheStream.read(reinterpret_cast<char *>(&entryHeader), sizeof(RasterShaderCacheEntryHeader));
+            if (cacheStream.fail() || (entryHeader.vertexShaderSize > RasterShaderCacheMaxBinarySize) || (entryHeader.pixelShaderSize > RasterShaderCacheMaxBinarySize)) {
+                return false;
+            }
+
+            OfflineEntry entry;
+            entry.desc = entryHeader.desc;
+            entry.lastUsedSession = entryHeader.lastUsedSession;
+            if (binariesValid) {
+                entry.binary.vertexShader.resize(entryHeader.vertexShaderSize);
+                entry.binary.pixelShader.resize(entryHeader.pixelShaderSize);
+                cacheStream.read(reinterpret_cast<char *>(entry.binary.vertexShader.data()), entryHeader.vertexShaderSize);
+                cacheStream.read(reinterpret_cast<char *>(entry.binary.pixelShader.data()), entryHeader.pixelShaderSize);
+            }
+            else {
+                cacheStream.seekg(std::streamoff(entryHeader.vertexShaderSize) + std::streamoff(entryHeader.pixelShaderSize), std::ios::cur);
+            }
+
+            if (cacheStream.fail()) {
+                return false;
+            }
+
+            loadedEntries[entry.desc.hash()] = std::move(entry);
+        }
+
+        {
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+
+            // The configuration might've changed while the file was being read.
+            const bool discardBinaries = (configurationHash != expectedConfigurationHash);
+            for (auto &it : loadedEntries) {
+                if (discardBinaries) {
+                    it.second.binary = RasterShaderBinary();
+                }
+
+                // Entries that were created during this session before the file finished loading keep their contents.
+                const uint32_t lastUsedSession = it.second.lastUsedSession;
+                auto emplaceResult = offlineEntries.emplace(it.first, std::move(it.second));
+                if (!emplaceResult.second) {
+                    emplaceResult.first->second.lastUsedSession = lastUsedSession;
+                }
+            }
+
+            offlineSessionIndex = cacheHeader.sessionIndex;
+        }
+
+        return true;
+    }
+
+    bool RasterShaderCache::saveOfflineCache(const std::filesystem::path &path) {
+        // The entries from the previous sessions must be loaded before the cache can be replaced.
+        if (offlineLoadTask != nullptr) {
+            taskScheduler->wait(offlineLoadTask);
+        }
+
+        // Write to a temporary file first so a partially written cache never replaces a valid one.
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream cacheStream(tempPath, std::ios::binary);
+            if (!cacheStream.is_open()) {
+                return false;
+            }
+
+            struct SavedEntry {
+                const OfflineEntry *entry;
+                uint32_t lastUsedSession;
+            };
+
+            // Discard the entries that are too old and keep only the most recently used ones if the limit is exceeded.
+            const std::unique_lock<std::mutex> lock(offlineEntriesMutex);
+            const uint32_t sessionIndex = offlineSessionIndex + 1;
+            std::vector<SavedEntry> savedEntries;
+            savedEntries.reserve(offlineEntries.size());
+            for (const auto &it : offlineEntries) {
+                const OfflineEntry &entry = it.second;
+                const uint32_t lastUsedSession = entry.usedThisSession ? sessionIndex : std::min(entry.lastUsedSession, sessionIndex);
+                if ((sessionIndex - lastUsedSession) <= RasterShaderCacheMaxSessionAge) {
+                    savedEntries.push_back({ &entry, lastUsedSession });
+                }
+            }
+
+            if (savedEntries.size() > RasterShaderCacheMaxEntries) {
+                auto mostRecentFirst = [](const SavedEntry &a, const SavedEntry &b) { return a.lastUsedSession > b.lastUsedSession; };
+                std::nth_element(savedEntries.begin(), savedEntries.begin() + RasterShaderCacheMaxEntries, savedEntries.end(), mostRecentFirst);
+                savedEntries.resize(RasterShaderCacheMaxEntries);
+            }
+
+            RasterShaderCacheHeader cacheHeader;
+            cacheHeader.magic = RasterShaderCacheMagic;
+            cacheHeader.version = RasterShaderCacheVersion;
+            cacheHeader.configurationHash = configurationHash;
+            cacheHeader.sessionIndex = sessionIndex;
+            cacheHeader.entryCount = uint32_t(savedEntries.size());
+            cacheStream.write(reinterpret_cast<const char *>(&cacheHeader), sizeof(RasterShaderCacheHeader));
+
+            for (const SavedEntry &savedEntry : savedEntries) {
+                const OfflineEntry &entry = *savedEntry.entry;
+                RasterShaderCacheEntryHeader entryHeader;
+                entryHeader.desc = entry.desc;
+                entryHeader.lastUsedSession = savedEntry.lastUsedSession;
+                entryHeader.vertexShaderSize = uint32_t(entry.binary.empty() ? 0 : entry.binary.vertexShader.size());
+                entryHeader.pixelShaderSize = uint32_t(entry.binary.empty() ? 0 : entry.binary.pixelShader.size());
+                cacheStream.write(reinterpret_cast<const char *>(&entryHeader), sizeof(RasterShaderCacheEntryHeader));
+                cacheStream.write(reinterpret_cast<const char *>(entry.binary.vertexShader.data()), entryHeader.vertexShaderSize);
+                cacheStream.write(reinterpret_cast<const char *>(entry.binary.pixelShader.data()), entryHeader.pixelShaderSize);
+            }
+
+            if (cacheStream.fail()) {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        return !ec;
     }
     
     void RasterShaderCache::waitForAll() {
         {
             std::unique_lock<std::mutex> queueLock(descQueueMutex);
             descQueue = std::queue<ShaderDescription>();
+            prewarmQueue = std::queue<ShaderDescription>();
         }
 
-        bool keepWaiting = false;
-        do {
-            std::unique_lock<std::mutex> queueLock(descQueueMutex);
-            keepWaiting = (descQueueActiveCount > 0);
-        } while (keepWaiting);
+        // Only the compilations that were already in progress need to finish.
+        taskScheduler->cancel(compilationGroup);
+        taskScheduler->wait(compilationGroup);
     }
 
     void RasterShaderCache::destroyAll() {
@@ -4,52 +4,74 @@
 
 #pragma once
 
-#include <atomic>
-#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <mutex>
 #include <queue>
-#include <thread>
 #include <unordered_map>
 
+#include "common/rt64_task_scheduler.h"
+
 #include "rt64_raster_shader.h"
 
 namespace RT64 {
+    struct RasterShaderCacheHeader {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t configurationHash = 0;
+        uint32_t sessionIndex = 0;
+        uint32_t entryCount = 0;
+    };
+
+    struct RasterShaderCacheEntryHeader {
+        ShaderDescription desc;
+        uint32_t lastUsedSession = 0;
+        uint32_t vertexShaderSize = 0;
+        uint32_t pixelShaderSize = 0;
+    };
+
     struct RasterShaderCache {
-        struct CompilationThread {
-            RasterShaderCache *shaderCache;
-            std::unique_ptr<std::thread> thread;
-            std::atomic<bool> threadRunning;
-
-            CompilationThread(RasterShaderCache *shaderCache);
-            ~CompilationThread();
-            void loop();
+        struct OfflineEntry {
+            ShaderDescription desc;
+            RasterShaderBinary binary;
+            uint32_t lastUsedSession = 0;
+            bool usedThisSession = false;
         };
 
         RenderDevice *device;
+        RenderPipelineCache *pipelineCache = nullptr;
         std::unique_ptr<RasterShaderUber> shaderUber;
         OptimizerCacheSPIRV optimizerCacheSPIRV;
         std::mutex submissionMutex;
         std::queue<ShaderDescription> descQueue;
+        std::queue<ShaderDescription> prewarmQueue;
         std::mutex descQueueMutex;
-        int32_t descQueueActiveCount = 0;
-        std::condition_variable descQueueChanged;
         std::unordered_map<uint64_t, bool> shaderHashes;
         std::unordered_map<uint64_t, std::unique_ptr<RasterShader>> GPUShaders;
         std::mutex GPUShadersMutex;
-        std::list<std::unique_ptr<CompilationThread>> compilationThreads;
-        uint32_t threadCount;
+        TaskScheduler *taskScheduler;
+        TaskScheduler::Group compilationGroup;
         uint32_t ubershaderThreadCount;
         RenderShaderFormat shaderFormat;
         std::unique_ptr<ShaderCompiler> shaderCompiler;
         RenderMultisampling multisampling;
         bool usesHDR = false;
+        uint64_t configurationHash = 0;
+        std::unordered_map<uint64_t, OfflineEntry> offlineEntries;
+        std::mutex offlineEntriesMutex;
+        uint32_t offlineSessionIndex = 0;
+        std::shared_ptr<TaskScheduler::Task> offlineLoadTask;
         
-        RasterShaderCache(uint32_t threadCount, uint32_t ubershaderThreadCount);
+        RasterShaderCache(TaskScheduler *taskScheduler, uint32_t ubershaderThreadCount);
         ~RasterShaderCache();
+        void queueCompilations(size_t count);
+        void compileNext();
         void setup(RenderDevice *device, RenderShaderFormat shaderFormat, const ShaderLibrary *shaderLibrary, const RenderMultisampling &multisampling);
         void submit(const ShaderDescription &desc);
+        void prewarm();
+        void loadOfflineCache(const std::filesystem::path &path);
+        bool readOfflineCache(const std::filesystem::path &path);
+        bool saveOfflineCache(const std::filesystem::path &path);
         void waitForAll();
         void destroyAll();
         RasterShader *getGPUShader(const ShaderDescription &desc);
@@ -22,10 +22,12 @@ namespace RT64 {
 
     void RenderWorker::execute() {
         commandQueue->executeCommandLists(commandList.get(), commandFence.get());
+        submittedCount++;
     }
 
     void RenderWorker::wait() {
         commandQueue->waitForCommandFence(commandFence.get());
+        completedCount = submittedCount.load();
     }
 
     // RenderWorkerExecution
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "rhi/rt64_render_interface.h"
 
 namespace RT64 {
@@ -14,6 +16,10 @@ namespace RT64 {
         std::unique_ptr<RenderCommandList> commandList;
         std::unique_ptr<RenderCommandFence> commandFence;
 
+        // Count the submissions of the worker and how many of them the GPU is known to have finished, so resources read by them can be reclaimed.
+        std::atomic<uint64_t> submittedCount = 0;
+        std::atomic<uint64_t> completedCount = 0;
+
         RenderWorker(RenderDevice *device, const std::string &name, RenderCommandListType commandListType);
         ~RenderWorker();
         void execute();
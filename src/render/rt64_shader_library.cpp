@@ -265,7 +265,7 @@ namespace RT64 {
             
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(BicubicScalingCSBlobDXIL, BicubicScalingCSBlobSPIRV, BicubicScalingCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(bicubicScaling.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            bicubicScaling.pipeline = device->createComputePipeline(pipelineDesc);
+            bicubicScaling.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Box filter.
@@ -279,7 +279,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(BoxFilterCSBlobDXIL, BoxFilterCSBlobSPIRV, BoxFilterCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(boxFilter.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            boxFilter.pipeline = device->createComputePipeline(pipelineDesc);
+            boxFilter.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Raytracing compose.
@@ -298,7 +298,7 @@ namespace RT64 {
             pipelineDesc.renderTargetCount = 1;
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pixelShader = pixelShader.get();
-            compose.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            compose.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
 
         /*
@@ -352,7 +352,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(IdleCSBlobDXIL, IdleCSBlobSPIRV, IdleCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(idle.pipelineLayout.get(), computeShader.get(), 1, 1, 1);
-            idle.pipeline = device->createComputePipeline(pipelineDesc);
+            idle.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Framebuffer changes clear.
@@ -365,7 +365,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(FbChangesClearCSBlobDXIL, FbChangesClearCSBlobSPIRV, FbChangesClearCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(fbChangesClear.pipelineLayout.get(), computeShader.get(), 1, 1, 1);
-            fbChangesClear.pipeline = device->createComputePipeline(pipelineDesc);
+            fbChangesClear.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Framebuffer read any changes and full.
@@ -381,10 +381,10 @@ namespace RT64 {
             fbReadAnyFull.pipelineLayout = layoutBuilder.create(device);
 
             std::unique_ptr<RenderShader> anyChangesShader = device->createShader(CREATE_SHADER_INPUTS(FbReadAnyChangesCSBlobDXIL, FbReadAnyChangesCSBlobSPIRV, FbReadAnyChangesCSBlobMSL, "CSMain", shaderFormat));
-            fbReadAnyChanges.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbReadAnyChanges.pipelineLayout.get(), anyChangesShader.get(), 8, 8, 1));
+            fbReadAnyChanges.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbReadAnyChanges.pipelineLayout.get(), anyChangesShader.get(), 8, 8, 1), pipelineCache);
 
             std::unique_ptr<RenderShader> fullShader = device->createShader(CREATE_SHADER_INPUTS(FbReadAnyFullCSBlobDXIL, FbReadAnyFullCSBlobSPIRV, FbReadAnyFullCSBlobMSL, "CSMain", shaderFormat));
-            fbReadAnyFull.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbReadAnyFull.pipelineLayout.get(), fullShader.get(), 8, 8, 1));
+            fbReadAnyFull.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbReadAnyFull.pipelineLayout.get(), fullShader.get(), 8, 8, 1), pipelineCache);
         }
 
         // Framebuffer Reinterpretation.
@@ -398,7 +398,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(FbReinterpretCSBlobDXIL, FbReinterpretCSBlobSPIRV, FbReinterpretCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(fbReinterpret.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            fbReinterpret.pipeline = device->createComputePipeline(pipelineDesc);
+            fbReinterpret.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Framebuffer write color or depth.
@@ -415,13 +415,13 @@ namespace RT64 {
             fbWriteDepthMS.pipelineLayout = layoutBuilder.create(device);
 
             std::unique_ptr<RenderShader> colorShader = device->createShader(CREATE_SHADER_INPUTS(FbWriteColorCSBlobDXIL, FbWriteColorCSBlobSPIRV, FbWriteColorCSBlobMSL, "CSMain", shaderFormat));
-            fbWriteColor.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbWriteColor.pipelineLayout.get(), colorShader.get(), 8, 8, 1));
+            fbWriteColor.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbWriteColor.pipelineLayout.get(), colorShader.get(), 8, 8, 1), pipelineCache);
 
             std::unique_ptr<RenderShader> depthShader = device->createShader(CREATE_SHADER_INPUTS(FbWriteDepthCSBlobDXIL, FbWriteDepthCSBlobSPIRV, FbWriteDepthCSBlobMSL, "CSMain", shaderFormat));
-            fbWriteDepth.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbWriteDepth.pipelineLayout.get(), depthShader.get(), 8, 8, 1));
+            fbWriteDepth.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbWriteDepth.pipelineLayout.get(), depthShader.get(), 8, 8, 1), pipelineCache);
 
             std::unique_ptr<RenderShader> depthShaderMS = device->createShader(CREATE_SHADER_INPUTS(FbWriteDepthCSMSBlobDXIL, FbWriteDepthCSMSBlobSPIRV, FbWriteDepthCSMSBlobMSL, "CSMain", shaderFormat));
-            fbWriteDepthMS.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbWriteDepthMS.pipelineLayout.get(), depthShaderMS.get(), 8, 8, 1));
+            fbWriteDepthMS.pipeline = device->createComputePipeline(RenderComputePipelineDesc(fbWriteDepthMS.pipelineLayout.get(), depthShaderMS.get(), 8, 8, 1), pipelineCache);
         }
 
         // Gaussian filter.
@@ -435,7 +435,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(GaussianFilterRGB3x3CSBlobDXIL, GaussianFilterRGB3x3CSBlobSPIRV, GaussianFilterRGB3x3CSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(gaussianFilterRGB3x3.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            gaussianFilterRGB3x3.pipeline = device->createComputePipeline(pipelineDesc);
+            gaussianFilterRGB3x3.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Histogram average.
@@ -449,7 +449,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(HistogramAverageCSBlobDXIL, HistogramAverageCSBlobSPIRV, HistogramAverageCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(histogramAverage.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            histogramAverage.pipeline = device->createComputePipeline(pipelineDesc);
+            histogramAverage.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Histogram clear.
@@ -462,7 +462,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(HistogramClearCSBlobDXIL, HistogramClearCSBlobSPIRV, HistogramClearCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(histogramClear.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            histogramClear.pipeline = device->createComputePipeline(pipelineDesc);
+            histogramClear.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Histogram set.
@@ -476,7 +476,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(HistogramSetCSBlobDXIL, HistogramSetCSBlobSPIRV, HistogramSetCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(histogramSet.pipelineLayout.get(), computeShader.get(), 1, 1, 1);
-            histogramSet.pipeline = device->createComputePipeline(pipelineDesc);
+            histogramSet.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Luminance histogram.
@@ -490,7 +490,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(LuminanceHistogramCSBlobDXIL, LuminanceHistogramCSBlobSPIRV, LuminanceHistogramCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(luminanceHistogram.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            luminanceHistogram.pipeline = device->createComputePipeline(pipelineDesc);
+            luminanceHistogram.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // RSP Modify.
@@ -504,7 +504,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(RSPModifyCSBlobDXIL, RSPModifyCSBlobSPIRV, RSPModifyCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(rspModify.pipelineLayout.get(), computeShader.get(), 64, 1, 1);
-            rspModify.pipeline = device->createComputePipeline(pipelineDesc);
+            rspModify.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // RSP Process.
@@ -518,7 +518,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(RSPProcessCSBlobDXIL, RSPProcessCSBlobSPIRV, RSPProcessCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(rspProcess.pipelineLayout.get(), computeShader.get(), 64, 1, 1);
-            rspProcess.pipeline = device->createComputePipeline(pipelineDesc);
+            rspProcess.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // RSP Smooth Normal.
@@ -532,7 +532,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(RSPSmoothNormalCSBlobDXIL, RSPSmoothNormalCSBlobSPIRV, RSPSmoothNormalCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(rspSmoothNormal.pipelineLayout.get(), computeShader.get(), 64, 1, 1);
-            rspSmoothNormal.pipeline = device->createComputePipeline(pipelineDesc);
+            rspSmoothNormal.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // RSP World.
@@ -546,7 +546,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(RSPWorldCSBlobDXIL, RSPWorldCSBlobSPIRV, RSPWorldCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(rspWorld.pipelineLayout.get(), computeShader.get(), 64, 1, 1);
-            rspWorld.pipeline = device->createComputePipeline(pipelineDesc);
+            rspWorld.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Texture Copy.
@@ -566,7 +566,7 @@ namespace RT64 {
             pipelineDesc.renderTargetCount = 1;
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pixelShader = pixelShader.get();
-            textureCopy.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            textureCopy.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
 
         // Texture Decode.
@@ -580,7 +580,7 @@ namespace RT64 {
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(TextureDecodeCSBlobDXIL, TextureDecodeCSBlobSPIRV, TextureDecodeCSBlobMSL, "CSMain", shaderFormat));
             RenderComputePipelineDesc pipelineDesc(textureDecode.pipelineLayout.get(), computeShader.get(), 8, 8, 1);
-            textureDecode.pipeline = device->createComputePipeline(pipelineDesc);
+            textureDecode.pipeline = device->createComputePipeline(pipelineDesc, pipelineCache);
         }
 
         // Video Interface.
@@ -603,7 +603,7 @@ namespace RT64 {
             pipelineDesc.renderTargetBlend[0] = RenderBlendDesc::Copy();
             pipelineDesc.renderTargetCount = 1;
             pipelineDesc.pipelineLayout = videoInterfaceNearest.pipelineLayout.get();
-            videoInterfaceNearest.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            videoInterfaceNearest.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
 
             layoutBuilder.begin();
             layoutBuilder.addPushConstant(0, 0, sizeof(interop::VideoInterfaceCB), RenderShaderStageFlag::PIXEL);
@@ -613,11 +613,11 @@ namespace RT64 {
             videoInterfacePixel.pipelineLayout = layoutBuilder.create(device);
 
             pipelineDesc.pipelineLayout = videoInterfaceLinear.pipelineLayout.get();
-            videoInterfaceLinear.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            videoInterfaceLinear.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
 
             pipelineDesc.pixelShader = pixelShader.get();
             pipelineDesc.pipelineLayout = videoInterfacePixel.pipelineLayout.get();
-            videoInterfacePixel.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            videoInterfacePixel.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
     }
 
@@ -773,7 +773,7 @@ namespace RT64 {
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pixelShader = colorShader.get();
             pipelineDesc.multisampling = multisampling;
-            fbChangesDrawColor.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            fbChangesDrawColor.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
 
             std::unique_ptr<RenderShader> depthShader = device->createShader(CREATE_SHADER_INPUTS(FbChangesDrawDepthPSBlobDXIL, FbChangesDrawDepthPSBlobSPIRV, FbChangesDrawDepthPSBlobMSL, "PSMain", shaderFormat));
             pipelineDesc.pipelineLayout = fbChangesDrawDepth.pipelineLayout.get();
@@ -782,7 +782,7 @@ namespace RT64 {
             pipelineDesc.depthFunction = RenderComparisonFunction::ALWAYS;
             pipelineDesc.depthWriteEnabled = true;
             pipelineDesc.depthTargetFormat = RenderFormat::D32_FLOAT;
-            fbChangesDrawDepth.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            fbChangesDrawDepth.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
 
         // Copy color to depth and depth to color.
@@ -805,13 +805,13 @@ namespace RT64 {
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pipelineLayout = rtCopyDepthToColor.pipelineLayout.get();
             pipelineDesc.pixelShader = depthToColorShader.get();
-            rtCopyDepthToColor.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            rtCopyDepthToColor.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
 
             if (RtCopyDepthToColorPSMSBlob != nullptr) {
                 std::unique_ptr<RenderShader> depthToColorMSShader = device->createShader(RtCopyDepthToColorPSMSBlob, RtCopyDepthToColorPSMSBlobSize, "PSMain", shaderFormat);
                 pipelineDesc.pixelShader = depthToColorMSShader.get();
                 pipelineDesc.multisampling = multisampling;
-                rtCopyDepthToColorMS.pipeline = device->createGraphicsPipeline(pipelineDesc);
+                rtCopyDepthToColorMS.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
             }
 
             std::unique_ptr<RenderShader> colorToDepthShader = device->createShader(RtCopyColorToDepthPSBlob, RtCopyColorToDepthPSBlobSize, "PSMain", shaderFormat);
@@ -822,13 +822,13 @@ namespace RT64 {
             pipelineDesc.pipelineLayout = rtCopyColorToDepth.pipelineLayout.get();
             pipelineDesc.pixelShader = colorToDepthShader.get();
             pipelineDesc.multisampling = RenderMultisampling();
-            rtCopyColorToDepth.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            rtCopyColorToDepth.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
 
             if (RtCopyColorToDepthPSMSBlob != nullptr) {
                 std::unique_ptr<RenderShader> colorToDepthMSShader = device->createShader(RtCopyColorToDepthPSMSBlob, RtCopyColorToDepthPSMSBlobSize, "PSMain", shaderFormat);
                 pipelineDesc.pixelShader = colorToDepthMSShader.get();
                 pipelineDesc.multisampling = multisampling;
-                rtCopyColorToDepthMS.pipeline = device->createGraphicsPipeline(pipelineDesc);
+                rtCopyColorToDepthMS.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
             }
         }
 
@@ -849,7 +849,7 @@ namespace RT64 {
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pixelShader = pixelShader.get();
             pipelineDesc.multisampling = multisampling;
-            postProcess.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            postProcess.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
         
         // Raytracing debug.
@@ -874,7 +874,7 @@ namespace RT64 {
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pixelShader = pixelShader.get();
             pipelineDesc.multisampling = multisampling;
-            debug.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            debug.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
 
         // RSP Vertex Test Z.
@@ -890,10 +890,10 @@ namespace RT64 {
             rspVertexTestZMS.pipelineLayout = layoutBuilder.create(device);
 
             std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(RSPVertexTestZCSBlobDXIL, RSPVertexTestZCSBlobSPIRV, RSPVertexTestZCSBlobMSL, "CSMain", shaderFormat));
-            rspVertexTestZ.pipeline = device->createComputePipeline(RenderComputePipelineDesc(rspVertexTestZ.pipelineLayout.get(), computeShader.get(), 1, 1, 1));
+            rspVertexTestZ.pipeline = device->createComputePipeline(RenderComputePipelineDesc(rspVertexTestZ.pipelineLayout.get(), computeShader.get(), 1, 1, 1), pipelineCache);
 
             std::unique_ptr<RenderShader> computeShaderMS = device->createShader(CREATE_SHADER_INPUTS(RSPVertexTestZCSMSBlobDXIL, RSPVertexTestZCSMSBlobSPIRV, RSPVertexTestZCSMSBlobMSL, "CSMain", shaderFormat));
-            rspVertexTestZMS.pipeline = device->createComputePipeline(RenderComputePipelineDesc(rspVertexTestZMS.pipelineLayout.get(), computeShaderMS.get(), 1, 1, 1));
+            rspVertexTestZMS.pipeline = device->createComputePipeline(RenderComputePipelineDesc(rspVertexTestZMS.pipelineLayout.get(), computeShaderMS.get(), 1, 1, 1), pipelineCache);
         }
 
         // Texture Resolve.
@@ -913,7 +913,7 @@ namespace RT64 {
             pipelineDesc.renderTargetCount = 1;
             pipelineDesc.vertexShader = fullScreenVertexShader.get();
             pipelineDesc.pixelShader = pixelShader.get();
-            textureResolve.pipeline = device->createGraphicsPipeline(pipelineDesc);
+            textureResolve.pipeline = device->createGraphicsPipeline(pipelineDesc, pipelineCache);
         }
     }
 };
@@ -19,6 +19,9 @@ namespace RT64 {
         bool usesHDR = false;
         bool usesHardwareResolve = false;
 
+        // Optional cache used for creating every pipeline in the library. Must outlive the library.
+        RenderPipelineCache *pipelineCache = nullptr;
+
         // All shaders.
         ShaderRecord bicubicScaling;
         ShaderRecord boxFilter;
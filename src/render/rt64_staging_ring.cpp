@@ -0,0 +1,154 @@
+//
+// RT64
+//
+
+#include "rt64_staging_ring.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace RT64 {
+    // Common functions.
+
+    static const uint64_t BlockAlignment = 256;
+
+    static uint64_t roundUp(uint64_t value, uint64_t powerOf2Alignment) {
+        return (value + powerOf2Alignment - 1) & ~(powerOf2Alignment - 1);
+    }
+
+    // StagingRing
+
+    StagingRing::StagingRing(RenderDevice *device, uint64_t initialSize) {
+        assert(device != nullptr);
+
+        this->device = device;
+        createRing(roundUp(std::max(initialSize, BlockAlignment), BlockAlignment));
+    }
+
+    StagingRing::~StagingRing() {
+        for (Ring &ring : rings) {
+            ring.buffer->unmap();
+        }
+    }
+
+    StagingRing::Allocation StagingRing::allocate(uint64_t size) {
+        assert(size > 0);
+
+        const uint64_t alignedSize = roundUp(size, BlockAlignment);
+        std::unique_lock<std::mutex> ringLock(ringMutex);
+
+        // Destroy any of the replaced rings the GPU is no longer using.
+        auto ringIt = rings.begin();
+        while (std::next(ringIt) != rings.end()) {
+            reclaim(*ringIt);
+            if (ringIt->blocks.empty()) {
+                ringIt->buffer->unmap();
+                ringIt = rings.erase(ringIt);
+            }
+            else {
+                ringIt++;
+            }
+        }
+
+        Ring *ring = &rings.back();
+        reclaim(*ring);
+
+        // Replace the ring with a bigger one when there's not enough space left. This is the only case where the upload memory is reallocated.
+        uint64_t offset = 0;
+        if (!fits(*ring, alignedSize, offset)) {
+            createRing(std::max(ring->size * 2, roundUp(alignedSize * 2, BlockAlignment)));
+            ring = &rings.back();
+            offset = 0;
+            growCount++;
+        }
+
+        Block &block = ring->blocks.emplace_back();
+        block.offset = offset;
+        block.size = alignedSize;
+        ring->head = offset + alignedSize;
+
+        Allocation allocation;
+        allocation.buffer = ring->buffer.get();
+        allocation.data = ring->mappedData + offset;
+        allocation.offset = offset;
+        allocation.block = &block;
+        return allocation;
+    }
+
+    void StagingRing::markUsed(const Allocation &allocation, const RenderWorker *worker) {
+        assert(allocation.valid());
+        assert(worker != nullptr);
+
+        std::unique_lock<std::mutex> ringLock(ringMutex);
+        assert((allocation.block->worker == nullptr) || (allocation.block->worker == worker));
+        allocation.block->worker = worker;
+        allocation.block->retireCount = worker->submittedCount + 1;
+    }
+
+    void StagingRing::release(Allocation &allocation) {
+        if (!allocation.valid()) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> ringLock(ringMutex);
+        allocation.block->released = true;
+        allocation = Allocation();
+    }
+
+    void StagingRing::createRing(uint64_t size) {
+        Ring &ring = rings.emplace_back();
+        ring.buffer = device->createBuffer(RenderBufferDesc::UploadBuffer(size));
+        ring.mappedData = static_cast<uint8_t *>(ring.buffer->map());
+        ring.size = size;
+        ring.head = 0;
+    }
+
+    void StagingRing::reclaim(Ring &ring) {
+        // Blocks are only reclaimed in the order they were allocated, so a block that is still in use holds back the ones after it.
+        while (!ring.blocks.empty()) {
+            const Block &block = ring.blocks.front();
+            if (!block.released || ((block.worker != nullptr) && (block.worker->completedCount < block.retireCount))) {
+                break;
+            }
+
+            ring.blocks.pop_front();
+        }
+
+        if (ring.blocks.empty()) {
+            ring.head = 0;
+        }
+    }
+
+    bool StagingRing::fits(const Ring &ring, uint64_t size, uint64_t &offset) const {
+        if (ring.blocks.empty()) {
+            offset = 0;
+            return (size <= ring.size);
+        }
+
+        const uint64_t tail = ring.blocks.front().offset;
+        if (ring.blocks.back().offset >= tail) {
+            // The blocks in use don't wrap around the end of the ring. Use the space after them or wrap around to the start.
+            if ((ring.head + size) <= ring.size) {
+                offset = ring.head;
+                return true;
+            }
+            else if (size <= tail) {
+                offset = 0;
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+        else {
+            // The only free space left is the gap between the newest and the oldest blocks.
+            if ((ring.head + size) <= tail) {
+                offset = ring.head;
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+    }
+};
@@ -0,0 +1,65 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <deque>
+#include <list>
+#include <mutex>
+
+#include "rt64_render_worker.h"
+
+namespace RT64 {
+    // Persistently mapped upload memory shared by all the buffer uploaders. Space is sub-allocated linearly and reclaimed
+    // in allocation order once the workers that recorded copies from it have waited on their fences past those submissions.
+    struct StagingRing {
+        struct Block {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            const RenderWorker *worker = nullptr;
+            uint64_t retireCount = 0;
+            bool released = false;
+        };
+
+        struct Ring {
+            std::unique_ptr<RenderBuffer> buffer;
+            uint8_t *mappedData = nullptr;
+            uint64_t size = 0;
+            uint64_t head = 0;
+            std::deque<Block> blocks;
+        };
+
+        struct Allocation {
+            RenderBuffer *buffer = nullptr;
+            uint8_t *data = nullptr;
+            uint64_t offset = 0;
+            Block *block = nullptr;
+
+            bool valid() const {
+                return block != nullptr;
+            }
+        };
+
+        RenderDevice *device;
+        std::mutex ringMutex;
+
+        // Rings that were replaced by a bigger one are kept alive until the GPU is done with all of their blocks.
+        std::list<Ring> rings;
+        uint64_t growCount = 0;
+
+        StagingRing(RenderDevice *device, uint64_t initialSize);
+        ~StagingRing();
+        Allocation allocate(uint64_t size);
+
+        // Indicates the allocation is read by the next submission of the worker. Can be called multiple times if the copy is recorded again.
+        void markUsed(const Allocation &allocation, const RenderWorker *worker);
+
+        // The memory is only reused once every submission that was marked as using it has been completed.
+        void release(Allocation &allocation);
+
+        void createRing(uint64_t size);
+        void reclaim(Ring &ring);
+        bool fits(const Ring &ring, uint64_t size, uint64_t &offset) const;
+    };
+};
@@ -19,7 +19,8 @@ namespace RT64 {
         LoadTile loadTile;
         uint32_t mipmaps = 0;
         uint64_t memorySize = 0;
-        std::vector<uint8_t> bytesTMEM;
+        uint64_t tmemArenaOffset = 0;
+        TMEMRangeList tmemRanges;
         bool decodeTMEM = false;
     };
 };
\ No newline at end of file
@@ -29,12 +29,21 @@ namespace RT64 {
     static const uint32_t TextureDataPitchAlignment = 256;
     static const uint32_t TextureDataPlacementAlignment = 512;
 
+    static uint64_t nextPlacementAlignedOffset(uint64_t offset) {
+        if (offset % TextureDataPlacementAlignment) {
+            return offset + (TextureDataPlacementAlignment - (offset % TextureDataPlacementAlignment));
+        }
+        else {
+            return offset;
+        }
+    }
+
     ReplacementMap::ReplacementMap() {
         // Empty constructor.
     }
 
     ReplacementMap::~ReplacementMap() {
-        for (auto it : loadedTextureMap) {
+        for (const auto &it : loadedTextureMap) {
             delete it.second.texture;
         }
 
@@ -44,7 +53,7 @@ namespace RT64 {
     }
 
     void ReplacementMap::clear(std::vector<Texture *> &evictedTextures) {
-        for (auto it : loadedTextureMap) {
+        for (const auto &it : loadedTextureMap) {
             evictedTextures.emplace_back(it.second.texture);
         }
 
@@ -74,8 +83,9 @@ namespace RT64 {
 
             // Erase from the maps and the relative path set.
             auto it = loadedTextureReverseMap.find(lastUnusedTexture);
-            fileSystemStreamSets[it->second->second.fileSystemIndex].erase(it->second->second.relativePath);
-            loadedTextureMap.erase(it->second);
+            auto entryIt = loadedTextureMap.find(it->second);
+            fileSystemStreamSets[entryIt->second.fileSystemIndex].erase(entryIt->second.relativePath);
+            loadedTextureMap.erase(entryIt);
             loadedTextureReverseMap.erase(it);
 
             // Take texture off the unused list.
@@ -131,7 +141,7 @@ namespace RT64 {
 
         if (referenceCounted) {
             entry.unusedTextureListIterator = unusedTextureList.insert(unusedTextureList.begin(), texture);
-            loadedTextureReverseMap[texture] = loadedTextureMap.find(pathHash);
+            loadedTextureReverseMap[texture] = pathHash;
             cachedTexturePoolSize += texture->memorySize;
         }
     }
@@ -160,7 +170,7 @@ namespace RT64 {
         assert(it != loadedTextureReverseMap.end());
 
         // Remove entry from unused list if reference count was zero.
-        MapEntry &entry = it->second->second;
+        MapEntry &entry = loadedTextureMap[it->second];
         if (entry.references == 0) {
             assert(entry.unusedTextureListIterator != unusedTextureList.end());
             unusedTextureList.erase(entry.unusedTextureListIterator);
@@ -173,7 +183,7 @@ namespace RT64 {
 
     void ReplacementMap::decrementReference(Texture *texture) {
         auto it = loadedTextureReverseMap.find(texture);
-        MapEntry &entry = it->second->second;
+        MapEntry &entry = loadedTextureMap[it->second];
         assert(entry.references > 0);
         entry.references--;
 
@@ -187,8 +197,16 @@ namespace RT64 {
 
     // TextureMap
 
+    // The oldest half of the change log is dropped once it reaches this size.
+    static const size_t ChangeLogMaxSize = 64 * 1024;
+
+    // The TMEM arena is only compacted once it's at least this big and half of it belongs to evicted textures.
+    static const size_t TMEMArenaCompactMinSize = 1024 * 1024;
+
     TextureMap::TextureMap() {
         globalVersion = 0;
+        changeLogStart = 0;
+        tmemArenaFreedBytes = 0;
         replacementMapEnabled = true;
     }
 
@@ -209,15 +227,21 @@ namespace RT64 {
                 textureReplacementShiftedByHalf[i] = false;
                 textureReplacementReferenceCounted[i] = false;
                 versions[i]++;
+                logChange(uint32_t(i));
             }
         }
 
         globalVersion++;
     }
 
-    void TextureMap::add(uint64_t hash, uint64_t creationFrame, Texture *texture) {
+    void TextureMap::add(uint64_t hash, uint64_t creationFrame, Texture *texture, const uint8_t *bytesTMEM) {
         assert(hashMap.find(hash) == hashMap.end());
 
+        // Keep the compacted bytes so the texture can be hashed again with older hash versions.
+        const uint32_t tmemByteCount = texture->tmemRanges.byteCount();
+        texture->tmemArenaOffset = tmemArena.size();
+        tmemArena.insert(tmemArena.end(), bytesTMEM, bytesTMEM + tmemByteCount);
+
         // Check for free spaces on the LIFO queue first.
         uint32_t textureIndex;
         if (!freeSpaces.empty()) {
@@ -250,6 +274,7 @@ namespace RT64 {
         versions[textureIndex]++;
         creationFrames[textureIndex] = creationFrame;
         globalVersion++;
+        logChange(textureIndex);
 
         accessList.push_front({ textureIndex, creationFrame });
         listIterators[textureIndex] = accessList.begin();
@@ -282,6 +307,7 @@ namespace RT64 {
         cachedTextureReplacementDimensions[it->second] = interop::float3(float(texture->width), float(texture->height), float(texture->mipmaps));
         versions[it->second]++;
         globalVersion++;
+        logChange(it->second);
 
         if (referenceCounted) {
             // Increment reference counter for this replacement so it doesn't get unloaded from the cache.
@@ -326,7 +352,7 @@ namespace RT64 {
         return true;
     }
 
-    bool TextureMap::evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes) {
+    bool TextureMap::evict(uint64_t submissionFrame, uint32_t queueDepth, std::vector<uint64_t> &evictedHashes) {
         evictedHashes.clear();
 
         auto it = accessList.rbegin();
@@ -335,8 +361,8 @@ namespace RT64 {
             
             // The max age allowed is the difference between the last time the texture was used and the time it was uploaded.
             // Ensure the textures live long enough for the frame queue to use them.
-            const uint64_t MinimumMaxAge = WORKLOAD_QUEUE_SIZE * 2;
-            const uint64_t MaximumMaxAge = WORKLOAD_QUEUE_SIZE * 32;
+            const uint64_t MinimumMaxAge = queueDepth * 2;
+            const uint64_t MaximumMaxAge = queueDepth * 32;
             const uint64_t age = submissionFrame - it->second;
             const uint64_t maxAge = std::clamp(it->second - creationFrames[it->first], MinimumMaxAge, MaximumMaxAge);
 
@@ -344,6 +370,7 @@ namespace RT64 {
             if (age >= maxAge) {
                 const uint32_t textureIndex = it->first;
                 const uint64_t textureHash = hashes[textureIndex];
+                tmemArenaFreedBytes += textures[textureIndex]->tmemRanges.byteCount();
                 evictedTextures.emplace_back(textures[textureIndex]);
                 textures[textureIndex] = nullptr;
                 textureScales[textureIndex] = { 1.0f, 1.0f };
@@ -363,6 +390,7 @@ namespace RT64 {
                 textureReplacements[textureIndex] = nullptr;
                 textureReplacementShiftedByHalf[textureIndex] = false;
                 textureReplacementReferenceCounted[textureIndex] = false;
+                logChange(textureIndex);
             }
             // Stop iterating if we reach an entry that has been used in the present.
             else if (age == 0) {
@@ -373,9 +401,48 @@ namespace RT64 {
             }
         }
 
+        if ((tmemArena.size() >= TMEMArenaCompactMinSize) && ((tmemArenaFreedBytes * 2) >= tmemArena.size())) {
+            compactTMEMArena();
+        }
+
         return !evictedHashes.empty();
     }
 
+    void TextureMap::compactTMEMArena() {
+        tmemArenaScratch.clear();
+        for (Texture *texture : textures) {
+            if (texture != nullptr) {
+                const uint8_t *bytesTMEM = getBytesTMEM(texture);
+                texture->tmemArenaOffset = tmemArenaScratch.size();
+                tmemArenaScratch.insert(tmemArenaScratch.end(), bytesTMEM, bytesTMEM + texture->tmemRanges.byteCount());
+            }
+        }
+
+        tmemArena.swap(tmemArenaScratch);
+        tmemArenaScratch.clear();
+        tmemArenaFreedBytes = 0;
+    }
+
+    const uint8_t *TextureMap::getBytesTMEM(const Texture *texture) const {
+        assert((texture->tmemArenaOffset + texture->tmemRanges.byteCount()) <= tmemArena.size());
+        return tmemArena.data() + texture->tmemArenaOffset;
+    }
+
+    void TextureMap::logChange(uint32_t textureIndex) {
+        // Readers that were behind the dropped entries must copy the entire map again.
+        if (changeLog.size() >= ChangeLogMaxSize) {
+            const size_t droppedCount = changeLog.size() / 2;
+            changeLog.erase(changeLog.begin(), changeLog.begin() + droppedCount);
+            changeLogStart += droppedCount;
+        }
+
+        changeLog.push_back(textureIndex);
+    }
+
+    uint64_t TextureMap::getChangeLogEnd() const {
+        return changeLogStart + changeLog.size();
+    }
+
     Texture *TextureMap::get(uint32_t index) const {
         assert(index < textures.size());
         return textures[index];
@@ -385,84 +452,269 @@ namespace RT64 {
         return textures.size();
     }
 
-    // TextureCache::StreamThread
+    // TextureCache::StreamQueue
+
+    bool TextureCache::StreamQueue::Priority::operator<(const Priority &other) const {
+        if (fromPreload != other.fromPreload) {
+            return !fromPreload;
+        }
+        else if (requestFrame != other.requestFrame) {
+            return requestFrame > other.requestFrame;
+        }
+        else if (estimatedSize != other.estimatedSize) {
+            return estimatedSize < other.estimatedSize;
+        }
+        else {
+            // Serve the newest request first when everything else is equal.
+            return sequence > other.sequence;
+        }
+    }
+
+    void TextureCache::StreamQueue::push(const StreamDescription &streamDesc) {
+        if (update(streamDesc)) {
+            return;
+        }
+
+        if (fileSystemPriorities.size() <= streamDesc.fileSystemIndex) {
+            fileSystemPriorities.resize(streamDesc.fileSystemIndex + 1);
+        }
+
+        Priority priority;
+        priority.fromPreload = streamDesc.fromPreload;
+        priority.requestFrame = streamDesc.requestFrame;
+        priority.estimatedSize = streamDesc.estimatedSize;
+        priority.sequence = sequenceCounter++;
+        entries[priority] = { streamDesc, Timer::current() };
+        fileSystemPriorities[streamDesc.fileSystemIndex][streamDesc.relativePath] = priority;
+
+        if (streamDesc.textureHash != 0) {
+            hashPriorities[streamDesc.textureHash] = priority;
+        }
+    }
+
+    bool TextureCache::StreamQueue::update(const StreamDescription &streamDesc) {
+        if (fileSystemPriorities.size() <= streamDesc.fileSystemIndex) {
+            return false;
+        }
+
+        auto &priorities = fileSystemPriorities[streamDesc.fileSystemIndex];
+        auto priorityIt = priorities.find(streamDesc.relativePath);
+        if (priorityIt == priorities.end()) {
+            return false;
+        }
+
+        // Only raise the priority of the request. It keeps the original timestamp so the wait time reflects the first request.
+        auto entryIt = entries.find(priorityIt->second);
+        assert(entryIt != entries.end());
+        Priority priority = entryIt->first;
+        Entry entry = entryIt->second;
+        priority.fromPreload = priority.fromPreload && streamDesc.fromPreload;
+        priority.requestFrame = std::max(priority.requestFrame, streamDesc.requestFrame);
+        priority.sequence = sequenceCounter++;
+        entry.streamDesc.fromPreload = priority.fromPreload;
+        entry.streamDesc.requestFrame = priority.requestFrame;
+        if (streamDesc.textureHash != 0) {
+            entry.streamDesc.textureHash = streamDesc.textureHash;
+        }
+
+        erase(entryIt);
+        entries[priority] = entry;
+        fileSystemPriorities[streamDesc.fileSystemIndex][streamDesc.relativePath] = priority;
+
+        if (entry.streamDesc.textureHash != 0) {
+            hashPriorities[entry.streamDesc.textureHash] = priority;
+        }
+
+        return true;
+    }
+
+    bool TextureCache::StreamQueue::pop(StreamDescription &streamDesc, Timestamp &queueTimestamp) {
+        if (entries.empty()) {
+            return false;
+        }
+
+        auto it = entries.begin();
+        streamDesc = it->second.streamDesc;
+        queueTimestamp = it->second.queueTimestamp;
+        erase(it);
+        return true;
+    }
+
+    void TextureCache::StreamQueue::cancel(uint64_t textureHash, std::vector<StreamDescription> &canceledDescs) {
+        auto hashIt = hashPriorities.find(textureHash);
+        if (hashIt == hashPriorities.end()) {
+            return;
+        }
+
+        // Preloaded textures are never canceled, as they're meant to stay in memory regardless of their usage.
+        auto entryIt = entries.find(hashIt->second);
+        assert(entryIt != entries.end());
+        if (entryIt->second.streamDesc.fromPreload) {
+            return;
+        }
+
+        canceledDescs.emplace_back(entryIt->second.streamDesc);
+        erase(entryIt);
+    }
+
+    void TextureCache::StreamQueue::erase(std::map<Priority, Entry>::iterator it) {
+        const StreamDescription &streamDesc = it->second.streamDesc;
+        fileSystemPriorities[streamDesc.fileSystemIndex].erase(streamDesc.relativePath);
+
+        // The hash might've been assigned to a different request since.
+        auto hashIt = hashPriorities.find(streamDesc.textureHash);
+        if ((hashIt != hashPriorities.end()) && (hashIt->second.sequence == it->first.sequence)) {
+            hashPriorities.erase(hashIt);
+        }
+
+        entries.erase(it);
+    }
+
+    void TextureCache::StreamQueue::clear() {
+        entries.clear();
+        fileSystemPriorities.clear();
+        hashPriorities.clear();
+    }
+
+    bool TextureCache::StreamQueue::empty() const {
+        return entries.empty();
+    }
 
-    TextureCache::StreamThread::StreamThread(TextureCache *textureCache) {
+    size_t TextureCache::StreamQueue::size() const {
+        return entries.size();
+    }
+
+    // TextureCache::UploadBatch
+
+    uint64_t TextureCache::UploadBatch::allocate(uint64_t size) {
+        const uint64_t offset = nextPlacementAlignedOffset(bufferCursor);
+        assert(((offset + size) <= bufferSize) && "The upload batch is too small for this allocation.");
+        bufferCursor = offset + size;
+        return offset;
+    }
+
+    // TextureCache::StreamContext
+
+    TextureCache::StreamContext::StreamContext(TextureCache *textureCache) {
         assert(textureCache != nullptr);
 
         this->textureCache = textureCache;
 
         worker = std::make_unique<RenderWorker>(textureCache->directWorker->device, "RT64 Stream Worker", RenderCommandListType::COPY);
-        thread = std::make_unique<std::thread>(&StreamThread::loop, this);
-        threadRunning = false;
     }
 
-    TextureCache::StreamThread::~StreamThread() {
-        threadRunning = false;
-        textureCache->streamDescStackChanged.notify_all();
-        thread->join();
-        thread.reset(nullptr);
+    TextureCache::StreamContext::~StreamContext() {
+        std::unique_lock poolLock(textureCache->uploadResourcePoolMutex);
+        uploadResource.reset();
     }
 
-    void TextureCache::StreamThread::loop() {
-        Thread::setCurrentThreadName("RT64 Stream");
+    bool TextureCache::StreamContext::popStreamDescription(StreamDescription &streamDesc) {
+        Timestamp queueTimestamp;
+        {
+            std::unique_lock queueLock(textureCache->streamDescQueueMutex);
+            if (!textureCache->streamDescQueue.pop(streamDesc, queueTimestamp)) {
+                return false;
+            }
+        }
 
-        // Texture streaming threads should have a priority somewhere inbetween the main threads and the shader compilation threads.
-        Thread::setCurrentThreadPriority(Thread::Priority::Low);
+        textureCache->addStreamWaitTime(Timer::deltaMicroseconds(queueTimestamp, Timer::current()));
+        return true;
+    }
 
-        threadRunning = true;
+    void TextureCache::StreamContext::loadBatch(uint32_t batchCount, uint64_t batchUploadSize) {
+        // Grow the staging buffer shared by all the textures in the batch if it's not big enough.
+        if (uploadResourceSize < batchUploadSize) {
+            std::unique_lock poolLock(textureCache->uploadResourcePoolMutex);
+            uploadResource.reset();
+            uploadResource = textureCache->uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(batchUploadSize));
+            uploadResourceSize = batchUploadSize;
+        }
+
+        UploadBatch uploadBatch;
+        uploadBatch.buffer = uploadResource.get();
+        uploadBatch.bufferData = reinterpret_cast<uint8_t *>(uploadResource->map());
+        uploadBatch.bufferSize = uploadResourceSize;
+
+        batchResults.clear();
+        worker->commandList->begin();
+        for (uint32_t i = 0; i < batchCount; i++) {
+            const BatchEntry &entry = batchEntries[i];
+            Texture *texture = TextureCache::loadTextureFromBytes(worker->device, worker->commandList.get(), entry.fileData, entry.fileDataByteCount, uploadResource, nullptr, nullptr, &uploadBatch);
+            if (texture != nullptr) {
+                batchResults.emplace_back(texture, entry.streamDesc.fileSystemIndex, entry.streamDesc.relativePath, entry.streamDesc.fromPreload);
+            }
+        }
 
-        std::vector<uint8_t> replacementBytes;
-        while (threadRunning) {
-            StreamDescription streamDesc;
+        worker->commandList->end();
+        uploadResource->unmap();
 
-            // Check the top of the queue or wait if it's empty.
-            {
-                std::unique_lock queueLock(textureCache->streamDescStackMutex);
-                textureCache->streamDescStackActiveCount--;
-                textureCache->streamDescStackChanged.wait(queueLock, [this]() {
-                    return !threadRunning || !textureCache->streamDescStack.empty();
-                });
+        // Only execute the command list and wait if at least one texture was loaded successfully.
+        if (!batchResults.empty()) {
+            worker->execute();
+            worker->wait();
+            textureCache->uploadQueueMutex.lock();
+            textureCache->streamResultQueue.insert(textureCache->streamResultQueue.end(), batchResults.begin(), batchResults.end());
+            textureCache->uploadQueueMutex.unlock();
+            textureCache->uploadQueueChanged.notify_all();
+        }
 
-                textureCache->streamDescStackActiveCount++;
+        // Release the staging buffer if a texture bigger than the budget forced it to grow past it.
+        if (uploadResourceSize > textureCache->streamBatchMaxBytes) {
+            std::unique_lock poolLock(textureCache->uploadResourcePoolMutex);
+            uploadResource.reset();
+            uploadResourceSize = 0;
+        }
+    }
 
-                if (!textureCache->streamDescStack.empty()) {
-                    streamDesc = textureCache->streamDescStack.top();
-                    textureCache->streamDescStack.pop();
-                }
+    void TextureCache::StreamContext::streamBatch() {
+        const uint32_t batchMaxCount = std::max(textureCache->streamBatchMaxCount.load(), 1U);
+        const uint64_t batchMaxBytes = textureCache->streamBatchMaxBytes;
+        uint32_t batchCount = 0;
+        uint64_t batchUploadSize = 0;
+        StreamDescription streamDesc;
+
+        // Gather as many descriptions as the batch limits allow.
+        while ((batchCount < batchMaxCount) && (batchUploadSize < batchMaxBytes) && popStreamDescription(streamDesc)) {
+            if (streamDesc.relativePath.empty()) {
+                continue;
             }
-            
-            if (!streamDesc.relativePath.empty()) {
-                ElapsedTimer elapsedTimer;
-                bool fileLoaded = textureCache->textureMap.replacementMap.fileSystems[streamDesc.fileSystemIndex]->load(streamDesc.relativePath, replacementBytes);
-                textureCache->addStreamLoadTime(elapsedTimer.elapsedMicroseconds());
-
-                if (fileLoaded) {
-                    worker->commandList->begin();
-                    Texture *texture = TextureCache::loadTextureFromBytes(worker->device, worker->commandList.get(), replacementBytes, uploadResource);
-                    worker->commandList->end();
-
-                    // Only execute the command list and wait if the texture was loaded successfully.
-                    if (texture != nullptr) {
-                        worker->execute();
-                        worker->wait();
-                        textureCache->uploadQueueMutex.lock();
-                        textureCache->streamResultQueue.emplace_back(texture, streamDesc.fileSystemIndex, streamDesc.relativePath, streamDesc.fromPreload);
-                        textureCache->uploadQueueMutex.unlock();
-                        textureCache->uploadQueueChanged.notify_all();
-                    }
-                }
+
+            if (batchEntries.size() <= batchCount) {
+                batchEntries.resize(batchCount + 1);
+            }
+
+            BatchEntry &batchEntry = batchEntries[batchCount];
+            ElapsedTimer elapsedTimer;
+            bool fileLoaded = textureCache->textureMap.replacementMap.fileSystems[streamDesc.fileSystemIndex]->viewOrLoad(streamDesc.relativePath, batchEntry.replacementBytes, batchEntry.fileData, batchEntry.fileDataByteCount);
+            textureCache->addStreamLoadTime(elapsedTimer.elapsedMicroseconds());
+            if (!fileLoaded) {
+                continue;
+            }
+
+            batchEntry.uploadSize = TextureCache::computeUploadSize(batchEntry.fileData, batchEntry.fileDataByteCount);
+            if (batchEntry.uploadSize == 0) {
+                continue;
             }
+
+            batchEntry.streamDesc = streamDesc;
+            batchUploadSize = nextPlacementAlignedOffset(batchUploadSize) + batchEntry.uploadSize;
+            batchCount++;
+        }
+
+        if (batchCount > 0) {
+            loadBatch(batchCount, batchUploadSize);
         }
     }
 
     // TextureCache
 
-    TextureCache::TextureCache(RenderWorker *directWorker, RenderWorker *copyWorker, uint32_t threadCount, const ShaderLibrary *shaderLibrary) {
+    TextureCache::TextureCache(RenderWorker *directWorker, RenderWorker *copyWorker, TaskScheduler *taskScheduler, const ShaderLibrary *shaderLibrary) {
         assert(directWorker != nullptr);
+        assert(taskScheduler != nullptr);
 
         this->directWorker = directWorker;
         this->copyWorker = copyWorker;
+        this->taskScheduler = taskScheduler;
         this->shaderLibrary = shaderLibrary;
 
         lockCounter = 0;
@@ -483,18 +735,12 @@ namespace RT64 {
 
         // Create upload thread.
         uploadThread = std::make_unique<std::thread>(&TextureCache::uploadThreadLoop, this);
-
-        // Create streaming threads.
-        streamDescStackActiveCount = threadCount;
-
-        for (uint32_t i = 0; i < threadCount; i++) {
-            streamThreads.push_back(std::make_unique<StreamThread>(this));
-        }
     }
 
     TextureCache::~TextureCache() {
-        waitForAllStreamThreads(true);
-        streamThreads.clear();
+        waitForAllStreamTasks(true);
+        freeStreamContexts.clear();
+        streamContexts.clear();
 
         if (uploadThread != nullptr) {
             uploadThreadRunning = false;
@@ -504,7 +750,7 @@ namespace RT64 {
         }
         
         descriptorSets.clear();
-        tmemUploadResources.clear();
+        tmemUploadResource.reset();
         replacementUploadResources.clear();
         uploadResourcePool.reset(nullptr);
     }
@@ -531,7 +777,7 @@ namespace RT64 {
         }
     }
     
-    void TextureCache::setRGBA32(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, uint32_t width, uint32_t height, uint32_t rowPitch, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool, std::mutex *uploadResourcePoolMutex) {
+    void TextureCache::setRGBA32(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, uint32_t width, uint32_t height, uint32_t rowPitch, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool, std::mutex *uploadResourcePoolMutex, UploadBatch *uploadBatch) {
         assert(dstTexture != nullptr);
         assert(device != nullptr);
         assert(commandList != nullptr);
@@ -546,25 +792,40 @@ namespace RT64 {
         dstTexture->texture = device->createTexture(RenderTextureDesc::Texture2D(width, height, 1, dstTexture->format));
 
         uint32_t alignedRowPitch = nextSizeAlignedTo(rowPitch, TextureDataPitchAlignment);
-        if (uploadResourcePool != nullptr) {
-            assert(uploadResourcePoolMutex != nullptr);
-            std::unique_lock queueLock(*uploadResourcePoolMutex);
-            dstUploadResource = uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(alignedRowPitch * height));
+        RenderBuffer *uploadBuffer = nullptr;
+        uint64_t uploadOffset = 0;
+        uint8_t *dstData = nullptr;
+        if (uploadBatch != nullptr) {
+            uploadOffset = uploadBatch->allocate(alignedRowPitch * height);
+            uploadBuffer = uploadBatch->buffer;
+            dstData = &uploadBatch->bufferData[uploadOffset];
         }
         else {
-            dstUploadResource = device->createBuffer(RenderBufferDesc::UploadBuffer(alignedRowPitch * height));
+            if (uploadResourcePool != nullptr) {
+                assert(uploadResourcePoolMutex != nullptr);
+                std::unique_lock queueLock(*uploadResourcePoolMutex);
+                dstUploadResource = uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(alignedRowPitch * height));
+            }
+            else {
+                dstUploadResource = device->createBuffer(RenderBufferDesc::UploadBuffer(alignedRowPitch * height));
+            }
+
+            uploadBuffer = dstUploadResource.get();
+            dstData = reinterpret_cast<uint8_t *>(dstUploadResource->map());
         }
 
         dstTexture->memorySize = alignedRowPitch * height;
 
-        uint8_t *dstData = reinterpret_cast<uint8_t *>(dstUploadResource->map());
         const uint8_t *srcData = reinterpret_cast<const uint8_t *>(bytes);
         memcpyRows(dstData, alignedRowPitch, srcData, rowPitch, height);
-        dstUploadResource->unmap();
+
+        if (uploadBatch == nullptr) {
+            dstUploadResource->unmap();
+        }
 
         uint32_t alignedRowWidth = alignedRowPitch / RenderFormatSize(dstTexture->format);
         commandList->barriers(RenderBarrierStage::COPY, RenderTextureBarrier(dstTexture->texture.get(), RenderTextureLayout::COPY_DEST));
-        commandList->copyTextureRegion(RenderTextureCopyLocation::Subresource(dstTexture->texture.get()), RenderTextureCopyLocation::PlacedFootprint(dstUploadResource.get(), dstTexture->format, width, height, 1, alignedRowWidth));
+        commandList->copyTextureRegion(RenderTextureCopyLocation::Subresource(dstTexture->texture.get()), RenderTextureCopyLocation::PlacedFootprint(uploadBuffer, dstTexture->format, width, height, 1, alignedRowWidth, uploadOffset));
     }
 
     static RenderTextureDimension toRenderDimension(ddspp::TextureType type) {
@@ -735,7 +996,29 @@ namespace RT64 {
         }
     }
 
-    bool TextureCache::setDDS(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool, std::mutex *uploadResourcePoolMutex) {
+    static uint32_t computeDDSMipmapOffsets(const ddspp::Descriptor &ddsDescriptor, std::vector<uint32_t> &mipmapOffsets) {
+        uint32_t blockWidth, blockHeight;
+        ddspp::get_block_size(ddsDescriptor.format, blockWidth, blockHeight);
+
+        // Compute the additional padding that will be required on the buffer to align the mipmap data.
+        const uint32_t height = nextSizeAlignedTo(ddsDescriptor.height, blockHeight);
+        uint32_t totalSize = 0;
+        mipmapOffsets.clear();
+        for (uint32_t mip = 0; mip < ddsDescriptor.numMips; mip++) {
+            totalSize = nextSizeAlignedTo(totalSize, TextureDataPlacementAlignment);
+            mipmapOffsets.emplace_back(totalSize);
+
+            uint32_t mipHeight = std::max(height >> mip, 1U);
+            uint32_t ddsRowPitch = ddspp::get_row_pitch(ddsDescriptor, mip);
+            uint32_t alignedRowPitch = nextSizeAlignedTo(ddsRowPitch, TextureDataPitchAlignment);
+            uint32_t rowCount = (mipHeight + blockWidth - 1) / blockWidth;
+            totalSize += alignedRowPitch * rowCount;
+        }
+
+        return totalSize;
+    }
+
+    bool TextureCache::setDDS(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool, std::mutex *uploadResourcePoolMutex, UploadBatch *uploadBatch) {
         assert(dstTexture != nullptr);
         assert(device != nullptr);
         assert(commandList != nullptr);
@@ -768,34 +1051,34 @@ namespace RT64 {
         const uint8_t *imageData = &bytes[ddsDescriptor.headerSize];
         size_t imageDataSize = byteCount - ddsDescriptor.headerSize;
 
-        // Compute the additional padding that will be required on the buffer to align the mipmap data.
         std::vector<uint32_t> mipmapOffsets;
         const uint32_t formatSize = RenderFormatSize(desc.format);
-        uint32_t totalSize = 0;
-        for (uint32_t mip = 0; mip < desc.mipLevels; mip++) {
-            totalSize = nextSizeAlignedTo(totalSize, TextureDataPlacementAlignment);
-            mipmapOffsets.emplace_back(totalSize);
-
-            uint32_t mipHeight = std::max(desc.height >> mip, 1U);
-            uint32_t ddsRowPitch = ddspp::get_row_pitch(ddsDescriptor, mip);
-            uint32_t alignedRowPitch = nextSizeAlignedTo(ddsRowPitch, TextureDataPitchAlignment);
-            uint32_t rowCount = (mipHeight + blockWidth - 1) / blockWidth;
-            totalSize += alignedRowPitch * rowCount;
-        }
-
-        if (uploadResourcePool != nullptr) {
-            assert(uploadResourcePoolMutex != nullptr);
-            std::unique_lock queueLock(*uploadResourcePoolMutex);
-            dstUploadResource = uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(totalSize));
+        const uint32_t totalSize = computeDDSMipmapOffsets(ddsDescriptor, mipmapOffsets);
+        RenderBuffer *uploadBuffer = nullptr;
+        uint64_t uploadOffset = 0;
+        uint8_t *dstData = nullptr;
+        if (uploadBatch != nullptr) {
+            uploadOffset = uploadBatch->allocate(totalSize);
+            uploadBuffer = uploadBatch->buffer;
+            dstData = &uploadBatch->bufferData[uploadOffset];
         }
         else {
-            dstUploadResource = device->createBuffer(RenderBufferDesc::UploadBuffer(totalSize));
+            if (uploadResourcePool != nullptr) {
+                assert(uploadResourcePoolMutex != nullptr);
+                std::unique_lock queueLock(*uploadResourcePoolMutex);
+                dstUploadResource = uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(totalSize));
+            }
+            else {
+                dstUploadResource = device->createBuffer(RenderBufferDesc::UploadBuffer(totalSize));
+            }
+
+            uploadBuffer = dstUploadResource.get();
+            dstData = reinterpret_cast<uint8_t *>(dstUploadResource->map());
         }
 
         dstTexture->memorySize = totalSize;
 
         // Copy each mipmap into the buffer with the correct padding applied.
-        uint8_t *dstData = reinterpret_cast<uint8_t *>(dstUploadResource->map());
         memset(dstData, 0, totalSize);
         for (uint32_t mip = 0; mip < desc.mipLevels; mip++) {
             uint32_t mipOffset = mipmapOffsets[mip];
@@ -807,7 +1090,9 @@ namespace RT64 {
             memcpyRows(&dstData[mipOffset], alignedRowPitch, &imageData[ddsOffset], ddsRowPitch, rowCount);
         }
 
-        dstUploadResource->unmap();
+        if (uploadBatch == nullptr) {
+            dstUploadResource->unmap();
+        }
 
         commandList->barriers(RenderBarrierStage::COPY, RenderTextureBarrier(dstTexture->texture.get(), RenderTextureLayout::COPY_DEST));
 
@@ -817,7 +1102,7 @@ namespace RT64 {
             uint32_t mipHeight = std::max(desc.height >> mip, 1U);
             uint32_t ddsRowPitch = ddspp::get_row_pitch(ddsDescriptor, mip);
             uint32_t alignedRowWidth = ((nextSizeAlignedTo(ddsRowPitch, TextureDataPitchAlignment) + formatSize - 1) / formatSize) * blockWidth;
-            commandList->copyTextureRegion(RenderTextureCopyLocation::Subresource(dstTexture->texture.get(), mip), RenderTextureCopyLocation::PlacedFootprint(dstUploadResource.get(), desc.format, mipWidth, mipHeight, 1, alignedRowWidth, offset));
+            commandList->copyTextureRegion(RenderTextureCopyLocation::Subresource(dstTexture->texture.get(), mip), RenderTextureCopyLocation::PlacedFootprint(uploadBuffer, desc.format, mipWidth, mipHeight, 1, alignedRowWidth, uploadOffset + offset));
         }
 
         return true;
@@ -929,22 +1214,33 @@ namespace RT64 {
         return true;
     }
 
-    Texture *TextureCache::loadTextureFromBytes(RenderDevice *device, RenderCommandList *commandList, const std::vector<uint8_t> &fileBytes, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *resourcePool, std::mutex *uploadResourcePoolMutex) {
-        const uint32_t PNG_MAGIC = 0x474E5089;
+    static const uint32_t PNG_MAGIC = 0x474E5089;
+
+    static uint32_t readMagicNumber(const uint8_t *fileBytes, size_t fileByteCount) {
+        // The bytes can be a view of a mapped file, so they're not guaranteed to be aligned.
+        uint32_t magicNumber = 0;
+        if (fileByteCount >= sizeof(uint32_t)) {
+            memcpy(&magicNumber, fileBytes, sizeof(uint32_t));
+        }
+
+        return magicNumber;
+    }
+
+    Texture *TextureCache::loadTextureFromBytes(RenderDevice *device, RenderCommandList *commandList, const uint8_t *fileBytes, size_t fileByteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *resourcePool, std::mutex *uploadResourcePoolMutex, UploadBatch *uploadBatch) {
         Texture *replacementTexture = new Texture();
-        uint32_t magicNumber = *reinterpret_cast<const uint32_t *>(fileBytes.data());
+        uint32_t magicNumber = readMagicNumber(fileBytes, fileByteCount);
         bool loadedTexture = false;
         switch (magicNumber) {
         case ddspp::DDS_MAGIC:
-            loadedTexture = TextureCache::setDDS(replacementTexture, device, commandList, fileBytes.data(), fileBytes.size(), dstUploadResource, resourcePool, uploadResourcePoolMutex);
+            loadedTexture = TextureCache::setDDS(replacementTexture, device, commandList, fileBytes, fileByteCount, dstUploadResource, resourcePool, uploadResourcePoolMutex, uploadBatch);
             break;
         case PNG_MAGIC: {
             int width, height;
-            stbi_uc *data = stbi_load_from_memory(fileBytes.data(), fileBytes.size(), &width, &height, nullptr, 4);
+            stbi_uc *data = stbi_load_from_memory(fileBytes, int(fileByteCount), &width, &height, nullptr, 4);
             if (data != nullptr) {
                 uint32_t rowPitch = uint32_t(width) * 4;
                 size_t byteCount = uint32_t(height) * rowPitch;
-                TextureCache::setRGBA32(replacementTexture, device, commandList, data, byteCount, uint32_t(width), uint32_t(height), rowPitch, dstUploadResource, resourcePool);
+                TextureCache::setRGBA32(replacementTexture, device, commandList, data, byteCount, uint32_t(width), uint32_t(height), rowPitch, dstUploadResource, resourcePool, uploadResourcePoolMutex, uploadBatch);
                 stbi_image_free(data);
                 loadedTexture = true;
             }
@@ -965,25 +1261,58 @@ namespace RT64 {
         }
     }
 
+    uint64_t TextureCache::computeUploadSize(const uint8_t *fileBytes, size_t fileByteCount) {
+        uint32_t magicNumber = readMagicNumber(fileBytes, fileByteCount);
+        switch (magicNumber) {
+        case ddspp::DDS_MAGIC: {
+            ddspp::Descriptor ddsDescriptor;
+            ddspp::Result result = ddspp::decode_header((unsigned char *)(fileBytes), ddsDescriptor);
+            if (result != ddspp::Success) {
+                return 0;
+            }
+
+            std::vector<uint32_t> mipmapOffsets;
+            return computeDDSMipmapOffsets(ddsDescriptor, mipmapOffsets);
+        }
+        case PNG_MAGIC: {
+            int width, height, channels;
+            if (stbi_info_from_memory(fileBytes, int(fileByteCount), &width, &height, &channels) == 0) {
+                return 0;
+            }
+
+            return uint64_t(nextSizeAlignedTo(uint32_t(width) * 4, TextureDataPitchAlignment)) * uint64_t(height);
+        }
+        default:
+            // Unknown format.
+            return 0;
+        }
+    }
+
     void TextureCache::uploadThreadLoop() {
         Thread::setCurrentThreadName("RT64 Texture");
 
         uploadThreadRunning = true;
 
         std::vector<TextureUpload> queueCopy;
-        std::vector<TextureUpload> newQueue;
+        std::vector<uint8_t> uploadArenaCopy;
+        std::vector<uint64_t> tmemUploadOffsets;
         std::vector<ReplacementResolvedPath> resolvedPathQueueCopy;
         std::vector<StreamResult> streamResultQueueCopy;
+        std::vector<StreamDescription> streamCancelQueueCopy;
         std::vector<TextureMapAddition> textureMapAdditions;
         std::vector<ReplacementMapAddition> replacementMapAdditions;
         std::vector<RenderTextureBarrier> beforeCopyBarriers;
         std::vector<RenderTextureBarrier> beforeDecodeBarriers;
         std::vector<RenderTextureBarrier> afterDecodeBarriers;
         std::vector<uint8_t> replacementBytes;
+        const uint8_t *replacementData = nullptr;
+        size_t replacementDataByteCount = 0;
+        uint64_t streamRequestFrame = 0;
 
         while (uploadThreadRunning) {
             resolvedPathQueueCopy.clear();
             streamResultQueueCopy.clear();
+            streamCancelQueueCopy.clear();
             beforeCopyBarriers.clear();
             beforeDecodeBarriers.clear();
             afterDecodeBarriers.clear();
@@ -992,11 +1321,14 @@ namespace RT64 {
             {
                 std::unique_lock queueLock(uploadQueueMutex);
                 uploadQueueChanged.wait(queueLock, [this]() {
-                    return !uploadThreadRunning || !uploadQueue.empty() || !resolvedPathQueue.empty() || !streamResultQueue.empty();
+                    return !uploadThreadRunning || !uploadQueue.empty() || !resolvedPathQueue.empty() || !streamResultQueue.empty() || !streamCancelQueue.empty();
                 });
 
+                // Take the entire queue along with the arena that holds its TMEM bytes. The previous arena is handed back empty so its memory can be reused.
                 if (!uploadQueue.empty()) {
-                    queueCopy = uploadQueue;
+                    queueCopy.swap(uploadQueue);
+                    uploadArenaCopy.swap(uploadArena);
+                    uploadQueueActiveCount = queueCopy.size();
                 }
 
                 if (!resolvedPathQueue.empty()) {
@@ -1008,6 +1340,20 @@ namespace RT64 {
                     streamResultQueueCopy.insert(streamResultQueueCopy.end(), streamResultQueue.begin(), streamResultQueue.end());
                     streamResultQueue.clear();
                 }
+
+                if (!streamCancelQueue.empty()) {
+                    streamCancelQueueCopy.insert(streamCancelQueueCopy.end(), streamCancelQueue.begin(), streamCancelQueue.end());
+                    streamCancelQueue.clear();
+                }
+            }
+
+            // The most recent frame a texture was uploaded on is used to rank the streaming requests.
+            for (const TextureUpload &upload : queueCopy) {
+                streamRequestFrame = std::max(streamRequestFrame, upload.creationFrame);
+            }
+
+            if (!streamCancelQueueCopy.empty()) {
+                cancelStreamDescriptions(streamCancelQueueCopy, streamRequestFrame);
             }
             
             if (!streamResultQueueCopy.empty()) {
@@ -1043,13 +1389,27 @@ namespace RT64 {
                 // Create new upload buffers and descriptor heaps to fill out the required size.
                 const size_t queueSize = queueCopy.size();
                 const uint64_t TMEMSize = 0x1000;
-                {
-                    std::unique_lock queueLock(uploadResourcePoolMutex);
-                    for (size_t i = tmemUploadResources.size(); i < queueSize; i++) {
-                        tmemUploadResources.emplace_back(uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(TMEMSize)));
+
+                // All the TMEM ranges in the batch are placed in a single upload buffer.
+                uint64_t tmemUploadSize = 0;
+                tmemUploadOffsets.clear();
+                for (const TextureUpload &upload : queueCopy) {
+                    for (uint32_t r = 0; r < upload.tmemRanges.count; r++) {
+                        tmemUploadSize = nextPlacementAlignedOffset(tmemUploadSize);
+                        tmemUploadOffsets.emplace_back(tmemUploadSize);
+                        tmemUploadSize += nextSizeAlignedTo(upload.tmemRanges.ranges[r].byteCount, TextureDataPitchAlignment);
                     }
                 }
 
+                if (tmemUploadSize > tmemUploadResourceSize) {
+                    std::unique_lock queueLock(uploadResourcePoolMutex);
+                    tmemUploadResourceSize = std::max(tmemUploadSize, tmemUploadResourceSize * 2);
+                    tmemUploadResource = uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(tmemUploadResourceSize));
+                }
+
+                uint8_t *tmemUploadData = (tmemUploadSize > 0) ? reinterpret_cast<uint8_t *>(tmemUploadResource->map()) : nullptr;
+                uint32_t tmemUploadRangeIndex = 0;
+
                 for (size_t i = descriptorSets.size(); i < queueSize; i++) {
                     descriptorSets.emplace_back(std::make_unique<TextureDecodeDescriptorSet>(directWorker->device));
                 }
@@ -1070,32 +1430,42 @@ namespace RT64 {
                     newTexture->format = RenderFormat::R8_UINT;
                     newTexture->width = upload.width;
                     newTexture->height = upload.height;
-                    newTexture->tmem = copyWorker->device->createTexture(RenderTextureDesc::Texture1D(std::max(uint32_t(upload.bytesTMEM.size()), 1U), 1, newTexture->format));
+                    newTexture->tmem = copyWorker->device->createTexture(RenderTextureDesc::Texture1D((upload.tmemRanges.count > 0) ? uint32_t(TMEMSize) : 1U, 1, newTexture->format));
                     newTexture->tmem->setName("Texture Cache TMEM #" + std::to_string(TMEMGlobalCounter++));
-                    newTexture->bytesTMEM = upload.bytesTMEM;
                     newTexture->loadTile = upload.loadTile;
                     newTexture->tlut = upload.tlut;
                     newTexture->decodeTMEM = upload.decodeTMEM;
 
-                    if (!upload.bytesTMEM.empty()) {
-                        void *dstData = tmemUploadResources[i]->map();
-                        memcpy(dstData, upload.bytesTMEM.data(), upload.bytesTMEM.size());
-                        tmemUploadResources[i]->unmap();
+                    const uint8_t *uploadBytes = uploadArenaCopy.data() + upload.arenaOffset;
+                    newTexture->tmemRanges = upload.tmemRanges;
+
+                    for (uint32_t r = 0; r < upload.tmemRanges.count; r++) {
+                        const TMEMRange &range = upload.tmemRanges.ranges[r];
+                        memcpy(&tmemUploadData[tmemUploadOffsets[tmemUploadRangeIndex++]], uploadBytes, range.byteCount);
+                        uploadBytes += range.byteCount;
                     }
 
                     beforeCopyBarriers.emplace_back(newTexture->tmem.get(), RenderTextureLayout::COPY_DEST);
                 }
 
+                if (tmemUploadData != nullptr) {
+                    tmemUploadResource->unmap();
+                }
+
                 copyWorker->commandList->barriers(RenderBarrierStage::COPY, beforeCopyBarriers);
 
+                // Copy every range to the same address it had in TMEM, as that's where the shaders will read it from.
+                tmemUploadRangeIndex = 0;
                 for (size_t i = 0; i < queueSize; i++) {
                     const TextureUpload &upload = queueCopy[i];
-                    const uint32_t byteCount = uint32_t(upload.bytesTMEM.size());
                     Texture *dstTexture = textureMapAdditions[i].texture;
-                    if (byteCount > 0) {
+                    for (uint32_t r = 0; r < upload.tmemRanges.count; r++) {
+                        const TMEMRange &range = upload.tmemRanges.ranges[r];
+                        const uint32_t alignedRowWidth = nextSizeAlignedTo(range.byteCount, TextureDataPitchAlignment);
                         copyWorker->commandList->copyTextureRegion(
                             RenderTextureCopyLocation::Subresource(dstTexture->tmem.get()),
-                            RenderTextureCopyLocation::PlacedFootprint(tmemUploadResources[i].get(), RenderFormat::R8_UINT, byteCount, 1, 1, byteCount)
+                            RenderTextureCopyLocation::PlacedFootprint(tmemUploadResource.get(), RenderFormat::R8_UINT, range.byteCount, 1, 1, alignedRowWidth, tmemUploadOffsets[tmemUploadRangeIndex++]),
+                            range.address
                         );
                     }
 
@@ -1112,7 +1482,7 @@ namespace RT64 {
                         beforeDecodeBarriers.emplace_back(dstTexture->texture.get(), RenderTextureLayout::GENERAL);
                     }
 
-                    addResolvedPaths(upload.hash, upload.width, upload.height, upload.tlut, upload.loadTile, upload.bytesTMEM, upload.decodeTMEM, resolvedPathQueueCopy);
+                    addResolvedPaths(upload.hash, upload.width, upload.height, upload.tlut, upload.loadTile, uploadArenaCopy.data() + upload.arenaOffset, upload.tmemRanges, upload.decodeTMEM, resolvedPathQueueCopy);
                 }
 
                 replacementMapAdditions.clear();
@@ -1136,7 +1506,7 @@ namespace RT64 {
 
                     // Replacement texture hasn't been loaded yet.
                     if (replacementTexture == nullptr) {
-                        // Queue the texture for being loaded from a texture cache streaming thread.
+                        // Queue the texture for being loaded from a texture cache streaming task.
                         if (resolvedPath.resolvedOperation == ReplacementOperation::Stream) {
 #                           if !ONLY_USE_LOW_MIP_CACHE
                             // Make sure the replacement map hasn't queued or loaded the relative path already.
@@ -1145,10 +1515,13 @@ namespace RT64 {
                                 streamSet.insert(resolvedPath.relativePath);
 
                                 // Push to the streaming queue.
-                                streamDescStackMutex.lock();
-                                streamDescStack.push(StreamDescription(resolvedPath.fileSystemIndex, resolvedPath.relativePath, false));
-                                streamDescStackMutex.unlock();
-                                streamDescStackChanged.notify_all();
+                                const uint64_t estimatedSize = textureMap.replacementMap.fileSystems[resolvedPath.fileSystemIndex]->getSize(resolvedPath.relativePath);
+                                pushStreamDescription(StreamDescription(resolvedPath.fileSystemIndex, resolvedPath.relativePath, false, resolvedPath.textureHash, streamRequestFrame, estimatedSize));
+                            }
+                            else {
+                                // Raise the priority of the request if it's still waiting in the streaming queue.
+                                std::unique_lock queueLock(streamDescQueueMutex);
+                                streamDescQueue.update(StreamDescription(resolvedPath.fileSystemIndex, resolvedPath.relativePath, false, resolvedPath.textureHash, streamRequestFrame));
                             }
 #                           endif
 
@@ -1159,9 +1532,9 @@ namespace RT64 {
                             replacementTexture = lowMipCacheTexture;
                         }
                         // Load the texture directly on this thread (operation was defined as Stall).
-                        else if (textureMap.replacementMap.fileSystems[resolvedPath.fileSystemIndex]->load(resolvedPath.relativePath, replacementBytes)) {
+                        else if (textureMap.replacementMap.fileSystems[resolvedPath.fileSystemIndex]->viewOrLoad(resolvedPath.relativePath, replacementBytes, replacementData, replacementDataByteCount)) {
                             replacementUploadResources.emplace_back();
-                            replacementTexture = TextureCache::loadTextureFromBytes(copyWorker->device, copyWorker->commandList.get(), replacementBytes, replacementUploadResources.back());
+                            replacementTexture = TextureCache::loadTextureFromBytes(copyWorker->device, copyWorker->commandList.get(), replacementData, replacementDataByteCount, replacementUploadResources.back());
                             textureMapMutex.lock();
                             textureMap.replacementMap.addLoadedTexture(replacementTexture, resolvedPath.fileSystemIndex, resolvedPath.relativePath, true);
                             textureMapMutex.unlock();
@@ -1234,8 +1607,9 @@ namespace RT64 {
                 // Add all the textures to the map once they're ready.
                 {
                     std::unique_lock lock(textureMapMutex);
-                    for (const TextureMapAddition &addition : textureMapAdditions) {
-                        textureMap.add(addition.hash, addition.texture->creationFrame, addition.texture);
+                    for (size_t i = 0; i < textureMapAdditions.size(); i++) {
+                        const TextureMapAddition &addition = textureMapAdditions[i];
+                        textureMap.add(addition.hash, addition.texture->creationFrame, addition.texture, uploadArenaCopy.data() + queueCopy[i].arenaOffset);
                     }
 
                     for (const ReplacementMapAddition &addition : replacementMapAdditions) {
@@ -1245,14 +1619,15 @@ namespace RT64 {
                     textureMap.replacementMap.evict(textureMap.evictedTextures);
                 }
 
-                // Make the new queue the remaining subsection of the upload queue that wasn't processed in this batch.
+                // Clear the batch while keeping the memory of the arena so it can be handed back to the queue.
+                queueCopy.clear();
+                uploadArenaCopy.clear();
+
                 {
                     std::unique_lock queueLock(uploadQueueMutex);
-                    newQueue = std::vector<TextureUpload>(uploadQueue.begin() + queueSize, uploadQueue.end());
-                    uploadQueue = std::move(newQueue);
+                    uploadQueueActiveCount = 0;
                 }
 
-                queueCopy.clear();
                 uploadQueueFinished.notify_all();
             }
         }
@@ -1268,11 +1643,23 @@ namespace RT64 {
         newUpload.height = height;
         newUpload.tlut = tlut;
         newUpload.loadTile = loadTile;
-        newUpload.bytesTMEM = (bytes != nullptr) ? std::vector<uint8_t>(bytes, bytes + bytesCount) : std::vector<uint8_t>();
         newUpload.decodeTMEM = decodeTMEM;
 
+        // Decoded textures only need the bytes they can read. Raw TMEM textures can be sampled from any address, so they keep all of it.
+        if (bytes != nullptr) {
+            if (decodeTMEM) {
+                TMEMHasher::sampledRanges(loadTile, width, height, tlut, newUpload.tmemRanges);
+            }
+            else {
+                newUpload.tmemRanges.add(0, bytesCount);
+            }
+        }
+
         {
             std::unique_lock queueLock(uploadQueueMutex);
+            newUpload.arenaOffset = uploadArena.size();
+            uploadArena.resize(uploadArena.size() + newUpload.tmemRanges.byteCount());
+            newUpload.tmemRanges.gather(bytes, uploadArena.data() + newUpload.arenaOffset);
             uploadQueue.emplace_back(newUpload);
         }
 
@@ -1282,16 +1669,25 @@ namespace RT64 {
     void TextureCache::waitForGPUUploads() {
         std::unique_lock queueLock(uploadQueueMutex);
         uploadQueueFinished.wait(queueLock, [this]() {
-            return uploadQueue.empty();
+            return uploadQueue.empty() && (uploadQueueActiveCount == 0);
         });
     }
 
-    void TextureCache::addResolvedPaths(uint64_t hash, uint32_t width, uint32_t height, uint32_t tlut, const LoadTile &loadTile, const std::vector<uint8_t> &bytesTMEM, bool decodeTMEM, std::vector<ReplacementResolvedPath> &resolvedPaths, uint64_t exclusiveDbHash) {
+    void TextureCache::addResolvedPaths(uint64_t hash, uint32_t width, uint32_t height, uint32_t tlut, const LoadTile &loadTile, const uint8_t *bytesTMEM, const TMEMRangeList &tmemRanges, bool decodeTMEM, std::vector<ReplacementResolvedPath> &resolvedPaths, uint64_t exclusiveDbHash) {
         uint64_t hashes[TMEMHasher::CurrentHashVersion + 1] = {};
+        uint8_t restoredTMEM[0x1000];
+        bool restoredTMEMValid = false;
         for (uint32_t v : textureMap.replacementMap.resolvedHashVersions) {
             if (decodeTMEM && v < TMEMHasher::CurrentHashVersion) {
+                // The stored ranges cover every byte that any of the hash versions can read, so they only need to be restored to their addresses.
+                if (!restoredTMEMValid) {
+                    memset(restoredTMEM, 0, sizeof(restoredTMEM));
+                    tmemRanges.scatter(bytesTMEM, restoredTMEM);
+                    restoredTMEMValid = true;
+                }
+
                 // If the database uses an older hash version, we hash TMEM again with the version corresponding to the database.
-                hashes[v] = TMEMHasher::hash(bytesTMEM.data(), loadTile, width, height, tlut, v);
+                hashes[v] = TMEMHasher::hash(restoredTMEM, loadTile, width, height, tlut, v);
             }
             else {
                 hashes[v] = hash;
@@ -1327,7 +1723,7 @@ namespace RT64 {
     }
     
     bool TextureCache::addReplacement(uint64_t hash, const std::string &relativePath, ReplacementShift shift) {
-        waitForAllStreamThreads(false);
+        waitForAllStreamTasks(false);
         waitForGPUUploads();
 
         std::unique_lock lock(textureMapMutex);
@@ -1347,7 +1743,7 @@ namespace RT64 {
         if (newTexture == nullptr) {
             std::unique_ptr<RenderBuffer> dstUploadBuffer;
             loaderCommandList->begin();
-            newTexture = TextureCache::loadTextureFromBytes(copyWorker->device, loaderCommandList.get(), replacementBytes, dstUploadBuffer);
+            newTexture = TextureCache::loadTextureFromBytes(copyWorker->device, loaderCommandList.get(), replacementBytes.data(), replacementBytes.size(), dstUploadBuffer);
             loaderCommandList->end();
 
             if (newTexture != nullptr) {
@@ -1378,7 +1774,7 @@ namespace RT64 {
 
         uploadQueueMutex.lock();
 
-        // Queue the texture as if it was the result from a streaming thread.
+        // Queue the texture as if it was the result from a streaming task.
         if (loadedNewTexture) {
             streamResultQueue.emplace_back(newTexture, 0, relativePathForward, false);
             textureMap.replacementMap.fileSystemStreamResolvedPaths[0].emplace(relativePathForward, resolvedPath);
@@ -1407,8 +1803,8 @@ namespace RT64 {
     }
 
     void TextureCache::clearReplacementDirectories() {
-        // Wait for the streaming threads to be finished.
-        waitForAllStreamThreads(true);
+        // Wait for the streaming tasks to be finished.
+        waitForAllStreamTasks(true);
 
         // Reset the benchmark counters.
         resetStreamPerformanceCounters();
@@ -1423,7 +1819,7 @@ namespace RT64 {
             streamResultQueue.clear();
         }
 
-        // Clear the current set of textures that were sent to streaming threads.
+        // Clear the current set of textures that were sent to streaming tasks.
         textureMap.replacementMap.fileSystemStreamSets.clear();
 
         // Clear the pending replacement checks for streamed textures.
@@ -1447,7 +1843,7 @@ namespace RT64 {
             for (size_t i = 0; i < textureMap.textures.size(); i++) {
                 if (textureMap.textures[i] != nullptr) {
                     Texture *texture = textureMap.textures[i];
-                    addResolvedPaths(textureMap.hashes[i], texture->width, texture->height, texture->tlut, texture->loadTile, texture->bytesTMEM, texture->decodeTMEM, resolvedPathQueue, exclusiveDbHash);
+                    addResolvedPaths(textureMap.hashes[i], texture->width, texture->height, texture->tlut, texture->loadTile, textureMap.getBytesTMEM(texture), texture->tmemRanges, texture->decodeTMEM, resolvedPathQueue, exclusiveDbHash);
                 }
             }
         }
@@ -1532,9 +1928,11 @@ namespace RT64 {
                     }
                 }
 
-                if (fileSystems[i]->load(ReplacementLowMipCacheFilename, mipCacheBytes)) {
+                const uint8_t *mipCacheData = nullptr;
+                size_t mipCacheDataByteCount = 0;
+                if (fileSystems[i]->viewOrLoad(ReplacementLowMipCacheFilename, mipCacheBytes, mipCacheData, mipCacheDataByteCount)) {
                     uploadBuffers.emplace_back();
-                    if (!setLowMipCache(copyWorker->device, loaderCommandList.get(), mipCacheBytes.data(), mipCacheBytes.size(), uploadBuffers.back(), textureMap.replacementMap.lowMipCacheTextures, totalMemory)) {
+                    if (!setLowMipCache(copyWorker->device, loaderCommandList.get(), mipCacheData, mipCacheDataByteCount, uploadBuffers.back(), textureMap.replacementMap.lowMipCacheTextures, totalMemory)) {
                         fprintf(stderr, "Failed to load low mip cache.\n");
                     }
                 }
@@ -1566,21 +1964,23 @@ namespace RT64 {
 
         // Queue all textures that must be preloaded to the stream queues.
         bool texturesPreloaded = false;
+        size_t preloadCount = 0;
         {
-            std::unique_lock queueLock(streamDescStackMutex);
+            std::unique_lock queueLock(streamDescQueueMutex);
             for (uint32_t i = 0; i < fileSystemCount; i++) {
                 for (const std::string &relativePath : textureMap.replacementMap.fileSystemStreamSets[i]) {
-                    streamDescStack.push(StreamDescription(i, relativePath, true));
+                    streamDescQueue.push(StreamDescription(i, relativePath, true));
                     texturesPreloaded = true;
+                    preloadCount++;
                 }
             }
         }
 
         if (texturesPreloaded) {
-            streamDescStackChanged.notify_all();
+            queueStreamTasks(preloadCount);
 
-            // Wait for all the streaming threads to be finished.
-            waitForAllStreamThreads(false);
+            // Wait for all the streaming tasks to be finished.
+            waitForAllStreamTasks(false);
         }
 
         reloadReplacements(true);
@@ -1713,9 +2113,45 @@ namespace RT64 {
         return textureMap.get(textureIndex);
     }
 
-    bool TextureCache::evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes) {
+    bool TextureCache::restoreTMEM(uint32_t textureIndex, uint8_t *TMEM) {
         std::unique_lock lock(textureMapMutex);
-        return textureMap.evict(submissionFrame, evictedHashes);
+        const Texture *texture = textureMap.get(textureIndex);
+        if (texture == nullptr) {
+            return false;
+        }
+
+        // The texture only stores the ranges it can read, so they're restored to their original addresses.
+        texture->tmemRanges.scatter(textureMap.getBytesTMEM(texture), TMEM);
+        return true;
+    }
+
+    bool TextureCache::evict(uint64_t submissionFrame, uint32_t queueDepth, std::vector<uint64_t> &evictedHashes) {
+        std::unique_lock lock(textureMapMutex);
+        if (!textureMap.evict(submissionFrame, queueDepth, evictedHashes)) {
+            return false;
+        }
+
+        // Cancel any streaming requests that were only pending for the textures that were evicted.
+        thread_local std::vector<StreamDescription> canceledDescs;
+        canceledDescs.clear();
+        {
+            std::unique_lock queueLock(streamDescQueueMutex);
+            for (uint64_t hash : evictedHashes) {
+                streamDescQueue.cancel(hash, canceledDescs);
+            }
+        }
+
+        // The upload thread owns the stream sets, so it must be the one to finish the cancellation.
+        if (!canceledDescs.empty()) {
+            {
+                std::unique_lock queueLock(uploadQueueMutex);
+                streamCancelQueue.insert(streamCancelQueue.end(), canceledDescs.begin(), canceledDescs.end());
+            }
+
+            uploadQueueChanged.notify_all();
+        }
+
+        return true;
     }
 
     void TextureCache::incrementLock() {
@@ -1737,28 +2173,98 @@ namespace RT64 {
         }
     }
 
-    void TextureCache::waitForAllStreamThreads(bool clearQueueImmediately) {
-        if (clearQueueImmediately) {
-            std::unique_lock<std::mutex> queueLock(streamDescStackMutex);
-            streamDescStack = std::stack<StreamDescription>();
+    void TextureCache::pushStreamDescription(const StreamDescription &streamDesc) {
+        streamDescQueueMutex.lock();
+        streamDescQueue.push(streamDesc);
+        streamDescQueueMutex.unlock();
+        queueStreamTasks(1);
+    }
+
+    void TextureCache::queueStreamTasks(size_t count) {
+        // Every task streams a batch of whichever descriptions are at the top of the queue when it runs. Texture streaming has a priority
+        // somewhere inbetween the main threads and the shader compilation.
+        for (size_t i = 0; i < count; i++) {
+            taskScheduler->submit(Thread::Priority::Low, [this]() { streamNext(); }, &streamGroup);
         }
+    }
 
-        bool keepWaiting = false;
-        do {
-            streamDescStackMutex.lock();
-            keepWaiting = (streamDescStackActiveCount > 0);
-            streamDescStackMutex.unlock();
+    void TextureCache::streamNext() {
+        // Contexts are reused by the tasks. A new one is only created when all of them are being used at the same time.
+        StreamContext *streamContext = nullptr;
+        {
+            std::unique_lock contextLock(streamContextMutex);
+            if (freeStreamContexts.empty()) {
+                streamContexts.emplace_back(std::make_unique<StreamContext>(this));
+                streamContext = streamContexts.back().get();
+            }
+            else {
+                streamContext = freeStreamContexts.back();
+                freeStreamContexts.pop_back();
+            }
+        }
+
+        streamContext->streamBatch();
+
+        {
+            std::unique_lock contextLock(streamContextMutex);
+            freeStreamContexts.emplace_back(streamContext);
+        }
+    }
 
-            if (keepWaiting) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    void TextureCache::cancelStreamDescriptions(const std::vector<StreamDescription> &canceledDescs, uint64_t requestFrame) {
+        for (const StreamDescription &streamDesc : canceledDescs) {
+            // Ignore cancellations that were queued before the replacements were reloaded.
+            const auto &replacementMap = textureMap.replacementMap;
+            if ((streamDesc.fileSystemIndex >= replacementMap.fileSystemStreamSets.size()) || (streamDesc.fileSystemIndex >= replacementMap.fileSystemStreamResolvedPaths.size())) {
+                continue;
             }
-        } while (keepWaiting);
+
+            // Discard the pending replacement checks for the evicted hash.
+            auto &streamResolvedPaths = textureMap.replacementMap.fileSystemStreamResolvedPaths[streamDesc.fileSystemIndex];
+            auto range = streamResolvedPaths.equal_range(streamDesc.relativePath);
+            uint64_t remainingHash = 0;
+            for (auto it = range.first; it != range.second;) {
+                if (it->second.textureHash == streamDesc.textureHash) {
+                    it = streamResolvedPaths.erase(it);
+                }
+                else {
+                    remainingHash = it->second.textureHash;
+                    it++;
+                }
+            }
+
+            // Queue the request again if other textures are still waiting on the same file. Otherwise, allow it to be requested again later.
+            if (remainingHash != 0) {
+                pushStreamDescription(StreamDescription(streamDesc.fileSystemIndex, streamDesc.relativePath, false, remainingHash, requestFrame, streamDesc.estimatedSize));
+            }
+            else {
+                textureMap.replacementMap.fileSystemStreamSets[streamDesc.fileSystemIndex].erase(streamDesc.relativePath);
+            }
+        }
+    }
+
+    void TextureCache::waitForAllStreamTasks(bool clearQueueImmediately) {
+        if (clearQueueImmediately) {
+            streamDescQueueMutex.lock();
+            streamDescQueue.clear();
+            streamDescQueueMutex.unlock();
+
+            uploadQueueMutex.lock();
+            streamCancelQueue.clear();
+            uploadQueueMutex.unlock();
+
+            taskScheduler->cancel(streamGroup);
+        }
+
+        taskScheduler->wait(streamGroup);
     }
 
     void TextureCache::resetStreamPerformanceCounters() {
         std::unique_lock lock(streamPerformanceMutex);
         streamLoadTimeTotal = 0;
         streamLoadCount = 0;
+        streamWaitTimes.clear();
+        streamWaitTimeCursor = 0;
     }
 
     void TextureCache::addStreamLoadTime(uint64_t streamLoadTime) {
@@ -1767,6 +2273,19 @@ namespace RT64 {
         streamLoadCount++;
     }
 
+    void TextureCache::addStreamWaitTime(uint64_t streamWaitTime) {
+        // Only keep the most recent samples to compute the percentiles from.
+        const size_t MaxWaitTimeSamples = 1024;
+        std::unique_lock lock(streamPerformanceMutex);
+        if (streamWaitTimes.size() < MaxWaitTimeSamples) {
+            streamWaitTimes.emplace_back(streamWaitTime);
+        }
+        else {
+            streamWaitTimes[streamWaitTimeCursor] = streamWaitTime;
+            streamWaitTimeCursor = (streamWaitTimeCursor + 1) % MaxWaitTimeSamples;
+        }
+    }
+
     uint64_t TextureCache::getAverageStreamLoadTime() {
         std::unique_lock lock(streamPerformanceMutex);
         if (streamLoadTimeTotal > 0) {
@@ -1777,6 +2296,35 @@ namespace RT64 {
         }
     }
 
+    size_t TextureCache::getStreamQueueDepth() {
+        std::unique_lock lock(streamDescQueueMutex);
+        return streamDescQueue.size();
+    }
+
+    void TextureCache::getStreamWaitTimePercentiles(uint64_t &p50, uint64_t &p90, uint64_t &p99) {
+        thread_local std::vector<uint64_t> sortedWaitTimes;
+        {
+            std::unique_lock lock(streamPerformanceMutex);
+            sortedWaitTimes = streamWaitTimes;
+        }
+
+        if (sortedWaitTimes.empty()) {
+            p50 = p90 = p99 = 0;
+            return;
+        }
+
+        std::sort(sortedWaitTimes.begin(), sortedWaitTimes.end());
+        const size_t lastIndex = sortedWaitTimes.size() - 1;
+        p50 = sortedWaitTimes[(lastIndex * 50) / 100];
+        p90 = sortedWaitTimes[(lastIndex * 90) / 100];
+        p99 = sortedWaitTimes[(lastIndex * 99) / 100];
+    }
+
+    void TextureCache::setStreamBatchLimits(uint32_t maxCount, uint64_t maxBytes) {
+        streamBatchMaxCount = maxCount;
+        streamBatchMaxBytes = maxBytes;
+    }
+
     void TextureCache::setReplacementPoolMaxSize(uint64_t maxSize) {
         std::unique_lock lock(textureMapMutex);
         textureMap.replacementMap.maxTexturePoolSize = maxSize;
@@ -7,14 +7,17 @@
 #include <atomic>
 #include <condition_variable>
 #include <filesystem>
+#include <map>
 #include <mutex>
-#include <stack>
 #include <thread>
 #include <unordered_map>
 
 #include <json/json.hpp>
 
+#include "common/rt64_flat_hash_map.h"
 #include "common/rt64_replacement_database.h"
+#include "common/rt64_task_scheduler.h"
+#include "common/rt64_timer.h"
 #include "hle/rt64_draw_call.h"
 
 #include "rt64_descriptor_sets.h"
@@ -42,7 +45,8 @@ namespace RT64 {
         uint32_t height;
         uint32_t tlut;
         LoadTile loadTile;
-        std::vector<uint8_t> bytesTMEM;
+        uint64_t arenaOffset;
+        TMEMRangeList tmemRanges;
         bool decodeTMEM;
     };
 
@@ -73,8 +77,8 @@ namespace RT64 {
             std::list<Texture *>::iterator unusedTextureListIterator;
         };
 
-        typedef std::unordered_map<uint64_t, MapEntry> LoadedTextureMap;
-        typedef std::unordered_map<Texture *, LoadedTextureMap::iterator> LoadedTextureReverseMap;
+        typedef FlatHashMap<MapEntry> LoadedTextureMap;
+        typedef std::unordered_map<Texture *, uint64_t> LoadedTextureReverseMap;
 
         LoadedTextureMap loadedTextureMap;
         LoadedTextureReverseMap loadedTextureReverseMap;
@@ -119,7 +123,7 @@ namespace RT64 {
     };
 
     struct TextureMap {
-        std::unordered_map<uint64_t, uint32_t> hashMap;
+        FlatHashMap<uint32_t> hashMap;
         std::vector<Texture *> textures;
         std::vector<interop::float3> cachedTextureDimensions;
         std::vector<Texture *> textureReplacements;
@@ -132,19 +136,34 @@ namespace RT64 {
         std::vector<uint32_t> versions;
         std::vector<uint64_t> creationFrames;
         uint32_t globalVersion;
+
+        // Indices of the textures that changed, in order. Readers keep the position they read up to and only copy those entries.
+        std::vector<uint32_t> changeLog;
+        uint64_t changeLogStart;
+
         AccessList accessList;
         std::vector<AccessList::iterator> listIterators;
         std::vector<Texture *> evictedTextures;
+
+        // Compacted TMEM bytes of every texture in the map, addressed by the offset stored in the texture.
+        std::vector<uint8_t> tmemArena;
+        std::vector<uint8_t> tmemArenaScratch;
+        uint64_t tmemArenaFreedBytes;
+
         ReplacementMap replacementMap;
         bool replacementMapEnabled;
 
         TextureMap();
         ~TextureMap();
         void clearReplacements();
-        void add(uint64_t hash, uint64_t creationFrame, Texture *texture);
+        void add(uint64_t hash, uint64_t creationFrame, Texture *texture, const uint8_t *bytesTMEM);
         void replace(uint64_t hash, Texture *texture, bool shiftedByHalf, bool referenceCounted);
         bool use(uint64_t hash, uint64_t submissionFrame, uint32_t &textureIndex, interop::float2 &textureScale, interop::float3 &textureDimensions, bool &textureReplaced, bool &hasMipmaps, bool &shiftedByHalf);
-        bool evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes);
+        bool evict(uint64_t submissionFrame, uint32_t queueDepth, std::vector<uint64_t> &evictedHashes);
+        void compactTMEMArena();
+        const uint8_t *getBytesTMEM(const Texture *texture) const;
+        void logChange(uint32_t textureIndex);
+        uint64_t getChangeLogEnd() const;
         void incrementLock();
         void decrementLock();
         Texture *get(uint32_t index) const;
@@ -156,18 +175,56 @@ namespace RT64 {
             uint32_t fileSystemIndex = 0;
             std::string relativePath;
             bool fromPreload = false;
+            uint64_t textureHash = 0;
+            uint64_t requestFrame = 0;
+            uint64_t estimatedSize = 0;
 
             StreamDescription() {
                 // Default constructor.
             }
 
-            StreamDescription(uint32_t fileSystemIndex, const std::string &relativePath, bool fromPreload) {
+            StreamDescription(uint32_t fileSystemIndex, const std::string &relativePath, bool fromPreload, uint64_t textureHash = 0, uint64_t requestFrame = 0, uint64_t estimatedSize = 0) {
                 this->fileSystemIndex = fileSystemIndex;
                 this->relativePath = relativePath;
                 this->fromPreload = fromPreload;
+                this->textureHash = textureHash;
+                this->requestFrame = requestFrame;
+                this->estimatedSize = estimatedSize;
             }
         };
 
+        // Streaming requests are served in priority order instead of the order they were submitted in. Textures that are visible on screen
+        // are loaded before preloaded textures. Among them, textures requested on the most recent frame go first, then the smallest files.
+        struct StreamQueue {
+            struct Priority {
+                bool fromPreload = false;
+                uint64_t requestFrame = 0;
+                uint64_t estimatedSize = 0;
+                uint64_t sequence = 0;
+
+                bool operator<(const Priority &other) const;
+            };
+
+            struct Entry {
+                StreamDescription streamDesc;
+                Timestamp queueTimestamp;
+            };
+
+            std::map<Priority, Entry> entries;
+            std::vector<std::unordered_map<std::string, Priority>> fileSystemPriorities;
+            std::unordered_map<uint64_t, Priority> hashPriorities;
+            uint64_t sequenceCounter = 0;
+
+            void push(const StreamDescription &streamDesc);
+            bool update(const StreamDescription &streamDesc);
+            bool pop(StreamDescription &streamDesc, Timestamp &queueTimestamp);
+            void cancel(uint64_t textureHash, std::vector<StreamDescription> &canceledDescs);
+            void erase(std::map<Priority, Entry>::iterator it);
+            void clear();
+            bool empty() const;
+            size_t size() const;
+        };
+
         struct StreamResult {
             Texture *texture = nullptr;
             uint32_t fileSystemIndex = 0;
@@ -186,23 +243,47 @@ namespace RT64 {
             }
         };
 
-        struct StreamThread {
+        struct UploadBatch {
+            RenderBuffer *buffer = nullptr;
+            uint8_t *bufferData = nullptr;
+            uint64_t bufferSize = 0;
+            uint64_t bufferCursor = 0;
+
+            uint64_t allocate(uint64_t size);
+        };
+
+        struct StreamContext {
+            struct BatchEntry {
+                StreamDescription streamDesc;
+                std::vector<uint8_t> replacementBytes;
+                const uint8_t *fileData = nullptr;
+                size_t fileDataByteCount = 0;
+                uint64_t uploadSize = 0;
+            };
+
             std::unique_ptr<RenderWorker> worker;
             TextureCache *textureCache = nullptr;
-            std::unique_ptr<std::thread> thread;
-            std::atomic<bool> threadRunning;
             std::unique_ptr<RenderBuffer> uploadResource;
+            uint64_t uploadResourceSize = 0;
+            std::vector<BatchEntry> batchEntries;
+            std::vector<StreamResult> batchResults;
 
-            StreamThread(TextureCache *textureCache);
-            ~StreamThread();
-            void loop();
+            StreamContext(TextureCache *textureCache);
+            ~StreamContext();
+            bool popStreamDescription(StreamDescription &streamDesc);
+            void loadBatch(uint32_t batchCount, uint64_t batchUploadSize);
+            void streamBatch();
         };
 
         const ShaderLibrary *shaderLibrary;
         std::vector<TextureUpload> uploadQueue;
+        std::vector<uint8_t> uploadArena;
+        size_t uploadQueueActiveCount = 0;
         std::vector<ReplacementResolvedPath> resolvedPathQueue;
         std::vector<StreamResult> streamResultQueue;
-        std::vector<std::unique_ptr<RenderBuffer>> tmemUploadResources;
+        std::vector<StreamDescription> streamCancelQueue;
+        std::unique_ptr<RenderBuffer> tmemUploadResource;
+        uint64_t tmemUploadResourceSize = 0;
         std::vector<std::unique_ptr<RenderBuffer>> replacementUploadResources;
         std::vector<std::unique_ptr<TextureDecodeDescriptorSet>> descriptorSets;
         std::mutex uploadQueueMutex;
@@ -210,14 +291,20 @@ namespace RT64 {
         std::condition_variable uploadQueueFinished;
         std::unique_ptr<std::thread> uploadThread;
         std::atomic<bool> uploadThreadRunning;
-        std::stack<StreamDescription> streamDescStack;
-        std::mutex streamDescStackMutex;
-        std::condition_variable streamDescStackChanged;
-        int32_t streamDescStackActiveCount = 0;
-        std::list<std::unique_ptr<StreamThread>> streamThreads;
+        StreamQueue streamDescQueue;
+        std::mutex streamDescQueueMutex;
+        std::atomic<uint32_t> streamBatchMaxCount = 16;
+        std::atomic<uint64_t> streamBatchMaxBytes = 64 * 1024 * 1024;
+        TaskScheduler *taskScheduler;
+        TaskScheduler::Group streamGroup;
+        std::vector<std::unique_ptr<StreamContext>> streamContexts;
+        std::vector<StreamContext *> freeStreamContexts;
+        std::mutex streamContextMutex;
         std::mutex streamPerformanceMutex;
         uint64_t streamLoadTimeTotal = 0;
         uint64_t streamLoadCount = 0;
+        std::vector<uint64_t> streamWaitTimes;
+        size_t streamWaitTimeCursor = 0;
         TextureMap textureMap;
         std::mutex textureMapMutex;
         RenderWorker *directWorker;
@@ -230,12 +317,12 @@ namespace RT64 {
         uint32_t lockCounter;
         bool developerMode;
 
-        TextureCache(RenderWorker *directWorker, RenderWorker *copyWorker, uint32_t threadCount, const ShaderLibrary *shaderLibrary);
+        TextureCache(RenderWorker *directWorker, RenderWorker *copyWorker, TaskScheduler *taskScheduler, const ShaderLibrary *shaderLibrary);
         ~TextureCache();
         void uploadThreadLoop();
         void queueGPUUploadTMEM(uint64_t hash, uint64_t creationFrame, const uint8_t *bytes, int bytesCount, int width, int height, uint32_t tlut, const LoadTile &loadTile, bool decodeTMEM);
         void waitForGPUUploads();
-        void addResolvedPaths(uint64_t hash, uint32_t width, uint32_t height, uint32_t tlut, const LoadTile &loadTile, const std::vector<uint8_t> &bytesTMEM, bool decodeTMEM, std::vector<ReplacementResolvedPath> &resolvedPaths, uint64_t exclusiveDbHash = 0);
+        void addResolvedPaths(uint64_t hash, uint32_t width, uint32_t height, uint32_t tlut, const LoadTile &loadTile, const uint8_t *bytesTMEM, const TMEMRangeList &tmemRanges, bool decodeTMEM, std::vector<ReplacementResolvedPath> &resolvedPaths, uint64_t exclusiveDbHash = 0);
         bool useTexture(uint64_t hash, uint64_t submissionFrame, uint32_t &textureIndex, interop::float2 &textureScale, interop::float3 &textureDimensions, bool &textureReplaced, bool &hasMipmaps, bool &shiftedByHalf);
         bool useTexture(uint64_t hash, uint64_t submissionFrame, uint32_t &textureIndex);
         bool addReplacement(uint64_t hash, const std::string &relativePath, ReplacementShift shift);
@@ -250,19 +337,29 @@ namespace RT64 {
         void setReplacementShift(uint64_t hash, ReplacementShift shift);
         void setReplacementOperation(uint64_t hash, ReplacementOperation operation);
         void removeUnusedEntriesFromDatabase();
-        bool evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes);
+        bool evict(uint64_t submissionFrame, uint32_t queueDepth, std::vector<uint64_t> &evictedHashes);
         void incrementLock();
         void decrementLock();
-        void waitForAllStreamThreads(bool clearQueueImmediately);
+        void pushStreamDescription(const StreamDescription &streamDesc);
+        void queueStreamTasks(size_t count);
+        void streamNext();
+        void cancelStreamDescriptions(const std::vector<StreamDescription> &canceledDescs, uint64_t requestFrame);
+        void waitForAllStreamTasks(bool clearQueueImmediately);
         void resetStreamPerformanceCounters();
         void addStreamLoadTime(uint64_t streamLoadTime);
+        void addStreamWaitTime(uint64_t streamWaitTime);
         uint64_t getAverageStreamLoadTime();
+        size_t getStreamQueueDepth();
+        void getStreamWaitTimePercentiles(uint64_t &p50, uint64_t &p90, uint64_t &p99);
+        void setStreamBatchLimits(uint32_t maxCount, uint64_t maxBytes);
         void setReplacementPoolMaxSize(uint64_t maxSize);
         void getReplacementPoolStats(uint64_t &usedSize, uint64_t &cachedSize, uint64_t &maxSize);
         Texture *getTexture(uint32_t textureIndex);
-        static void setRGBA32(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, uint32_t width, uint32_t height, uint32_t rowPitch, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr);
-        static bool setDDS(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr);
+        bool restoreTMEM(uint32_t textureIndex, uint8_t *TMEM);
+        static void setRGBA32(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, uint32_t width, uint32_t height, uint32_t rowPitch, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr, UploadBatch *uploadBatch = nullptr);
+        static bool setDDS(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr, UploadBatch *uploadBatch = nullptr);
         static bool setLowMipCache(RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, std::unordered_map<std::string, LowMipCacheTexture> &dstTextureMap, uint64_t &totalMemory);
-        static Texture *loadTextureFromBytes(RenderDevice *device, RenderCommandList *commandList, const std::vector<uint8_t> &fileBytes, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *resourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr);
+        static Texture *loadTextureFromBytes(RenderDevice *device, RenderCommandList *commandList, const uint8_t *fileBytes, size_t fileByteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *resourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr, UploadBatch *uploadBatch = nullptr);
+        static uint64_t computeUploadSize(const uint8_t *fileBytes, size_t fileByteCount);
     };
 };
\ No newline at end of file
@@ -14,8 +14,8 @@ namespace RT64 {
 
     TileProcessor::~TileProcessor() { }
 
-    void TileProcessor::setup(RenderWorker *worker) {
-        bufferUploader = std::make_unique<BufferUploader>(worker->device);
+    void TileProcessor::setup(RenderWorker *worker, StagingRing *stagingRing, TaskScheduler *taskScheduler) {
+        bufferUploader = std::make_unique<BufferUploader>(worker->device, stagingRing, taskScheduler);
     }
 
     void TileProcessor::process(const ProcessParams &p) {
@@ -15,8 +15,8 @@ namespace RT64 {
 
     TransformProcessor::~TransformProcessor() { }
 
-    void TransformProcessor::setup(RenderWorker *worker) {
-        bufferUploader = std::make_unique<BufferUploader>(worker->device);
+    void TransformProcessor::setup(RenderWorker *worker, StagingRing *stagingRing, TaskScheduler *taskScheduler) {
+        bufferUploader = std::make_unique<BufferUploader>(worker->device, stagingRing, taskScheduler);
     }
 
     void TransformProcessor::process(const ProcessParams &p) {
@@ -25,7 +25,7 @@ namespace RT64 {
 
         TransformProcessor();
         ~TransformProcessor();
-        void setup(RenderWorker *worker);
+        void setup(RenderWorker *worker, StagingRing *stagingRing, TaskScheduler *taskScheduler);
         void process(const ProcessParams &p);
         void upload(const ProcessParams &p);
     };
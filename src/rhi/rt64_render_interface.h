@@ -55,6 +55,13 @@ namespace RT64 {
         virtual RenderPipelineProgram getProgram(const std::string &name) const = 0;
     };
 
+    struct RenderPipelineCache {
+        virtual ~RenderPipelineCache() { }
+
+        // Serializes the contents of the cache so they can be used to create it again on the next run with the same device and driver.
+        virtual bool getData(std::vector<uint8_t> &data) = 0;
+    };
+
     struct RenderPipelineLayout {
         virtual ~RenderPipelineLayout() { }
     };
@@ -67,6 +74,17 @@ namespace RT64 {
         virtual ~RenderCommandSemaphore() { }
     };
 
+    struct RenderQueryPool {
+        virtual ~RenderQueryPool() { }
+
+        // Reads back the results of all the queries in the pool. Must only be called after the GPU has finished executing the command lists that wrote them.
+        virtual void queryResults() = 0;
+
+        // Timestamps are converted to nanoseconds.
+        virtual const uint64_t *getResults() const = 0;
+        virtual uint32_t getCount() const = 0;
+    };
+
     struct RenderDescriptorSet {
         // Descriptor indices correspond to the index assuming the descriptor set is one contiguous array. They DO NOT correspond to the bindings, which can be sparse.
         // User code should derive these indices on its own by looking at the order the bindings were assigned during set creation along with the descriptor count and
@@ -114,6 +132,8 @@ namespace RT64 {
         virtual void traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) = 0;
         virtual void drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) = 0;
         virtual void drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) = 0;
+        virtual void drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) = 0;
+        virtual void drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) = 0;
         virtual void setPipeline(const RenderPipeline *pipeline) = 0;
         virtual void setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) = 0;
         virtual void setComputePushConstants(uint32_t rangeIndex, const void *data) = 0;
@@ -139,6 +159,13 @@ namespace RT64 {
         virtual void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect = nullptr) = 0;
         virtual void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) = 0;
         virtual void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) = 0;
+        virtual void resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) = 0;
+        virtual void writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) = 0;
+        virtual void resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) = 0;
+
+        // Indicates the list can be recorded at the same time as other lists that are submitted before it. Validation that relies on
+        // the state tracked by the resources being recorded in submission order is skipped.
+        virtual void setOutOfOrderRecording(bool enabled) = 0;
         
         // Concrete implementation shortcuts.
         inline void barriers(RenderBarrierStages stages, const RenderBufferBarrier &barrier) {
@@ -206,8 +233,8 @@ namespace RT64 {
         virtual std::unique_ptr<RenderDescriptorSet> createDescriptorSet(const RenderDescriptorSetDesc &desc) = 0;
         virtual std::unique_ptr<RenderShader> createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) = 0;
         virtual std::unique_ptr<RenderSampler> createSampler(const RenderSamplerDesc &desc) = 0;
-        virtual std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc) = 0;
-        virtual std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) = 0;
+        virtual std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache = nullptr) = 0;
+        virtual std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache = nullptr) = 0;
         virtual std::unique_ptr<RenderPipeline> createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline = nullptr) = 0;
         virtual std::unique_ptr<RenderCommandQueue> createCommandQueue(RenderCommandListType type) = 0;
         virtual std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) = 0;
@@ -215,9 +242,11 @@ namespace RT64 {
         virtual std::unique_ptr<RenderAccelerationStructure> createAccelerationStructure(const RenderAccelerationStructureDesc &desc) = 0;
         virtual std::unique_ptr<RenderPool> createPool(const RenderPoolDesc &desc) = 0;
         virtual std::unique_ptr<RenderPipelineLayout> createPipelineLayout(const RenderPipelineLayoutDesc &desc) = 0;
+        virtual std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data = nullptr, uint64_t size = 0) = 0;
         virtual std::unique_ptr<RenderCommandFence> createCommandFence() = 0;
         virtual std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() = 0;
         virtual std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) = 0;
+        virtual std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) = 0;
         virtual void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild = true, bool preferFastTrace = false) = 0;
         virtual void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild = true, bool preferFastTrace = false) = 0;
         virtual void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) = 0;
@@ -235,6 +264,9 @@ namespace RT64 {
     };
 
     extern void RenderInterfaceTest(RenderInterface *renderInterface);
+
+    // Runs every test for a fixed number of frames without creating a window. Returns a non-zero status if the context couldn't be created.
+    extern int RenderInterfaceTestHeadless(RenderInterface *renderInterface, uint32_t frameCount);
     extern void TestInitialize(RenderInterface* renderInterface, RenderWindow window);
     extern void TestDraw();
     extern void TestResize();
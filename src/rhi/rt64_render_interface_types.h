@@ -413,7 +413,8 @@ namespace RT64 {
             ACCELERATION_STRUCTURE_INPUT = 1U << 6,
             ACCELERATION_STRUCTURE_SCRATCH = 1U << 7,
             SHADER_BINDING_TABLE = 1U << 8,
-            UNORDERED_ACCESS = 1U << 9
+            UNORDERED_ACCESS = 1U << 9,
+            INDIRECT = 1U << 10
         };
     };
 
@@ -749,6 +750,22 @@ namespace RT64 {
         }
     };
 
+    // Layout of the arguments read by indirect draws. Matches the layout expected by all backends.
+    struct RenderDrawIndirectArguments {
+        uint32_t vertexCountPerInstance = 0;
+        uint32_t instanceCount = 0;
+        uint32_t startVertexLocation = 0;
+        uint32_t startInstanceLocation = 0;
+    };
+
+    struct RenderDrawIndexedIndirectArguments {
+        uint32_t indexCountPerInstance = 0;
+        uint32_t instanceCount = 0;
+        uint32_t startIndexLocation = 0;
+        int32_t baseVertexLocation = 0;
+        uint32_t startInstanceLocation = 0;
+    };
+
     struct RenderBufferBarrier {
         RenderBuffer *buffer = nullptr;
         RenderBufferAccessBits accessBits = RenderBufferAccess::NONE;
@@ -1734,6 +1751,9 @@ namespace RT64 {
         RenderDeviceVendor vendor = RenderDeviceVendor::UNKNOWN;
         uint64_t driverVersion = 0;
         uint64_t dedicatedVideoMemory = 0;
+
+        // Identifies the device and driver combination that pipeline cache data is valid for.
+        uint8_t pipelineCacheUUID[16] = {};
     };
 
     struct RenderDeviceCapabilities {
@@ -1757,6 +1777,12 @@ namespace RT64 {
 
         // HDR.
         bool preferHDR = false;
+
+        // Queries.
+        bool timestampQueries = false;
+
+        // Draws. Indirect draws read their draw count from a buffer and can start at any instance.
+        bool drawIndirectCount = false;
     };
 
     struct RenderInterfaceCapabilities {
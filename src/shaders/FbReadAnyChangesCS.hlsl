@@ -18,7 +18,9 @@ void CSMain(uint2 coord : SV_DispatchThreadID) {
     if ((coord.x < gConstants.resolution.x) && (coord.y < gConstants.resolution.y)) {
         const uint bufferIndex = coord.y * gConstants.resolution.x.x + coord.x;
         const uint2 pixelCoord = gConstants.offset + coord.xy;
-        if (gNewInput[bufferIndex] != gCurInput[bufferIndex]) {
+        // Rows outside of the dirty range were copied from the current input and can't be different.
+        const bool dirtyRow = (coord.y >= gConstants.dirtyRowStart) && (coord.y < gConstants.dirtyRowEnd);
+        if (dirtyRow && (gNewInput[bufferIndex] != gCurInput[bufferIndex])) {
             const uint swappedUint = EndianSwapUINT(gNewInput[bufferIndex], gConstants.siz);
             if (gConstants.fmt == G_IM_FMT_DEPTH) {
                 const float newDepth = Depth16ToFloat(swappedUint);
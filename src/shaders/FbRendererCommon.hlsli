@@ -38,6 +38,7 @@ SamplerState gNearestMirrorClampSampler : register(s21, space0);
 SamplerState gNearestClampWrapSampler : register(s22, space0);
 SamplerState gNearestClampMirrorSampler : register(s23, space0);
 SamplerState gNearestClampClampSampler : register(s24, space0);
+StructuredBuffer<uint> rawVertexRenderIndices : register(t68, space0);
 
 // Set 1 - RGBA32 texture cache.
 Texture2D<float4> gTextures[8192] : register(t0, space1);
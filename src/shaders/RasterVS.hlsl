@@ -11,7 +11,12 @@
 
 [[vk::push_constant]] ConstantBuffer<RasterParams> gConstants : register(b0, space0);
 
-LIBRARY_EXPORT void RasterVS(const RenderParams rp, in float4 iPosition, in float2 iUV, in float4 iColor, out float4 oPosition, out float2 oUV, out float4 oSmoothColor, out float4 oFlatColor) {
+uint getVertexRenderIndex(uint vertexId, uint instanceRenderIndex) {
+    return (gConstants.renderIndexFromVertex != 0) ? rawVertexRenderIndices[vertexId] : instanceRenderIndex;
+}
+
+LIBRARY_EXPORT void RasterVS(const RenderParams rp, uint vertexId, uint instanceRenderIndex, in float4 iPosition, in float2 iUV, in float4 iColor, out float4 oPosition, out float2 oUV, out float4 oSmoothColor, out float4 oFlatColor, out uint oRenderIndex) {
+    const uint renderIndex = getVertexRenderIndex(vertexId, instanceRenderIndex);
     float4 ndcPos = iPosition;
     
     // Skip any sort of transformation on the coordinates when rendering rects.
@@ -29,7 +34,7 @@ LIBRARY_EXPORT void RasterVS(const RenderParams rp, in float4 iPosition, in floa
     const bool copyMode = (otherMode.cycleType() == G_CYC_COPY);
     const bool zSourcePrim = (otherMode.zSource() == G_ZS_PRIM);
     if (!copyMode && zSourcePrim) {
-        const uint instanceIndex = instanceRenderIndices[gConstants.renderIndex].instanceIndex;
+        const uint instanceIndex = instanceRenderIndices[renderIndex].instanceIndex;
         ndcPos.z = instanceRDPParams[instanceIndex].primDepth.x * ndcPos.w;
     }
 
@@ -37,11 +42,12 @@ LIBRARY_EXPORT void RasterVS(const RenderParams rp, in float4 iPosition, in floa
     oUV = iUV;
     oSmoothColor = iColor;
     oFlatColor = iColor;
+    oRenderIndex = renderIndex;
 }
 
 #if defined(DYNAMIC_RENDER_PARAMS)
-RenderParams getRenderParams() {
-    uint instanceIndex = instanceRenderIndices[gConstants.renderIndex].instanceIndex;
+RenderParams getRenderParams(uint renderIndex) {
+    uint instanceIndex = instanceRenderIndices[renderIndex].instanceIndex;
     return DynamicRenderParams[instanceIndex];
 }
 #elif defined(SPEC_CONSTANT_RENDER_PARAMS)
@@ -50,20 +56,23 @@ RenderParams getRenderParams() {
 
 #if defined(DYNAMIC_RENDER_PARAMS) || defined(SPEC_CONSTANT_RENDER_PARAMS)
 void VSMain(
-    in float4 iPosition : POSITION
+    in uint iVertexId : SV_VertexID
+    , in float4 iPosition : POSITION
     , in float2 iUV : TEXCOORD
     , in float4 iColor : COLOR
+    , in uint iRenderIndex : RENDERINDEX
     , out float4 oPosition : SV_POSITION
     , out float2 oUV : TEXCOORD
     , out float4 oSmoothColor : COLOR0
 #if defined(DYNAMIC_RENDER_PARAMS) || defined(VERTEX_FLAT_COLOR)
     , out float4 oFlatColor : COLOR1
 #endif
+    , nointerpolation out uint oRenderIndex : RENDERINDEX
 )
 {
 #if !defined(DYNAMIC_RENDER_PARAMS) && !defined(VERTEX_FLAT_COLOR)
     float4 oFlatColor;
 #endif
-    RasterVS(getRenderParams(), iPosition, iUV, iColor, oPosition, oUV, oSmoothColor, oFlatColor);
+    RasterVS(getRenderParams(getVertexRenderIndex(iVertexId, iRenderIndex)), iVertexId, iRenderIndex, iPosition, iUV, iColor, oPosition, oUV, oSmoothColor, oFlatColor, oRenderIndex);
 }
 #endif
\ No newline at end of file
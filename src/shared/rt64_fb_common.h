@@ -19,6 +19,8 @@ namespace interop {
         uint ditherPattern;
         uint ditherRandomSeed;
         uint usesHDR;
+        uint dirtyRowStart;
+        uint dirtyRowEnd;
     };
 #ifdef HLSL_CPU
 };
@@ -12,6 +12,10 @@ namespace interop {
     struct RasterParams {
         uint renderIndex;
         float2 halfPixelOffset;
+
+        // Draws merged from multiple calls read the render index of every raw vertex from a buffer instead.
+        // Otherwise the vertex shader reads it from the instance attribute so indirect draws can identify each call.
+        uint renderIndexFromVertex;
     };
 #ifdef HLSL_CPU
 };
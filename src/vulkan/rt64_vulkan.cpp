@@ -87,6 +87,7 @@ namespace RT64 {
         VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
         VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME,
         VK_EXT_LAYER_SETTINGS_EXTENSION_NAME,
+        VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME,
     };
 
     // Common functions.
@@ -761,6 +762,7 @@ namespace RT64 {
         bufferInfo.usage |= (desc.flags & RenderBufferFlag::ACCELERATION_STRUCTURE_SCRATCH) ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : 0;
         bufferInfo.usage |= (desc.flags & RenderBufferFlag::ACCELERATION_STRUCTURE_INPUT) ? VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR : 0;
         bufferInfo.usage |= (desc.flags & RenderBufferFlag::SHADER_BINDING_TABLE) ? VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR : 0;
+        bufferInfo.usage |= (desc.flags & RenderBufferFlag::INDIRECT) ? VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT : 0;
 
         const uint32_t deviceAddressMask = RenderBufferFlag::ACCELERATION_STRUCTURE | RenderBufferFlag::ACCELERATION_STRUCTURE_SCRATCH | RenderBufferFlag::ACCELERATION_STRUCTURE_INPUT | RenderBufferFlag::SHADER_BINDING_TABLE;
         bufferInfo.usage |= (desc.flags & deviceAddressMask) ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0;
@@ -1179,6 +1181,64 @@ namespace RT64 {
         }
     }
 
+    // VulkanPipelineCache
+
+    VulkanPipelineCache::VulkanPipelineCache(VulkanDevice *device, const void *data, uint64_t size) {
+        assert(device != nullptr);
+
+        this->device = device;
+
+        VkPipelineCacheCreateInfo cacheInfo = {};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = (data != nullptr) ? size_t(size) : 0;
+        cacheInfo.pInitialData = (data != nullptr) ? data : nullptr;
+
+        VkResult res = vkCreatePipelineCache(device->vk, &cacheInfo, nullptr, &vk);
+        if ((res != VK_SUCCESS) && (cacheInfo.initialDataSize > 0)) {
+            // The driver is allowed to reject the initial data, so try again with an empty cache.
+            cacheInfo.initialDataSize = 0;
+            cacheInfo.pInitialData = nullptr;
+            res = vkCreatePipelineCache(device->vk, &cacheInfo, nullptr, &vk);
+        }
+
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkCreatePipelineCache failed with error code 0x%X.\n", res);
+            return;
+        }
+    }
+
+    VulkanPipelineCache::~VulkanPipelineCache() {
+        if (vk != VK_NULL_HANDLE) {
+            vkDestroyPipelineCache(device->vk, vk, nullptr);
+        }
+    }
+
+    bool VulkanPipelineCache::getData(std::vector<uint8_t> &data) {
+        data.clear();
+
+        if (vk == VK_NULL_HANDLE) {
+            return false;
+        }
+
+        size_t dataSize = 0;
+        VkResult res = vkGetPipelineCacheData(device->vk, vk, &dataSize, nullptr);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkGetPipelineCacheData failed with error code 0x%X.\n", res);
+            return false;
+        }
+
+        data.resize(dataSize);
+        res = vkGetPipelineCacheData(device->vk, vk, &dataSize, data.data());
+        if ((res != VK_SUCCESS) && (res != VK_INCOMPLETE)) {
+            fprintf(stderr, "vkGetPipelineCacheData failed with error code 0x%X.\n", res);
+            data.clear();
+            return false;
+        }
+
+        data.resize(dataSize);
+        return true;
+    }
+
     // VulkanShader
 
     VulkanShader::VulkanShader(VulkanDevice *device, const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) {
@@ -1261,7 +1321,7 @@ namespace RT64 {
 
     // VulkanComputePipeline
 
-    VulkanComputePipeline::VulkanComputePipeline(VulkanDevice *device, const RenderComputePipelineDesc &desc) : VulkanPipeline(device, Type::Compute) {
+    VulkanComputePipeline::VulkanComputePipeline(VulkanDevice *device, const RenderComputePipelineDesc &desc, VulkanPipelineCache *pipelineCache) : VulkanPipeline(device, Type::Compute) {
         assert(desc.pipelineLayout != nullptr);
         assert(desc.computeShader != nullptr);
         assert((desc.threadGroupSizeX > 0) && (desc.threadGroupSizeY > 0) && (desc.threadGroupSizeZ > 0));
@@ -1285,7 +1345,8 @@ namespace RT64 {
         pipelineInfo.layout = pipelineLayout->vk;
         pipelineInfo.stage = stageInfo;
 
-        VkResult res = vkCreateComputePipelines(device->vk, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &vk);
+        VkPipelineCache vkPipelineCache = (pipelineCache != nullptr) ? pipelineCache->vk : VK_NULL_HANDLE;
+        VkResult res = vkCreateComputePipelines(device->vk, vkPipelineCache, 1, &pipelineInfo, nullptr, &vk);
         if (res != VK_SUCCESS) {
             fprintf(stderr, "vkCreateComputePipelines failed with error code 0x%X.\n", res);
             return;
@@ -1305,7 +1366,7 @@ namespace RT64 {
 
     // VulkanGraphicsPipeline
 
-    VulkanGraphicsPipeline::VulkanGraphicsPipeline(VulkanDevice *device, const RenderGraphicsPipelineDesc &desc) : VulkanPipeline(device, Type::Graphics) {
+    VulkanGraphicsPipeline::VulkanGraphicsPipeline(VulkanDevice *device, const RenderGraphicsPipelineDesc &desc, VulkanPipelineCache *pipelineCache) : VulkanPipeline(device, Type::Graphics) {
         assert(desc.pipelineLayout != nullptr);
 
         thread_local std::vector<VkPipelineShaderStageCreateInfo> stages;
@@ -1503,7 +1564,8 @@ namespace RT64 {
         pipelineInfo.layout = pipelineLayout->vk;
         pipelineInfo.renderPass = renderPass;
 
-        VkResult res = vkCreateGraphicsPipelines(device->vk, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &vk);
+        VkPipelineCache vkPipelineCache = (pipelineCache != nullptr) ? pipelineCache->vk : VK_NULL_HANDLE;
+        VkResult res = vkCreateGraphicsPipelines(device->vk, vkPipelineCache, 1, &pipelineInfo, nullptr, &vk);
         if (res != VK_SUCCESS) {
             fprintf(stderr, "vkCreateGraphicsPipelines failed with error code 0x%X.\n", res);
             return;
@@ -2659,6 +2721,30 @@ namespace RT64 {
         vkCmdDrawIndexed(vk, indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
     }
 
+    void VulkanCommandList::drawIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        assert(argumentBuffer.ref != nullptr);
+        assert(countBuffer.ref != nullptr);
+        assert(device->capabilities.drawIndirectCount && "Indirect draws with a count buffer must be supported.");
+
+        checkActiveRenderPass();
+
+        const VulkanBuffer *interfaceArgumentBuffer = static_cast<const VulkanBuffer *>(argumentBuffer.ref);
+        const VulkanBuffer *interfaceCountBuffer = static_cast<const VulkanBuffer *>(countBuffer.ref);
+        vkCmdDrawIndirectCountKHR(vk, interfaceArgumentBuffer->vk, argumentBuffer.offset, interfaceCountBuffer->vk, countBuffer.offset, maxDrawCount, sizeof(RenderDrawIndirectArguments));
+    }
+
+    void VulkanCommandList::drawIndexedIndirect(RenderBufferReference argumentBuffer, uint32_t maxDrawCount, RenderBufferReference countBuffer) {
+        assert(argumentBuffer.ref != nullptr);
+        assert(countBuffer.ref != nullptr);
+        assert(device->capabilities.drawIndirectCount && "Indirect draws with a count buffer must be supported.");
+
+        checkActiveRenderPass();
+
+        const VulkanBuffer *interfaceArgumentBuffer = static_cast<const VulkanBuffer *>(argumentBuffer.ref);
+        const VulkanBuffer *interfaceCountBuffer = static_cast<const VulkanBuffer *>(countBuffer.ref);
+        vkCmdDrawIndexedIndirectCountKHR(vk, interfaceArgumentBuffer->vk, argumentBuffer.offset, interfaceCountBuffer->vk, countBuffer.offset, maxDrawCount, sizeof(RenderDrawIndexedIndirectArguments));
+    }
+
     void VulkanCommandList::setPipeline(const RenderPipeline *pipeline) {
         assert(pipeline != nullptr);
 
@@ -3157,6 +3243,31 @@ namespace RT64 {
         vkCmdBuildAccelerationStructuresKHR(vk, 1, &buildGeometryInfo, &buildRangeInfoPtr);
     }
 
+    void VulkanCommandList::resetQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        assert(queryPool != nullptr);
+
+        // Queries can't be reset inside a render pass.
+        endActiveRenderPass();
+
+        VulkanQueryPool *interfaceQueryPool = static_cast<VulkanQueryPool *>(queryPool);
+        vkCmdResetQueryPool(vk, interfaceQueryPool->vk, queryFirstIndex, queryCount);
+    }
+
+    void VulkanCommandList::writeTimestamp(RenderQueryPool *queryPool, uint32_t queryIndex) {
+        assert(queryPool != nullptr);
+
+        VulkanQueryPool *interfaceQueryPool = static_cast<VulkanQueryPool *>(queryPool);
+        vkCmdWriteTimestamp(vk, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, interfaceQueryPool->vk, queryIndex);
+    }
+
+    void VulkanCommandList::resolveQueryPool(RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        // Query results are retrieved directly from the pool when requested.
+    }
+
+    void VulkanCommandList::setOutOfOrderRecording(bool enabled) {
+        // No validation depends on the recording order.
+    }
+
     void VulkanCommandList::checkActiveRenderPass() {
         assert(targetFramebuffer != nullptr);
 
@@ -3188,6 +3299,58 @@ namespace RT64 {
         vkCmdBindDescriptorSets(vk, bindPoint, pipelineLayout->vk, setIndex, 1, &interfaceSet->vk, 0, nullptr);
     }
 
+    // VulkanQueryPool
+
+    VulkanQueryPool::VulkanQueryPool(VulkanDevice *device, uint32_t queryCount) {
+        assert(device != nullptr);
+        assert(queryCount > 0);
+
+        this->device = device;
+
+        VkQueryPoolCreateInfo queryPoolInfo = {};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = queryCount;
+
+        VkResult res = vkCreateQueryPool(device->vk, &queryPoolInfo, nullptr, &vk);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateQueryPool failed with error code 0x%X.\n", res);
+            return;
+        }
+
+        ticks.resize(queryCount, 0);
+        results.resize(queryCount, 0);
+    }
+
+    VulkanQueryPool::~VulkanQueryPool() {
+        if (vk != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device->vk, vk, nullptr);
+        }
+    }
+
+    void VulkanQueryPool::queryResults() {
+        // Queries that weren't written since the last reset are reported as not ready and leave their previous values intact.
+        VkResult res = vkGetQueryPoolResults(device->vk, vk, 0, uint32_t(ticks.size()), ticks.size() * sizeof(uint64_t), ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if ((res != VK_SUCCESS) && (res != VK_NOT_READY)) {
+            fprintf(stderr, "vkGetQueryPoolResults failed with error code 0x%X.\n", res);
+            return;
+        }
+
+        // Convert the ticks to nanoseconds.
+        const double nanosecondsPerTick = double(device->physicalDeviceProperties.limits.timestampPeriod);
+        for (size_t i = 0; i < results.size(); i++) {
+            results[i] = uint64_t(double(ticks[i]) * nanosecondsPerTick);
+        }
+    }
+
+    const uint64_t *VulkanQueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t VulkanQueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
     // VulkanCommandFence
 
     VulkanCommandFence::VulkanCommandFence(VulkanDevice *device) {
@@ -3465,6 +3628,7 @@ namespace RT64 {
                 description.name = std::string(deviceProperties.deviceName);
                 description.driverVersion = deviceProperties.driverVersion;
                 description.vendor = RenderDeviceVendor(deviceProperties.vendorID);
+                memcpy(description.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, sizeof(description.pipelineCacheUUID));
                 currentDeviceTypeScore = deviceTypeScore;
             }
         }
@@ -3758,6 +3922,13 @@ namespace RT64 {
         capabilities.displayTiming = supportedOptionalExtensions.find(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME) != supportedOptionalExtensions.end();
         capabilities.maxTextureSize = physicalDeviceProperties.limits.maxImageDimension2D;
         capabilities.preferHDR = memoryHeapSize > (512 * 1024 * 1024);
+        capabilities.timestampQueries = physicalDeviceProperties.limits.timestampComputeAndGraphics;
+
+        // Indirect draws must be able to start at any instance as it's used to identify each draw.
+        static_assert(sizeof(RenderDrawIndirectArguments) == sizeof(VkDrawIndirectCommand), "Indirect draw arguments must match.");
+        static_assert(sizeof(RenderDrawIndexedIndirectArguments) == sizeof(VkDrawIndexedIndirectCommand), "Indirect indexed draw arguments must match.");
+        const bool drawIndirectCountSupported = supportedOptionalExtensions.find(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) != supportedOptionalExtensions.end();
+        capabilities.drawIndirectCount = drawIndirectCountSupported && deviceFeatures.features.multiDrawIndirect && deviceFeatures.features.drawIndirectFirstInstance;
 
         // Fill Vulkan-only capabilities.
         loadStoreOpNoneSupported = supportedOptionalExtensions.find(VK_EXT_LOAD_STORE_OP_NONE_EXTENSION_NAME) != supportedOptionalExtensions.end();
@@ -3779,12 +3950,12 @@ namespace RT64 {
         return std::make_unique<VulkanSampler>(this, desc);
     }
 
-    std::unique_ptr<RenderPipeline> VulkanDevice::createComputePipeline(const RenderComputePipelineDesc &desc) {
-        return std::make_unique<VulkanComputePipeline>(this, desc);
+    std::unique_ptr<RenderPipeline> VulkanDevice::createComputePipeline(const RenderComputePipelineDesc &desc, RenderPipelineCache *pipelineCache) {
+        return std::make_unique<VulkanComputePipeline>(this, desc, static_cast<VulkanPipelineCache *>(pipelineCache));
     }
 
-    std::unique_ptr<RenderPipeline> VulkanDevice::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) {
-        return std::make_unique<VulkanGraphicsPipeline>(this, desc);
+    std::unique_ptr<RenderPipeline> VulkanDevice::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc, RenderPipelineCache *pipelineCache) {
+        return std::make_unique<VulkanGraphicsPipeline>(this, desc, static_cast<VulkanPipelineCache *>(pipelineCache));
     }
 
     std::unique_ptr<RenderPipeline> VulkanDevice::createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) {
@@ -3815,6 +3986,10 @@ namespace RT64 {
         return std::make_unique<VulkanPipelineLayout>(this, desc);
     }
 
+    std::unique_ptr<RenderPipelineCache> VulkanDevice::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<VulkanPipelineCache>(this, data, size);
+    }
+
     std::unique_ptr<RenderCommandFence> VulkanDevice::createCommandFence() {
         return std::make_unique<VulkanCommandFence>(this);
     }
@@ -3827,6 +4002,10 @@ namespace RT64 {
         return std::make_unique<VulkanFramebuffer>(this, desc);
     }
 
+    std::unique_ptr<RenderQueryPool> VulkanDevice::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<VulkanQueryPool>(this, queryCount);
+    }
+
     void VulkanDevice::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
         assert(meshes != nullptr);
         assert(meshCount > 0);